@@ -19,17 +19,24 @@
 */
 
 #include "csvimport.h"
+#include "csvstreamparser.h"
 
 #include <QByteArray>
 #include <QFile>
 #include <QRegExp>
+#include <QStringList>
+#include <QTextCodec>
+#include <QTextStream>
 #include <QVector>
 #include <QApplication>
 
+#include <kcharsets.h>
 #include <kmessagebox.h>
 #include <kdebug.h>
 #include <kpluginfactory.h>
 #include <klocale.h>
+#include <KConfigGroup>
+#include <KSharedConfig>
 
 #include <KoCsvImportDialog.h>
 #include <KoFilterChain.h>
@@ -38,14 +45,19 @@
 #include <sheets/ElapsedTime_p.h>
 #include <sheets/CalculationSettings.h>
 #include <sheets/Cell.h>
+#include <sheets/CellStorage.h>
+#include <sheets/DependencyManager.h>
+#include <sheets/Formula.h>
 #include <sheets/part/Doc.h>
 #include <sheets/Global.h>
 #include <sheets/Map.h>
+#include <sheets/RecalcManager.h>
 #include <sheets/RowColumnFormat.h>
 #include <sheets/Sheet.h>
 #include <sheets/Style.h>
 #include <sheets/Value.h>
 #include <sheets/ValueConverter.h>
+#include <sheets/ValueParser.h>
 
 using namespace Calligra::Sheets;
 
@@ -57,6 +69,62 @@ using namespace Calligra::Sheets;
  perl -e '$i=0;while($i<30000) { print rand().",".rand()."\n"; $i++ }' > file.csv
 */
 
+// The rows inserted at once and the characters they may hold. These bound
+// the memory used by the streaming import besides the sheet itself.
+static const int g_batchRows = 1024;
+static const int g_batchCharacters = 4 * 1024 * 1024;
+// The rows looked at to infer the column types and widths.
+static const int g_sampleRows = 100;
+
+// Resolves the encoding named in the import dialog like the dialog does.
+static QTextCodec* codecForDialogText(const QString& text)
+{
+    if (text.isEmpty())
+        return QTextCodec::codecForName("UTF-8");
+    const QString name = KCharsets::charsets()->encodingForName(text);
+    bool ok = false;
+    QTextCodec* codec = QTextCodec::codecForName(name.toUtf8());
+    if (!codec)
+        codec = KCharsets::charsets()->codecForName(name, ok);
+    else
+        ok = true;
+    if (!codec || !ok) {
+        kWarning(30501) << "Cannot find encoding:" << name;
+        return QTextCodec::codecForName("UTF-8");
+    }
+    return codec;
+}
+
+// Parses the field \p column of \p userInputs like Cell::parseUserInput()
+// does on a new sheet. A formula is moved to \p formulas, which grows on
+// demand. A \p numeric column is tried to be parsed as a number first.
+// Returns true for a formula.
+static bool parseField(Sheet* sheet, int row, int column, QStringList& userInputs, QVector<Value>& values,
+                       QVector<Formula>& formulas, bool numeric)
+{
+    const QString text = userInputs[column];
+    if (text.isEmpty())
+        return false;
+    if (text[0] == '=') {
+        Formula formula(sheet, Cell(sheet, column + 1, row));
+        formula.setExpression(text);
+        if (!formula.isValid())
+            values[column] = Value::errorPARSE();
+        formulas.resize(userInputs.count());
+        formulas[column] = formula;
+        userInputs[column].clear();
+        return true;
+    }
+    const ValueParser *const valueParser = sheet->map()->parser();
+    bool ok = false;
+    if (numeric && text[0] != '\'')
+        values[column] = valueParser->tryParseNumber(text.trimmed(), &ok);
+    if (!ok)
+        values[column] = valueParser->parse(text);
+    return false;
+}
+
+
 K_PLUGIN_FACTORY_WITH_JSON(CSVImportFactory, "calligra_filter_csv2sheets.json", registerPlugin<CSVFilter>();)
 
 CSVFilter::CSVFilter(QObject* parent, const QVariantList&) :
@@ -95,6 +163,12 @@ KoFilter::ConversionStatus CSVFilter::convert(const QByteArray& from, const QByt
         return KoFilter::FileNotFound;
     }
 
+    if (m_chain->manager()->getBatchMode()) {
+        const KoFilter::ConversionStatus status = convertStreaming(ksdoc, &in);
+        in.close();
+        return status;
+    }
+
     QString csv_delimiter;
     // ###### FIXME: disabled for now
     //if (!config.isNull())
@@ -138,10 +212,16 @@ KoFilter::ConversionStatus CSVFilter::convert(const QByteArray& from, const QByt
     for (int i = 0; i < numCols; ++i)
         widths[i] = defaultWidth;
 
-    Cell cell(sheet, 1, 1);
-    QFontMetrics fm(cell.style().font());
+    QFontMetrics fm(Cell(sheet, 1, 1).style().font());
+    const ValueConverter *const converter = ksdoc->map()->converter();
+    CellStorage *const storage = sheet->cellStorage();
 
+    // The dependencies and values are updated once at the end.
+    storage->beginBulkInsertion();
     for (int row = 0; row < numRows; ++row) {
+        QStringList userInputs;
+        QVector<Value> values(numCols);
+        QVector<Formula> formulas;
         for (int col = 0; col < numCols; ++col) {
             value += step;
             emit sigProgress(value);
@@ -152,40 +232,40 @@ KoFilter::ConversionStatus CSVFilter::convert(const QByteArray& from, const QByt
             if (len > widths[col])
                 widths[col] = len;
 
-            cell = Cell(sheet, col + 1, row + 1);
-
+            userInputs << text;
             switch (dialog->dataType(col)) {
             case KoCsvImportDialog::Generic:
             default: {
-                cell.parseUserInput(text);
+                parseField(sheet, row + 1, col, userInputs, values, formulas, false);
                 break;
             }
             case KoCsvImportDialog::Text: {
-                Value value(text);
-                cell.setValue(value);
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
+                values[col] = Value(text);
+                userInputs[col] = converter->asString(values[col]).asString();
                 break;
             }
             case KoCsvImportDialog::Date: {
                 Value value(text);
-                cell.setValue(ksdoc->map()->converter()->asDate(value));
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
+                values[col] = converter->asDate(value);
+                userInputs[col] = converter->asString(value).asString();
                 break;
             }
             case KoCsvImportDialog::Currency: {
-                Value value(text);
-                value.setFormat(Value::fmt_Money);
-                cell.setValue(value);
-                cell.setUserInput(ksdoc->map()->converter()->asString(value).asString());
+                values[col] = Value(text);
+                values[col].setFormat(Value::fmt_Money);
+                userInputs[col] = converter->asString(values[col]).asString();
                 break;
             }
             case KoCsvImportDialog::None: {
                 // just skip the content
+                userInputs[col].clear();
                 break;
             }
             }
         }
+        storage->insertRow(row + 1, 1, userInputs, values, formulas);
     }
+    storage->endBulkInsertion();
 
     emit sigProgress(98);
 
@@ -205,4 +285,108 @@ KoFilter::ConversionStatus CSVFilter::convert(const QByteArray& from, const QByt
     return KoFilter::OK;
 }
 
+KoFilter::ConversionStatus CSVFilter::convertStreaming(Doc* ksdoc, QIODevice* device)
+{
+    ElapsedTime t("Streaming data into document");
+
+    // Use the settings of the import dialog; in batch mode it would not
+    // be shown either.
+    const KConfigGroup configGroup = KSharedConfig::openConfig()->group("CSVDialog Settings");
+    const QChar textQuote = configGroup.readEntry("textQuote", "\"").at(0);
+    const QString delimiter = configGroup.readEntry("delimiter", ",");
+    const bool ignoreDuplicates = configGroup.readEntry("ignoreDups", false);
+    const QString codecText = configGroup.readEntry("codec", "");
+
+    QTextStream stream(device);
+    stream.setCodec(codecForDialogText(codecText));
+    CsvStreamParser parser(&stream, delimiter, textQuote, ignoreDuplicates);
+
+    Map *const map = ksdoc->map();
+    Sheet *sheet = map->addNewSheet();
+    CellStorage *const storage = sheet->cellStorage();
+    const ValueParser *const valueParser = map->parser();
+    const qint64 size = qMax<qint64>(device->size(), 1);
+
+    emit sigProgress(0);
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+
+    // The dependencies and values are updated once at the end.
+    map->setLoading(true);
+
+    const double defaultWidth = map->defaultColumnFormat()->width();
+    QFontMetrics fm(Cell(sheet, 1, 1).style().font());
+    QVector<double> widths;
+    // Columns holding only numbers in the first rows are parsed as such
+    // directly; anything else falls back to the generic parsing.
+    QVector<bool> numeric;
+    bool formulas = false;
+
+    QVector<QStringList> rows;
+    int row = 1;
+    bool more = true;
+    while (more) {
+        rows.clear();
+        more = parser.readRows(rows, g_batchRows, g_batchCharacters);
+
+        if (row == 1) {
+            // A column is taken as numeric, if most of its sampled fields are
+            // numbers; a header row does not spoil it.
+            QVector<int> votes;
+            const int sampleRows = qMin(rows.count(), g_sampleRows);
+            for (int r = 0; r < sampleRows; ++r) {
+                const QStringList& fields = rows[r];
+                if (fields.count() > votes.count()) {
+                    votes.resize(fields.count());
+                    widths.resize(fields.count());
+                }
+                for (int col = 0; col < fields.count(); ++col) {
+                    const QString& text = fields[col];
+                    // ### FIXME: how to calculate the width of numbers (as they might not be in the right format)
+                    widths[col] = qMax(widths[col], double(fm.width(text)));
+                    if (text.isEmpty())
+                        continue;
+                    bool ok = false;
+                    if (text[0] != '\'' && text[0] != '=')
+                        valueParser->tryParseNumber(text.trimmed(), &ok);
+                    votes[col] += ok ? 1 : -1;
+                }
+            }
+            numeric.resize(votes.count());
+            for (int col = 0; col < votes.count(); ++col)
+                numeric[col] = votes[col] > 0;
+        }
+
+        storage->beginBulkInsertion();
+        for (int r = 0; r < rows.count(); ++r, ++row) {
+            QStringList userInputs = rows[r];
+            QVector<Value> values(userInputs.count());
+            QVector<Formula> cellFormulas;
+            for (int col = 0; col < userInputs.count(); ++col) {
+                const bool numericColumn = col < numeric.count() && numeric[col];
+                if (parseField(sheet, row, col, userInputs, values, cellFormulas, numericColumn))
+                    formulas = true;
+            }
+            storage->insertRow(row, 1, userInputs, values, cellFormulas);
+        }
+        storage->endBulkInsertion();
+        emit sigProgress(int(qMin<qint64>(device->pos() * 98 / size, 98)));
+    }
+
+    for (int i = 0; i < widths.count(); ++i) {
+        if (widths[i] > defaultWidth)
+            sheet->nonDefaultColumnFormat(i + 1)->setWidth(widths[i]);
+    }
+
+    map->setLoading(false);
+    if (formulas) {
+        map->dependencyManager()->updateAllDependencies(map);
+        map->recalcManager()->recalcMap();
+    }
+
+    emit sigProgress(100);
+    QApplication::restoreOverrideCursor();
+
+    return KoFilter::OK;
+}
+
 #include <csvimport.moc>
@@ -23,6 +23,16 @@
 #include <KoFilter.h>
 #include <QVariantList>
 
+class QIODevice;
+
+namespace Calligra
+{
+namespace Sheets
+{
+class Doc;
+}
+}
+
 class CSVFilter : public KoFilter
 {
 
@@ -33,5 +43,14 @@ public:
     virtual ~CSVFilter() {}
 
     virtual KoFilter::ConversionStatus convert(const QByteArray& from, const QByteArray& to);
+
+private:
+    /**
+     * Imports the CSV data from \p device without the import dialog.
+     * The data is parsed in chunks and inserted in batches of rows, so
+     * that the memory used besides the sheet does not depend on the size
+     * of the file. Used in batch mode.
+     */
+    KoFilter::ConversionStatus convertStreaming(Calligra::Sheets::Doc* doc, QIODevice* device);
 };
 #endif // CSVIMPORT_H
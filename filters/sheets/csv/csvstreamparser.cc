@@ -0,0 +1,127 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "csvstreamparser.h"
+
+#include <QTextStream>
+
+bool CsvStreamParser::readRows(QVector<QStringList>& rows, int maxRows, int maxCharacters)
+{
+    m_rows = &rows;
+    m_characters = 0;
+    while (rows.count() < maxRows && m_characters < maxCharacters) {
+        if (m_position >= m_buffer.length()) {
+            m_buffer = m_stream->read(m_chunkSize);
+            m_position = 0;
+            if (m_buffer.isEmpty()) {
+                // the last line of the file had not any line end
+                if (m_state != Start || !m_field.isEmpty() || !m_row.isEmpty())
+                    endRow();
+                return false;
+            }
+        }
+        QChar x = m_buffer.at(m_position++);
+
+        if (x == '\r') {
+            // We have a Carriage Return, assume that its role is the one of a LineFeed
+            m_lastCharWasCr = true;
+            x = '\n';
+        } else if (x == '\n' && m_lastCharWasCr) {
+            // The end of line was already handled by the Carriage Return
+            m_lastCharWasCr = false;
+            continue;
+        } else if (x == QChar(0xc)) {
+            // We have a FormFeed, skip it
+            m_lastCharWasCr = false;
+            continue;
+        } else {
+            m_lastCharWasCr = false;
+        }
+
+        switch (m_state) {
+        case Start:
+            if (x == m_textQuote) {
+                m_state = QuotedField;
+            } else if (x == '\n') {
+                endRow();
+            } else {
+                m_field += x;
+                if (atDelimiter()) {
+                    m_field.chop(m_delimiter.length());
+                    if (!m_ignoreDuplicates || !m_lastCharDelimiter || !m_field.isEmpty())
+                        endField();
+                    m_lastCharDelimiter = true;
+                    continue;
+                }
+                if (m_delimiter.isEmpty() || x != m_delimiter.at(0))
+                    m_state = NormalField;
+            }
+            break;
+        case QuotedField:
+            if (x == m_textQuote)
+                m_state = MaybeEndOfQuotedField;
+            else
+                m_field += x;
+            break;
+        case MaybeEndOfQuotedField:
+            if (x == m_textQuote) {
+                // a doubled quote
+                m_field += x;
+                m_state = QuotedField;
+                break;
+            }
+            m_unquoted = m_field.length();
+            m_state = NormalField;
+            // fall through
+        case NormalField:
+            if (x == '\n') {
+                endRow();
+            } else {
+                m_field += x;
+                if (atDelimiter()) {
+                    m_field.chop(m_delimiter.length());
+                    endField();
+                    m_lastCharDelimiter = true;
+                    continue;
+                }
+            }
+            break;
+        }
+        m_lastCharDelimiter = false;
+    }
+    return true;
+}
+
+void CsvStreamParser::endField()
+{
+    m_characters += m_field.length();
+    m_row.append(m_field);
+    m_field.clear();
+    m_unquoted = 0;
+    m_state = Start;
+}
+
+void CsvStreamParser::endRow()
+{
+    if (!m_field.isEmpty() || !m_row.isEmpty())
+        endField();
+    m_rows->append(m_row);
+    m_row.clear();
+    m_state = Start;
+}
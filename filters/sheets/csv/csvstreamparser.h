@@ -0,0 +1,89 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CSVSTREAMPARSER_H
+#define CSVSTREAMPARSER_H
+
+#include <QChar>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QTextStream;
+
+/**
+ * Parses CSV data chunk by chunk with the state machine described in the
+ * DESIGN file. Quoted fields may span several lines.
+ *
+ * The codec of the stream has to be set by the caller.
+ */
+class CsvStreamParser
+{
+public:
+    CsvStreamParser(QTextStream* stream, const QString& delimiter, QChar textQuote, bool ignoreDuplicates,
+                    int chunkSize = 64 * 1024)
+            : m_stream(stream)
+            , m_chunkSize(chunkSize)
+            , m_delimiter(delimiter)
+            , m_textQuote(textQuote)
+            , m_ignoreDuplicates(ignoreDuplicates)
+            , m_state(Start)
+            , m_position(0)
+            , m_unquoted(0)
+            , m_lastCharDelimiter(false)
+            , m_lastCharWasCr(false)
+            , m_rows(0)
+            , m_characters(0) {
+    }
+
+    /**
+     * Appends the next rows to \p rows, until either \p maxRows rows or
+     * \p maxCharacters characters are read.
+     * \return \c false, if the end of the data has been reached
+     */
+    bool readRows(QVector<QStringList>& rows, int maxRows, int maxCharacters);
+
+private:
+    bool atDelimiter() const {
+        return !m_delimiter.isEmpty() && m_field.length() - m_delimiter.length() >= m_unquoted
+               && m_field.endsWith(m_delimiter);
+    }
+    void endField();
+    void endRow();
+
+    enum State { Start, QuotedField, MaybeEndOfQuotedField, NormalField };
+
+    QTextStream* m_stream;
+    const int m_chunkSize;      // the characters read from the stream at once
+    const QString m_delimiter;
+    const QChar m_textQuote;
+    const bool m_ignoreDuplicates;
+    State m_state;
+    QString m_buffer;
+    int m_position;
+    QString m_field;
+    int m_unquoted;     // the start of the unquoted part of the field
+    QStringList m_row;
+    bool m_lastCharDelimiter;
+    bool m_lastCharWasCr;
+    QVector<QStringList>* m_rows;
+    int m_characters;
+};
+
+#endif // CSVSTREAMPARSER_H
@@ -0,0 +1,80 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestCsvStreamParser.h"
+
+#include <QTest>
+#include <QTextStream>
+
+#include "csvstreamparser.h"
+
+typedef QVector<QStringList> Rows;
+
+static const QString g_data = QString::fromUtf8(
+    "a,\"b,c\",d\n"
+    "\"line1\nline2\",x\r\n"
+    "\"say \"\"hi\"\"\",y\n"
+    "a,,b");
+
+// Parses all of data, maxRows rows and chunkSize characters at once.
+static Rows parse(QString data, bool ignoreDuplicates, int chunkSize = 64 * 1024, int maxRows = 1024)
+{
+    QTextStream stream(&data, QIODevice::ReadOnly);
+    CsvStreamParser parser(&stream, QString(','), QChar('"'), ignoreDuplicates, chunkSize);
+    Rows rows;
+    while (parser.readRows(rows, rows.count() + maxRows, 1024 * 1024)) {
+    }
+    return rows;
+}
+
+static Rows expectedRows()
+{
+    Rows rows;
+    rows << (QStringList() << "a" << "b,c" << "d");
+    rows << (QStringList() << "line1\nline2" << "x");
+    rows << (QStringList() << "say \"hi\"" << "y");
+    rows << (QStringList() << "a" << "" << "b");
+    return rows;
+}
+
+void TestCsvStreamParser::testFields()
+{
+    QCOMPARE(parse(g_data, false), expectedRows());
+    // the rows do not depend on the batches they are read in
+    QCOMPARE(parse(g_data, false, 64 * 1024, 1), expectedRows());
+}
+
+void TestCsvStreamParser::testIgnoreDuplicates()
+{
+    Rows expected = expectedRows();
+    expected[3] = QStringList() << "a" << "b";
+    QCOMPARE(parse(g_data, true), expected);
+    // quoted empty fields are kept
+    QCOMPARE(parse("a,\"\",b\n", true), Rows() << (QStringList() << "a" << "" << "b"));
+}
+
+void TestCsvStreamParser::testChunkBoundaries()
+{
+    // Each chunk size puts a boundary at another place, among them inside
+    // the quoted fields, between the doubled quotes and inside the CR LF.
+    for (int chunkSize = 1; chunkSize <= g_data.length(); ++chunkSize)
+        QCOMPARE(parse(g_data, false, chunkSize), expectedRows());
+}
+
+QTEST_GUILESS_MAIN(TestCsvStreamParser)
@@ -335,7 +335,8 @@ bool KarbonDocument::saveOdf(SavingContext &documentContext)
 
     mainStyles.saveOdfStyles(KoGenStyles::DocumentAutomaticStyles, contentWriter);
 
-    documentContext.odfStore.closeContentWriter();
+    if (!documentContext.odfStore.closeContentWriter())
+        return false;
 
     //add manifest line for content.xml
     documentContext.odfStore.manifestWriter()->addManifestEntry("content.xml", "text/xml");
@@ -92,6 +92,8 @@ KarbonCanvas::KarbonCanvas(KarbonDocument *p)
     d->part = p;
     d->toolProxy = new KoToolProxy(this);
     d->shapeManager = new KoShapeManager(this, d->part->shapes());
+    // documents with many paths scroll and zoom much smoother this way
+    d->shapeManager->setTiledPaintingEnabled(true);
     connect(d->shapeManager, SIGNAL(selectionChanged()), this, SLOT(updateSizeAndOffset()));
 
     setBackgroundRole(QPalette::Base);
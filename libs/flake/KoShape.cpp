@@ -49,6 +49,7 @@
 #include "KoEventActionRegistry.h"
 #include "KoOdfWorkaround.h"
 #include "KoFilterEffectStack.h"
+#include "KoShapeRasterCache_p.h"
 #include <KoSnapData.h>
 #include <KoElementReference.h>
 
@@ -75,6 +76,13 @@
 #include <limits>
 #include "KoOdfGradientBackground.h"
 
+/// Drops the cached filter effects and shadows of @p shape and its ancestors
+static void invalidateRasterCache(const KoShape *shape)
+{
+    if (KoShapeRasterCache *cache = KoShapeRasterCache::instance())
+        cache->invalidate(shape);
+}
+
 // KoShapePrivate
 
 KoShapePrivate::KoShapePrivate(KoShape *shape)
@@ -124,6 +132,7 @@ KoShapePrivate::KoShapePrivate(KoShape *shape)
 KoShapePrivate::~KoShapePrivate()
 {
     Q_Q(KoShape);
+    invalidateRasterCache(q);
     if (parent)
         parent->removeShape(q);
     foreach(KoShapeManager *manager, shapeManagers) {
@@ -145,6 +154,7 @@ KoShapePrivate::~KoShapePrivate()
 void KoShapePrivate::shapeChanged(KoShape::ChangeType type)
 {
     Q_Q(KoShape);
+    invalidateRasterCache(q);
     if (parent)
         parent->model()->childChanged(q, type);
     q->shapeChanged(type);
@@ -588,6 +598,8 @@ void KoShape::update() const
 {
     Q_D(const KoShape);
 
+    invalidateRasterCache(this);
+
     if (!d->shapeManagers.empty()) {
         QRectF rect(boundingRect());
         foreach(KoShapeManager * manager, d->shapeManagers) {
@@ -605,6 +617,7 @@ void KoShape::update(const QRectF &rect) const
 
     Q_D(const KoShape);
 
+    invalidateRasterCache(this);
     if (!d->shapeManagers.empty() && isVisible()) {
         QRectF rc(absoluteTransformation(0).mapRect(rect));
         foreach(KoShapeManager * manager, d->shapeManagers) {
@@ -686,6 +699,7 @@ void KoShape::copySettings(const KoShape *shape)
 void KoShape::notifyChanged()
 {
     Q_D(KoShape);
+    invalidateRasterCache(this);
     foreach(KoShapeManager * manager, d->shapeManagers) {
         manager->notifyShapeChanged(this);
     }
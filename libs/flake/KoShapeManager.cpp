@@ -42,11 +42,75 @@
 #include <KoRTree.h>
 #include "KoClipPath.h"
 #include "KoShapePaintingContext.h"
+#include "KoShapeRasterCache_p.h"
+#include "KoPathShape.h"
+#include "KoPatternBackground.h"
 
 #include <QPainter>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QTimer>
 #include <FlakeDebug.h>
 
+namespace
+{
+/// the edge length of the tiles painted on the thread pool
+const int TileSize = 256;
+/// fewer shapes are painted directly, as splitting them into tiles costs more than it saves
+const int MinimumTiledShapeCount = 16;
+
+QThreadPool *tilePool()
+{
+    static QThreadPool threadPool;
+    return &threadPool;
+}
+} // namespace
+
+/**
+ * Paints the shapes intersecting a tile of the painted area into an image.
+ */
+class KoShapeManager::Private::TileJob : public QRunnable
+{
+public:
+    TileJob(KoShapeManager::Private *manager, const QRect &rect, int devicePixelRatio,
+            QPainter::RenderHints renderHints, const KoViewConverter &converter, bool forPrint)
+        : manager(manager)
+        , rect(rect)
+        , devicePixelRatio(devicePixelRatio)
+        , renderHints(renderHints)
+        , converter(converter)
+        , forPrint(forPrint)
+    {
+        setAutoDelete(false);
+    }
+
+    virtual void run()
+    {
+        image = QImage(rect.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(devicePixelRatio);
+        image.fill(Qt::transparent);
+
+        QPainter painter(&image);
+        painter.setRenderHints(renderHints);
+        painter.translate(-rect.topLeft());
+        painter.setClipRect(rect);
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(Qt::NoBrush);
+        manager->paintShapes(shapes, painter, converter, forPrint);
+    }
+
+    KoShapeManager::Private *manager;
+    QRect rect;
+    QList<KoShape*> shapes;
+    QImage image;
+
+private:
+    int devicePixelRatio;
+    QPainter::RenderHints renderHints;
+    const KoViewConverter &converter;
+    bool forPrint;
+};
+
 
 void KoShapeManager::Private::updateTree()
 {
@@ -103,6 +167,105 @@ void KoShapeManager::Private::paintGroup(KoShapeGroup *group, QPainter &painter,
     }
 }
 
+void KoShapeManager::Private::paintShapes(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint)
+{
+    foreach (KoShape *shape, shapes) {
+        if (shape->parent() != 0 && shape->parent()->isClipped(shape))
+            continue;
+
+        painter.save();
+
+        // apply shape clipping
+        KoClipPath::applyClipping(shape, painter, converter);
+
+        // let the painting strategy paint the shape
+        KoShapePaintingContext paintContext(canvas, forPrint); //FIXME
+        strategy->paint(shape, painter, converter, paintContext);
+
+        painter.restore();
+    }
+}
+
+void KoShapeManager::Private::paintTiled(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint)
+{
+    // shapes which have to be painted on this thread split the others into runs,
+    // which are tiled one after the other to keep the stacking order
+    QList<KoShape*> run;
+    foreach (KoShape *shape, shapes) {
+        if (canPaintInThread(shape)) {
+            run.append(shape);
+        } else {
+            paintTiles(run, painter, converter, forPrint);
+            run.clear();
+            paintShapes(QList<KoShape*>() << shape, painter, converter, forPrint);
+        }
+    }
+    paintTiles(run, painter, converter, forPrint);
+}
+
+void KoShapeManager::Private::paintTiles(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint)
+{
+    if (shapes.count() < MinimumTiledShapeCount) {
+        paintShapes(shapes, painter, converter, forPrint);
+        return;
+    }
+
+    // the shapes are not changed while painting, so their areas are determined up front
+    QVector<QRectF> shapeRects;
+    shapeRects.reserve(shapes.count());
+    foreach (KoShape *shape, shapes) {
+        QRectF br(shape->boundingRect());
+        strategy->adapt(shape, br);
+        // leave room for antialiasing
+        shapeRects.append(converter.documentToView(br).adjusted(-1, -1, 1, 1));
+    }
+
+    const QRegion clipRegion = painter.clipRegion();
+    const QRect bounds = clipRegion.boundingRect();
+    const int devicePixelRatio = painter.device()->devicePixelRatio();
+    QList<TileJob*> jobs;
+    for (int y = bounds.top(); y <= bounds.bottom(); y += TileSize) {
+        for (int x = bounds.left(); x <= bounds.right(); x += TileSize) {
+            const QRect rect = QRect(x, y, TileSize, TileSize) & bounds;
+            if (!clipRegion.intersects(rect))
+                continue;
+            QList<KoShape*> tileShapes;
+            for (int i = 0; i < shapes.count(); ++i) {
+                if (shapeRects[i].intersects(rect))
+                    tileShapes.append(shapes[i]);
+            }
+            if (tileShapes.isEmpty())
+                continue;
+            TileJob *job = new TileJob(this, rect, devicePixelRatio, painter.renderHints(), converter, forPrint);
+            job->shapes = tileShapes;
+            jobs.append(job);
+        }
+    }
+    if (jobs.isEmpty())
+        return;
+
+    // this thread paints the first tile itself instead of just waiting
+    for (int i = 1; i < jobs.count(); ++i) {
+        tilePool()->start(jobs[i]);
+    }
+    jobs.first()->run();
+    tilePool()->waitForDone();
+
+    foreach (TileJob *job, jobs) {
+        painter.drawImage(job->rect.topLeft(), job->image);
+    }
+    qDeleteAll(jobs);
+}
+
+bool KoShapeManager::Private::canPaintInThread(KoShape *shape)
+{
+    // path shapes paint with paths and images only, while e.g. pictures and
+    // pattern backgrounds use pixmaps, which are bound to the GUI thread
+    if (!dynamic_cast<KoPathShape*>(shape))
+        return false;
+    return !dynamic_cast<KoPatternBackground*>(shape->background().data());
+}
+
 KoShapeManager::KoShapeManager(KoCanvasBase *canvas, const QList<KoShape *> &shapes)
         : d(new Private(this, canvas))
 {
@@ -261,20 +424,10 @@ void KoShapeManager::paint(QPainter &painter, const KoViewConverter &converter,
 
     qSort(sortedShapes.begin(), sortedShapes.end(), KoShape::compareShapeZIndex);
 
-    foreach (KoShape *shape, sortedShapes) {
-        if (shape->parent() != 0 && shape->parent()->isClipped(shape))
-            continue;
-
-        painter.save();
-
-        // apply shape clipping
-        KoClipPath::applyClipping(shape, painter, converter);
-
-        // let the painting strategy paint the shape
-        KoShapePaintingContext paintContext(d->canvas, forPrint); //FIXME
-        d->strategy->paint(shape, painter, converter, paintContext);
-
-        painter.restore();
+    if (d->tiledPainting && painter.hasClipping() && painter.transform().type() <= QTransform::TxTranslate) {
+        d->paintTiled(sortedShapes, painter, converter, forPrint);
+    } else {
+        d->paintShapes(sortedShapes, painter, converter, forPrint);
     }
 
 #ifdef CALLIGRA_RTREE_DEBUG
@@ -316,6 +469,20 @@ void KoShapeManager::paintShape(KoShape *shape, QPainter &painter, const KoViewC
             painter.restore();
         }
     } else {
+        // The filtered image only depends on the zoom, reuse it as long as the shape does not change
+        KoShapeRasterCache *cache = KoShapeRasterCache::instance();
+        const bool antialiasing = painter.testRenderHint(QPainter::Antialiasing);
+        if (cache) {
+            QPointF offset;
+            const QImage image = cache->image(shape, KoShapeRasterCache::FilterEffects, converter, antialiasing, &offset);
+            if (!image.isNull()) {
+                painter.save();
+                painter.drawImage(offset, image);
+                painter.restore();
+                return;
+            }
+        }
+
         // There are filter effects, then we need to prerender the shape on an image, to filter it
         QRectF shapeBound(QPointF(), shape->size());
         // First step, compute the rectangle used for the image
@@ -339,7 +506,7 @@ void KoShapeManager::paintShape(KoShape *shape, QPainter &painter, const KoViewC
             imagePainter.translate(-1.0f*clippingOffset);
             imagePainter.setPen(Qt::NoPen);
             imagePainter.setBrush(Qt::NoBrush);
-            imagePainter.setRenderHint(QPainter::Antialiasing, painter.testRenderHint(QPainter::Antialiasing));
+            imagePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
 
             // Paint the shape on the image
             KoShapeGroup *group = dynamic_cast<KoShapeGroup*>(shape);
@@ -419,10 +586,14 @@ void KoShapeManager::paintShape(KoShape *shape, QPainter &painter, const KoViewC
         }
 
         KoFilterEffect *lastEffect = filterEffects.last();
+        const QImage filtered = imageBuffers.value(lastEffect->output());
+        if (cache) {
+            cache->insert(shape, KoShapeRasterCache::FilterEffects, converter, antialiasing, filtered, clippingOffset);
+        }
 
         // Paint the result
         painter.save();
-        painter.drawImage(clippingOffset, imageBuffers.value(lastEffect->output()));
+        painter.drawImage(clippingOffset, filtered);
         painter.restore();
     }
 }
@@ -582,6 +753,16 @@ void KoShapeManager::setPaintingStrategy(KoShapeManagerPaintingStrategy *strateg
     d->strategy = strategy;
 }
 
+void KoShapeManager::setTiledPaintingEnabled(bool enabled)
+{
+    d->tiledPainting = enabled;
+}
+
+bool KoShapeManager::isTiledPaintingEnabled() const
+{
+    return d->tiledPainting;
+}
+
 KoCanvasBase *KoShapeManager::canvas()
 {
     return d->canvas;
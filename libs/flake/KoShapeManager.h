@@ -198,6 +198,25 @@ public:
      */
     void setPaintingStrategy(KoShapeManagerPaintingStrategy *strategy);
 
+    /**
+     * Set whether paint() renders the shapes in tiles on a thread pool
+     *
+     * The clip region of the painter is split into tiles, which are painted
+     * in parallel and then composited onto the painter. Only path shapes are
+     * painted in the tiles; other shapes, e.g. those using pixmaps, are painted
+     * on the calling thread in between, so the stacking order is kept.
+     * Painters transformed by more than a translation are painted on directly.
+     *
+     * The painting strategy must allow painting from several threads at once
+     * and its adapt() must cover everything it paints of a shape.
+     * This is disabled by default.
+     * @param enabled if true, paint in tiles
+     */
+    void setTiledPaintingEnabled(bool enabled);
+
+    /// @return true if paint() renders the shapes in tiles on a thread pool
+    bool isTiledPaintingEnabled() const;
+
 Q_SIGNALS:
     /// emitted when the selection is changed
     void selectionChanged();
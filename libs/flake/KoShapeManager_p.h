@@ -55,7 +55,8 @@ public:
           canvas(c),
           tree(4, 2),
           strategy(new KoShapeManagerPaintingStrategy(shapeManager)),
-          q(shapeManager)
+          q(shapeManager),
+          tiledPainting(false)
     {
     }
 
@@ -77,6 +78,28 @@ public:
      */
     void paintGroup(KoShapeGroup *group, QPainter &painter, const KoViewConverter &converter, KoShapePaintingContext &paintContext);
 
+    /**
+     * Paints the given shapes, sorted by their z-index, with the painting strategy
+     */
+    void paintShapes(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint);
+
+    /**
+     * Paints the given shapes, sorted by their z-index, in tiles on the thread pool
+     * where possible, see KoShapeManager::setTiledPaintingEnabled()
+     */
+    void paintTiled(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint);
+
+    /**
+     * Paints the given shapes into tiles covering the clip region of the painter
+     * and composites the tiles onto the painter
+     */
+    void paintTiles(const QList<KoShape*> &shapes, QPainter &painter, const KoViewConverter &converter, bool forPrint);
+
+    /// @return true if the shape can be painted outside the GUI thread
+    static bool canPaintInThread(KoShape *shape);
+
+    class TileJob;
+
     class DetectCollision
     {
     public:
@@ -118,6 +141,7 @@ public:
     QHash<KoShape*, int> shapeIndexesBeforeUpdate;
     KoShapeManagerPaintingStrategy *strategy;
     KoShapeManager *q;
+    bool tiledPainting;
 };
 
 #endif
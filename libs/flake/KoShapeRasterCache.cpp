@@ -0,0 +1,178 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "KoShapeRasterCache_p.h"
+
+#include "KoShape.h"
+#include "KoShapeContainer.h"
+#include "KoViewConverter.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+
+namespace
+{
+// enough for a few dozen shapes on a large screen
+const int DefaultMaximumSize = 64 * 1024;
+
+struct Key
+{
+    const KoShape *shape;
+    int layer;
+    qreal zoomX;
+    qreal zoomY;
+    bool antialiasing;
+
+    bool operator==(const Key &other) const {
+        return shape == other.shape && layer == other.layer
+            && zoomX == other.zoomX && zoomY == other.zoomY
+            && antialiasing == other.antialiasing;
+    }
+};
+
+uint qHash(const Key &key, uint seed = 0)
+{
+    return ::qHash(key.shape, seed) ^ ::qHash(key.layer, seed) ^ ::qHash(key.zoomX, seed)
+        ^ ::qHash(key.zoomY, seed) ^ uint(key.antialiasing);
+}
+
+Key makeKey(const KoShape *shape, KoShapeRasterCache::Layer layer, const KoViewConverter &converter, bool antialiasing)
+{
+    Key key;
+    key.shape = shape;
+    key.layer = layer;
+    converter.zoom(&key.zoomX, &key.zoomY);
+    key.antialiasing = antialiasing;
+    return key;
+}
+
+struct Entry
+{
+    QImage image;
+    QPointF offset;
+};
+} // namespace
+
+Q_GLOBAL_STATIC(KoShapeRasterCache, s_instance)
+
+class Q_DECL_HIDDEN KoShapeRasterCache::Private
+{
+public:
+    Private()
+        : images(DefaultMaximumSize)
+    {
+    }
+
+    mutable QMutex mutex;
+    // the cost of an image is its size in kilobytes
+    QCache<Key, Entry> images;
+    // the shapes, which had images inserted; images may have been dropped since
+    QSet<const KoShape*> shapes;
+};
+
+KoShapeRasterCache::KoShapeRasterCache()
+    : d(new Private())
+{
+}
+
+KoShapeRasterCache::~KoShapeRasterCache()
+{
+    delete d;
+}
+
+KoShapeRasterCache *KoShapeRasterCache::instance()
+{
+    // shapes may still be deleted after the cache on exit
+    if (s_instance.isDestroyed())
+        return 0;
+    return s_instance;
+}
+
+QImage KoShapeRasterCache::image(const KoShape *shape, Layer layer, const KoViewConverter &converter,
+                                 bool antialiasing, QPointF *offset) const
+{
+    const Key key = makeKey(shape, layer, converter, antialiasing);
+    QMutexLocker locker(&d->mutex);
+    // QCache::object() marks the entry as recently used
+    Entry *entry = d->images.object(key);
+    if (!entry)
+        return QImage();
+    if (offset)
+        *offset = entry->offset;
+    return entry->image;
+}
+
+void KoShapeRasterCache::insert(const KoShape *shape, Layer layer, const KoViewConverter &converter,
+                                bool antialiasing, const QImage &image, const QPointF &offset)
+{
+    if (image.isNull())
+        return;
+
+    const Key key = makeKey(shape, layer, converter, antialiasing);
+    Entry *entry = new Entry;
+    entry->image = image;
+    entry->offset = offset;
+    const int cost = qMax(1, image.byteCount() / 1024);
+
+    QMutexLocker locker(&d->mutex);
+    // takes ownership of the entry, also if it is too large to be kept
+    if (d->images.insert(key, entry, cost))
+        d->shapes.insert(shape);
+}
+
+void KoShapeRasterCache::invalidate(const KoShape *shape)
+{
+    QMutexLocker locker(&d->mutex);
+    if (d->shapes.isEmpty())
+        return;
+
+    QSet<const KoShape*> dropped;
+    for (const KoShape *s = shape; s; s = s->parent()) {
+        if (d->shapes.remove(s))
+            dropped.insert(s);
+    }
+    if (dropped.isEmpty())
+        return;
+
+    foreach (const Key &key, d->images.keys()) {
+        if (dropped.contains(key.shape))
+            d->images.remove(key);
+    }
+}
+
+void KoShapeRasterCache::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    d->images.clear();
+    d->shapes.clear();
+}
+
+void KoShapeRasterCache::setMaximumSize(int kilobytes)
+{
+    QMutexLocker locker(&d->mutex);
+    d->images.setMaxCost(kilobytes);
+}
+
+int KoShapeRasterCache::maximumSize() const
+{
+    QMutexLocker locker(&d->mutex);
+    return d->images.maxCost();
+}
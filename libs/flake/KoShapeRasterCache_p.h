@@ -0,0 +1,90 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOSHAPERASTERCACHE_P_H
+#define KOSHAPERASTERCACHE_P_H
+
+#include <QImage>
+#include <QPointF>
+
+class KoShape;
+class KoViewConverter;
+
+/**
+ * Keeps the rasterised filter effects and blurred shadows of shapes, so
+ * they are not rendered again on every repaint, e.g. while scrolling.
+ *
+ * The images are kept per shape and zoom level. They are dropped when the
+ * shape or one of its children changes, see invalidate(). All the images
+ * together are limited to a memory budget; the least recently used ones
+ * are dropped first when it is exceeded.
+ *
+ * The cache may be used from several threads at once.
+ */
+class KoShapeRasterCache
+{
+public:
+    enum Layer {
+        FilterEffects,  ///< the shape with its filter effects applied
+        Shadow          ///< the blurred shadow of the shape
+    };
+
+    /// @return the cache, or 0 if it was already destroyed on exit
+    static KoShapeRasterCache *instance();
+
+    /**
+     * Looks up the image of @p layer of @p shape painted with @p converter.
+     * @param offset is set to the offset the image was inserted with
+     * @return the image or a null image if there is none
+     */
+    QImage image(const KoShape *shape, Layer layer, const KoViewConverter &converter,
+                 bool antialiasing, QPointF *offset = 0) const;
+
+    /**
+     * Inserts the image of @p layer of @p shape painted with @p converter.
+     * Images larger than the budget are not cached.
+     */
+    void insert(const KoShape *shape, Layer layer, const KoViewConverter &converter,
+                bool antialiasing, const QImage &image, const QPointF &offset = QPointF());
+
+    /**
+     * Drops all images of @p shape and of its ancestors, which contain
+     * the shape in their filtered images.
+     */
+    void invalidate(const KoShape *shape);
+
+    /// Drops all images
+    void clear();
+
+    /// Sets the memory budget of all images in kilobytes
+    void setMaximumSize(int kilobytes);
+    /// @return the memory budget of all images in kilobytes
+    int maximumSize() const;
+
+    KoShapeRasterCache();
+    ~KoShapeRasterCache();
+
+private:
+    Q_DISABLE_COPY(KoShapeRasterCache)
+
+    class Private;
+    Private * const d;
+};
+
+#endif
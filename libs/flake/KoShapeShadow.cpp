@@ -28,6 +28,7 @@
 #include "KoShape.h"
 #include "KoInsets.h"
 #include "KoPathShape.h"
+#include "KoShapeRasterCache_p.h"
 #include <KoGenStyle.h>
 #include <KoViewConverter.h>
 #include <FlakeDebug.h>
@@ -63,6 +64,12 @@ public:
      */
     void paintShadow(KoShape *shape, QPainter &painter, const KoViewConverter &converter);
     void blurShadow(QImage &image, int radius, const QColor& shadowColor);
+    /**
+     * Renders the blurred shadow of the shape.
+     * @param zoomedClipRegion the bounding rect of the shape in view coordinates
+     * @return the image of the size of @p zoomedClipRegion
+     */
+    QImage renderShadow(KoShape *shape, const KoViewConverter &converter, const QRectF &zoomedClipRegion, bool antialiasing);
 };
 
 void KoShapeShadow::Private::paintGroupShadow(KoShapeGroup *group, QPainter &painter, const KoViewConverter &converter)
@@ -240,6 +247,36 @@ void KoShapeShadow::paint(KoShape *shape, QPainter &painter, const KoViewConvert
     QRectF shadowRect = shape->boundingRect();
     QRectF zoomedClipRegion = converter.documentToView(shadowRect);
 
+    // The blurred image does not depend on the position of the shape,
+    // it is reused until the shape or the shadow changes
+    KoShapeRasterCache *cache = KoShapeRasterCache::instance();
+    const bool antialiasing = painter.testRenderHint(QPainter::Antialiasing);
+    QImage sourceGraphic;
+    if (cache) {
+        sourceGraphic = cache->image(shape, KoShapeRasterCache::Shadow, converter, antialiasing);
+        if (!sourceGraphic.isNull() && sourceGraphic.size() != zoomedClipRegion.size().toSize()) {
+            sourceGraphic = QImage();
+        }
+    }
+    if (sourceGraphic.isNull()) {
+        sourceGraphic = d->renderShadow(shape, converter, zoomedClipRegion, antialiasing);
+        if (cache) {
+            cache->insert(shape, KoShapeRasterCache::Shadow, converter, antialiasing, sourceGraphic);
+        }
+    }
+
+    // Paint the result
+    painter.save();
+    // The painter is initialized for us with canvas transform 'plus' shape transform
+    // we are only interested in the canvas transform so 'subtract' the shape transform part
+    painter.setTransform(shape->absoluteTransformation(&converter).inverted() * painter.transform());
+    painter.drawImage(zoomedClipRegion.topLeft(), sourceGraphic);
+    painter.restore();
+}
+
+QImage KoShapeShadow::Private::renderShadow(KoShape *shape, const KoViewConverter &converter,
+                                            const QRectF &zoomedClipRegion, bool antialiasing)
+{
     // Init the buffer image
     QImage sourceGraphic(zoomedClipRegion.size().toSize(), QImage::Format_ARGB32_Premultiplied);
     sourceGraphic.fill(qRgba(0,0,0,0));
@@ -247,34 +284,28 @@ void KoShapeShadow::paint(KoShape *shape, QPainter &painter, const KoViewConvert
     QPainter imagePainter(&sourceGraphic);
     imagePainter.setPen(Qt::NoPen);
     imagePainter.setBrush(Qt::NoBrush);
-    imagePainter.setRenderHint(QPainter::Antialiasing, painter.testRenderHint(QPainter::Antialiasing));
+    imagePainter.setRenderHint(QPainter::Antialiasing, antialiasing);
     // Since our imagebuffer and the canvas don't align we need to offset our drawings
-    imagePainter.translate(-1.0f*converter.documentToView(shadowRect.topLeft()));
+    imagePainter.translate(-1.0f*zoomedClipRegion.topLeft());
 
     // Handle the shadow offset
-    imagePainter.translate(converter.documentToView(offset()));
+    imagePainter.translate(converter.documentToView(offset));
 
     KoShapeGroup *group = dynamic_cast<KoShapeGroup*>(shape);
     if (group) {
-        d->paintGroupShadow(group, imagePainter, converter);
+        paintGroupShadow(group, imagePainter, converter);
     } else {
         //apply shape's transformation
         imagePainter.setTransform(shape->absoluteTransformation(&converter), true);
 
-        d->paintShadow(shape, imagePainter, converter);
+        paintShadow(shape, imagePainter, converter);
     }
     imagePainter.end();
 
     // Blur the shadow (well the entire buffer)
-    d->blurShadow(sourceGraphic, converter.documentToViewX(d->blur), d->color);
+    blurShadow(sourceGraphic, converter.documentToViewX(blur), color);
 
-    // Paint the result
-    painter.save();
-    // The painter is initialized for us with canvas transform 'plus' shape transform
-    // we are only interested in the canvas transform so 'subtract' the shape transform part
-    painter.setTransform(shape->absoluteTransformation(&converter).inverted() * painter.transform());
-    painter.drawImage(zoomedClipRegion.topLeft(), sourceGraphic);
-    painter.restore();
+    return sourceGraphic;
 }
 
 void KoShapeShadow::setOffset(const QPointF & offset)
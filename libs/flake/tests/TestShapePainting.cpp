@@ -23,6 +23,10 @@
 #include "KoShapeContainer.h"
 #include "KoShapeManager.h"
 #include "KoShapePaintingContext.h"
+#include "KoFilterEffect.h"
+#include "KoFilterEffectStack.h"
+#include "KoPathShape.h"
+#include "KoColorBackground.h"
 
 #include <MockShapes.h>
 
@@ -251,4 +255,123 @@ void TestShapePainting::testPaintOrder()
     delete root;
 }
 
+void TestShapePainting::testFilterEffectCache()
+{
+    class CountingFilterEffect : public KoFilterEffect {
+    public:
+        CountingFilterEffect() : KoFilterEffect("CountingEffect", "Counting"), processedCount(0) {
+            setFilterRect(QRectF(0, 0, 1, 1));
+        }
+        QImage processImage(const QImage &image, const KoFilterEffectRenderContext &) const {
+            processedCount++;
+            return image;
+        }
+        mutable int processedCount;
+    };
+
+    MockShape *shape = new MockShape();
+    shape->setSize(QSizeF(50, 50));
+    CountingFilterEffect *effect = new CountingFilterEffect();
+    KoFilterEffectStack *stack = new KoFilterEffectStack();
+    stack->appendFilterEffect(effect);
+    shape->setFilterEffectStack(stack);
+
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+    manager.addShape(shape);
+
+    QImage image(100, 100, QImage::Format_ARGB32_Premultiplied);
+    QPainter painter(&image);
+    KoViewConverter vc;
+    manager.paint(painter, vc, false);
+    QCOMPARE(shape->paintedCount, 1);
+    QCOMPARE(effect->processedCount, 1);
+
+    // the filtered image is reused
+    manager.paint(painter, vc, false);
+    QCOMPARE(shape->paintedCount, 1);
+    QCOMPARE(effect->processedCount, 1);
+
+    // another zoom level is rendered once as well
+    vc.setZoom(2.0);
+    manager.paint(painter, vc, false);
+    manager.paint(painter, vc, false);
+    QCOMPARE(shape->paintedCount, 2);
+    QCOMPARE(effect->processedCount, 2);
+
+    // a changed shape is rendered again
+    shape->update();
+    manager.paint(painter, vc, false);
+    QCOMPARE(shape->paintedCount, 3);
+    QCOMPARE(effect->processedCount, 3);
+
+    vc.setZoom(1.0);
+    manager.paint(painter, vc, false);
+    QCOMPARE(shape->paintedCount, 4);
+    QCOMPARE(effect->processedCount, 4);
+
+    delete shape;
+}
+
+void TestShapePainting::testTiledPainting()
+{
+    MockCanvas canvas;
+    KoShapeManager manager(&canvas);
+
+    // overlapping path shapes spread over several tiles
+    QList<KoShape*> shapes;
+    for (int i = 0; i < 100; ++i) {
+        KoPathShape *path = new KoPathShape();
+        path->moveTo(QPointF(0, 0));
+        path->lineTo(QPointF(80, 10));
+        path->lineTo(QPointF(30, 70));
+        path->close();
+        path->normalize();
+        path->setPosition(QPointF((i % 10) * 55, (i / 10) * 55));
+        path->setZIndex(i);
+        path->setBackground(QSharedPointer<KoShapeBackground>(new KoColorBackground(QColor::fromHsv((i * 37) % 360, 255, 255))));
+        manager.addShape(path);
+        shapes.append(path);
+    }
+    // a shape painted on the calling thread in the middle of the stack
+    MockShape *mock = new MockShape();
+    mock->setSize(QSizeF(600, 600));
+    mock->setZIndex(50);
+    manager.addShape(mock);
+    shapes.append(mock);
+
+    KoViewConverter vc;
+    QImage expected(600, 600, QImage::Format_ARGB32_Premultiplied);
+    expected.fill(Qt::white);
+    QPainter painter(&expected);
+    painter.setClipRect(0, 0, 600, 600);
+    manager.paint(painter, vc, true);
+    painter.end();
+    QCOMPARE(mock->paintedCount, 1);
+
+    QVERIFY(!manager.isTiledPaintingEnabled());
+    manager.setTiledPaintingEnabled(true);
+    QVERIFY(manager.isTiledPaintingEnabled());
+
+    QImage actual(600, 600, QImage::Format_ARGB32_Premultiplied);
+    actual.fill(Qt::white);
+    painter.begin(&actual);
+    painter.setClipRect(0, 0, 600, 600);
+    manager.paint(painter, vc, true);
+    painter.end();
+    QCOMPARE(mock->paintedCount, 2);
+    QCOMPARE(actual, expected);
+
+    // a translated painter paints the same tiles
+    actual.fill(Qt::white);
+    painter.begin(&actual);
+    painter.translate(-100, -100);
+    painter.setClipRect(100, 100, 600, 600);
+    manager.paint(painter, vc, true);
+    painter.end();
+    QCOMPARE(actual.copy(0, 0, 500, 500), expected.copy(100, 100, 500, 500));
+
+    qDeleteAll(shapes);
+}
+
 QTEST_MAIN(TestShapePainting)
@@ -30,6 +30,8 @@ private Q_SLOTS:
     void testPaintShape();
     void testPaintHiddenShape();
     void testPaintOrder();
+    void testFilterEffectCache();
+    void testTiledPainting();
 };
 
 #endif
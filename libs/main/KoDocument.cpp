@@ -841,6 +841,8 @@ bool KoDocument::saveNativeFormatODF(KoStore *store, const QByteArray &mimeType)
     // Tell KoStore not to touch the file names
 
     KoOdfWriteStore odfStore(store);
+    KConfigGroup cfgGrp(d->parentPart->componentData().config(), "Saving");
+    odfStore.setBodyMemoryLimit(cfgGrp.readEntry("BodyMemoryLimit", odfStore.bodyMemoryLimit()));
     KoXmlWriter *manifestWriter = odfStore.manifestWriter(mimeType);
     KoEmbeddedDocumentSaver embeddedSaver;
     SavingContext documentContext(odfStore, embeddedSaver);
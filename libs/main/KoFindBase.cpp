@@ -71,6 +71,25 @@ void KoFindBase::setMatches(const KoFindBase::KoFindMatchList &matches)
     d->matches = matches;
 }
 
+void KoFindBase::addMatches(const KoFindBase::KoFindMatchList &matches)
+{
+    if (matches.isEmpty()) {
+        return;
+    }
+
+    const bool hadMatches = d->matches.count() > 0;
+    d->matches.append(matches);
+    if (!hadMatches) {
+        if (d->currentMatch >= d->matches.size()) {
+            d->currentMatch = 0;
+        }
+        emit hasMatchesChanged(true);
+        emit matchFound(d->matches.at(d->currentMatch));
+    }
+
+    emit updateCanvas();
+}
+
 void KoFindBase::setCurrentMatch(int index)
 {
     d->currentMatch = index;
@@ -153,6 +153,17 @@ protected:
      */
     void setMatches(const KoFindMatchList &matches);
 
+    /**
+     * Append matches to the list of matches.
+     *
+     * This is meant for implementations which go on searching after
+     * findImplementation() returned. The signals are emitted as if
+     * the matches were found by find().
+     *
+     * \param matches The matches to append.
+     */
+    void addMatches(const KoFindMatchList &matches);
+
     /**
      * Set the current index.
      *
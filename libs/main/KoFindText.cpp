@@ -30,6 +30,8 @@
 #include <QStyle>
 #include <QApplication>
 #include <QAbstractTextDocumentLayout>
+#include <QElapsedTimer>
+#include <QTimer>
 
 #include <MainDebug.h>
 #include <klocalizedstring.h>
@@ -44,6 +46,11 @@
 #include "KoFindOption.h"
 #include "KoDocument.h"
 
+#include <algorithm>
+
+// The time in milliseconds a search may take before it continues in the background
+static const int SearchTimeSlice = 20;
+
 QTextCharFormat KoFindText::Private::highlightFormat;
 QTextCharFormat KoFindText::Private::currentMatchFormat;
 QTextCharFormat KoFindText::Private::currentSelectionFormat;
@@ -70,63 +77,39 @@ KoFindText::~KoFindText()
 void KoFindText::findImplementation(const QString &pattern, QList<KoFindMatch> & matchList)
 {
     KoFindOptionSet *opts = options();
-    QTextDocument::FindFlags flags = 0;
-
-    if(opts->option("caseSensitive")->value().toBool()) {
-        flags |= QTextDocument::FindCaseSensitively;
-    }
-    if(opts->option("wholeWords")->value().toBool()) {
-        flags |= QTextDocument::FindWholeWords;
-    }
-
-    int start = 0;
-    bool findInSelection = false;
+    d->caseSensitivity = opts->option("caseSensitive")->value().toBool() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    d->wholeWords = opts->option("wholeWords")->value().toBool();
 
     if(d->documents.size() == 0) {
         qWarning() << "No document available for searching!";
         return;
     }
 
-    bool before = opts->option("fromCursor")->value().toBool() && !d->currentCursor.isNull();
-    QList<KoFindMatch> matchBefore;
-    foreach(QTextDocument* document, d->documents) {
-        QTextCursor cursor = document->find(pattern, start, flags);
-        cursor.setKeepPositionOnInsert(true);
-
-        QVector<QAbstractTextDocumentLayout::Selection> selections;
-        while(!cursor.isNull()) {
-            if(findInSelection && d->selectionEnd <= cursor.position()) {
-                break;
-            }
-
-            if (before && document == d->currentCursor.document() && d->currentCursor < cursor) {
-                before = false;
-            }
-
-            QAbstractTextDocumentLayout::Selection selection;
-            selection.cursor = cursor;
-            selection.format = d->highlightFormat;
-            selections.append(selection);
+    if (pattern.isEmpty()) {
+        return;
+    }
+    d->pattern = pattern;
 
-            KoFindMatch match;
-            match.setContainer(QVariant::fromValue(document));
-            match.setLocation(QVariant::fromValue(cursor));
-            if (before) {
-                matchBefore.append(match);
-            }
-            else {
-                matchList.append(match);
-            }
+    // The matches behind the cursor come first, the ones in front of it last.
+    int cursorDocument = -1;
+    if (opts->option("fromCursor")->value().toBool() && !d->currentCursor.isNull()) {
+        cursorDocument = d->documents.indexOf(d->currentCursor.document());
+    }
+    const int cursorPosition = d->currentCursor.position();
+    d->searchRanges.clear();
+    for (int i = 0; i < d->documents.size(); ++i) {
+        const int index = cursorDocument < 0 ? i : (cursorDocument + i) % d->documents.size();
+        const int from = index == cursorDocument ? cursorPosition : 0;
+        d->searchRanges.append(Private::searchRange(d->documents[index], from, -1));
+    }
+    if (cursorDocument >= 0) {
+        d->searchRanges.append(Private::searchRange(d->documents[cursorDocument], 0, cursorPosition));
+    }
 
-            cursor = document->find(pattern, cursor, flags);
-            cursor.setKeepPositionOnInsert(true);
-        }
-        if (before && document == d->currentCursor.document()) {
-            before = false;
-        }
-        d->selections.insert(document, selections);
+    // Search until the first match is found, so it can be shown right away.
+    if (!d->searchBatch(matchList, true)) {
+        d->scheduleSearch();
     }
-    matchList.append(matchBefore);
 
     if (hasMatches()) {
         setCurrentMatch(0);
@@ -136,6 +119,12 @@ void KoFindText::findImplementation(const QString &pattern, QList<KoFindMatch> &
     d->updateSelections();
 }
 
+void KoFindText::replaceAll(const QVariant &value)
+{
+    d->finishSearch();
+    KoFindBase::replaceAll(value);
+}
+
 void KoFindText::replaceImplementation(const KoFindMatch &match, const QVariant &value)
 {
     if (!match.isValid() || !match.location().canConvert<QTextCursor>() || !match.container().canConvert<QTextDocument*>()) {
@@ -146,21 +135,18 @@ void KoFindText::replaceImplementation(const KoFindMatch &match, const QVariant
     cursor.setKeepPositionOnInsert(true);
 
     //Search for the selection matching this match.
-    QVector<QAbstractTextDocumentLayout::Selection> selections = d->selections.value(match.container().value<QTextDocument*>());
-    int index = 0;
-    foreach(const QAbstractTextDocumentLayout::Selection &sel, selections) {
-        if(sel.cursor == cursor) {
-            break;
-        }
-        index++;
-    }
+    QTextDocument *document = match.container().value<QTextDocument*>();
+    QVector<QAbstractTextDocumentLayout::Selection> &selections = d->selections[document];
+    int index = Private::indexOfSelection(selections, cursor);
 
     cursor.insertText(value.toString());
     cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, value.toString().length());
 
-    selections[index].cursor = cursor;
-    selections[index].format = d->replacedFormat;
-    d->selections.insert(match.container().value<QTextDocument*>(), selections);
+    if (index >= 0) {
+        selections[index].cursor = cursor;
+        selections[index].format = d->replacedFormat;
+        d->changedSelections.insert(document);
+    }
 
     d->updateCurrentMatch(0);
     d->updateSelections();
@@ -168,9 +154,12 @@ void KoFindText::replaceImplementation(const KoFindMatch &match, const QVariant
 
 void KoFindText::clearMatches()
 {
+    d->searchRanges.clear();
+
     d->selections.clear();
     foreach(QTextDocument* doc, d->documents) {
         d->selections.insert(doc, QVector<QAbstractTextDocumentLayout::Selection>());
+        d->changedSelections.insert(doc);
     }
     d->updateSelections();
 
@@ -242,17 +231,18 @@ void KoFindText::findTextInShapes(const QList<KoShape*> &shapes, QList<QTextDocu
 
 void KoFindText::Private::updateSelections()
 {
-    QHash< QTextDocument*, QVector<QAbstractTextDocumentLayout::Selection> >::ConstIterator itr;
-    for(itr = selections.constBegin(); itr != selections.constEnd(); ++itr) {
-        KoTextDocument doc(itr.key());
-        doc.setSelections(itr.value());
+    foreach(QTextDocument *document, changedSelections) {
+        KoTextDocument doc(document);
+        doc.setSelections(selections.value(document));
     }
+    changedSelections.clear();
 }
 
 void KoFindText::Private::updateDocumentList()
 {
     foreach(QTextDocument *document, documents) {
         connect(document, SIGNAL(destroyed(QObject*)), q, SLOT(documentDestroyed(QObject*)), Qt::UniqueConnection);
+        connect(document, SIGNAL(contentsChange(int,int,int)), q, SLOT(documentContentsChanged()), Qt::UniqueConnection);
     }
 }
 
@@ -261,37 +251,219 @@ void KoFindText::Private::documentDestroyed(QObject *document)
     QTextDocument* doc = qobject_cast<QTextDocument*>(document);
     if(doc) {
         selections.remove(doc);
+        changedSelections.remove(doc);
+        blockTextCache.remove(doc);
         documents.removeOne(doc);
+        for (int i = searchRanges.count() - 1; i >= 0; --i) {
+            if (searchRanges[i].document == doc) {
+                searchRanges.removeAt(i);
+            }
+        }
+        if (currentMatch.first == doc) {
+            currentMatch.first = 0;
+        }
     }
 }
 
+void KoFindText::Private::documentContentsChanged()
+{
+    // the contents signal does not tell which document changed;
+    // the pending search ranges follow the changes on their own
+    blockTextCache.clear();
+}
+
 void KoFindText::Private::updateCurrentMatch(int position)
 {
     Q_UNUSED(position);
     if (currentMatch.first != 0) {
-        QVector<QAbstractTextDocumentLayout::Selection> sel = selections.value(currentMatch.first);
+        QVector<QAbstractTextDocumentLayout::Selection> &sel = selections[currentMatch.first];
         Q_ASSERT(currentMatch.second < sel.count());
         if(sel[currentMatch.second].format == currentMatchFormat) {
             sel[currentMatch.second].format = highlightFormat;
+            changedSelections.insert(currentMatch.first);
         }
-        selections.insert(currentMatch.first, sel);
     }
 
     const KoFindMatch match = q->currentMatch();
     if (match.isValid() && match.location().canConvert<QTextCursor>() && match.container().canConvert<QTextDocument*>()) {
         QTextCursor cursor = match.location().value<QTextCursor>();
         QTextDocument *document = match.container().value<QTextDocument*>();
-        QVector<QAbstractTextDocumentLayout::Selection> sel = selections.value(document);
-        for (int i = 0; i < sel.size(); ++i) {
-            if (sel[i].cursor == cursor) {
-                sel[i].format = currentMatchFormat;
-                selections.insert(document, sel);
-                currentMatch.first = document;
-                currentMatch.second = i;
+        QVector<QAbstractTextDocumentLayout::Selection> &sel = selections[document];
+        const int i = indexOfSelection(sel, cursor);
+        if (i >= 0) {
+            sel[i].format = currentMatchFormat;
+            changedSelections.insert(document);
+            currentMatch.first = document;
+            currentMatch.second = i;
+        }
+    }
+}
+
+const QVector<KoFindText::Private::BlockText> &KoFindText::Private::blockTexts(QTextDocument *document)
+{
+    QHash<QTextDocument*, QVector<BlockText> >::iterator it = blockTextCache.find(document);
+    if (it == blockTextCache.end()) {
+        QVector<BlockText> texts;
+        texts.reserve(document->blockCount());
+        for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+            BlockText blockText;
+            blockText.position = block.position();
+            blockText.text = block.text();
+            blockText.text.replace(QChar::Nbsp, QLatin1Char(' '));
+            texts.append(blockText);
+        }
+        it = blockTextCache.insert(document, texts);
+    }
+    return it.value();
+}
+
+static bool selectionStartsBefore(const QAbstractTextDocumentLayout::Selection &selection, int position)
+{
+    return selection.cursor.selectionStart() < position;
+}
+
+void KoFindText::Private::addSelection(QTextDocument *document, const QTextCursor &cursor)
+{
+    QAbstractTextDocumentLayout::Selection selection;
+    selection.cursor = cursor;
+    selection.format = highlightFormat;
+
+    QVector<QAbstractTextDocumentLayout::Selection> &sel = selections[document];
+    const int index = std::lower_bound(sel.constBegin(), sel.constEnd(), cursor.selectionStart(), selectionStartsBefore) - sel.constBegin();
+    sel.insert(index, selection);
+    if (currentMatch.first == document && currentMatch.second >= index) {
+        ++currentMatch.second;
+    }
+    changedSelections.insert(document);
+}
+
+int KoFindText::Private::indexOfSelection(const QVector<QAbstractTextDocumentLayout::Selection> &selections, const QTextCursor &cursor)
+{
+    // the selections are sorted, unless the text was changed meanwhile
+    int index = std::lower_bound(selections.constBegin(), selections.constEnd(), cursor.selectionStart(), selectionStartsBefore) - selections.constBegin();
+    for (; index < selections.size() && selections[index].cursor.selectionStart() == cursor.selectionStart(); ++index) {
+        if (selections[index].cursor == cursor) {
+            return index;
+        }
+    }
+    for (index = 0; index < selections.size(); ++index) {
+        if (selections[index].cursor == cursor) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+bool KoFindText::Private::blockEndsBefore(const BlockText &blockText, int position)
+{
+    return blockText.position + blockText.text.length() < position;
+}
+
+KoFindText::Private::SearchRange KoFindText::Private::searchRange(QTextDocument *document, int from, int to)
+{
+    SearchRange range;
+    range.document = document;
+    range.from = QTextCursor(document);
+    range.from.setPosition(from);
+    // text inserted at the start of the range is searched too
+    range.from.setKeepPositionOnInsert(true);
+    range.to = QTextCursor(document);
+    if (to < 0) {
+        range.to.movePosition(QTextCursor::End);
+    } else {
+        range.to.setPosition(to);
+    }
+    range.next = range.from;
+    return range;
+}
+
+bool KoFindText::Private::searchBatch(QList<KoFindMatch> &matches, bool untilFirstMatch)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    while (!searchRanges.isEmpty()) {
+        SearchRange &range = searchRanges.first();
+        const int from = range.from.position();
+        const int to = range.to.position();
+        const QVector<BlockText> &texts = blockTexts(range.document);
+        QVector<BlockText>::const_iterator block = std::lower_bound(texts.constBegin(), texts.constEnd(), range.next.position(), blockEndsBefore);
+        for (; block != texts.constEnd() && block->position <= to; ++block) {
+            // Matches do not span blocks and do not overlap, just like with QTextDocument::find()
+            const QString &text = block->text;
+            int offset = 0;
+            while (offset <= text.length()) {
+                const int start = text.indexOf(pattern, offset, caseSensitivity);
+                if (start < 0) {
+                    break;
+                }
+                const int end = start + pattern.length();
+                if (wholeWords && ((start != 0 && text.at(start - 1).isLetterOrNumber())
+                                   || (end != text.length() && text.at(end).isLetterOrNumber()))) {
+                    offset = end + 1;
+                    continue;
+                }
+                offset = end;
+
+                if (block->position + end <= from || block->position + end > to) {
+                    continue;
+                }
+                QTextCursor cursor(range.document);
+                cursor.setPosition(block->position + start);
+                cursor.setPosition(block->position + end, QTextCursor::KeepAnchor);
+                cursor.setKeepPositionOnInsert(true);
+                addSelection(range.document, cursor);
+
+                KoFindMatch match;
+                match.setContainer(QVariant::fromValue(range.document));
+                match.setLocation(QVariant::fromValue(cursor));
+                matches.append(match);
+            }
+            QVector<BlockText>::const_iterator nextBlock = block + 1;
+            if (nextBlock == texts.constEnd() || nextBlock->position > to) {
                 break;
             }
+            range.next.setPosition(nextBlock->position);
+
+            if (timer.hasExpired(SearchTimeSlice) && !(untilFirstMatch && matches.isEmpty())) {
+                return false;
+            }
         }
+        searchRanges.removeFirst();
+    }
+    return true;
+}
+
+void KoFindText::Private::scheduleSearch()
+{
+    if (!searchScheduled) {
+        searchScheduled = true;
+        QTimer::singleShot(0, q, SLOT(continueSearch()));
+    }
+}
+
+void KoFindText::Private::continueSearch()
+{
+    searchScheduled = false;
+    if (searchRanges.isEmpty()) {
+        return;
+    }
+
+    QList<KoFindMatch> matches;
+    if (!searchBatch(matches, false)) {
+        scheduleSearch();
+    }
+    updateSelections();
+    q->addMatches(matches);
+}
+
+void KoFindText::Private::finishSearch()
+{
+    QList<KoFindMatch> matches;
+    while (!searchBatch(matches, false)) {
     }
+    updateSelections();
+    q->addMatches(matches);
 }
 
 void KoFindText::Private::initializeFormats()
@@ -36,8 +36,11 @@ class KoShape;
  * \brief KoFindBase implementation for searching within text shapes.
  *
  * This class provides a link between KoFindBase and QTextDocument for searching.
- * It uses a list of QTextDocument instances and searches through them using
- * QTextDocument::find().
+ * It uses a list of QTextDocument instances and searches through them the same
+ * way QTextDocument::find() does, using a cache of the text of the blocks.
+ *
+ * find() returns as soon as the first match is found; the remaining matches are
+ * searched for in the background and added in batches.
  *
  * The following options are defined:
  * <ul>
@@ -78,6 +81,10 @@ public:
      * Overridden from KoFindBase
      */
     virtual void findPrevious();
+    /**
+     * Overridden from KoFindBase to finish the search first.
+     */
+    virtual void replaceAll(const QVariant &value);
 
     /**
      * Retrieve the list of documents currently in use.
@@ -142,6 +149,8 @@ private:
     Private * const d;
 
     Q_PRIVATE_SLOT(d, void documentDestroyed(QObject* object))
+    Q_PRIVATE_SLOT(d, void documentContentsChanged())
+    Q_PRIVATE_SLOT(d, void continueSearch())
 };
 
 Q_DECLARE_METATYPE(QTextDocument *)
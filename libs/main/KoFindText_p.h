@@ -30,6 +30,8 @@
 #include <QPalette>
 #include <QStyle>
 #include <QAbstractTextDocumentLayout>
+#include <QSet>
+#include <QVector>
 
 #include <MainDebug.h>
 #include <klocalizedstring.h>
@@ -46,14 +48,56 @@
 class Q_DECL_HIDDEN KoFindText::Private
 {
 public:
-    Private(KoFindText* qq) : q(qq), selectionStart(-1), selectionEnd(-1) { }
+    Private(KoFindText* qq)
+        : q(qq), selectionStart(-1), selectionEnd(-1)
+        , caseSensitivity(Qt::CaseInsensitive), wholeWords(false), searchScheduled(false) { }
+
+    /// The text of a block as QTextDocument::find() searches it.
+    struct BlockText {
+        int position;
+        QString text;
+    };
+
+    /**
+     * A part of a document that still needs to be searched. The positions
+     * are kept by cursors, so they follow the changes made to the document
+     * while the search continues in the background.
+     */
+    struct SearchRange {
+        QTextDocument *document;
+        QTextCursor from; ///< matches end behind this position...
+        QTextCursor to; ///< ...and not behind this one
+        QTextCursor next; ///< the search continues with the block containing this position
+    };
+
+    /// Returns the range of @p document from @p from to @p to, or to its end if @p to is negative.
+    static SearchRange searchRange(QTextDocument *document, int from, int to);
 
     void updateSelections();
     void updateDocumentList();
     void documentDestroyed(QObject *document);
+    void documentContentsChanged();
     void updateCurrentMatch(int position);
     static void initializeFormats();
 
+    /// Returns the cached text of the blocks of @p document, in the order of their positions.
+    const QVector<BlockText> &blockTexts(QTextDocument *document);
+    /// Adds a highlight for @p cursor, keeping the selections of the document sorted.
+    void addSelection(QTextDocument *document, const QTextCursor &cursor);
+    static int indexOfSelection(const QVector<QAbstractTextDocumentLayout::Selection> &selections, const QTextCursor &cursor);
+    static bool blockEndsBefore(const BlockText &blockText, int position);
+
+    /**
+     * Searches the remaining search ranges and appends the matches to @p matches.
+     * Stops when the time slice is used up and, if @p untilFirstMatch is set, a match
+     * was found.
+     * @return true if the search is finished
+     */
+    bool searchBatch(QList<KoFindMatch> &matches, bool untilFirstMatch);
+    void scheduleSearch();
+    void continueSearch();
+    void finishSearch();
+
     KoFindText *q;
 
     QList<QTextDocument*> documents;
@@ -72,6 +116,16 @@ public:
     static bool formatsInitialized;
 
     QPair<QTextDocument*, int> currentMatch;
+
+    /// the documents whose selections need to be set again by updateSelections()
+    QSet<QTextDocument*> changedSelections;
+    QHash<QTextDocument*, QVector<BlockText> > blockTextCache;
+
+    QString pattern;
+    Qt::CaseSensitivity caseSensitivity;
+    bool wholeWords;
+    QList<SearchRange> searchRanges;
+    bool searchScheduled;
 };
 
 #endif
@@ -0,0 +1,162 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "testfindtext.h"
+
+#include <QTextDocument>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QSignalSpy>
+#include <QTest>
+
+#include "KoFindText.h"
+#include "KoFindOptionSet.h"
+
+static QList<QPair<int, int> > matchRanges(const KoFindText &finder, const QTextDocument *document)
+{
+    QList<QPair<int, int> > ranges;
+    foreach (const KoFindMatch &match, finder.matches()) {
+        if (match.container().value<QTextDocument*>() == document) {
+            QTextCursor cursor = match.location().value<QTextCursor>();
+            ranges.append(qMakePair(cursor.selectionStart(), cursor.selectionEnd()));
+        }
+    }
+    return ranges;
+}
+
+void TestFindText::testFindFromCursor()
+{
+    QTextDocument first("one two one\nthree one");
+    QTextDocument second("someone one");
+    KoFindText finder;
+    finder.setDocuments(QList<QTextDocument*>() << &first << &second);
+
+    QTextCursor cursor(&first);
+    cursor.setPosition(5);
+    finder.setCurrentCursor(cursor);
+    finder.find("one");
+
+    // the matches behind the cursor come first, the ones in front of it last
+    QCOMPARE(finder.matches().count(), 5);
+    QCOMPARE(finder.matches()[0].location().value<QTextCursor>().selectionStart(), 8);
+    QCOMPARE(finder.matches()[1].location().value<QTextCursor>().selectionStart(), 18);
+    QCOMPARE(finder.matches()[2].container().value<QTextDocument*>(), &second);
+    QCOMPARE(finder.matches()[3].container().value<QTextDocument*>(), &second);
+    QCOMPARE(finder.matches()[4].location().value<QTextCursor>().selectionStart(), 0);
+    QCOMPARE(finder.currentMatch().location().value<QTextCursor>().selectionStart(), 8);
+
+    QCOMPARE(matchRanges(finder, &second), QList<QPair<int, int> >() << qMakePair(4, 7) << qMakePair(8, 11));
+
+    // changed text is found
+    QTextCursor editCursor(&second);
+    editCursor.insertText("one ");
+    finder.find("one");
+    QCOMPARE(matchRanges(finder, &second).count(), 3);
+
+    finder.options()->setOptionValue("fromCursor", false);
+    finder.find("one");
+    QCOMPARE(finder.matches().count(), 6);
+    QCOMPARE(finder.matches()[0].location().value<QTextCursor>().selectionStart(), 0);
+}
+
+void TestFindText::testWholeWords()
+{
+    QTextDocument document(QString("someone One one%1one").arg(QChar(QChar::Nbsp)));
+    KoFindText finder;
+    finder.setDocuments(QList<QTextDocument*>() << &document);
+    finder.options()->setOptionValue("fromCursor", false);
+
+    finder.find("one");
+    QCOMPARE(finder.matches().count(), 4);
+
+    finder.options()->setOptionValue("wholeWords", true);
+    finder.find("one");
+    QCOMPARE(matchRanges(finder, &document), QList<QPair<int, int> >() << qMakePair(8, 11) << qMakePair(12, 15) << qMakePair(16, 19));
+
+    finder.options()->setOptionValue("caseSensitive", true);
+    finder.find("one");
+    QCOMPARE(matchRanges(finder, &document), QList<QPair<int, int> >() << qMakePair(12, 15) << qMakePair(16, 19));
+
+    finder.find(QString());
+    QVERIFY(!finder.hasMatches());
+}
+
+void TestFindText::testReplaceAll()
+{
+    QString text;
+    for (int i = 0; i < 1000; ++i) {
+        text += "find me\n";
+    }
+    QTextDocument document(text);
+    KoFindText finder;
+    finder.setDocuments(QList<QTextDocument*>() << &document);
+
+    finder.find("find");
+    QVERIFY(finder.hasMatches());
+    finder.replaceAll("found");
+    QCOMPARE(document.toPlainText().count("found"), 1000);
+    QCOMPARE(document.toPlainText().count("find"), 0);
+}
+
+void TestFindText::testBackgroundSearch()
+{
+    // too many matches to be found within one time slice
+    const int lines = 50000;
+    QStringList text;
+    for (int i = 0; i < lines; ++i) {
+        text << "one two";
+    }
+    QTextDocument document(text.join("\n"));
+    KoFindText finder;
+    finder.setDocuments(QList<QTextDocument*>() << &document);
+    finder.options()->setOptionValue("fromCursor", false);
+
+    finder.find("one");
+    const int foundFirst = finder.matches().count();
+    QVERIFY(foundFirst > 0);
+    QVERIFY(foundFirst < lines);
+    QSignalSpy matchFoundSpy(&finder, SIGNAL(matchFound(KoFindMatch)));
+    QSignalSpy updateCanvasSpy(&finder, SIGNAL(updateCanvas()));
+
+    // edit the searched and the pending part before the search continues
+    QTextCursor cursor(document.firstBlock());
+    cursor.movePosition(QTextCursor::EndOfBlock);
+    cursor.insertText("\none");
+    cursor = QTextCursor(document.lastBlock());
+    cursor.select(QTextCursor::BlockUnderCursor);
+    cursor.removeSelectedText();
+
+    // the line inserted into the searched part is not searched
+    QTRY_COMPARE(finder.matches().count(), lines - 1);
+    QTest::qWait(100);
+    QCOMPARE(finder.matches().count(), lines - 1);
+    QVERIFY(updateCanvasSpy.count() > 0);
+    QCOMPARE(matchFoundSpy.count(), 0);
+
+    // no match is duplicated or stale
+    int previousEnd = -1;
+    foreach (const KoFindMatch &match, finder.matches()) {
+        QTextCursor location = match.location().value<QTextCursor>();
+        QCOMPARE(location.selectedText(), QString("one"));
+        QVERIFY(location.selectionStart() > previousEnd);
+        previousEnd = location.selectionEnd();
+    }
+}
+
+QTEST_MAIN(TestFindText)
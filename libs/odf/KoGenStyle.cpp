@@ -22,6 +22,7 @@
 #include "KoGenStyle.h"
 #include "KoGenStyles.h"
 
+#include <QHash>
 #include <QTextLength>
 
 #include <KoXmlWriter.h>
@@ -30,6 +31,17 @@
 
 #include <OdfDebug.h>
 
+static uint hashMap(const QMap<QString, QString>& map, uint seed)
+{
+    uint hash = seed ^ uint(map.count());
+    QMap<QString, QString>::const_iterator it = map.constBegin();
+    for (; it != map.constEnd(); ++it) {
+        hash = 31 * hash + qHash(it.key());
+        hash = 31 * hash + qHash(it.value());
+    }
+    return hash;
+}
+
 // Returns -1, 0 (equal) or 1
 static int compareMap(const QMap<QString, QString>& map1, const QMap<QString, QString>& map2)
 {
@@ -48,7 +60,7 @@ static int compareMap(const QMap<QString, QString>& map1, const QMap<QString, QS
 KoGenStyle::KoGenStyle(Type type, const char* familyName,
                        const QString& parentName)
         : m_type(type), m_familyName(familyName), m_parentName(parentName),
-        m_autoStyleInStylesDotXml(false), m_defaultStyle(false)
+        m_autoStyleInStylesDotXml(false), m_defaultStyle(false), m_fingerprint(0)
 {
     switch (type) {
     case TextStyle:
@@ -322,6 +334,7 @@ void KoGenStyle::addPropertyPt(const QString& propName, qreal propValue, Propert
     str.setNum(propValue, 'f', DBL_DIG);
     str += "pt";
     m_properties[type].insert(propName, str);
+    m_fingerprint = 0;
 }
 
 void KoGenStyle::addPropertyLength(const QString& propName, const QTextLength &propValue, PropertyType type)
@@ -336,6 +349,7 @@ void KoGenStyle::addPropertyLength(const QString& propName, const QTextLength &p
         str.setNum((int) propValue.rawValue());
         str += '%';
         m_properties[type].insert(propName, str);
+        m_fingerprint = 0;
     }
 }
 
@@ -345,6 +359,7 @@ void KoGenStyle::addAttributePt(const QString& attrName, qreal attrValue)
     str.setNum(attrValue, 'f', DBL_DIG);
     str += "pt";
     m_attributes.insert(attrName, str);
+    m_fingerprint = 0;
 }
 
 void KoGenStyle::addAttributePercent(const QString &attrName, qreal value)
@@ -374,6 +389,7 @@ void KoGenStyle::addStyleMap(const QMap<QString, QString>& styleMap)
         }
     }
     m_maps.append(styleMap);
+    m_fingerprint = 0;
 }
 
 
@@ -460,6 +476,7 @@ bool KoGenStyle::operator<(const KoGenStyle &other) const
 
 bool KoGenStyle::operator==(const KoGenStyle &other) const
 {
+    if (m_fingerprint && other.m_fingerprint && m_fingerprint != other.m_fingerprint) return false;
     if (m_type != other.m_type) return false;
     if (m_parentName != other.m_parentName) return false;
     if (m_familyName != other.m_familyName) return false;
@@ -496,6 +513,24 @@ bool KoGenStyle::operator==(const KoGenStyle &other) const
     return true;
 }
 
+uint KoGenStyle::fingerprint() const
+{
+    if (m_fingerprint)
+        return m_fingerprint;
+    uint hash = qHash(int(m_type)) ^ qHash(m_parentName) ^ (qHash(m_familyName) << 1);
+    hash = 31 * hash + uint(m_autoStyleInStylesDotXml);
+    for (uint i = 0 ; i <= LastPropertyType; ++i) {
+        hash = hashMap(m_properties[i], hash);
+        hash = hashMap(m_childProperties[i], hash);
+    }
+    hash = hashMap(m_attributes, hash);
+    for (int i = 0 ; i < m_maps.count() ; ++i)
+        hash = hashMap(m_maps[i], hash);
+    // 0 marks a fingerprint to be computed
+    m_fingerprint = hash ? hash : 1;
+    return m_fingerprint;
+}
+
 bool KoGenStyle::isEmpty() const
 {
     if (!m_attributes.isEmpty() || ! m_maps.isEmpty())
@@ -159,6 +159,7 @@ public:
      */
     void setAutoStyleInStylesDotXml(bool b) {
         m_autoStyleInStylesDotXml = b;
+        m_fingerprint = 0;
     }
     /// @return the value passed to setAutoStyleInStylesDotXml; false by default
     bool autoStyleInStylesDotXml() const {
@@ -191,6 +192,7 @@ public:
     /// Sets the name of style's parent.
     void setParentName(const QString &name) {
         m_parentName = name;
+        m_fingerprint = 0;
     }
 
     /// Return the name of style's parent, if set
@@ -260,6 +262,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].insert(propName, propValue);
+        m_fingerprint = 0;
     }
     /// Overloaded version of addProperty that takes a char*, usually for "..."
     void addProperty(const QString &propName, const char *propValue, PropertyType type = DefaultType) {
@@ -267,6 +270,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].insert(propName, QString::fromUtf8(propValue));
+        m_fingerprint = 0;
     }
     /// Overloaded version of addProperty that converts an int to a string
     void addProperty(const QString &propName, int propValue, PropertyType type = DefaultType) {
@@ -274,6 +278,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].insert(propName, QString::number(propValue));
+        m_fingerprint = 0;
     }
     /// Overloaded version of addProperty that converts a bool to a string (false/true)
     void addProperty(const QString &propName, bool propValue, PropertyType type = DefaultType) {
@@ -281,6 +286,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].insert(propName, propValue ? "true" : "false");
+        m_fingerprint = 0;
     }
 
     /**
@@ -308,6 +314,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].remove(propName);
+        m_fingerprint = 0;
     }
 
     /**
@@ -319,6 +326,7 @@ public:
             type = m_propertyType;
         }
         m_properties[type].clear();
+        m_fingerprint = 0;
     }
 
     /**
@@ -328,19 +336,23 @@ public:
      */
     void addAttribute(const QString &attrName, const QString& attrValue) {
         m_attributes.insert(attrName, attrValue);
+        m_fingerprint = 0;
     }
     /// Overloaded version of addAttribute that takes a char*, usually for "..."
     void addAttribute(const QString &attrName, const char* attrValue) {
         m_attributes.insert(attrName, QString::fromUtf8(attrValue));
+        m_fingerprint = 0;
     }
     /// Overloaded version of addAttribute that converts an int to a string
     void addAttribute(const QString &attrName, int attrValue) {
         m_attributes.insert(attrName, QString::number(attrValue));
+        m_fingerprint = 0;
     }
 
     /// Overloaded version of addAttribute that converts a bool to a string
     void addAttribute(const QString &attrName, bool attrValue) {
         m_attributes.insert(attrName, attrValue ? "true" : "false");
+        m_fingerprint = 0;
     }
 
     /**
@@ -366,6 +378,7 @@ public:
      */
     void removeAttribute(const QString &attrName) {
         m_attributes.remove(attrName);
+        m_fingerprint = 0;
     }
 
 
@@ -393,6 +406,7 @@ public:
             type = m_propertyType;
         }
         m_childProperties[type].insert(elementName, elementContents);
+        m_fingerprint = 0;
     }
 
     /**
@@ -404,6 +418,7 @@ public:
             type = m_propertyType;
         }
         m_childProperties[type].insert(elementName, QString::fromUtf8(elementContents));
+        m_fingerprint = 0;
     }
 
     /**
@@ -412,6 +427,7 @@ public:
      */
     void addStyleChildElement(const QString &elementName, const QString& elementContents) {
         m_properties[StyleChildElement].insertMulti(elementName, elementContents);
+        m_fingerprint = 0;
     }
 
     /**
@@ -421,6 +437,7 @@ public:
      */
     void addStyleChildElement(const QString &elementName, const QByteArray& elementContents) {
         m_properties[StyleChildElement].insertMulti(elementName, QString::fromUtf8(elementContents));
+        m_fingerprint = 0;
     }
 
     /**
@@ -470,9 +487,16 @@ public:
      */
     bool operator<(const KoGenStyle &other) const;
 
-    /// Not needed for QMap, but can still be useful
+    /// Used by KoGenStyles to find identical styles
     bool operator==(const KoGenStyle &other) const;
 
+    /**
+     * Returns a fingerprint of everything operator==() compares: equal styles
+     * have equal fingerprints. It is computed on the first call and kept until
+     * the style is modified.
+     */
+    uint fingerprint() const;
+
     /**
      * Returns a property of this style. In prinicpal this class is meant to be write-only, but
      * some exceptional cases having read-support as well is very useful.  Passing DefaultType
@@ -541,6 +565,7 @@ private:
     bool m_autoStyleInStylesDotXml;
     bool m_defaultStyle;
     short m_unused2;
+    mutable uint m_fingerprint; // 0 if not computed yet
 
     // For insert()
     friend class KoGenStyles;
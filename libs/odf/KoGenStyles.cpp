@@ -117,6 +117,9 @@ public:
 
     ~Private()
     {
+        QVector<KoGenStyles::NamedStyle>::const_iterator it = styleList.constBegin();
+        for (; it != styleList.constEnd(); ++it)
+            delete (*it).style;
     }
 
     QVector<KoGenStyles::NamedStyle> styles(bool autoStylesInStylesDotXml, KoGenStyle::Type type) const;
@@ -134,8 +137,12 @@ public:
      */
     void saveOdfFontFaceDecls(KoXmlWriter* xmlWriter) const;
 
-    /// style definition -> name
-    StyleMap styleMap;
+    /// style fingerprint -> position in styleList
+    QMultiHash<uint, int> styleIndex;
+    /// family -> style name -> position in styleList
+    QHash<QByteArray, QHash<QString, int> > styleIndexByName;
+    /// positions of the styles handed out for modification, to be indexed anew
+    QVector<int> modifiedStyles;
 
     /// Map with the style name as key.
     /// This map is mainly used to check for name uniqueness
@@ -151,7 +158,8 @@ public:
     /// font faces
     QMap<QString, KoFontFace> fontFaces;
 
-    StyleMap::iterator insertStyle(const KoGenStyle &style, const QString &name, InsertionFlags flags);
+    int insertStyle(const KoGenStyle &style, const QString &name, InsertionFlags flags);
+    int findStyle(const KoGenStyle &style);
 
     struct RelationTarget {
         QString target; // the style we point to
@@ -328,17 +336,17 @@ QString KoGenStyles::insert(const KoGenStyle& style, const QString& baseName, In
     }
 
     if (flags & AllowDuplicates) {
-        StyleMap::iterator it = d->insertStyle(style, baseName, flags);
-        return it.value();
+        const int index = d->insertStyle(style, baseName, flags);
+        return d->styleList[index].name;
     }
 
-    StyleMap::iterator it = d->styleMap.find(style);
-    if (it == d->styleMap.end()) {
+    int index = d->findStyle(style);
+    if (index == -1) {
         // Not found, try if this style is in fact equal to its parent (the find above
         // wouldn't have found it, due to m_parentName being set).
         if (!style.parentName().isEmpty()) {
             KoGenStyle testStyle(style);
-            const KoGenStyle* parentStyle = this->style(style.parentName(), style.familyName());   // ## linear search
+            const KoGenStyle* parentStyle = this->style(style.parentName(), style.familyName());
             if (!parentStyle) {
                 debugOdf << "baseName=" << baseName << "parent style" << style.parentName()
                               << "not found in collection";
@@ -350,7 +358,7 @@ QString KoGenStyles::insert(const KoGenStyle& style, const QString& baseName, In
                                     << parentStyle->m_familyName;
                 }
 
-                testStyle.m_parentName = parentStyle->m_parentName;
+                testStyle.setParentName(parentStyle->m_parentName);
                 // Exclude the type from the comparison. It's ok for an auto style
                 // to have a user style as parent; they can still be identical
                 testStyle.m_type = parentStyle->m_type;
@@ -365,13 +373,28 @@ QString KoGenStyles::insert(const KoGenStyle& style, const QString& baseName, In
             }
         }
 
-        it = d->insertStyle(style, baseName, flags);
+        index = d->insertStyle(style, baseName, flags);
+    }
+    return d->styleList[index].name;
+}
+
+int KoGenStyles::Private::findStyle(const KoGenStyle &style)
+{
+    // the fingerprints of modified styles changed
+    foreach (int index, modifiedStyles)
+        styleIndex.insert(styleList[index].style->fingerprint(), index);
+    modifiedStyles.clear();
+
+    // the most recently inserted duplicate wins
+    QMultiHash<uint, int>::const_iterator it = styleIndex.constFind(style.fingerprint());
+    for (; it != styleIndex.constEnd() && it.key() == style.fingerprint(); ++it) {
+        if (*styleList[it.value()].style == style)
+            return it.value();
     }
-    return it.value();
+    return -1;
 }
 
-KoGenStyles::StyleMap::iterator KoGenStyles::Private::insertStyle(const KoGenStyle &style,
-                                                                  const QString& baseName, InsertionFlags flags)
+int KoGenStyles::Private::insertStyle(const KoGenStyle &style, const QString& baseName, InsertionFlags flags)
 {
     QString styleName(baseName);
     if (styleName.isEmpty()) {
@@ -389,17 +412,24 @@ KoGenStyles::StyleMap::iterator KoGenStyles::Private::insertStyle(const KoGenSty
         autoStylesInStylesDotXml[style.m_familyName].insert(styleName);
     else
         styleNames[style.m_familyName].insert(styleName);
-    KoGenStyles::StyleMap::iterator it = styleMap.insert(style, styleName);
+    KoGenStyle *storedStyle = new KoGenStyle(style);
     NamedStyle s;
-    s.style = &it.key();
+    s.style = storedStyle;
     s.name = styleName;
+    const int index = styleList.count();
     styleList.append(s);
-    return it;
+    styleIndex.insert(storedStyle->fingerprint(), index);
+    styleIndexByName[style.m_familyName].insert(styleName, index);
+    return index;
 }
 
 KoGenStyles::StyleMap KoGenStyles::styles() const
 {
-    return d->styleMap;
+    StyleMap styleMap;
+    QVector<KoGenStyles::NamedStyle>::const_iterator it = d->styleList.constBegin();
+    for (; it != d->styleList.constEnd(); ++it)
+        styleMap.insert(*(*it).style, (*it).name);
+    return styleMap;
 }
 
 QVector<KoGenStyles::NamedStyle> KoGenStyles::styles(KoGenStyle::Type type) const
@@ -409,19 +439,23 @@ QVector<KoGenStyles::NamedStyle> KoGenStyles::styles(KoGenStyle::Type type) cons
 
 const KoGenStyle* KoGenStyles::style(const QString &name, const QByteArray &family) const
 {
-    QVector<KoGenStyles::NamedStyle>::const_iterator it = d->styleList.constBegin();
-    const QVector<KoGenStyles::NamedStyle>::const_iterator end = d->styleList.constEnd();
-    for (; it != end ; ++it) {
-        if ((*it).name == name && (*it).style->familyName() == family) {
-            return (*it).style;
-        }
-    }
-    return 0;
+    const int index = d->styleIndexByName.value(family).value(name, -1);
+    return (index == -1) ? 0 : d->styleList[index].style;
 }
 
 KoGenStyle* KoGenStyles::styleForModification(const QString &name, const QByteArray &family)
 {
-    return const_cast<KoGenStyle *>(style(name, family));
+    const int index = d->styleIndexByName.value(family).value(name, -1);
+    if (index == -1)
+        return 0;
+    // Take the style out of the index, until it is looked up again. By then
+    // the modification is done and its fingerprint is up to date.
+    KoGenStyle *style = const_cast<KoGenStyle *>(d->styleList[index].style);
+    if (!d->modifiedStyles.contains(index)) {
+        d->styleIndex.remove(style->fingerprint(), index);
+        d->modifiedStyles.append(index);
+    }
+    return style;
 }
 
 void KoGenStyles::markStyleForStylesXml(const QString &name, const QByteArray &family)
@@ -111,7 +111,7 @@ public:
 
     /**
      * Return the entire collection of styles
-     * Use this for saving the styles
+     * @note The map is built on each call.
      */
     StyleMap styles() const;
 
@@ -24,6 +24,7 @@
 #include <klocalizedstring.h>
 
 #include <KoStore.h>
+#include <KoXmlNS.h>
 #include <KoXmlReader.h>
 
 #include "KoOdfStylesReader.h"
@@ -44,6 +45,8 @@ public:
     KoXmlDocument stylesDoc;
     KoXmlDocument contentDoc;
     KoXmlDocument settingsDoc;
+    // the text of content.xml, if its body is read by cursors
+    QByteArray content;
 };
 
 KoOdfReadStore::KoOdfReadStore(KoStore *store)
@@ -81,7 +84,59 @@ bool KoOdfReadStore::loadAndParse(QString &errorMessage)
     if (!loadAndParse("content.xml", d->contentDoc, errorMessage)) {
         return false;
     }
+    return loadAndParseStyles(errorMessage);
+}
 
+bool KoOdfReadStore::loadAndParseWithoutBody(QString &errorMessage)
+{
+    if (!d->store) {
+        errorMessage = i18n("No store backend");
+        return false;
+    }
+    if (!d->store->extractFile("content.xml", d->content)) {
+        errorMessage = i18n("Could not find %1", QString("content.xml"));
+        return false;
+    }
+
+    // The whitespace is kept as by loadAndParse().
+    KoXmlElementCursor cursor(d->content, false);
+    KoXmlElement contentElement;
+    if (cursor.readNextStartElement())
+        contentElement = cursor.readElementUntil(KoXmlNS::office, "body");
+    if (contentElement.isNull()) {
+        errorOdf << "Parsing error in content.xml! Aborting!" << endl
+        << " In line: " << cursor.lineNumber() << ", column: " << cursor.columnNumber() << endl
+        << " Error message: " << cursor.errorString();
+        errorMessage = i18n("Parsing error in the main document at line %1, column %2\nError message: %3"
+                            , cursor.lineNumber() , cursor.columnNumber() , cursor.errorString());
+        d->content.clear();
+        return false;
+    }
+    d->contentDoc = contentElement.ownerDocument();
+    if (!cursor.isElement(KoXmlNS::office, "body"))
+        d->content.clear();
+
+    return loadAndParseStyles(errorMessage);
+}
+
+KoXmlElementCursor *KoOdfReadStore::bodyCursor() const
+{
+    if (d->content.isEmpty())
+        return 0;
+    KoXmlElementCursor *cursor = new KoXmlElementCursor(d->content, false);
+    if (cursor->readNextStartElement()) {
+        while (cursor->readNextStartElement()) {
+            if (cursor->isElement(KoXmlNS::office, "body"))
+                return cursor;
+            cursor->skipCurrentElement();
+        }
+    }
+    delete cursor;
+    return 0;
+}
+
+bool KoOdfReadStore::loadAndParseStyles(QString &errorMessage)
+{
     if (d->store->hasFile("styles.xml")) {
         if (!loadAndParse("styles.xml", d->stylesDoc, errorMessage)) {
             return false;
@@ -26,6 +26,7 @@
 class QString;
 class QIODevice;
 class KoStore;
+class KoXmlElementCursor;
 class KoOdfStylesReader;
 
 /**
@@ -92,6 +93,30 @@ public:
      */
     bool loadAndParse(QString &errorMessage);
 
+    /**
+     * Load and parse like loadAndParse(QString&), but leave the office:body
+     * element out of contentDoc().
+     *
+     * The body is then read with bodyCursor() element by element, so
+     * that it does not have to be held in memory as a whole. Only the
+     * text of content.xml is kept until the store is destroyed.
+     *
+     * @param errorMessage The errorMessage is set in case an error is encounted.
+     * @return true if loading and parsing was successful, false otherwise.
+     */
+    bool loadAndParseWithoutBody(QString &errorMessage);
+
+    /**
+     * Create a cursor on content.xml positioned at the office:body element.
+     *
+     * Each call creates a new cursor, which can be used while other files
+     * of the store are read. The caller owns the cursor.
+     *
+     * @return the cursor, or 0 if loadAndParseWithoutBody() was not called
+     * or content.xml has no body
+     */
+    KoXmlElementCursor *bodyCursor() const;
+
     /**
      * Load a file from an odf store
      */
@@ -104,6 +129,8 @@ public:
     static bool loadAndParse(QIODevice *fileDevice, KoXmlDocument &doc, QString &errorMessage, const QString& fileName);
 
 private:
+    bool loadAndParseStyles(QString &errorMessage);
+
     class Private;
     Private * const d;
 };
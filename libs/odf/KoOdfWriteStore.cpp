@@ -21,6 +21,7 @@
 #include "KoOdfWriteStore.h"
 
 #include <QBuffer>
+#include <QVector>
 
 #include <QTemporaryFile>
 #include <OdfDebug.h>
@@ -32,6 +33,213 @@
 
 #include "KoXmlNS.h"
 
+// The body is compressed in chunks of this size
+static const int s_bodyChunkSize = 256 * 1024;
+static const qint64 s_defaultBodyMemoryLimit = 64 * 1024 * 1024;
+
+namespace {
+
+/**
+ * Buffers the body of content.xml, compressed in chunks. The chunks are
+ * kept in memory up to a limit; the following ones go to a temporary file.
+ * Once written, the whole body is read by reopening the device read-only.
+ * A failure to buffer or read back a chunk is sticky, see hasError().
+ */
+class BodyBuffer : public QIODevice
+{
+public:
+    explicit BodyBuffer(qint64 memoryLimit);
+    virtual ~BodyBuffer();
+
+    virtual bool isSequential() const;
+    virtual bool open(OpenMode mode);
+    virtual void close();
+    virtual qint64 bytesAvailable() const;
+
+    /// @return true, if some part of the body could not be buffered or read back
+    bool hasError() const;
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize);
+    virtual qint64 writeData(const char *data, qint64 maxSize);
+
+private:
+    bool compressPending();
+    bool uncompressNextChunk();
+
+    struct Chunk {
+        QByteArray data; // empty, if in the temporary file
+        qint64 offset;   // position in the temporary file
+        int size;
+        int uncompressedSize;
+    };
+    QVector<Chunk> m_chunks;
+    qint64 m_memoryLimit;
+    qint64 m_memory;
+    qint64 m_size;
+    QTemporaryFile *m_file;
+    QByteArray m_pending;   // written but not compressed yet, or uncompressed but not read yet
+    int m_position;         // read position in m_pending
+    int m_nextChunk;
+    qint64 m_remaining;     // uncompressed size of the chunks not read yet
+    bool m_error;
+};
+
+BodyBuffer::BodyBuffer(qint64 memoryLimit)
+        : m_memoryLimit(memoryLimit)
+        , m_memory(0)
+        , m_size(0)
+        , m_file(0)
+        , m_position(0)
+        , m_nextChunk(0)
+        , m_remaining(0)
+        , m_error(false)
+{
+    m_pending.reserve(s_bodyChunkSize);
+}
+
+BodyBuffer::~BodyBuffer()
+{
+    delete m_file;
+}
+
+bool BodyBuffer::isSequential() const
+{
+    return true;
+}
+
+bool BodyBuffer::open(OpenMode mode)
+{
+    if (isOpen())
+        close();
+    if (mode & WriteOnly) {
+        // written only once
+        if (m_size > 0 || !m_chunks.isEmpty())
+            return false;
+    } else {
+        // rewind
+        m_pending.clear();
+        m_position = 0;
+        m_nextChunk = 0;
+        m_remaining = m_size;
+    }
+    return QIODevice::open(mode);
+}
+
+void BodyBuffer::close()
+{
+    if ((openMode() & WriteOnly) && !m_error && !compressPending())
+        m_error = true;
+    QIODevice::close();
+}
+
+qint64 BodyBuffer::bytesAvailable() const
+{
+    if (!(openMode() & ReadOnly))
+        return QIODevice::bytesAvailable();
+    return m_pending.size() - m_position + m_remaining + QIODevice::bytesAvailable();
+}
+
+bool BodyBuffer::hasError() const
+{
+    return m_error;
+}
+
+qint64 BodyBuffer::readData(char *data, qint64 maxSize)
+{
+    qint64 read = 0;
+    while (read < maxSize) {
+        if (m_position == m_pending.size() && !uncompressNextChunk())
+            break;
+        const int count = qMin<qint64>(maxSize - read, m_pending.size() - m_position);
+        memcpy(data + read, m_pending.constData() + m_position, count);
+        m_position += count;
+        read += count;
+    }
+    if (read == 0 && m_error)
+        return -1;
+    return read;
+}
+
+qint64 BodyBuffer::writeData(const char *data, qint64 maxSize)
+{
+    // KoXmlWriter does not check the result, so a failure is remembered
+    if (m_error)
+        return -1;
+    m_pending.append(data, maxSize);
+    m_size += maxSize;
+    if (m_pending.size() >= s_bodyChunkSize && !compressPending()) {
+        m_error = true;
+        return -1;
+    }
+    return maxSize;
+}
+
+bool BodyBuffer::compressPending()
+{
+    if (m_pending.isEmpty())
+        return true;
+
+    Chunk chunk;
+    chunk.uncompressedSize = m_pending.size();
+    // favor speed, the body is compressed once more in the store
+    const QByteArray compressed = qCompress(m_pending, 1);
+    chunk.size = compressed.size();
+    chunk.offset = -1;
+    if (m_memoryLimit < 0 || m_memory + chunk.size <= m_memoryLimit) {
+        chunk.data = compressed;
+        m_memory += chunk.size;
+    } else {
+        if (!m_file) {
+            m_file = new QTemporaryFile;
+            if (!m_file->open()) {
+                setErrorString(m_file->errorString());
+                warnOdf << "Failed to open the temporary content file";
+                return false;
+            }
+        }
+        chunk.offset = m_file->pos();
+        if (m_file->write(compressed) != chunk.size) {
+            setErrorString(m_file->errorString());
+            warnOdf << "Failed to write the temporary content file";
+            return false;
+        }
+    }
+    m_chunks.append(chunk);
+    // only dropped once stored
+    m_pending.resize(0); // keeps the reserved capacity
+    return true;
+}
+
+bool BodyBuffer::uncompressNextChunk()
+{
+    if (m_nextChunk >= m_chunks.count())
+        return false;
+
+    const Chunk &chunk = m_chunks[m_nextChunk++];
+    m_remaining -= chunk.uncompressedSize;
+    QByteArray compressed = chunk.data;
+    if (chunk.offset >= 0) {
+        if (!m_file->seek(chunk.offset)) {
+            setErrorString(m_file->errorString());
+            m_error = true;
+            return false;
+        }
+        compressed = m_file->read(chunk.size);
+    }
+    m_pending = qUncompress(compressed);
+    m_position = 0;
+    if (m_pending.size() != chunk.uncompressedSize) {
+        setErrorString(QLatin1String("Corrupted content buffer"));
+        m_pending.clear();
+        m_error = true;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
 struct Q_DECL_HIDDEN KoOdfWriteStore::Private {
     Private(KoStore * store)
             : store(store)
@@ -39,7 +247,8 @@ struct Q_DECL_HIDDEN KoOdfWriteStore::Private {
             , contentWriter(0)
             , bodyWriter(0)
             , manifestWriter(0)
-            , contentTmpFile(0) {}
+            , bodyBuffer(0)
+            , bodyMemoryLimit(s_defaultBodyMemoryLimit) {}
 
 
     ~Private() {
@@ -49,6 +258,8 @@ struct Q_DECL_HIDDEN KoOdfWriteStore::Private {
         delete contentWriter;
         Q_ASSERT(!bodyWriter);
         delete bodyWriter;
+        Q_ASSERT(!bodyBuffer);
+        delete bodyBuffer;
         Q_ASSERT(!storeDevice);
         delete storeDevice;
         Q_ASSERT(!manifestWriter);
@@ -61,7 +272,8 @@ struct Q_DECL_HIDDEN KoOdfWriteStore::Private {
 
     KoXmlWriter * bodyWriter;
     KoXmlWriter * manifestWriter;
-    QTemporaryFile * contentTmpFile;
+    BodyBuffer * bodyBuffer;
+    qint64 bodyMemoryLimit;
 };
 
 KoOdfWriteStore::KoOdfWriteStore(KoStore* store)
@@ -141,18 +353,24 @@ KoXmlWriter* KoOdfWriteStore::contentWriter()
     return d->contentWriter;
 }
 
+void KoOdfWriteStore::setBodyMemoryLimit(qint64 bytes)
+{
+    Q_ASSERT(!d->bodyWriter);
+    d->bodyMemoryLimit = bytes;
+}
+
+qint64 KoOdfWriteStore::bodyMemoryLimit() const
+{
+    return d->bodyMemoryLimit;
+}
+
 KoXmlWriter* KoOdfWriteStore::bodyWriter()
 {
     if (!d->bodyWriter) {
-        Q_ASSERT(!d->contentTmpFile);
-        d->contentTmpFile = new QTemporaryFile;
-        if (!d->contentTmpFile->open()) {
-            warnOdf << "Failed to open the temporary content file";
-            delete d->contentTmpFile;
-            d->contentTmpFile = 0;
-            return 0;
-        }
-        d->bodyWriter = new KoXmlWriter(d->contentTmpFile, 1);
+        Q_ASSERT(!d->bodyBuffer);
+        d->bodyBuffer = new BodyBuffer(d->bodyMemoryLimit);
+        d->bodyBuffer->open(QIODevice::WriteOnly);
+        d->bodyWriter = new KoXmlWriter(d->bodyBuffer, 1);
     }
     return d->bodyWriter;
 }
@@ -160,17 +378,20 @@ KoXmlWriter* KoOdfWriteStore::bodyWriter()
 bool KoOdfWriteStore::closeContentWriter()
 {
     Q_ASSERT(d->bodyWriter);
-    Q_ASSERT(d->contentTmpFile);
+    Q_ASSERT(d->bodyBuffer);
 
     delete d->bodyWriter; d->bodyWriter = 0;
 
-    // copy over the contents from the tempfile to the real one
-    d->contentTmpFile->close(); // does not really close but seeks to the beginning of the file
-    if (d->contentWriter) {
-        d->contentWriter->addCompleteElement(d->contentTmpFile);
+    // copy over the contents from the buffer to the real one
+    d->bodyBuffer->close(); // compresses the last chunk
+    if (d->contentWriter && !d->bodyBuffer->hasError()) {
+        d->contentWriter->addCompleteElement(d->bodyBuffer);
+    }
+    const bool ok = !d->bodyBuffer->hasError();
+    if (!ok) {
+        warnOdf << "Failed to buffer the body of content.xml:" << d->bodyBuffer->errorString();
     }
-    d->contentTmpFile->close(); // seek again to the beginning
-    delete d->contentTmpFile; d->contentTmpFile = 0; // and finally close and remove the QTemporaryFile
+    delete d->bodyBuffer; d->bodyBuffer = 0; // and finally drop the buffered body
 
     if (d->contentWriter) {
         d->contentWriter->endElement(); // document-content
@@ -183,7 +404,7 @@ bool KoOdfWriteStore::closeContentWriter()
     if (!d->store->close()) {   // done with content.xml
         return false;
     }
-    return true;
+    return ok;
 }
 
 KoXmlWriter* KoOdfWriteStore::manifestWriter(const char* mimeType)
@@ -31,6 +31,8 @@ class KoStore;
  * once. So we open a KoXmlWriter into a memory buffer, write the body into it,
  * collect automatic styles while doing that, write out automatic styles,
  * and then copy the body XML from the buffer into the real KoXmlWriter.
+ * The buffered body is compressed in chunks; beyond bodyMemoryLimit() the
+ * chunks are moved to a temporary file.
  *
  * The typical use of this class is therefore:
  *   - write body into bodyWriter() and collect auto styles
@@ -46,6 +48,8 @@ class KoStore;
  */
 #include "koodf_export.h"
 
+#include <QtGlobal>
+
 class KOODF_EXPORT KoOdfWriteStore
 {
 public:
@@ -79,9 +83,25 @@ public:
      */
     KoXmlWriter *contentWriter();
 
+    /**
+     * Sets the memory the compressed body may take, before the following
+     * parts of it are buffered in a temporary file. -1 means no limit, 0
+     * always uses the temporary file. The default is 64 MB.
+     * KoDocument sets it from the BodyMemoryLimit entry of the Saving
+     * group in the application's configuration.
+     * Call this before bodyWriter().
+     */
+    void setBodyMemoryLimit(qint64 bytes);
+
+    /**
+     * @return the memory the compressed body may take
+     * @see setBodyMemoryLimit()
+     */
+    qint64 bodyMemoryLimit() const;
+
     /**
      * Open another KoXmlWriter for writing out the contents
-     * into a temporary file, to collect automatic styles while doing that.
+     * into a compressed buffer, to collect automatic styles while doing that.
      */
     KoXmlWriter *bodyWriter();
 
@@ -89,6 +109,8 @@ public:
      * This will copy the body into the content writer,
      * delete the bodyWriter and the contentWriter, and then
      * close contents.xml.
+     * @return false, if the body could not be buffered or contents.xml
+     * could not be closed
      */
     bool closeContentWriter();
 
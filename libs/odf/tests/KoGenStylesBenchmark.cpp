@@ -0,0 +1,105 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "KoGenStylesBenchmark.h"
+
+#include <KoGenStyle.h>
+#include <KoGenStyles.h>
+#include <KoXmlWriter.h>
+
+#include <QBuffer>
+#include <QTest>
+
+void KoGenStylesBenchmark::addCounts()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("100000") << 100000;
+}
+
+KoGenStyle KoGenStylesBenchmark::cellStyle(int i)
+{
+    KoGenStyle style(KoGenStyle::TableCellAutoStyle, "table-cell");
+    style.setParentName("Default");
+    style.addProperty("fo:background-color", QString("#%1").arg(i % 0x1000000, 6, 16, QChar('0')));
+    style.addProperty("fo:border", "0.06pt solid #000000");
+    style.addProperty("style:vertical-align", (i % 3) ? "middle" : "top");
+    style.addProperty("fo:font-weight", (i / 7) % 2 ? "bold" : "normal", KoGenStyle::TextType);
+    style.addProperty("fo:font-size", QString("%1pt").arg(8 + i % 5), KoGenStyle::TextType);
+    style.addProperty("fo:text-align", "start", KoGenStyle::ParagraphType);
+    style.addAttribute("style:data-style-name", QString("N%1").arg(i % 11));
+    return style;
+}
+
+void KoGenStylesBenchmark::benchmarkInsertUnique_data()
+{
+    addCounts();
+}
+
+void KoGenStylesBenchmark::benchmarkInsertUnique()
+{
+    QFETCH(int, count);
+
+    QBENCHMARK {
+        KoGenStyles styles;
+        for (int i = 0; i < count; ++i)
+            styles.insert(cellStyle(i), "ce");
+    }
+}
+
+void KoGenStylesBenchmark::benchmarkInsertShared_data()
+{
+    addCounts();
+}
+
+void KoGenStylesBenchmark::benchmarkInsertShared()
+{
+    QFETCH(int, count);
+
+    // most cells share one of a few hundred styles
+    QBENCHMARK {
+        KoGenStyles styles;
+        for (int i = 0; i < count; ++i)
+            styles.insert(cellStyle(i % 500), "ce");
+    }
+}
+
+void KoGenStylesBenchmark::benchmarkSave_data()
+{
+    addCounts();
+}
+
+void KoGenStylesBenchmark::benchmarkSave()
+{
+    QFETCH(int, count);
+
+    QBENCHMARK {
+        KoGenStyles styles;
+        for (int i = 0; i < count; ++i)
+            styles.insert(cellStyle(i % (count / 10)), "ce");
+
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        KoXmlWriter writer(&buffer);
+        styles.saveOdfStyles(KoGenStyles::DocumentAutomaticStyles, &writer);
+    }
+}
+
+QTEST_MAIN(KoGenStylesBenchmark)
@@ -0,0 +1,48 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOGENSTYLESBENCHMARK_H
+#define KOGENSTYLESBENCHMARK_H
+
+#include <QObject>
+
+class KoGenStyle;
+
+/**
+ * Measures the insertion of many automatic styles into KoGenStyles and
+ * their saving, as done for the cells of large imported spreadsheets.
+ */
+class KoGenStylesBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void benchmarkInsertUnique_data();
+    void benchmarkInsertUnique();
+    void benchmarkInsertShared_data();
+    void benchmarkInsertShared();
+    void benchmarkSave_data();
+    void benchmarkSave();
+
+private:
+    void addCounts();
+    /// @return the @p i'th of many distinct table cell styles
+    static KoGenStyle cellStyle(int i);
+};
+
+#endif // KOGENSTYLESBENCHMARK_H
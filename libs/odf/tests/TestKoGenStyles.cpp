@@ -375,4 +375,29 @@ void TestKoGenStyles::testStylesDotXml()
     QCOMPARE(firstName, QString("P2"));     // anything but not P1.
 }
 
+void TestKoGenStyles::testStyleForModification()
+{
+    KoGenStyles coll;
+
+    KoGenStyle first(KoGenStyle::ParagraphAutoStyle, "paragraph");
+    first.addProperty("fo:margin-left", "1cm");
+    QString firstName = coll.insert(first, "P");
+
+    KoGenStyle second(KoGenStyle::ParagraphAutoStyle, "paragraph");
+    second.addProperty("fo:margin-left", "2cm");
+    QString secondName = coll.insert(second, "P");
+    QVERIFY(firstName != secondName);
+
+    // the modified style is found by its new properties only
+    KoGenStyle *modified = coll.styleForModification(firstName, "paragraph");
+    QVERIFY(modified);
+    modified->addProperty("fo:margin-left", "3cm");
+    QCOMPARE(coll.insert(first, "P"), QString("P3"));
+    KoGenStyle third(KoGenStyle::ParagraphAutoStyle, "paragraph");
+    third.addProperty("fo:margin-left", "3cm");
+    QCOMPARE(coll.insert(third, "P"), firstName);
+    QCOMPARE(coll.insert(second, "P"), secondName);
+    QCOMPARE(coll.styles().count(), 3);
+}
+
 QTEST_MAIN(TestKoGenStyles)
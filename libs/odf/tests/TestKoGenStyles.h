@@ -31,6 +31,7 @@ private Q_SLOTS:
     void testUserStyles();
     void testWriteStyle();
     void testStylesDotXml();
+    void testStyleForModification();
 };
 
 #endif // TESTKOGENSTYLES_H
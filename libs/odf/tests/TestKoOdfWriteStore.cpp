@@ -0,0 +1,127 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestKoOdfWriteStore.h"
+
+#include <KoOdfWriteStore.h>
+#include <KoStore.h>
+#include <KoXmlWriter.h>
+
+#include <QBuffer>
+#include <QTest>
+
+static void writeBody(KoXmlWriter *writer, int rows)
+{
+    writer->startElement("office:body");
+    writer->startElement("office:spreadsheet");
+    writer->startElement("table:table");
+    for (int row = 0; row < rows; ++row) {
+        writer->startElement("table:table-row");
+        for (int column = 0; column < 5; ++column) {
+            writer->startElement("table:table-cell");
+            writer->addAttribute("office:value-type", "float");
+            writer->addAttribute("office:value", row * 5 + column);
+            writer->startElement("text:p");
+            writer->addTextNode(QString::number(row * 5 + column));
+            writer->endElement();
+            writer->endElement();
+        }
+        writer->endElement();
+    }
+    writer->endElement();
+    writer->endElement();
+    writer->endElement();
+}
+
+void TestKoOdfWriteStore::testBody_data()
+{
+    QTest::addColumn<qint64>("memoryLimit");
+    QTest::addColumn<int>("rows");
+
+    QTest::newRow("small") << qint64(64 * 1024 * 1024) << 10;
+    QTest::newRow("in memory") << qint64(-1) << 20000;
+    QTest::newRow("temporary file") << qint64(0) << 20000;
+    QTest::newRow("both") << qint64(100000) << 20000;
+}
+
+void TestKoOdfWriteStore::testBody()
+{
+    QFETCH(qint64, memoryLimit);
+    QFETCH(int, rows);
+
+    // the body, as written without buffering
+    QBuffer expected;
+    expected.open(QIODevice::WriteOnly);
+    KoXmlWriter expectedWriter(&expected, 1);
+    writeBody(&expectedWriter, rows);
+
+    const char *mimeType = "application/vnd.oasis.opendocument.spreadsheet";
+    QBuffer package;
+    KoStore *store = KoStore::createStore(&package, KoStore::Write, mimeType, KoStore::Zip);
+    KoOdfWriteStore odfStore(store);
+    odfStore.setBodyMemoryLimit(memoryLimit);
+    QCOMPARE(odfStore.bodyMemoryLimit(), memoryLimit);
+
+    KoXmlWriter *contentWriter = odfStore.contentWriter();
+    QVERIFY(contentWriter);
+    KoXmlWriter *bodyWriter = odfStore.bodyWriter();
+    QVERIFY(bodyWriter);
+    writeBody(bodyWriter, rows);
+    contentWriter->startElement("office:automatic-styles");
+    contentWriter->endElement();
+    QVERIFY(odfStore.closeContentWriter());
+    delete store;
+
+    store = KoStore::createStore(&package, KoStore::Read, mimeType, KoStore::Zip);
+    QVERIFY(store->open("content.xml"));
+    const QByteArray content = store->read(store->size());
+    QVERIFY(store->close());
+    delete store;
+
+    QVERIFY(content.contains(expected.data()));
+    QVERIFY(content.indexOf("office:automatic-styles") < content.indexOf("office:body"));
+    QVERIFY(content.trimmed().endsWith("</office:document-content>"));
+}
+
+void TestKoOdfWriteStore::testBodyError()
+{
+    // the temporary file cannot be created
+    const QByteArray tmpDir = qgetenv("TMPDIR");
+    qputenv("TMPDIR", "/nonexistent/calligra-test");
+
+    const char *mimeType = "application/vnd.oasis.opendocument.spreadsheet";
+    QBuffer package;
+    KoStore *store = KoStore::createStore(&package, KoStore::Write, mimeType, KoStore::Zip);
+    KoOdfWriteStore odfStore(store);
+    odfStore.setBodyMemoryLimit(0);
+
+    QVERIFY(odfStore.contentWriter());
+    writeBody(odfStore.bodyWriter(), 20000);
+    const bool ok = odfStore.closeContentWriter();
+    delete store;
+
+    if (tmpDir.isNull())
+        qunsetenv("TMPDIR");
+    else
+        qputenv("TMPDIR", tmpDir);
+
+    QVERIFY(!ok);
+}
+
+QTEST_GUILESS_MAIN(TestKoOdfWriteStore)
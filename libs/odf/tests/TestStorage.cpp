@@ -18,6 +18,7 @@
  * Boston, MA 02110-1301, USA.
 */
 
+#include <QBuffer>
 #include <QFile>
 #include <QDir>
 
@@ -38,6 +39,9 @@ private Q_SLOTS:
     void storage();
     void storage2_data();
     void storage2();
+    void storedEntries_data();
+    void storedEntries();
+    void parallelEntries();
 
 private:
     char getch(QIODevice * dev);
@@ -259,6 +263,117 @@ void TestStorage::storage2()
     QFile::remove(testFile);
 }
 
+void TestStorage::storedEntries_data()
+{
+    QTest::addColumn<bool>("inMemory");
+    QTest::addColumn<bool>("compressed");
+
+    QTest::newRow("file, stored") << false << false;
+    QTest::newRow("file, deflated") << false << true;
+    QTest::newRow("buffer, stored") << true << false;
+    QTest::newRow("buffer, deflated") << true << true;
+}
+
+void TestStorage::storedEntries()
+{
+    QFETCH(bool, inMemory);
+    QFETCH(bool, compressed);
+
+    // larger than the mapping threshold
+    QByteArray picture;
+    for (int i = 0; i < 100000; ++i)
+        picture.append(char(i % 251));
+
+    const QString testFile("testStored.zip");
+    QBuffer buffer;
+    KoStore* store = inMemory
+        ? KoStore::createStore(&buffer, KoStore::Write, "", KoStore::Zip)
+        : KoStore::createStore(testFile, KoStore::Write, "", KoStore::Zip);
+    QVERIFY(store->bad() == false);
+    store->setCompressionEnabled(compressed);
+    QVERIFY(store->open("Pictures/picture.png"));
+    QCOMPARE(store->write(picture), qint64(picture.size()));
+    QVERIFY(store->close());
+    delete store;
+
+    store = inMemory
+        ? KoStore::createStore(&buffer, KoStore::Read, "", KoStore::Zip)
+        : KoStore::createStore(testFile, KoStore::Read, "", KoStore::Zip);
+    QVERIFY(store->bad() == false);
+
+    // random access
+    QVERIFY(store->open("Pictures/picture.png"));
+    QCOMPARE(store->size(), qint64(picture.size()));
+    QVERIFY(store->seek(50000));
+    QCOMPARE(store->read(1000), picture.mid(50000, 1000));
+    QVERIFY(store->seek(10));
+    QCOMPARE(store->read(10), picture.mid(10, 10));
+    QVERIFY(store->seek(picture.size() - 5));
+    QCOMPARE(store->read(100), picture.right(5));
+    QVERIFY(store->atEnd());
+    QVERIFY(store->close());
+
+    QByteArray data;
+    QVERIFY(store->extractFile("Pictures/picture.png", data));
+    QCOMPARE(data, picture);
+    delete store;
+
+    QFile::remove(testFile);
+}
+
+void TestStorage::parallelEntries()
+{
+    const QByteArray mimetype("application/vnd.oasis.opendocument.presentation");
+
+    // text, that compresses well, spanning several compression blocks
+    QByteArray content;
+    for (int i = 0; content.size() < 3 * 1024 * 1024 + 17; ++i)
+        content.append("<text:p>paragraph " + QByteArray::number(i) + "</text:p>\n");
+    // noise, that does not compress
+    QByteArray picture;
+    uint seed = 1;
+    for (int i = 0; i < 200000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        picture.append(char(seed >> 16));
+    }
+
+    QList<QPair<QString, QByteArray> > entries;
+    entries << qMakePair(QString("content.xml"), content);
+    for (int i = 0; i < 20; ++i)
+        entries << qMakePair(QString("Pictures/picture%1.png").arg(i), picture.left(i * 10000));
+    entries << qMakePair(QString("styles.xml"), content.left(1000));
+
+    QBuffer buffer;
+    KoStore* store = KoStore::createStore(&buffer, KoStore::Write, mimetype, KoStore::Zip);
+    QVERIFY(store->bad() == false);
+    for (int i = 0; i < entries.count(); ++i) {
+        const QByteArray &data = entries[i].second;
+        QVERIFY(store->open(entries[i].first));
+        for (int pos = 0; pos < data.size(); pos += 100000)
+            QVERIFY(store->write(data.constData() + pos, qMin(100000, data.size() - pos)) > 0);
+        QVERIFY(store->close());
+    }
+    QVERIFY(store->finalize());
+    delete store;
+
+    // the mimetype is the first entry and stored
+    const QByteArray archive = buffer.data();
+    QVERIFY(archive.startsWith("PK\003\004"));
+    QCOMPARE(int(archive[8]), 0);
+    QCOMPARE(archive.mid(30, 8), QByteArray("mimetype"));
+    QCOMPARE(archive.mid(38, mimetype.size()), mimetype);
+
+    store = KoStore::createStore(&buffer, KoStore::Read, "", KoStore::Zip);
+    QVERIFY(store->bad() == false);
+    QVERIFY(store->hasFile("mimetype"));
+    for (int i = 0; i < entries.count(); ++i) {
+        QByteArray data;
+        QVERIFY(store->extractFile(entries[i].first, data));
+        QCOMPARE(data, entries[i].second);
+    }
+    delete store;
+}
+
 QTEST_GUILESS_MAIN(TestStorage)
 #include <TestStorage.moc>
 
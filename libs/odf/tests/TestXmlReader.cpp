@@ -7,6 +7,7 @@
 #include <QString>
 #include <QTextStream>
 
+#include <KoXmlNS.h>
 #include <KoXmlReader.h>
 
 
@@ -34,6 +35,7 @@ private Q_SLOTS:
     void testSimpleOpenDocumentSpreadsheet();
     void testSimpleOpenDocumentPresentation();
     void testSimpleOpenDocumentFormula();
+    void testElementCursor();
     void testLargeOpenDocumentSpreadsheet();
     void testExternalOpenDocumentSpreadsheet(const QString& filename);
 };
@@ -2421,6 +2423,148 @@ void TestXmlReader::testSimpleOpenDocumentFormula()
     QCOMPARE(annotationElement.attributeNS(mathNS, "encoding", ""), QString("StarMath 5.0"));
 }
 
+void TestXmlReader::testElementCursor()
+{
+    QByteArray xml;
+    xml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    xml += "<office:document-content ";
+    xml += "xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" ";
+    xml += "xmlns:text=\"urn:oasis:names:tc:opendocument:xmlns:text:1.0\" ";
+    xml += "xmlns:table=\"urn:oasis:names:tc:opendocument:xmlns:table:1.0\">";
+    xml += "<office:body>";
+    xml += "<office:spreadsheet>";
+    xml += "<table:table table:name=\"Sheet1\" table:print=\"false\">";
+    xml += "<table:table-column table:style-name=\"co1\"/>";
+    for (int row = 0; row < 100; ++row) {
+        xml += "<table:table-row table:style-name=\"ro1\">";
+        xml += "<table:table-cell office:value-type=\"string\">";
+        xml += "<text:p>Row " + QByteArray::number(row) + "</text:p>";
+        xml += "</table:table-cell>";
+        xml += "<table:table-cell/>";
+        xml += "</table:table-row>";
+    }
+    xml += "</table:table>";
+    xml += "</office:spreadsheet>";
+    xml += "</office:body>";
+    xml += "</office:document-content>";
+
+    QString officeNS = "urn:oasis:names:tc:opendocument:xmlns:office:1.0";
+    QString textNS = "urn:oasis:names:tc:opendocument:xmlns:text:1.0";
+    QString tableNS = "urn:oasis:names:tc:opendocument:xmlns:table:1.0";
+
+    KoXmlElementCursor cursor(xml);
+    QVERIFY(cursor.readNextStartElement());
+    QVERIFY(cursor.isElement(officeNS, "document-content"));
+    QVERIFY(cursor.readNextStartElement());
+    QVERIFY(cursor.isElement(officeNS, "body"));
+    QVERIFY(cursor.readNextStartElement());
+    QVERIFY(cursor.isElement(officeNS, "spreadsheet"));
+    QVERIFY(cursor.readNextStartElement());
+    QVERIFY(cursor.isElement(tableNS, "table"));
+    QCOMPARE(cursor.attributeNS(tableNS, "name"), QString("Sheet1"));
+    QCOMPARE(cursor.hasAttributeNS(tableNS, "style-name"), false);
+    QCOMPARE(cursor.attributeNS(tableNS, "style-name", "ta1"), QString("ta1"));
+
+    // the table without its rows
+    KoXmlElement tableElement = cursor.element();
+    QCOMPARE(tableElement.isNull(), false);
+    QCOMPARE(tableElement.localName(), QString("table"));
+    QCOMPARE(tableElement.namespaceURI(), tableNS);
+    QCOMPARE(tableElement.attributeNS(tableNS, "name"), QString("Sheet1"));
+    QCOMPARE(tableElement.attributeNS(tableNS, "print"), QString("false"));
+    QCOMPARE(tableElement.hasChildNodes(), false);
+
+    // the column is skipped, the rows are read one by one
+    int rowCount = 0;
+    while (cursor.readNextStartElement()) {
+        if (!cursor.isElement(tableNS, "table-row")) {
+            QVERIFY(cursor.isElement(tableNS, "table-column"));
+            cursor.skipCurrentElement();
+            continue;
+        }
+        KoXmlElement rowElement = cursor.readElement();
+        QCOMPARE(rowElement.isNull(), false);
+        QCOMPARE(rowElement.localName(), QString("table-row"));
+        QCOMPARE(rowElement.attributeNS(tableNS, "style-name"), QString("ro1"));
+        QCOMPARE(KoXml::childNodesCount(rowElement), 2);
+        KoXmlElement cellElement = rowElement.firstChild().toElement();
+        QCOMPARE(cellElement.attributeNS(officeNS, "value-type"), QString("string"));
+        KoXmlElement textElement = KoXml::namedItemNS(cellElement, textNS, "p");
+        QCOMPARE(textElement.text(), QString("Row %1").arg(rowCount));
+        QCOMPARE(cellElement.nextSibling().toElement().hasChildNodes(), false);
+        ++rowCount;
+    }
+    QCOMPARE(rowCount, 100);
+    QCOMPARE(cursor.hasError(), false);
+
+    // the end of the spreadsheet, the body and the document
+    QCOMPARE(cursor.readNextStartElement(), false);
+    QCOMPARE(cursor.readNextStartElement(), false);
+    QCOMPARE(cursor.readNextStartElement(), false);
+    QCOMPARE(cursor.hasError(), false);
+
+    // the namespaces of OpenOffice.org 1.x map to the current ones
+    QByteArray oldXml;
+    oldXml += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    oldXml += "<office:document-content ";
+    oldXml += "xmlns:office=\"http://openoffice.org/2000/office\" ";
+    oldXml += "xmlns:style=\"http://openoffice.org/2000/style\" ";
+    oldXml += "xmlns:table=\"http://openoffice.org/2000/table\">";
+    oldXml += "<office:automatic-styles>";
+    oldXml += "<style:style style:name=\"ro1\" style:family=\"table-row\"/>";
+    oldXml += "</office:automatic-styles>";
+    oldXml += "<office:body>";
+    oldXml += "<table:table table:name=\"Sheet1\" office:other=\"x\">";
+    oldXml += "<table:table-row table:style-name=\"ro1\"/>";
+    oldXml += "</table:table>";
+    oldXml += "</office:body>";
+    oldXml += "</office:document-content>";
+    KoXmlElementCursor oldCursor(oldXml);
+    QVERIFY(oldCursor.readNextStartElement());
+    QVERIFY(oldCursor.isElement(KoXmlNS::office, "document-content"));
+
+    // the head of the document without its body
+    KoXmlElement headElement = oldCursor.readElementUntil(KoXmlNS::office, "body");
+    QCOMPARE(headElement.isNull(), false);
+    QCOMPARE(headElement.namespaceURI(), KoXmlNS::office);
+    QCOMPARE(KoXml::childNodesCount(headElement), 1);
+    KoXmlElement styleElement = KoXml::namedItemNS(KoXml::namedItemNS(headElement, KoXmlNS::office, "automatic-styles"),
+                                                   KoXmlNS::style, "style");
+    QCOMPARE(styleElement.attributeNS(KoXmlNS::style, "name"), QString("ro1"));
+    QVERIFY(oldCursor.isElement(KoXmlNS::office, "body"));
+
+    QVERIFY(oldCursor.readNextStartElement());
+    QVERIFY(oldCursor.isElement(KoXmlNS::table, "table"));
+    QCOMPARE(oldCursor.hasAttributeNS(KoXmlNS::table, "name"), true);
+    QCOMPARE(oldCursor.attributeNS(KoXmlNS::table, "name"), QString("Sheet1"));
+    QCOMPARE(oldCursor.attributeNS(KoXmlNS::office, "other"), QString("x"));
+    QCOMPARE(oldCursor.hasAttributeNS(KoXmlNS::office, "name"), false);
+    QCOMPARE(oldCursor.hasAttributeNS("http://openoffice.org/2000/table", "name"), false);
+    // the elements handed out agree with the cursor
+    QCOMPARE(oldCursor.element().attributeNS(KoXmlNS::table, "name"), QString("Sheet1"));
+    KoXmlElement oldTableElement = oldCursor.readElement();
+    QCOMPARE(oldTableElement.attributeNS(KoXmlNS::table, "name"), QString("Sheet1"));
+    QCOMPARE(oldTableElement.attributeNS(KoXmlNS::office, "other"), QString("x"));
+    KoXmlElement oldRowElement = KoXml::namedItemNS(oldTableElement, KoXmlNS::table, "table-row");
+    QCOMPARE(oldRowElement.attributeNS(KoXmlNS::table, "style-name"), QString("ro1"));
+    QCOMPARE(oldCursor.hasError(), false);
+
+    // and so does the whole document
+    KoXmlDocument oldDocument;
+    QVERIFY(oldDocument.setContent(oldXml, true));
+    KoXmlElement oldBody = KoXml::namedItemNS(oldDocument.documentElement(), KoXmlNS::office, "body");
+    oldTableElement = KoXml::namedItemNS(oldBody, KoXmlNS::table, "table");
+    QCOMPARE(oldTableElement.attributeNS(KoXmlNS::table, "name"), QString("Sheet1"));
+
+    // a broken document
+    KoXmlElementCursor brokenCursor(QByteArray("<a><b><c></b></a>"));
+    QVERIFY(brokenCursor.readNextStartElement());
+    QVERIFY(brokenCursor.readNextStartElement());
+    QCOMPARE(brokenCursor.localName(), QString("b"));
+    QCOMPARE(brokenCursor.readElement().isNull(), true);
+    QCOMPARE(brokenCursor.hasError(), true);
+}
+
 void TestXmlReader::testLargeOpenDocumentSpreadsheet()
 {
     QString errorMsg;
@@ -239,7 +239,8 @@ bool KoPADocument::saveOdf( SavingContext & documentContext )
 
     mainStyles.saveOdfStyles( KoGenStyles::DocumentAutomaticStyles, contentWriter );
 
-    documentContext.odfStore.closeContentWriter();
+    if ( !documentContext.odfStore.closeContentWriter() )
+        return false;
 
     //add manifest line for content.xml
     documentContext.odfStore.manifestWriter()->addManifestEntry( "content.xml", "text/xml" );
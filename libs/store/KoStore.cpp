@@ -485,6 +485,17 @@ bool KoStore::extractFile(const QString &srcName, const QString &fileName)
 bool KoStore::extractFile(const QString &srcName, QByteArray &data)
 {
     Q_D(KoStore);
+    if (!open(srcName))
+        return false;
+    const qint64 size = this->size();
+    if (size >= 0) {
+        // read the whole file at once, instead of growing the array block by block
+        data = read(size);
+        close();
+        return data.size() == size;
+    }
+    close();
+
     QBuffer buffer(&data);
     return d->extractFile(srcName, buffer);
 }
@@ -726,7 +726,7 @@ namespace {
         QXmlStreamAttributes attr = xml.attributes();
         for  (int a = 0; a < attr.count(); a++) {
             doc.addAttribute(attr[a].qualifiedName().toString(),
-                             attr[a].namespaceUri().toString(),
+                             fixNamespace(attr[a].namespaceUri().toString()),
                              attr[a].value().toString());
         }
         if (stripSpaces)
@@ -736,6 +736,48 @@ namespace {
         // reader.tokenType() is now QXmlStreamReader::EndElement
         doc.closeElement();
     }
+
+    // Parses the current element like parseElement(), but only up to its
+    // first child element localName in nsURI, which stays the current token.
+    // The whitespace between the children is dropped.
+    void parseElementUntil(QXmlStreamReader &xml, KoXmlPackedDocument &doc, bool stripSpaces,
+                           const QString &nsURI, const QString &localName)
+    {
+        doc.addElement(xml.qualifiedName().toString(),
+                       fixNamespace(xml.namespaceUri().toString()));
+        QXmlStreamAttributes attr = xml.attributes();
+        for  (int a = 0; a < attr.count(); a++) {
+            doc.addAttribute(attr[a].qualifiedName().toString(),
+                             fixNamespace(attr[a].namespaceUri().toString()),
+                             attr[a].value().toString());
+        }
+        xml.readNext();
+        while (!xml.atEnd() && xml.tokenType() != QXmlStreamReader::EndElement) {
+            switch (xml.tokenType()) {
+            case QXmlStreamReader::StartElement:
+                if (xml.name() == localName && fixNamespace(xml.namespaceUri().toString()) == nsURI) {
+                    doc.closeElement();
+                    return;
+                }
+                parseElement(xml, doc, stripSpaces);
+                break;
+            case QXmlStreamReader::Characters:
+                if (xml.isCDATA()) {
+                    doc.addCData(xml.text().toString());
+                } else if (!xml.isWhitespace()) {
+                    doc.addText(xml.text().toString());
+                }
+                break;
+            case QXmlStreamReader::ProcessingInstruction:
+                doc.addProcessingInstruction();
+                break;
+            default:
+                break;
+            }
+            xml.readNext();
+        }
+        doc.closeElement();
+    }
 }
 
 
@@ -2359,3 +2401,309 @@ bool KoXml::setDocument(KoXmlDocument& doc, QIODevice* device,
     bool result = doc.setContent(&reader, errorMsg, errorLine, errorColumn);
     return result;
 }
+
+// ==================================================================
+//
+//         KoXmlElementCursor
+//
+// ==================================================================
+
+class Q_DECL_HIDDEN KoXmlElementCursor::Private
+{
+public:
+    Private(bool stripSpaces) : stripSpaces(stripSpaces) {}
+
+    void init() {
+        reader.setNamespaceProcessing(true);
+#ifndef KOXML_USE_QDOM
+        reader.setEntityResolver(&entityResolver);
+#endif
+    }
+
+    QBuffer buffer;
+    QXmlStreamReader reader;
+#ifndef KOXML_USE_QDOM
+    DumbEntityResolver entityResolver;
+#endif
+    bool stripSpaces;
+
+    // the documents of the last elements handed out
+    KoXmlDocument element;
+    KoXmlDocument deepElement;
+};
+
+#ifdef KOXML_USE_QDOM
+static QDomElement readDomElement(QXmlStreamReader &reader, QDomDocument &doc, bool stripSpaces, bool deep)
+{
+    QDomElement element = doc.createElementNS(reader.namespaceUri().toString(),
+                                              reader.qualifiedName().toString());
+    const QXmlStreamAttributes attributes = reader.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        element.setAttributeNS(attributes[i].namespaceUri().toString(),
+                               attributes[i].qualifiedName().toString(),
+                               attributes[i].value().toString());
+    }
+    if (!deep)
+        return element;
+
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement:
+            element.appendChild(readDomElement(reader, doc, stripSpaces, true));
+            break;
+        case QXmlStreamReader::Characters:
+            if (reader.isCDATA())
+                element.appendChild(doc.createCDATASection(reader.text().toString()));
+            else if (!stripSpaces || !reader.isWhitespace())
+                element.appendChild(doc.createTextNode(reader.text().toString()));
+            break;
+        case QXmlStreamReader::EndElement:
+            return element;
+        default:
+            break;
+        }
+    }
+    return element;
+}
+
+static QDomElement readDomElementUntil(QXmlStreamReader &reader, QDomDocument &doc, bool stripSpaces,
+                                       const QString &nsURI, const QString &localName)
+{
+    QDomElement element = readDomElement(reader, doc, stripSpaces, false);
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement:
+            if (reader.name() == localName && reader.namespaceUri() == nsURI)
+                return element;
+            element.appendChild(readDomElement(reader, doc, stripSpaces, true));
+            break;
+        case QXmlStreamReader::Characters:
+            if (reader.isCDATA())
+                element.appendChild(doc.createCDATASection(reader.text().toString()));
+            else if (!reader.isWhitespace())
+                element.appendChild(doc.createTextNode(reader.text().toString()));
+            break;
+        case QXmlStreamReader::EndElement:
+            return element;
+        default:
+            break;
+        }
+    }
+    return element;
+}
+#endif
+
+KoXmlElementCursor::KoXmlElementCursor(QIODevice *device, bool stripSpaces)
+    : d(new Private(stripSpaces))
+{
+    if (!device->isOpen())
+        device->open(QIODevice::ReadOnly);
+    d->reader.setDevice(device);
+    d->init();
+}
+
+KoXmlElementCursor::KoXmlElementCursor(const QByteArray &data, bool stripSpaces)
+    : d(new Private(stripSpaces))
+{
+    d->buffer.setData(data);
+    d->buffer.open(QIODevice::ReadOnly);
+    d->reader.setDevice(&d->buffer);
+    d->init();
+}
+
+KoXmlElementCursor::~KoXmlElementCursor()
+{
+    delete d;
+}
+
+bool KoXmlElementCursor::readNextStartElement()
+{
+    return d->reader.readNextStartElement();
+}
+
+void KoXmlElementCursor::skipCurrentElement()
+{
+    d->reader.skipCurrentElement();
+}
+
+KoXmlElement KoXmlElementCursor::readElement()
+{
+    // release the previous element before parsing the next one
+    d->deepElement = KoXmlDocument();
+    if (!d->reader.isStartElement())
+        return KoXmlElement();
+
+#ifdef KOXML_USE_QDOM
+    QDomDocument doc;
+    doc.appendChild(readDomElement(d->reader, doc, d->stripSpaces, true));
+    if (d->reader.hasError())
+        return KoXmlElement();
+    d->deepElement = doc;
+#else
+    KoXmlDocumentData *data = new KoXmlDocumentData(0);
+    data->nodeType = KoXmlNode::DocumentNode;
+    data->stripSpaces = d->stripSpaces;
+    data->packedDoc = new KoXmlPackedDocument;
+    data->packedDoc->processNamespace = true;
+    d->deepElement = KoXmlDocument(data);
+
+    parseElement(d->reader, *data->packedDoc, d->stripSpaces);
+    if (d->reader.hasError()) {
+        d->deepElement = KoXmlDocument();
+        return KoXmlElement();
+    }
+    data->packedDoc->finish();
+#endif
+    return d->deepElement.documentElement();
+}
+
+KoXmlElement KoXmlElementCursor::readElementUntil(const QString &nsURI, const QString &localName)
+{
+    d->deepElement = KoXmlDocument();
+    if (!d->reader.isStartElement())
+        return KoXmlElement();
+
+#ifdef KOXML_USE_QDOM
+    QDomDocument doc;
+    doc.appendChild(readDomElementUntil(d->reader, doc, d->stripSpaces, nsURI, localName));
+    if (d->reader.hasError())
+        return KoXmlElement();
+    d->deepElement = doc;
+#else
+    KoXmlDocumentData *data = new KoXmlDocumentData(0);
+    data->nodeType = KoXmlNode::DocumentNode;
+    data->stripSpaces = d->stripSpaces;
+    data->packedDoc = new KoXmlPackedDocument;
+    data->packedDoc->processNamespace = true;
+    d->deepElement = KoXmlDocument(data);
+
+    parseElementUntil(d->reader, *data->packedDoc, d->stripSpaces, nsURI, localName);
+    if (d->reader.hasError()) {
+        d->deepElement = KoXmlDocument();
+        return KoXmlElement();
+    }
+    data->packedDoc->finish();
+#endif
+    return d->deepElement.documentElement();
+}
+
+KoXmlElement KoXmlElementCursor::element()
+{
+    d->element = KoXmlDocument();
+    if (!d->reader.isStartElement())
+        return KoXmlElement();
+
+#ifdef KOXML_USE_QDOM
+    QDomDocument doc;
+    doc.appendChild(readDomElement(d->reader, doc, d->stripSpaces, false));
+    d->element = doc;
+#else
+    KoXmlDocumentData *data = new KoXmlDocumentData(0);
+    data->nodeType = KoXmlNode::DocumentNode;
+    data->packedDoc = new KoXmlPackedDocument;
+    data->packedDoc->processNamespace = true;
+    d->element = KoXmlDocument(data);
+
+    KoXmlPackedDocument &doc = *data->packedDoc;
+    doc.addElement(d->reader.qualifiedName().toString(),
+                   fixNamespace(d->reader.namespaceUri().toString()));
+    const QXmlStreamAttributes attributes = d->reader.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+        doc.addAttribute(attributes[i].qualifiedName().toString(),
+                         fixNamespace(attributes[i].namespaceUri().toString()),
+                         attributes[i].value().toString());
+    }
+    doc.closeElement();
+    doc.finish();
+#endif
+    return d->element.documentElement();
+}
+
+bool KoXmlElementCursor::isStartElement() const
+{
+    return d->reader.isStartElement();
+}
+
+bool KoXmlElementCursor::isElement(const QString &nsURI, const QString &localName) const
+{
+    return d->reader.isStartElement() && d->reader.name() == localName && namespaceURI() == nsURI;
+}
+
+QString KoXmlElementCursor::namespaceURI() const
+{
+#ifdef KOXML_USE_QDOM
+    return d->reader.namespaceUri().toString();
+#else
+    return fixNamespace(d->reader.namespaceUri().toString());
+#endif
+}
+
+QString KoXmlElementCursor::localName() const
+{
+    return d->reader.name().toString();
+}
+
+#ifndef KOXML_USE_QDOM
+// Returns the index of the attribute, mapping the namespaces of older
+// OpenOffice.org documents as namespaceURI() does, or -1.
+static int indexOfAttribute(const QXmlStreamAttributes &attributes,
+                            const QString &nsURI, const QString &localName)
+{
+    for (int i = 0; i < attributes.count(); ++i) {
+        const QXmlStreamAttribute &attribute = attributes.at(i);
+        if (attribute.name() == localName && fixNamespace(attribute.namespaceUri().toString()) == nsURI)
+            return i;
+    }
+    return -1;
+}
+#endif
+
+bool KoXmlElementCursor::hasAttributeNS(const QString &nsURI, const QString &localName) const
+{
+#ifdef KOXML_USE_QDOM
+    return d->reader.attributes().hasAttribute(nsURI, localName);
+#else
+    return indexOfAttribute(d->reader.attributes(), nsURI, localName) != -1;
+#endif
+}
+
+QString KoXmlElementCursor::attributeNS(const QString &nsURI, const QString &localName,
+                                        const QString &defaultValue) const
+{
+    const QXmlStreamAttributes attributes = d->reader.attributes();
+#ifdef KOXML_USE_QDOM
+    if (!attributes.hasAttribute(nsURI, localName))
+        return defaultValue;
+    return attributes.value(nsURI, localName).toString();
+#else
+    const int index = indexOfAttribute(attributes, nsURI, localName);
+    if (index == -1)
+        return defaultValue;
+    return attributes.at(index).value().toString();
+#endif
+}
+
+bool KoXmlElementCursor::atEnd() const
+{
+    return d->reader.atEnd();
+}
+
+bool KoXmlElementCursor::hasError() const
+{
+    return d->reader.hasError();
+}
+
+QString KoXmlElementCursor::errorString() const
+{
+    return d->reader.errorString();
+}
+
+int KoXmlElementCursor::lineNumber() const
+{
+    return d->reader.lineNumber();
+}
+
+int KoXmlElementCursor::columnNumber() const
+{
+    return d->reader.columnNumber();
+}
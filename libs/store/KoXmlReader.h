@@ -317,6 +317,7 @@ public:
 
 private:
     friend class KoXmlNode;
+    friend class KoXmlElementCursor;
     explicit KoXmlDocument(KoXmlDocumentData*);
 };
 
@@ -443,6 +444,106 @@ KOSTORE_EXPORT bool setDocument(KoXmlDocument& doc, QIODevice* device,
                                 int* errorLine = 0, int* errorColumn = 0);
 }
 
+/**
+ * KoXmlElementCursor reads an XML document in a single pass, one element
+ * at a time.
+ *
+ * Unlike KoXmlDocument it never holds the tree of the whole document. The
+ * cursor moves over the start elements like QXmlStreamReader does, and the
+ * element it is positioned on can be read, with all its children, into a
+ * KoXmlElement. Loaders that take a KoXmlElement, e.g. for a table row or a
+ * paragraph, can thus be fed element by element, and the peak memory is
+ * bounded by the largest element read at once instead of the document.
+ *
+ * \code
+ * KoXmlElementCursor cursor(device);
+ * cursor.readNextStartElement();       // office:document-content
+ * ...
+ * while (cursor.readNextStartElement()) {
+ *     if (cursor.isElement(KoXmlNS::table, "table-row"))
+ *         loadRow(cursor.readElement());
+ *     else
+ *         cursor.skipCurrentElement();
+ * }
+ * \endcode
+ *
+ * Namespace processing is always enabled; the namespaces of older
+ * OpenOffice.org documents are translated as by KoXmlDocument.
+ *
+ * The elements returned by element() and readElement() are valid until
+ * the next call of the same method or until the cursor is destroyed, unless
+ * their ownerDocument() is kept. readElementUntil() shares its document
+ * with readElement().
+ */
+class KOSTORE_EXPORT KoXmlElementCursor
+{
+public:
+    /**
+     * Reads from @p device, which is opened if necessary.
+     * @see KoXmlDocument::setWhitespaceStripping() for @p stripSpaces
+     */
+    explicit KoXmlElementCursor(QIODevice *device, bool stripSpaces = true);
+    explicit KoXmlElementCursor(const QByteArray &data, bool stripSpaces = true);
+    ~KoXmlElementCursor();
+
+    /**
+     * Reads until the next start element within the current element.
+     * @return true, if a start element was reached, false if the end of
+     * the current element was reached or an error occurred
+     */
+    bool readNextStartElement();
+
+    /**
+     * Skips the current element with all its children.
+     */
+    void skipCurrentElement();
+
+    /**
+     * Reads the current element with all its children. Afterwards the
+     * cursor is positioned at the end of the element.
+     * @return the element, or a null element on an error
+     */
+    KoXmlElement readElement();
+
+    /**
+     * Reads the current element like readElement(), but only up to its
+     * first child element @p localName in @p nsURI, which becomes the
+     * current element. This way the head of a large element can be read
+     * as a whole and the rest element by element. The whitespace between
+     * the children read is dropped. If there is no such child, the whole
+     * element is read.
+     * @return the element with the children before the given one, or a
+     * null element on an error
+     */
+    KoXmlElement readElementUntil(const QString &nsURI, const QString &localName);
+
+    /**
+     * @return the current element with its attributes, but without its
+     * children. The cursor does not move.
+     */
+    KoXmlElement element();
+
+    bool isStartElement() const;
+    bool isElement(const QString &nsURI, const QString &localName) const;
+    QString namespaceURI() const;
+    QString localName() const;
+    bool hasAttributeNS(const QString &nsURI, const QString &localName) const;
+    QString attributeNS(const QString &nsURI, const QString &localName,
+                        const QString &defaultValue = QString()) const;
+
+    bool atEnd() const;
+    bool hasError() const;
+    QString errorString() const;
+    int lineNumber() const;
+    int columnNumber() const;
+
+private:
+    Q_DISABLE_COPY(KoXmlElementCursor)
+
+    class Private;
+    Private * const d;
+};
+
 /**
  * \def forEachElement( elem, parent )
  * \brief Loop through all child elements of \parent.
@@ -31,6 +31,56 @@
 #include <QByteArray>
 #include <QDataStream>
 #include <QBuffer>
+#include <QMutex>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <algorithm>
+
+/**
+ * A block of KoXmlVector, packed or unpacked on a thread pool.
+ * The owner waits for it before reading the result.
+ */
+class KoXmlVectorJob : public QRunnable
+{
+public:
+    KoXmlVectorJob() : m_done(false) {
+        setAutoDelete(false);
+    }
+    virtual ~KoXmlVectorJob() {}
+
+    virtual void run() {
+        process();
+        QMutexLocker locker(&m_mutex);
+        m_done = true;
+        m_finished.wakeAll();
+    }
+
+    void wait() {
+        QMutexLocker locker(&m_mutex);
+        while (!m_done)
+            m_finished.wait(&m_mutex);
+    }
+
+    /**
+     * The jobs have a pool of their own, so that documents loaded on the
+     * threads of the global pool cannot starve them.
+     */
+    static QThreadPool *pool() {
+        static QThreadPool threadPool;
+        return &threadPool;
+    }
+
+protected:
+    virtual void process() = 0;
+
+private:
+    QMutex m_mutex;
+    QWaitCondition m_finished;
+    bool m_done;
+};
 
 /**
  * KoXmlVector
@@ -45,6 +95,11 @@
  * <li>just read content with operator[]</li>
  * </sl>
  *
+ * Full blocks are serialized and compressed on a thread pool,
+ * while the next items are added. On reading, the block following the one
+ * just read is decompressed ahead on the pool, so that a sequential
+ * traversal rarely waits for the decompression.
+ *
  * @param uncompressedItemCount when number of buffered items reach this,
  *      compression will start small value will give better memory usage at the
  *      cost of speed bigger value will be better in term of speed, but use
@@ -54,14 +109,106 @@ template <typename T, int uncompressedItemCount = 256, int reservedBufferSize =
 class KoXmlVector
 {
 private:
+    // the number of blocks being compressed at once, bounds the memory
+    enum { MaximumPendingBlocks = 8 };
+
+    class Packer : public KoXmlVectorJob
+    {
+    public:
+        Packer(int block, const QVector<T> &items) : block(block), items(items) {}
+        int block;
+        QVector<T> items;
+        QByteArray data;
+    protected:
+        virtual void process() {
+            data = pack(items);
+            items.clear();
+        }
+    };
+
+    class Unpacker : public KoXmlVectorJob
+    {
+    public:
+        Unpacker(int block, const QByteArray &data) : block(block), data(data) {}
+        int block;
+        QByteArray data;
+        QVector<T> items;
+    protected:
+        virtual void process() {
+            QByteArray buffer;
+            unpack(data, buffer, items);
+        }
+    };
+
     unsigned m_totalItems;
     QVector<unsigned> m_startIndex;
-    QVector<QByteArray> m_blocks;
+    mutable QVector<QByteArray> m_blocks;
+    // the blocks still being compressed, in order
+    mutable QVector<QSharedPointer<Packer> > m_packers;
+    // the block decompressed ahead
+    mutable QSharedPointer<Unpacker> m_unpacker;
 
     mutable unsigned m_bufferStartIndex;
     mutable QVector<T> m_bufferItems;
     mutable QByteArray m_bufferData;
 
+    static QByteArray pack(const QVector<T> &items) {
+        QBuffer buffer;
+        buffer.open(QIODevice::WriteOnly);
+        QDataStream out(&buffer);
+        out << items;
+#ifdef KOXMLVECTOR_USE_LZF
+        return KoLZF::compress(buffer.data());
+#else
+        return buffer.data();
+#endif
+    }
+
+    static void unpack(const QByteArray &data, QByteArray &bufferData, QVector<T> &items) {
+#ifdef KOXMLVECTOR_USE_LZF
+        KoLZF::decompress(data, bufferData);
+#else
+        bufferData = data;
+#endif
+        QBuffer buffer(&bufferData);
+        buffer.open(QIODevice::ReadOnly);
+        QDataStream in(&buffer);
+        items.clear();
+        in >> items;
+    }
+
+    static bool useThreads() {
+        return KoXmlVectorJob::pool()->maxThreadCount() > 1;
+    }
+
+    /**
+     * takes over the compressed blocks, waiting for at most @p pending
+     * blocks to be still in compression
+     */
+    void collectBlocks(int pending) const {
+        while (m_packers.count() > pending) {
+            QSharedPointer<Packer> packer = m_packers.first();
+            packer->wait();
+            m_blocks[packer->block] = packer->data;
+            m_packers.remove(0);
+        }
+    }
+
+    void waitForJobs() {
+        collectBlocks(0);
+        if (m_unpacker) {
+            m_unpacker->wait();
+            m_unpacker.clear();
+        }
+    }
+
+    void prefetch(int block) const {
+        if (!useThreads() || block >= m_blocks.count())
+            return;
+        m_unpacker = QSharedPointer<Unpacker>(new Unpacker(block, m_blocks[block]));
+        KoXmlVectorJob::pool()->start(m_unpacker.data());
+    }
+
 protected:
     /**
      * fetch given item index to the buffer
@@ -73,44 +220,41 @@ protected:
             if (index - m_bufferStartIndex < (unsigned)m_bufferItems.count())
                 return;
 
+        collectBlocks(0);
+
         // search in the stored blocks
-        // TODO: binary search to speed up
-        int loc = m_startIndex.count() - 1;
-        for (int c = 0; c < m_startIndex.count() - 1; ++c)
-            if (index >= m_startIndex[c])
-                if (index < m_startIndex[c+1]) {
-                    loc = c;
-                    break;
-                }
+        const int loc = std::upper_bound(m_startIndex.constBegin(), m_startIndex.constEnd(), index)
+                        - m_startIndex.constBegin() - 1;
 
         m_bufferStartIndex = m_startIndex[loc];
-#ifdef KOXMLVECTOR_USE_LZF
-        KoLZF::decompress(m_blocks[loc], m_bufferData);
-#else
-        m_bufferData = m_blocks[loc];
-#endif
-        QBuffer buffer(&m_bufferData);
-        buffer.open(QIODevice::ReadOnly);
-        QDataStream in(&buffer);
-        m_bufferItems.clear();
-        in >> m_bufferItems;
+        bool fetched = false;
+        if (m_unpacker) {
+            m_unpacker->wait();
+            if (m_unpacker->block == loc) {
+                m_bufferItems = m_unpacker->items;
+                fetched = true;
+            }
+            m_unpacker.clear();
+        }
+        if (!fetched)
+            unpack(m_blocks[loc], m_bufferData, m_bufferItems);
+        prefetch(loc + 1);
     }
 
     /**
      * store data in the buffer to main m_blocks
      */
     void storeBuffer() {
-        QBuffer buffer;
-        buffer.open(QIODevice::WriteOnly);
-        QDataStream out(&buffer);
-        out << m_bufferItems;
-
         m_startIndex.append(m_bufferStartIndex);
-#ifdef KOXMLVECTOR_USE_LZF
-        m_blocks.append(KoLZF::compress(buffer.data()));
-#else
-        m_blocks.append(buffer.data());
-#endif
+        if (useThreads()) {
+            m_blocks.append(QByteArray());
+            QSharedPointer<Packer> packer(new Packer(m_blocks.count() - 1, m_bufferItems));
+            m_packers.append(packer);
+            KoXmlVectorJob::pool()->start(packer.data());
+            collectBlocks(MaximumPendingBlocks);
+        } else {
+            m_blocks.append(pack(m_bufferItems));
+        }
 
         m_bufferStartIndex += m_bufferItems.count();
         m_bufferItems.clear();
@@ -119,7 +263,31 @@ protected:
 public:
     inline KoXmlVector(): m_totalItems(0), m_bufferStartIndex(0) {};
 
+    KoXmlVector(const KoXmlVector &other)
+        : m_totalItems(0), m_bufferStartIndex(0) {
+        *this = other;
+    }
+
+    KoXmlVector &operator=(const KoXmlVector &other) {
+        if (this != &other) {
+            waitForJobs();
+            other.collectBlocks(0);
+            m_totalItems = other.m_totalItems;
+            m_startIndex = other.m_startIndex;
+            m_blocks = other.m_blocks;
+            m_bufferStartIndex = other.m_bufferStartIndex;
+            m_bufferItems = other.m_bufferItems;
+        }
+        return *this;
+    }
+
+    ~KoXmlVector() {
+        // the jobs must not outlive their data
+        waitForJobs();
+    }
+
     void clear() {
+        waitForJobs();
         m_totalItems = 0;
         m_startIndex.clear();
         m_blocks.clear();
@@ -169,6 +337,7 @@ public:
      */
     void squeeze() {
         storeBuffer();
+        collectBlocks(0);
     }
 
 };
@@ -20,9 +20,11 @@
 
 #include "KoZipStore.h"
 #include "KoStore_p.h"
+#include "KoZipWriter.h"
 
 #include <QBuffer>
 #include <QByteArray>
+#include <QFile>
 
 #include <kzip.h>
 #include <StoreDebug.h>
@@ -30,6 +32,57 @@
 #include <QUrl>
 #include <KoNetAccess.h>
 
+// Smaller stored entries are read through the archive device.
+static const qint64 s_minimumMappedSize = 16 * 1024;
+
+namespace {
+
+/**
+ * Reads a stored entry directly from the memory mapped archive file.
+ * Seeking is free, and only the pages actually read are loaded.
+ */
+class MappedEntryDevice : public QIODevice
+{
+public:
+    MappedEntryDevice(QFile *file, uchar *data, qint64 size)
+        : m_file(file), m_data(data), m_size(size)
+    {
+        open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+    }
+
+    virtual ~MappedEntryDevice()
+    {
+        m_file->unmap(m_data);
+    }
+
+    virtual qint64 size() const
+    {
+        return m_size;
+    }
+
+protected:
+    virtual qint64 readData(char *data, qint64 maxSize)
+    {
+        const qint64 count = qMin(maxSize, m_size - pos());
+        if (count <= 0)
+            return 0;
+        memcpy(data, m_data + pos(), count);
+        return count;
+    }
+
+    virtual qint64 writeData(const char *, qint64)
+    {
+        return -1;
+    }
+
+private:
+    QFile *m_file;
+    uchar *m_data;
+    qint64 m_size;
+};
+
+} // namespace
+
 KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray & appIdentification,
                        bool writeMimetype)
   : KoStore(mode, writeMimetype)
@@ -41,7 +94,13 @@ KoZipStore::KoZipStore(const QString & _filename, Mode mode, const QByteArray &
 
     d->localFileName = _filename;
 
-    m_pZip = new KZip(_filename);
+    if (mode == Write) {
+        m_pZip = 0;
+        m_writer = new KoZipWriter(_filename);
+    } else {
+        m_pZip = new KZip(_filename);
+        m_writer = 0;
+    }
 
     init(appIdentification);   // open the zip file and init some vars
 }
@@ -50,7 +109,13 @@ KoZipStore::KoZipStore(QIODevice *dev, Mode mode, const QByteArray & appIdentifi
                        bool writeMimetype)
   : KoStore(mode, writeMimetype)
 {
-    m_pZip = new KZip(dev);
+    if (mode == Write) {
+        m_pZip = 0;
+        m_writer = new KoZipWriter(dev);
+    } else {
+        m_pZip = new KZip(dev);
+        m_writer = 0;
+    }
     init(appIdentification);
 }
 
@@ -76,7 +141,13 @@ KoZipStore::KoZipStore(QWidget* window, const QUrl &_url, const QString & _filen
         d->localFileName = QLatin1String("/tmp/kozip"); // ### FIXME with KTempFile
     }
 
-    m_pZip = new KZip(d->localFileName);
+    if (mode == Write) {
+        m_pZip = 0;
+        m_writer = new KoZipWriter(d->localFileName);
+    } else {
+        m_pZip = new KZip(d->localFileName);
+        m_writer = 0;
+    }
     init(appIdentification);   // open the zip file and init some vars
 }
 
@@ -86,7 +157,11 @@ KoZipStore::~KoZipStore()
     debugStore << "KoZipStore::~KoZipStore";
     if (!d->finalized)
         finalize(); // ### no error checking when the app forgot to call finalize itself
+    // a mapped entry device needs the archive file
+    delete d->stream;
+    d->stream = 0;
     delete m_pZip;
+    delete m_writer;
 
     // Now we have still some job to do for remote files.
     if (d->fileMode == KoStorePrivate::RemoteRead) {
@@ -102,7 +177,7 @@ void KoZipStore::init(const QByteArray& appIdentification)
     Q_D(KoStore);
 
     m_currentDir = 0;
-    d->good = m_pZip->open(d->mode == Write ? QIODevice::WriteOnly : QIODevice::ReadOnly);
+    d->good = d->mode == Write ? m_writer->open() : m_pZip->open(QIODevice::ReadOnly);
 
     if (!d->good)
         return;
@@ -110,16 +185,15 @@ void KoZipStore::init(const QByteArray& appIdentification)
     if (d->mode == Write) {
         //debugStore <<"KoZipStore::init writing mimetype" << appIdentification;
 
-        m_pZip->setCompression(KZip::NoCompression);
-        m_pZip->setExtraField(KZip::NoExtraField);
-
-        // Write identification
+        // Write identification; it is the first entry and stored, as ODF requires.
+        // The writer appends the entries in order, however they are compressed.
         if (d->writeMimetype) {
-            (void)m_pZip->writeFile(QLatin1String("mimetype"), appIdentification);
+            m_writer->setCompressionEnabled(false);
+            (void)m_writer->writeFile(QLatin1String("mimetype"), appIdentification);
         }
 
-        m_pZip->setCompression(KZip::DeflateCompression);
-        // We don't need the extra field in Calligra - so we leave it as "no extra field".
+        m_writer->setCompressionEnabled(true);
+        // We don't need the extra field in Calligra - the writer never writes one.
     } else {
         d->good = m_pZip->directory() != 0;
     }
@@ -127,23 +201,20 @@ void KoZipStore::init(const QByteArray& appIdentification)
 
 void KoZipStore::setCompressionEnabled(bool e)
 {
-    if (e) {
-        m_pZip->setCompression(KZip::DeflateCompression);
-    } else {
-        m_pZip->setCompression(KZip::NoCompression);        
-    }
+    if (m_writer)
+        m_writer->setCompressionEnabled(e);
 }
 
 bool KoZipStore::doFinalize()
 {
-    return m_pZip->close();
+    return m_writer ? m_writer->close() : m_pZip->close();
 }
 
 bool KoZipStore::openWrite(const QString& name)
 {
     Q_D(KoStore);
     d->stream = 0; // Don't use!
-    return m_pZip->prepareWriting(name, "", "" /*m_pZip->rootDir()->user(), m_pZip->rootDir()->group()*/, 0);
+    return m_writer->prepareWriting(name);
 }
 
 bool KoZipStore::openRead(const QString& name)
@@ -160,11 +231,35 @@ bool KoZipStore::openRead(const QString& name)
     // Must cast to KZipFileEntry, not only KArchiveFile, because device() isn't virtual!
     const KZipFileEntry * f = static_cast<const KZipFileEntry *>(entry);
     delete d->stream;
-    d->stream = f->createDevice();
+    d->stream = createEntryDevice(f);
     d->size = f->size();
     return true;
 }
 
+QIODevice *KoZipStore::createEntryDevice(const KZipFileEntry *entry) const
+{
+    // Deflated entries are inflated on demand by the device of KZip, which
+    // reads the archive as the entry is read.
+    if (entry->encoding() != 0 || entry->size() < s_minimumMappedSize)
+        return entry->createDevice();
+
+    // Stored entries are read in place.
+    QIODevice *archive = m_pZip->device();
+    if (QFile *file = qobject_cast<QFile *>(archive)) {
+        uchar *data = file->map(entry->position(), entry->size());
+        if (data)
+            return new MappedEntryDevice(file, data, entry->size());
+    } else if (QBuffer *buffer = qobject_cast<QBuffer *>(archive)) {
+        if (entry->position() + entry->size() <= buffer->data().size()) {
+            QBuffer *device = new QBuffer;
+            device->setData(QByteArray::fromRawData(buffer->data().constData() + entry->position(), entry->size()));
+            device->open(QIODevice::ReadOnly);
+            return device;
+        }
+    }
+    return entry->createDevice();
+}
+
 qint64 KoZipStore::write(const char* _data, qint64 _len)
 {
     Q_D(KoStore);
@@ -181,7 +276,7 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
     }
 
     d->size += _len;
-    if (m_pZip->writeData(_data, _len))     // writeData returns a bool!
+    if (m_writer->writeData(_data, _len))     // writeData returns a bool!
         return _len;
     return 0;
 }
@@ -189,6 +284,15 @@ qint64 KoZipStore::write(const char* _data, qint64 _len)
 QStringList KoZipStore::directoryList() const
 {
     QStringList retval;
+    if (m_writer) {
+        Q_D(const KoStore);
+        foreach (const QString &fileName, d->filesList) {
+            const int slash = fileName.indexOf(QLatin1Char('/'));
+            if (slash > 0 && !retval.contains(fileName.left(slash)))
+                retval << fileName.left(slash);
+        }
+        return retval;
+    }
     const KArchiveDirectory *directory = m_pZip->directory();
     foreach(const QString &name, directory->entries()) {
         const KArchiveEntry* fileArchiveEntry = m_pZip->directory()->entry(name);
@@ -203,7 +307,7 @@ bool KoZipStore::closeWrite()
 {
     Q_D(KoStore);
     debugStore << "Wrote file" << d->fileName << " into ZIP archive. size" << d->size;
-    return m_pZip->finishWriting(d->size);
+    return m_writer->finishWriting();
 }
 
 bool KoZipStore::enterRelativeDirectory(const QString& dirName)
@@ -226,6 +330,8 @@ bool KoZipStore::enterRelativeDirectory(const QString& dirName)
 
 bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 {
+    if (m_writer) // Write, no checking here
+        return true;
     if (path.isEmpty()) {
         m_currentDir = 0;
         return true;
@@ -237,6 +343,10 @@ bool KoZipStore::enterAbsoluteDirectory(const QString& path)
 
 bool KoZipStore::fileExists(const QString& absPath) const
 {
+    if (m_writer) {
+        Q_D(const KoStore);
+        return d->filesList.contains(absPath);
+    }
     const KArchiveEntry *entry = m_pZip->directory()->entry(absPath);
     return entry && entry->isFile();
 }
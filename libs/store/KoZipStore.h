@@ -23,6 +23,8 @@
 #include "KoStore.h"
 
 class KZip;
+class KZipFileEntry;
+class KoZipWriter;
 class KArchiveDirectory;
 class QUrl;
 
@@ -60,9 +62,16 @@ protected:
     virtual bool fileExists(const QString& absPath) const;
 
 private:
+    /**
+     * @return a device reading @p entry. Stored entries of local archives
+     * are memory mapped, entries of archives in memory are used in place.
+     */
+    QIODevice *createEntryDevice(const KZipFileEntry *entry) const;
 
-    /// The archive
+    /// The archive, in "Read" mode
     KZip * m_pZip;
+    /// The archive, in "Write" mode; it compresses the entries on a thread pool
+    KoZipWriter * m_writer;
 
     /** In "Read" mode this pointer is pointing to the
     current directory in the archive to speed up the verification process */
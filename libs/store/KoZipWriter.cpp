@@ -0,0 +1,425 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "KoZipWriter.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <StoreDebug.h>
+
+#include <zlib.h>
+#include <string.h>
+
+// The amount of data compressed at once.
+static const int s_blockSize = 1024 * 1024;
+// Each block is primed with the end of the previous one, the window of deflate.
+static const int s_dictionarySize = 32 * 1024;
+// The general purpose flags of all entries: the names are UTF-8.
+static const quint16 s_flags = 0x0800;
+
+namespace {
+
+struct Entry {
+    QByteArray name;
+    bool deflated;
+    quint16 time;
+    quint16 date;
+    quint32 crc;
+    qint64 compressedSize;
+    qint64 size;
+    qint64 offset;  // of the local header
+};
+
+/**
+ * A block of an entry. The checksum and the compressed data are computed
+ * on the thread pool.
+ */
+class Block : public QRunnable
+{
+public:
+    Block(int entry, const QByteArray &input, const QByteArray &dictionary,
+          bool deflate, bool first, bool last, QMutex *mutex, QWaitCondition *finished)
+        : entry(entry), input(input), dictionary(dictionary)
+        , deflate(deflate), first(first), last(last), crc(0), failed(false), done(false)
+        , m_mutex(mutex), m_finished(finished)
+    {
+        setAutoDelete(false);
+    }
+
+    virtual void run();
+
+    int entry;
+    QByteArray input;
+    QByteArray dictionary;
+    QByteArray output;
+    bool deflate;
+    bool first;
+    bool last;
+    quint32 crc;
+    bool failed;
+    bool done;  // guarded by the mutex
+
+private:
+    QMutex *m_mutex;
+    QWaitCondition *m_finished;
+};
+
+void Block::run()
+{
+    crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(input.constData()), input.size());
+
+    if (deflate) {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            failed = true;
+        } else {
+            if (!dictionary.isEmpty())
+                deflateSetDictionary(&stream, reinterpret_cast<const Bytef *>(dictionary.constData()), dictionary.size());
+            stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.constData()));
+            stream.avail_in = input.size();
+            output.resize(deflateBound(&stream, input.size()) + 16);
+            // A block ending an entry finishes the stream, the others are
+            // flushed to a byte boundary, so that the compressed blocks of
+            // an entry can just be concatenated.
+            const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+            forever {
+                if (stream.total_out == uLong(output.size()))
+                    output.resize(output.size() * 2);
+                stream.next_out = reinterpret_cast<Bytef *>(output.data()) + stream.total_out;
+                stream.avail_out = output.size() - stream.total_out;
+                const int result = ::deflate(&stream, flush);
+                if (result == Z_STREAM_ERROR) {
+                    failed = true;
+                    break;
+                }
+                if (last ? result == Z_STREAM_END : stream.avail_out != 0)
+                    break;
+            }
+            output.resize(stream.total_out);
+            deflateEnd(&stream);
+        }
+        dictionary.clear();
+    }
+
+    QMutexLocker locker(m_mutex);
+    done = true;
+    m_finished->wakeAll();
+}
+
+void appendShort(QByteArray &data, quint16 value)
+{
+    data.append(char(value & 0xff));
+    data.append(char(value >> 8));
+}
+
+void appendLong(QByteArray &data, quint32 value)
+{
+    appendShort(data, value & 0xffff);
+    appendShort(data, value >> 16);
+}
+
+} // namespace
+
+
+class Q_DECL_HIDDEN KoZipWriter::Private
+{
+public:
+    Private() : device(0), ownsDevice(false), compression(true), good(true), current(-1), first(false) {}
+
+    /// Queues the buffered data of the current entry for compression
+    void submit(bool last);
+    /// Writes the compressed blocks in order, until at most @p pending are left
+    void writeBlocks(int pending);
+    void writeBlock(Block *block);
+    void write(const QByteArray &data);
+
+    QIODevice *device;
+    bool ownsDevice;
+    bool compression;
+    bool good;
+
+    QThreadPool pool;
+    QMutex mutex;
+    QWaitCondition finished;
+    QQueue<Block *> blocks;     // in the order of the archive
+    QVector<Entry> entries;
+
+    int current;                // the entry being written
+    bool first;                 // no block of it submitted yet
+    QByteArray buffer;
+    QByteArray dictionary;
+};
+
+void KoZipWriter::Private::submit(bool last)
+{
+    const bool deflate = entries[current].deflated;
+    Block *block = new Block(current, buffer, dictionary, deflate, first, last, &mutex, &finished);
+    if (deflate && !last)
+        dictionary = buffer.right(s_dictionarySize);
+    buffer.clear();
+    first = false;
+
+    blocks.enqueue(block);
+    pool.start(block);
+    // keep the memory bounded, if the pool falls behind
+    writeBlocks(2 * qMax(1, pool.maxThreadCount()));
+}
+
+void KoZipWriter::Private::writeBlocks(int pending)
+{
+    forever {
+        QMutexLocker locker(&mutex);
+        if (blocks.isEmpty())
+            return;
+        Block *block = blocks.head();
+        while (!block->done && blocks.count() > pending)
+            finished.wait(&mutex);
+        if (!block->done)
+            return;
+        blocks.dequeue();
+        locker.unlock();
+
+        writeBlock(block);
+        delete block;
+    }
+}
+
+void KoZipWriter::Private::writeBlock(Block *block)
+{
+    Entry &entry = entries[block->entry];
+    if (block->failed) {
+        errorStore << "Could not compress" << entry.name;
+        good = false;
+    }
+    // Deflating a single block, that did not get smaller, was in vain.
+    if (block->first && block->last && block->output.size() >= block->input.size())
+        entry.deflated = false;
+
+    const QByteArray &data = entry.deflated ? block->output : block->input;
+    entry.crc = block->first ? block->crc : quint32(crc32_combine(entry.crc, block->crc, block->input.size()));
+    entry.size += block->input.size();
+    entry.compressedSize += data.size();
+    if (entry.size > 0xffffffffLL || device->pos() + data.size() > 0xffffffffLL) {
+        errorStore << "The archive is too large for" << entry.name;
+        good = false;
+        return;
+    }
+
+    if (block->first) {
+        // The checksum and the sizes are patched, once the last block of
+        // a larger entry is written.
+        entry.offset = device->pos();
+        QByteArray header;
+        appendLong(header, 0x04034b50);
+        appendShort(header, 20);    // version needed to extract: 2.0
+        appendShort(header, s_flags);
+        appendShort(header, entry.deflated ? 8 : 0);
+        appendShort(header, entry.time);
+        appendShort(header, entry.date);
+        appendLong(header, entry.crc);
+        appendLong(header, entry.compressedSize);
+        appendLong(header, entry.size);
+        appendShort(header, entry.name.size());
+        appendShort(header, 0);     // no extra field
+        header.append(entry.name);
+        write(header);
+    }
+    write(data);
+
+    if (block->last && !block->first) {
+        const qint64 end = device->pos();
+        QByteArray sizes;
+        appendLong(sizes, entry.crc);
+        appendLong(sizes, entry.compressedSize);
+        appendLong(sizes, entry.size);
+        if (!device->seek(entry.offset + 14))
+            good = false;
+        write(sizes);
+        if (!device->seek(end))
+            good = false;
+    }
+}
+
+void KoZipWriter::Private::write(const QByteArray &data)
+{
+    if (device->write(data) != data.size()) {
+        errorStore << "Could not write the archive:" << device->errorString();
+        good = false;
+    }
+}
+
+
+KoZipWriter::KoZipWriter(const QString &fileName)
+    : d(new Private)
+{
+    d->device = new QSaveFile(fileName);
+    d->ownsDevice = true;
+}
+
+KoZipWriter::KoZipWriter(QIODevice *device)
+    : d(new Private)
+{
+    d->device = device;
+}
+
+KoZipWriter::~KoZipWriter()
+{
+    d->pool.waitForDone();
+    qDeleteAll(d->blocks);
+    // an uncommitted save file discards the archive
+    if (d->ownsDevice)
+        delete d->device;
+    delete d;
+}
+
+bool KoZipWriter::open()
+{
+    if (!d->ownsDevice && d->device->isOpen())
+        return d->device->isWritable();
+    if (!d->device->open(QIODevice::WriteOnly)) {
+        errorStore << "Could not open the archive:" << d->device->errorString();
+        return false;
+    }
+    return true;
+}
+
+void KoZipWriter::setCompressionEnabled(bool enabled)
+{
+    d->compression = enabled;
+}
+
+bool KoZipWriter::prepareWriting(const QString &name)
+{
+    if (d->current != -1) {
+        warnStore << "The entry" << d->entries[d->current].name << "is not finished";
+        return false;
+    }
+    if (d->entries.count() == 0xffff) {
+        errorStore << "Too many entries in the archive";
+        return false;
+    }
+
+    const QDateTime now = QDateTime::currentDateTime();
+    Entry entry;
+    entry.name = name.toUtf8();
+    entry.deflated = d->compression;
+    entry.time = (now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() >> 1);
+    entry.date = ((now.date().year() - 1980) << 9) | (now.date().month() << 5) | now.date().day();
+    entry.crc = 0;
+    entry.compressedSize = 0;
+    entry.size = 0;
+    entry.offset = 0;
+    d->entries.append(entry);
+
+    d->current = d->entries.count() - 1;
+    d->first = true;
+    d->dictionary.clear();
+    return d->good;
+}
+
+bool KoZipWriter::writeData(const char *data, qint64 size)
+{
+    if (d->current == -1)
+        return false;
+    while (size > 0) {
+        const int count = qMin<qint64>(size, s_blockSize - d->buffer.size());
+        d->buffer.append(data, count);
+        data += count;
+        size -= count;
+        if (d->buffer.size() == s_blockSize)
+            d->submit(false);
+    }
+    return d->good;
+}
+
+bool KoZipWriter::finishWriting()
+{
+    if (d->current == -1)
+        return false;
+    d->submit(true);
+    d->current = -1;
+    return d->good;
+}
+
+bool KoZipWriter::writeFile(const QString &name, const QByteArray &data)
+{
+    return prepareWriting(name) && writeData(data.constData(), data.size()) && finishWriting();
+}
+
+bool KoZipWriter::close()
+{
+    if (d->current != -1)
+        finishWriting();
+    d->pool.waitForDone();
+    d->writeBlocks(0);
+
+    const qint64 offset = d->device->pos();
+    QByteArray directory;
+    foreach (const Entry &entry, d->entries) {
+        appendLong(directory, 0x02014b50);
+        appendShort(directory, 0x0314);     // made by: unix, 2.0
+        appendShort(directory, 20);         // version needed to extract: 2.0
+        appendShort(directory, s_flags);
+        appendShort(directory, entry.deflated ? 8 : 0);
+        appendShort(directory, entry.time);
+        appendShort(directory, entry.date);
+        appendLong(directory, entry.crc);
+        appendLong(directory, entry.compressedSize);
+        appendLong(directory, entry.size);
+        appendShort(directory, entry.name.size());
+        appendShort(directory, 0);          // extra field
+        appendShort(directory, 0);          // comment
+        appendShort(directory, 0);          // disk number
+        appendShort(directory, 0);          // internal attributes
+        appendLong(directory, quint32(0100644) << 16);   // regular file, rw-r--r--
+        appendLong(directory, entry.offset);
+        directory.append(entry.name);
+    }
+    const qint64 size = directory.size();
+    appendLong(directory, 0x06054b50);
+    appendShort(directory, 0);              // disk number
+    appendShort(directory, 0);              // disk of the central directory
+    appendShort(directory, d->entries.count());
+    appendShort(directory, d->entries.count());
+    appendLong(directory, size);
+    appendLong(directory, offset);
+    appendShort(directory, 0);              // comment
+    d->write(directory);
+
+    if (d->ownsDevice) {
+        QSaveFile *file = static_cast<QSaveFile *>(d->device);
+        if (!d->good)
+            file->cancelWriting();
+        if (!file->commit())
+            d->good = false;
+    } else {
+        d->device->close();
+    }
+    return d->good;
+}
@@ -0,0 +1,98 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef KOZIPWRITER_H
+#define KOZIPWRITER_H
+
+#include <QtGlobal>
+
+class QByteArray;
+class QIODevice;
+class QString;
+
+/**
+ * Writes a zip archive, deflating the entries on a thread pool.
+ *
+ * The data of each entry is cut into blocks, which are compressed
+ * independently of each other, while the caller goes on producing the
+ * next entries. The compressed blocks are appended to the archive in the
+ * order they were written, so the layout of the archive is the same as if
+ * it was written sequentially; in particular an entry written first stays
+ * the first one in the archive.
+ *
+ * Entries consisting of a single block are stored instead of deflated, if
+ * deflating does not make them smaller, e.g. for PNG or JPEG pictures.
+ *
+ * The device must be seekable. Archives larger than 4 GB are not supported.
+ */
+class KoZipWriter
+{
+public:
+    /// Writes to the file @p fileName, which is replaced on close()
+    explicit KoZipWriter(const QString &fileName);
+    /// Writes to @p device, which is not owned
+    explicit KoZipWriter(QIODevice *device);
+    ~KoZipWriter();
+
+    /**
+     * Opens the device for writing.
+     */
+    bool open();
+
+    /**
+     * Sets whether the following entries are deflated; by default they are.
+     */
+    void setCompressionEnabled(bool enabled);
+
+    /**
+     * Starts writing the entry @p name.
+     */
+    bool prepareWriting(const QString &name);
+
+    /**
+     * Appends @p size bytes of @p data to the current entry.
+     */
+    bool writeData(const char *data, qint64 size);
+
+    /**
+     * Finishes the current entry. The entry is written to the archive
+     * later, once it is compressed.
+     */
+    bool finishWriting();
+
+    /**
+     * Writes an entry with the contents @p data.
+     */
+    bool writeFile(const QString &name, const QByteArray &data);
+
+    /**
+     * Waits for the pending entries, writes the central directory and
+     * closes the device.
+     * @return false, if any entry could not be written
+     */
+    bool close();
+
+private:
+    Q_DISABLE_COPY(KoZipWriter)
+
+    class Private;
+    Private * const d;
+};
+
+#endif
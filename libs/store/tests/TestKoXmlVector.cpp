@@ -95,6 +95,8 @@ void TestKoXmlVector::writeAndRead_data()
     for(unsigned int i = 0; i < writeAndReadUncompressedCount*3+1; ++i) {
         QTest::newRow(QByteArray::number(i)) << i;
     }
+    // more blocks than are compressed at once
+    QTest::newRow("1000") << 1000u;
 }
 
 
@@ -100,6 +100,9 @@ void KoTextRange::setPositionOnlyMode(bool b)
 {
     Q_D(KoTextRange);
     d->positionOnlyMode = b;
+    if (d->manager) {
+        d->manager->invalidatePositionIndexes();
+    }
 }
 
 bool KoTextRange::hasRange() const
@@ -125,6 +128,9 @@ void KoTextRange::setRangeStart(int position)
     Q_D(KoTextRange);
     d->positionOnlyMode = true;
     d->cursor.setPosition(position);
+    if (d->manager) {
+        d->manager->invalidatePositionIndexes();
+    }
 }
 
 void KoTextRange::setRangeEnd(int position)
@@ -133,6 +139,9 @@ void KoTextRange::setRangeEnd(int position)
     d->positionOnlyMode = false;
     d->cursor.setPosition(d->cursor.selectionStart());
     d->cursor.setPosition(position, QTextCursor::KeepAnchor);
+    if (d->manager) {
+        d->manager->invalidatePositionIndexes();
+    }
 }
 
 QString KoTextRange::text() const
@@ -24,6 +24,30 @@
 
 #include "TextDebug.h"
 
+#include <QTextDocument>
+#include <QVector>
+#include <QPair>
+
+#include <algorithm>
+
+typedef QPair<int, KoTextRange *> PositionEntry;
+
+class Q_DECL_HIDDEN KoTextRangeManager::PositionIndex
+{
+public:
+    PositionIndex()
+        : valid(false)
+        , characterCount(0)
+    {
+    }
+
+    QVector<PositionEntry> starts; // all text ranges sorted by their start
+    QVector<PositionEntry> ends; // the text ranges with a range sorted by their end
+    bool valid;
+    // the text ranges move with the text, so a changed size also means the index is outdated
+    int characterCount;
+};
+
 KoTextRangeManager::KoTextRangeManager(QObject *parent)
     : QObject(parent)
 {
@@ -31,6 +55,7 @@ KoTextRangeManager::KoTextRangeManager(QObject *parent)
 
 KoTextRangeManager::~KoTextRangeManager()
 {
+    qDeleteAll(m_positionIndexes);
 }
 
 void KoTextRangeManager::insert(KoTextRange *textRange)
@@ -62,6 +87,7 @@ void KoTextRangeManager::insert(KoTextRange *textRange)
         }
     }
     m_textRanges.insert(textRange);
+    invalidatePositionIndexes();
 }
 
 void KoTextRangeManager::remove(KoTextRange *textRange)
@@ -84,6 +110,7 @@ void KoTextRangeManager::remove(KoTextRange *textRange)
     m_textRanges.remove(textRange);
     m_deletedTextRanges.insert(textRange);
     textRange->snapshot();
+    invalidatePositionIndexes();
 }
 
 const KoBookmarkManager *KoTextRangeManager::bookmarkManager() const
@@ -102,40 +129,111 @@ QList<KoTextRange *> KoTextRangeManager::textRanges() const
 }
 
 
-QHash<int, KoTextRange *> KoTextRangeManager::textRangesChangingWithin(const QTextDocument *doc, int first, int last, int matchFirst, int matchLast) const
+void KoTextRangeManager::invalidatePositionIndexes()
 {
-    QHash<int, KoTextRange *> ranges;
+    foreach (PositionIndex *index, m_positionIndexes) {
+        index->valid = false;
+    }
+}
+
+void KoTextRangeManager::invalidatePositionIndex()
+{
+    PositionIndex *index = m_positionIndexes.value(qobject_cast<QTextDocument *>(sender()));
+    if (index) {
+        index->valid = false;
+    }
+}
+
+void KoTextRangeManager::removePositionIndex(QObject *document)
+{
+    // the document is being destroyed, so it is no QTextDocument anymore
+    delete m_positionIndexes.take(static_cast<QTextDocument *>(document));
+}
+
+const KoTextRangeManager::PositionIndex *KoTextRangeManager::positionIndex(const QTextDocument *document) const
+{
+    PositionIndex *index = m_positionIndexes.value(document);
+    if (!index) {
+        index = new PositionIndex;
+        m_positionIndexes.insert(document, index);
+        connect(document, SIGNAL(contentsChange(int,int,int)), this, SLOT(invalidatePositionIndex()));
+        connect(document, SIGNAL(destroyed(QObject*)), this, SLOT(removePositionIndex(QObject*)));
+    } else if (index->valid && index->characterCount == document->characterCount()) {
+        return index;
+    }
+
+    index->starts.clear();
+    index->ends.clear();
     foreach (KoTextRange *range, m_textRanges) {
-        if (range->document() != doc) {
+        if (range->document() != document) {
             continue;
         }
-        if (!range->hasRange()) {
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                ranges.insertMulti(range->rangeStart(), range);
-            }
-        } else {
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                if (matchLast == -1 || range->rangeEnd() <= matchLast) {
-                    if (range->rangeEnd() >= matchFirst) {
-                        ranges.insertMulti(range->rangeStart(), range);
-                    }
+        index->starts.append(PositionEntry(range->rangeStart(), range));
+        if (range->hasRange()) {
+            index->ends.append(PositionEntry(range->rangeEnd(), range));
+        }
+    }
+    std::sort(index->starts.begin(), index->starts.end());
+    std::sort(index->ends.begin(), index->ends.end());
+    index->valid = true;
+    index->characterCount = document->characterCount();
+    return index;
+}
+
+static void addRangeChangingWithin(QHash<int, KoTextRange *> &ranges, KoTextRange *range, int first, int last, int matchFirst, int matchLast)
+{
+    if (!range->hasRange()) {
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            ranges.insertMulti(range->rangeStart(), range);
+        }
+    } else {
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            if (matchLast == -1 || range->rangeEnd() <= matchLast) {
+                if (range->rangeEnd() >= matchFirst) {
+                    ranges.insertMulti(range->rangeStart(), range);
                 }
             }
-            if (range->rangeEnd() >= first && range->rangeEnd() <= last) {
-                if (matchLast == -1 || range->rangeStart() <= matchLast) {
-                    if (range->rangeStart() >= matchFirst) {
-                        ranges.insertMulti(range->rangeEnd(), range);
-                    }
+        }
+        if (range->rangeEnd() >= first && range->rangeEnd() <= last) {
+            if (matchLast == -1 || range->rangeStart() <= matchLast) {
+                if (range->rangeStart() >= matchFirst) {
+                    ranges.insertMulti(range->rangeEnd(), range);
                 }
             }
-            if (range->rangeStart() >= first && range->rangeStart() <= last) {
-                if (matchLast == -1 || range->rangeEnd() >= matchLast) {
-                    if (range->rangeEnd() >= matchFirst) {
-                        ranges.insert(range->rangeStart(), range);
-                    }
+        }
+        if (range->rangeStart() >= first && range->rangeStart() <= last) {
+            if (matchLast == -1 || range->rangeEnd() >= matchLast) {
+                if (range->rangeEnd() >= matchFirst) {
+                    ranges.insert(range->rangeStart(), range);
                 }
             }
         }
     }
+}
+
+QHash<int, KoTextRange *> KoTextRangeManager::textRangesChangingWithin(const QTextDocument *doc, int first, int last, int matchFirst, int matchLast) const
+{
+    QHash<int, KoTextRange *> ranges;
+    if (!doc || first > last) {
+        return ranges;
+    }
+
+    const PositionIndex *index = positionIndex(doc);
+    const PositionEntry firstEntry(first, 0);
+
+    // the text ranges starting within first and last
+    QVector<PositionEntry>::const_iterator it = std::lower_bound(index->starts.constBegin(), index->starts.constEnd(), firstEntry);
+    for (; it != index->starts.constEnd() && it->first <= last; ++it) {
+        addRangeChangingWithin(ranges, it->second, first, last, matchFirst, matchLast);
+    }
+
+    // the text ranges only ending within first and last
+    it = std::lower_bound(index->ends.constBegin(), index->ends.constEnd(), firstEntry);
+    for (; it != index->ends.constEnd() && it->first <= last; ++it) {
+        const int start = it->second->rangeStart();
+        if (start < first || start > last) {
+            addRangeChangingWithin(ranges, it->second, first, last, matchFirst, matchLast);
+        }
+    }
     return ranges;
 }
@@ -30,6 +30,7 @@
 #include <QHash>
 #include <QSet>
 
+class QTextDocument;
 
 /**
  * A container to register all the text ranges with.
@@ -74,12 +75,30 @@ public:
      */
     QHash<int, KoTextRange *> textRangesChangingWithin(const QTextDocument *, int first, int last, int matchFirst, int matchLast) const;
 
+private Q_SLOTS:
+    void invalidatePositionIndex();
+    void removePositionIndex(QObject *document);
+
 private:
+    friend class KoTextRange;
+
+    class PositionIndex;
+
+    /**
+     * Return the text ranges of @p document sorted by their positions.
+     * The index is rebuilt if the positions changed since it was built.
+     */
+    const PositionIndex *positionIndex(const QTextDocument *document) const;
+    /// Marks the indexes of all documents as outdated
+    void invalidatePositionIndexes();
+
     QSet<KoTextRange *> m_textRanges;
     QSet<KoTextRange *> m_deletedTextRanges; // kept around for undo purposes
 
     KoBookmarkManager m_bookmarkManager;
     KoAnnotationManager m_annotationManager;
+
+    mutable QHash<const QTextDocument *, PositionIndex *> m_positionIndexes;
 };
 
 Q_DECLARE_METATYPE(KoTextRangeManager *)
@@ -0,0 +1,117 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "TestKoTextRangeManager.h"
+
+#include <QTest>
+#include <QTextDocument>
+#include <QTextCursor>
+
+#include <KoTextRangeManager.h>
+#include <KoBookmark.h>
+
+static KoBookmark *createBookmark(KoTextRangeManager &manager, QTextDocument &doc, const QString &name, int start, int end = -1)
+{
+    QTextCursor cursor(&doc);
+    cursor.setPosition(start);
+    if (end >= 0) {
+        cursor.setPosition(end, QTextCursor::KeepAnchor);
+    }
+    KoBookmark *bookmark = new KoBookmark(cursor);
+    bookmark->setName(name);
+    manager.insert(bookmark);
+    return bookmark;
+}
+
+void TestKoTextRangeManager::testTextRangesChangingWithin()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(100, 'x'));
+    QTextDocument otherDoc;
+    otherDoc.setPlainText(QString(100, 'x'));
+    KoTextRangeManager manager;
+
+    KoBookmark *point = createBookmark(manager, doc, "point", 5);
+    KoBookmark *first = createBookmark(manager, doc, "first", 10, 20);
+    KoBookmark *second = createBookmark(manager, doc, "second", 30, 60);
+    KoBookmark *other = createBookmark(manager, otherDoc, "other", 10, 20);
+
+    QHash<int, KoTextRange *> ranges = manager.textRangesChangingWithin(&doc, 0, 15, 0, -1);
+    QCOMPARE(ranges.count(), 2);
+    QCOMPARE(ranges.value(5), static_cast<KoTextRange *>(point));
+    QCOMPARE(ranges.value(10), static_cast<KoTextRange *>(first));
+
+    // ranges starting before the window are found by their end
+    ranges = manager.textRangesChangingWithin(&doc, 15, 35, 0, -1);
+    QCOMPARE(ranges.count(), 2);
+    QCOMPARE(ranges.value(20), static_cast<KoTextRange *>(first));
+    QCOMPARE(ranges.value(30), static_cast<KoTextRange *>(second));
+
+    // the opposite end has to be within matchFirst and matchLast
+    ranges = manager.textRangesChangingWithin(&doc, 50, 70, 40, 70);
+    QVERIFY(ranges.isEmpty());
+    ranges = manager.textRangesChangingWithin(&doc, 50, 70, 20, 70);
+    QCOMPARE(ranges.count(), 1);
+    QCOMPARE(ranges.value(60), static_cast<KoTextRange *>(second));
+
+    ranges = manager.textRangesChangingWithin(&otherDoc, 0, 100, 0, -1);
+    QCOMPARE(ranges.count(), 2);
+    QCOMPARE(ranges.values(), QList<KoTextRange *>() << other << other);
+
+    delete point;
+    delete first;
+    delete second;
+    delete other;
+}
+
+void TestKoTextRangeManager::testPositionChanges()
+{
+    QTextDocument doc;
+    doc.setPlainText(QString(100, 'x'));
+    KoTextRangeManager manager;
+
+    KoBookmark *point = createBookmark(manager, doc, "point", 5);
+    KoBookmark *range = createBookmark(manager, doc, "range", 10, 20);
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 0, 100, 0, -1).count(), 3);
+
+    // the text ranges move with the text
+    QTextCursor cursor(&doc);
+    cursor.insertText("abc");
+    QHash<int, KoTextRange *> ranges = manager.textRangesChangingWithin(&doc, 0, 9, 0, -1);
+    QCOMPARE(ranges.count(), 1);
+    QCOMPARE(ranges.value(8), static_cast<KoTextRange *>(point));
+    ranges = manager.textRangesChangingWithin(&doc, 20, 30, 0, -1);
+    QCOMPARE(ranges.count(), 1);
+    QCOMPARE(ranges.value(23), static_cast<KoTextRange *>(range));
+
+    point->setRangeStart(50);
+    ranges = manager.textRangesChangingWithin(&doc, 45, 55, 0, -1);
+    QCOMPARE(ranges.count(), 1);
+    QCOMPARE(ranges.value(50), static_cast<KoTextRange *>(point));
+
+    manager.remove(range);
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 0, 100, 0, -1).count(), 1);
+    manager.insert(range);
+    QCOMPARE(manager.textRangesChangingWithin(&doc, 0, 100, 0, -1).count(), 3);
+
+    delete point;
+    delete range;
+}
+
+QTEST_MAIN(TestKoTextRangeManager)
@@ -53,7 +53,12 @@
 #include <QTextBlock>
 #include <QTextTable>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QList>
+#include <QSet>
+#include <QVector>
+
+#include <algorithm>
 
 extern int qt_defaultDpiY();
 
@@ -87,6 +92,10 @@ public:
        , isLayouting(false)
        , layoutScheduled(false)
        , continuousLayout(true)
+       , layoutTimeSlice(0)
+       , synchronousRootAreaCount(1)
+       , timeSliced(false)
+       , layoutInterrupted(false)
        , layoutBlocked(false)
        , changesBlocked(false)
        , restartLayout(false)
@@ -133,13 +142,119 @@ public:
     bool isLayouting;
     bool layoutScheduled;
     bool continuousLayout;
+    int layoutTimeSlice;
+    int synchronousRootAreaCount;
+    bool timeSliced; // the current layout run may be interrupted
+    bool layoutInterrupted; // the last layout run used up its time slice
+    QElapsedTimer layoutTimer;
     bool layoutBlocked;
     bool changesBlocked;
     bool restartLayout;
     bool wordprocessingMode;
     bool showInlineObjectVisualization;
+
+    /// the index of each root area in rootAreaList
+    QHash<KoTextLayoutRootArea *, int> rootAreaIndexes;
+    /// the number of auto numbered foot notes in front of each root area in rootAreaList
+    QVector<int> footNoteCounts;
+    /// the root areas marked dirty since they were laid out the last time
+    QSet<KoTextLayoutRootArea *> dirtyRootAreas;
+
+    /**
+     * Puts @p rootArea at @p index of rootAreaList. If another root area is
+     * there, it and all following ones are removed first.
+     */
+    void setRootArea(int index, KoTextLayoutRootArea *rootArea, int footNoteCount);
+    void appendRootArea(KoTextLayoutRootArea *rootArea, int footNoteCount);
+    /// removes all root areas from @p index on
+    void truncateRootAreas(int index);
+    /// @return the index of @p rootArea in rootAreaList or -1
+    int indexOfRootArea(KoTextLayoutRootArea *rootArea) const;
+    /**
+     * @return the index of the first root area whose bounding rect ends at or below @p y,
+     * or the number of root areas if there is none
+     */
+    int firstRootAreaEndingBelow(qreal y) const;
+    /**
+     * @return the index of the root area the layout has to continue with; all root
+     * areas in front of it are laid out and not dirty
+     */
+    int firstRootAreaToLayout() const;
+    /// @return true if a root area after the one at @p index is dirty
+    bool hasDirtyRootAreaAfter(int index) const;
 };
 
+void KoTextDocumentLayout::Private::setRootArea(int index, KoTextLayoutRootArea *rootArea, int footNoteCount)
+{
+    if (index < rootAreaList.count() && rootAreaList[index] == rootArea) {
+        footNoteCounts[index] = footNoteCount;
+    } else {
+        truncateRootAreas(index);
+        appendRootArea(rootArea, footNoteCount);
+    }
+}
+
+void KoTextDocumentLayout::Private::appendRootArea(KoTextLayoutRootArea *rootArea, int footNoteCount)
+{
+    rootAreaIndexes.insert(rootArea, rootAreaList.count());
+    rootAreaList.append(rootArea);
+    footNoteCounts.append(footNoteCount);
+}
+
+void KoTextDocumentLayout::Private::truncateRootAreas(int index)
+{
+    while (rootAreaList.count() > index) {
+        KoTextLayoutRootArea *rootArea = rootAreaList.takeLast();
+        rootAreaIndexes.remove(rootArea);
+        dirtyRootAreas.remove(rootArea);
+    }
+    footNoteCounts.resize(rootAreaList.count());
+}
+
+int KoTextDocumentLayout::Private::indexOfRootArea(KoTextLayoutRootArea *rootArea) const
+{
+    return rootAreaIndexes.value(rootArea, -1);
+}
+
+static bool rootAreaEndsAbove(KoTextLayoutRootArea *rootArea, qreal y)
+{
+    return rootArea->boundingRect().bottom() < y;
+}
+
+int KoTextDocumentLayout::Private::firstRootAreaEndingBelow(qreal y) const
+{
+    // doLayout() places every root area below the previous one, so the root areas
+    // are sorted by their vertical position
+    return std::lower_bound(rootAreaList.constBegin(), rootAreaList.constEnd(), y, rootAreaEndsAbove)
+            - rootAreaList.constBegin();
+}
+
+int KoTextDocumentLayout::Private::firstRootAreaToLayout() const
+{
+    int first = rootAreaList.count();
+    foreach (KoTextLayoutRootArea *rootArea, dirtyRootAreas) {
+        const int index = indexOfRootArea(rootArea);
+        if (index >= 0) {
+            first = qMin(first, index);
+        }
+    }
+    // the layout continues where the previous root area ended
+    while (first > 0 && !rootAreaList[first - 1]->nextStartOfArea()) {
+        --first;
+    }
+    return first;
+}
+
+bool KoTextDocumentLayout::Private::hasDirtyRootAreaAfter(int index) const
+{
+    foreach (KoTextLayoutRootArea *rootArea, dirtyRootAreas) {
+        if (indexOfRootArea(rootArea) > index) {
+            return true;
+        }
+    }
+    return false;
+}
+
 
 // ------------------- KoTextDocumentLayout --------------------
 KoTextDocumentLayout::KoTextDocumentLayout(QTextDocument *doc, KoTextLayoutRootAreaProvider *provider)
@@ -324,7 +439,7 @@ void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int c
         } else {
             fromArea = d->rootAreaList.at(0);
         }
-        int startIndex = fromArea ? qMax(0, d->rootAreaList.indexOf(fromArea)) : 0;
+        int startIndex = fromArea ? qMax(0, d->indexOfRootArea(fromArea)) : 0;
         int endIndex = startIndex;
         if (charsRemoved != 0 || charsAdded != 0) {
             // If any characters got removed or added make sure to also catch other root-areas that may be
@@ -335,7 +450,7 @@ void KoTextDocumentLayout::documentChanged(int position, int charsRemoved, int c
             KoTextLayoutRootArea *toArea = fromArea ? rootAreaForPosition(position + qMax(charsRemoved, charsAdded) + 1) : 0;
             if (toArea) {
                 if (toArea != fromArea) {
-                    endIndex = qMax(startIndex, d->rootAreaList.indexOf(toArea));
+                    endIndex = qMax(startIndex, d->indexOfRootArea(toArea));
                 } else {
                     endIndex = startIndex;
                 }
@@ -371,16 +486,21 @@ KoTextLayoutRootArea *KoTextDocumentLayout::rootAreaForPosition(int position) co
     if (!line.isValid())
         return 0;
 
-    foreach (KoTextLayoutRootArea *rootArea, d->rootAreaList) {
+    QPointF pos = line.position();
+    qreal x = pos.x();
+    qreal y = pos.y();
+
+    // only the root areas from the first one ending below the line can contain it
+    for (int i = d->firstRootAreaEndingBelow(y); i < d->rootAreaList.count(); ++i) {
+        KoTextLayoutRootArea *rootArea = d->rootAreaList[i];
         QRectF rect = rootArea->boundingRect(); // should already be normalized()
+        //0.125 needed since Qt Scribe works with fixed point
+        if (y + line.height() + 0.125 < rect.y())
+            break;
         if (rect.width() <= 0.0 && rect.height() <= 0.0) // ignore the rootArea if it has a size of QSizeF(0,0)
             continue;
-        QPointF pos = line.position();
-        qreal x = pos.x();
-        qreal y = pos.y();
 
-        //0.125 needed since Qt Scribe works with fixed point
-        if (x + 0.125 >= rect.x() && x<= rect.right() && y + line.height() + 0.125 >= rect.y() && y <= rect.bottom()) {
+        if (x + 0.125 >= rect.x() && x<= rect.right()) {
             return rootArea;
         }
     }
@@ -389,7 +509,10 @@ KoTextLayoutRootArea *KoTextDocumentLayout::rootAreaForPosition(int position) co
 
 KoTextLayoutRootArea *KoTextDocumentLayout::rootAreaForPoint(const QPointF &point) const
 {
-    foreach(KoTextLayoutRootArea *rootArea, d->rootAreaList) {
+    for (int i = d->firstRootAreaEndingBelow(point.y()); i < d->rootAreaList.count(); ++i) {
+        KoTextLayoutRootArea *rootArea = d->rootAreaList[i];
+        if (rootArea->boundingRect().top() > point.y())
+            break;
         if (!rootArea->isDirty()) {
             if (rootArea->boundingRect().contains(point)) {
                 return rootArea;
@@ -695,6 +818,7 @@ void KoTextDocumentLayout::layout()
 
     Q_ASSERT(!d->isLayouting);
     d->isLayouting = true;
+    d->layoutTimer.start();
 
     bool finished;
     do {
@@ -709,6 +833,9 @@ void KoTextDocumentLayout::layout()
     if (finished) {
         // We are only finished with layouting if continuousLayout()==true.
         emit finishedLayout();
+    } else if (d->layoutInterrupted) {
+        emit layoutInterrupted();
+        scheduleLayout();
     }
 }
 
@@ -754,22 +881,40 @@ RootAreaConstraint constraintsForPosition(QTextFrame::iterator it, bool previous
 
 bool KoTextDocumentLayout::doLayout()
 {
-    delete d->layoutPosition;
-    d->layoutPosition = new FrameIterator(document()->rootFrame());
-    d->y = 0;
     d->layoutScheduled = false;
     d->restartLayout = false;
+    d->layoutInterrupted = false;
     FrameIterator *transferedFootNoteCursor = 0;
     KoInlineNote *transferedContinuedNote = 0;
     int footNoteAutoCount = 0;
     KoTextLayoutRootArea *rootArea = 0;
 
-    d->rootAreaList.clear();
+    // All root areas in front of the first dirty one are laid out already, so
+    // continue with the state the previous root area ended with.
+    int currentAreaNumber = d->firstRootAreaToLayout();
+    delete d->layoutPosition;
+    if (currentAreaNumber > 0) {
+        KoTextLayoutRootArea *previousArea = d->rootAreaList[currentAreaNumber - 1];
+        d->layoutPosition = new FrameIterator(previousArea->nextStartOfArea());
+        d->y = previousArea->bottom() + qreal(50);
+        transferedFootNoteCursor = previousArea->footNoteCursorToNext();
+        transferedContinuedNote = previousArea->continuedNoteToNext();
+        footNoteAutoCount = d->footNoteCounts[currentAreaNumber - 1] + previousArea->footNoteAutoCount();
+        if (!transferedFootNoteCursor && d->layoutPosition->it == document()->rootFrame()->end()) {
+            d->provider->releaseAllAfter(previousArea);
+            d->truncateRootAreas(currentAreaNumber);
+            return true; // Finished layouting
+        }
+    } else {
+        d->layoutPosition = new FrameIterator(document()->rootFrame());
+        d->y = 0;
+    }
 
-    int currentAreaNumber = 0;
     do {
         if (d->restartLayout) {
-            return false; // Abort layouting to restart from the beginning.
+            // Only the root areas laid out so far are known to be up to date
+            d->truncateRootAreas(currentAreaNumber);
+            return false; // Abort layouting to restart from the first dirty root area.
         }
 
         // Build our request for our rootArea provider
@@ -780,10 +925,11 @@ bool KoTextDocumentLayout::doLayout()
         rootArea = d->provider->provide(this, constraints, currentAreaNumber, &newRootArea);
         if (!rootArea) {
             // Out of space ? Nothing more to do
+            d->truncateRootAreas(currentAreaNumber);
             break;
         }
 
-        d->rootAreaList.append(rootArea);
+        d->setRootArea(currentAreaNumber, rootArea, footNoteAutoCount);
         bool shouldLayout = false;
 
         if (rootArea->top() != d->y) {
@@ -806,6 +952,7 @@ bool KoTextDocumentLayout::doLayout()
             rootArea->setReferenceRect(rect.left(), rect.right(), d->y + rect.top(), d->y + rect.bottom());
 
             beginAnchorCollecting(rootArea);
+            d->dirtyRootAreas.remove(rootArea);
 
             // Layout all that can fit into that root area
             bool finished;
@@ -845,20 +992,27 @@ bool KoTextDocumentLayout::doLayout()
             if (finished && !rootArea->footNoteCursorToNext()) {
                 d->provider->releaseAllAfter(rootArea);
                 // We must also delete them from our own list too
-                int newsize = d->rootAreaList.indexOf(rootArea) + 1;
-                while (d->rootAreaList.size() > newsize) {
-                    d->rootAreaList.removeLast();
-                }
+                d->truncateRootAreas(d->indexOfRootArea(rootArea) + 1);
                 return true; // Finished layouting
             }
 
             if (d->layoutPosition->it == document()->rootFrame()->end()) {
+                d->truncateRootAreas(currentAreaNumber + 1);
                 return true; // Finished layouting
             }
 
             if (!continuousLayout()) {
+                d->truncateRootAreas(currentAreaNumber + 1);
                 return false; // Let's take a break. We are not finished layouting yet.
             }
+
+            if (d->timeSliced && d->layoutTimeSlice > 0
+                    && currentAreaNumber + 1 >= d->synchronousRootAreaCount
+                    && d->layoutTimer.hasExpired(d->layoutTimeSlice)) {
+                d->truncateRootAreas(currentAreaNumber + 1);
+                d->layoutInterrupted = true;
+                return false; // Continue with the next root area in another run.
+            }
         } else {
             // Drop following rootAreas
             delete d->layoutPosition;
@@ -866,10 +1020,17 @@ bool KoTextDocumentLayout::doLayout()
             if (d->layoutPosition->it == document()->rootFrame()->end() && !rootArea->footNoteCursorToNext()) {
                 d->provider->releaseAllAfter(rootArea);
                 // We must also delete them from our own list too
-                int newsize = d->rootAreaList.indexOf(rootArea) + 1;
-                while (d->rootAreaList.size() > newsize) {
-                    d->rootAreaList.removeLast();
-                }
+                d->truncateRootAreas(d->indexOfRootArea(rootArea) + 1);
+                return true; // Finished layouting
+            }
+
+            // The following root areas continued this one before, which is unchanged.
+            // If none of them is dirty and the foot notes are numbered as before, the
+            // following root areas are unchanged too.
+            const int nextAreaNumber = currentAreaNumber + 1;
+            if (nextAreaNumber < d->rootAreaList.count()
+                    && d->footNoteCounts[nextAreaNumber] == footNoteAutoCount + rootArea->footNoteAutoCount()
+                    && !d->hasDirtyRootAreaAfter(currentAreaNumber)) {
                 return true; // Finished layouting
             }
         }
@@ -882,6 +1043,7 @@ bool KoTextDocumentLayout::doLayout()
         currentAreaNumber++;
     } while (transferedFootNoteCursor || d->layoutPosition->it != document()->rootFrame()->end());
 
+    d->truncateRootAreas(currentAreaNumber);
     return true; // Finished layouting
 }
 
@@ -907,7 +1069,9 @@ void KoTextDocumentLayout::executeScheduledLayout()
         // root-areas that got dirty and are before the currently processed root-area.
         d->restartLayout = true;
     } else {
+        d->timeSliced = true;
         layout();
+        d->timeSliced = false;
     }
 }
 
@@ -921,6 +1085,17 @@ void KoTextDocumentLayout::setContinuousLayout(bool continuous)
     d->continuousLayout = continuous;
 }
 
+void KoTextDocumentLayout::setLayoutTimeSlice(int msecs, int synchronousRootAreaCount)
+{
+    d->layoutTimeSlice = msecs;
+    d->synchronousRootAreaCount = synchronousRootAreaCount;
+}
+
+int KoTextDocumentLayout::layoutTimeSlice() const
+{
+    return d->layoutTimeSlice;
+}
+
 void KoTextDocumentLayout::setBlockLayout(bool block)
 {
     d->layoutBlocked = block;
@@ -1000,9 +1175,13 @@ QList<KoTextLayoutRootArea *> KoTextDocumentLayout::rootAreas() const
 
 void KoTextDocumentLayout::removeRootArea(KoTextLayoutRootArea *rootArea)
 {
-    int indexOf = rootArea ? qMax(0, d->rootAreaList.indexOf(rootArea)) : 0;
-    for(int i = d->rootAreaList.count() - 1; i >= indexOf; --i)
-        d->rootAreaList.removeAt(i);
+    int indexOf = rootArea ? qMax(0, d->indexOfRootArea(rootArea)) : 0;
+    d->truncateRootAreas(indexOf);
+}
+
+void KoTextDocumentLayout::setRootAreaDirty(KoTextLayoutRootArea *rootArea)
+{
+    d->dirtyRootAreas.insert(rootArea);
 }
 
 QList<KoShape*> KoTextDocumentLayout::shapes() const
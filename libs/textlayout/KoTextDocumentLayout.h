@@ -225,6 +225,13 @@ public:
      */
     void removeRootArea(KoTextLayoutRootArea *rootArea = 0);
 
+    /**
+     * Remembers that \p rootArea needs to be laid out again, so the next layout
+     * run can start at the first dirty root-area instead of the beginning of the
+     * document. Called by KoTextLayoutRootArea::setDirty().
+     */
+    void setRootAreaDirty(KoTextLayoutRootArea *rootArea);
+
     /// reimplemented from QAbstractTextDocumentLayout
     virtual void documentChanged(int position, int charsRemoved, int charsAdded);
 
@@ -239,6 +246,17 @@ public:
     /// Set should layout be continued when done with current root area
     void setContinuousLayout(bool continuous);
 
+    /**
+     * Lets scheduled layout runs interrupt themselves after @p msecs milliseconds
+     * and continue in another scheduled run, so the event loop is not blocked
+     * while a long document is laid out. The first @p synchronousRootAreaCount
+     * root areas are always laid out in one run, e.g. to show the first screenful
+     * at once. Direct calls of \a layout() are never interrupted.
+     * A time slice of 0, the default, disables the interruption.
+     */
+    void setLayoutTimeSlice(int msecs, int synchronousRootAreaCount = 1);
+    int layoutTimeSlice() const;
+
     /// Set \a layout() to be blocked (no layouting will happen)
     void setBlockLayout(bool block);
     bool layoutBlocked() const;
@@ -268,6 +286,13 @@ Q_SIGNALS:
      */
     void finishedLayout();
 
+    /**
+     * Signal is emitted every time a scheduled layout run used up its time slice
+     * before all text was positioned. The layout continues in another scheduled run.
+     * @see setLayoutTimeSlice
+     */
+    void layoutInterrupted();
+
     /**
      * Signal is emitted when emitLayoutIsDirty() is called which happens at
      * least when a root area is marked as dirty.
@@ -283,8 +308,9 @@ public Q_SLOTS:
      * This method will layout the text into sections, tables and textlines,
      * chunk by chunk.
      * It may interrupt itself, @see contiuousLayout
-     * calling this method when the layout is not dirty, doesn't take that much
-     * time as it doesn't do much, although it does check every root area
+     * The layout continues after the last root area in front of the first dirty one
+     * and stops as soon as the following root areas are known to be unchanged, so
+     * calling this method when the layout is not dirty doesn't take much time
      */
     virtual void layout();
 
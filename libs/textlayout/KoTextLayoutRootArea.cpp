@@ -111,6 +111,7 @@ KoTextPage* KoTextLayoutRootArea::page() const
 void KoTextLayoutRootArea::setDirty()
 {
     d->dirty = true;
+    documentLayout()->setRootAreaDirty(this);
     documentLayout()->emitLayoutIsDirty();
 }
 
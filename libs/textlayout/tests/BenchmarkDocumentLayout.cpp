@@ -0,0 +1,122 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkDocumentLayout.h"
+#include "MockPagedRootAreaProvider.h"
+
+#include <KoTextDocument.h>
+#include <KoStyleManager.h>
+#include <KoInlineTextObjectManager.h>
+#include <KoParagraphStyle.h>
+#include <KoTextDocumentLayout.h>
+#include <KoTextLayoutRootArea.h>
+
+#include <QTest>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+// about forty lines fit on a page, so this gives around a thousand pages
+static const int ParagraphCount = 20000;
+
+void BenchmarkDocumentLayout::initTestCase()
+{
+    m_doc = new QTextDocument;
+    m_provider = new MockPagedRootAreaProvider();
+    KoTextDocument(m_doc).setInlineTextObjectManager(new KoInlineTextObjectManager);
+    m_doc->setDefaultFont(QFont("Sans Serif", 12, QFont::Normal, false));
+    m_styleManager = new KoStyleManager(0);
+    KoTextDocument(m_doc).setStyleManager(m_styleManager);
+
+    m_layout = new KoTextDocumentLayout(m_doc, m_provider);
+    m_doc->setDocumentLayout(m_layout);
+
+    QTextCursor cursor(m_doc);
+    for (int i = 0; i < ParagraphCount; ++i) {
+        if (i > 0)
+            cursor.insertBlock();
+        cursor.insertText(QString("Paragraph %1 of a long document, which takes about two lines on a page.").arg(i));
+    }
+    KoParagraphStyle style;
+    style.setStyleId(101); // needed to do manually since we don't use the stylemanager
+    for (QTextBlock block = m_doc->begin(); block.isValid(); block = block.next()) {
+        style.applyStyle(block);
+    }
+
+    m_layout->layout();
+    QVERIFY(m_layout->rootAreas().count() > 500);
+    QCOMPARE(m_layout->rootAreas().count(), m_provider->m_areas.count());
+}
+
+void BenchmarkDocumentLayout::cleanupTestCase()
+{
+    delete m_provider;
+    delete m_doc;
+    delete m_styleManager;
+}
+
+void BenchmarkDocumentLayout::testRootAreaForPosition()
+{
+    const QList<KoTextLayoutRootArea *> rootAreas = m_layout->rootAreas();
+    const int lastPosition = m_doc->characterCount() - 1;
+    // the root areas are found in the order of the document
+    int previousIndex = 0;
+    for (int position = 0; position < lastPosition; position += lastPosition / 100) {
+        const int index = rootAreas.indexOf(m_layout->rootAreaForPosition(position));
+        QVERIFY(index >= previousIndex);
+        previousIndex = index;
+    }
+    QCOMPARE(m_layout->rootAreaForPosition(lastPosition - 1), rootAreas.last());
+
+    QBENCHMARK {
+        for (int position = 0; position < lastPosition; position += lastPosition / 1000) {
+            m_layout->rootAreaForPosition(position);
+        }
+    }
+}
+
+void BenchmarkDocumentLayout::testRootAreaForPoint()
+{
+    const QList<KoTextLayoutRootArea *> rootAreas = m_layout->rootAreas();
+    foreach (KoTextLayoutRootArea *rootArea, rootAreas) {
+        QCOMPARE(m_layout->rootAreaForPoint(rootArea->boundingRect().center()), rootArea);
+    }
+
+    QBENCHMARK {
+        foreach (KoTextLayoutRootArea *rootArea, rootAreas) {
+            m_layout->rootAreaForPoint(rootArea->boundingRect().center());
+        }
+    }
+}
+
+void BenchmarkDocumentLayout::testTyping()
+{
+    // type at the end of the document, where every lookup had to pass all pages
+    QTextCursor cursor(m_doc);
+    cursor.movePosition(QTextCursor::End);
+    cursor.movePosition(QTextCursor::StartOfBlock);
+
+    QBENCHMARK {
+        cursor.insertText("x");
+        m_layout->layout();
+        QVERIFY(m_layout->rootAreaForPosition(cursor.position()));
+    }
+}
+
+QTEST_MAIN(BenchmarkDocumentLayout)
@@ -0,0 +1,52 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef BENCHMARKDOCUMENTLAYOUT_H
+#define BENCHMARKDOCUMENTLAYOUT_H
+
+#include <QObject>
+
+class QTextDocument;
+class KoTextDocumentLayout;
+class KoStyleManager;
+class MockPagedRootAreaProvider;
+
+/**
+ * Measures the lookup of root areas and typing in a long document
+ * of about a thousand pages.
+ */
+class BenchmarkDocumentLayout : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testRootAreaForPosition();
+    void testRootAreaForPoint();
+    void testTyping();
+
+private:
+    QTextDocument *m_doc;
+    KoTextDocumentLayout *m_layout;
+    MockPagedRootAreaProvider *m_provider;
+    KoStyleManager *m_styleManager;
+};
+
+#endif
@@ -0,0 +1,76 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "MockPagedRootAreaProvider.h"
+
+#include "KoTextLayoutRootArea.h"
+
+MockPagedRootAreaProvider::MockPagedRootAreaProvider(const QRectF &pageRect)
+    : m_pageRect(pageRect)
+    , m_laidOutCount(0)
+{
+}
+
+MockPagedRootAreaProvider::~MockPagedRootAreaProvider()
+{
+    qDeleteAll(m_areas);
+}
+
+KoTextLayoutRootArea *MockPagedRootAreaProvider::provide(KoTextDocumentLayout *documentLayout, const RootAreaConstraint &, int requestedPosition, bool *isNewRootArea)
+{
+    if (requestedPosition < m_areas.count()) {
+        *isNewRootArea = false;
+        return m_areas[requestedPosition];
+    }
+    KoTextLayoutRootArea *area = new KoTextLayoutRootArea(documentLayout);
+    m_areas.append(area);
+    *isNewRootArea = true;
+    return area;
+}
+
+void MockPagedRootAreaProvider::releaseAllAfter(KoTextLayoutRootArea *afterThis)
+{
+    const int count = m_areas.indexOf(afterThis) + 1;
+    while (m_areas.count() > count) {
+        delete m_areas.takeLast();
+    }
+}
+
+void MockPagedRootAreaProvider::doPostLayout(KoTextLayoutRootArea *rootArea, bool isNewRootArea)
+{
+    Q_UNUSED(rootArea);
+    Q_UNUSED(isNewRootArea);
+    ++m_laidOutCount;
+}
+
+QRectF MockPagedRootAreaProvider::suggestRect(KoTextLayoutRootArea *rootArea)
+{
+    Q_UNUSED(rootArea);
+    return m_pageRect;
+}
+
+QList<KoTextLayoutObstruction *> MockPagedRootAreaProvider::relevantObstructions(KoTextLayoutRootArea *rootArea)
+{
+    Q_UNUSED(rootArea);
+    return QList<KoTextLayoutObstruction *>();
+}
+
+void MockPagedRootAreaProvider::updateAll()
+{
+}
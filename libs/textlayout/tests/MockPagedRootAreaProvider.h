@@ -0,0 +1,52 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef MOCKPAGEDROOTAREAPROVIDER_H
+#define MOCKPAGEDROOTAREAPROVIDER_H
+
+#include "KoTextLayoutRootAreaProvider.h"
+
+#include <QList>
+#include <QRectF>
+
+/**
+ * Provides as many root areas of the same size as the layout asks for,
+ * like the pages of a word processor.
+ */
+class MockPagedRootAreaProvider : public KoTextLayoutRootAreaProvider
+{
+public:
+    explicit MockPagedRootAreaProvider(const QRectF &pageRect = QRectF(0, 0, 400, 600));
+    virtual ~MockPagedRootAreaProvider();
+
+    /// reimplemented
+    virtual KoTextLayoutRootArea *provide(KoTextDocumentLayout *documentLayout, const RootAreaConstraint &constraints, int requestedPosition, bool *isNewArea);
+    virtual void releaseAllAfter(KoTextLayoutRootArea *afterThis);
+    virtual void doPostLayout(KoTextLayoutRootArea *rootArea, bool isNewRootArea);
+    virtual QRectF suggestRect(KoTextLayoutRootArea *rootArea);
+    virtual QList<KoTextLayoutObstruction *> relevantObstructions(KoTextLayoutRootArea *rootArea);
+    virtual void updateAll();
+
+    QList<KoTextLayoutRootArea *> m_areas;
+    QRectF m_pageRect;
+    /// the number of root areas laid out, counted in doPostLayout()
+    int m_laidOutCount;
+};
+
+#endif
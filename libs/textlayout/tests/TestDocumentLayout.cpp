@@ -20,7 +20,9 @@
  */
 #include "TestDocumentLayout.h"
 #include "MockRootAreaProvider.h"
+#include "MockPagedRootAreaProvider.h"
 #include <QTest>
+#include <QSignalSpy>
 
 #include <TextLayoutDebug.h>
 
@@ -31,6 +33,7 @@
 #include <KoInlineTextObjectManager.h>
 #include <KoTextDocumentLayout.h>
 #include <KoTextLayoutRootArea.h>
+#include <FrameIterator.h>
 #include <KoShape.h>
 
 void TestDocumentLayout::initTestCase()
@@ -39,12 +42,14 @@ void TestDocumentLayout::initTestCase()
     m_layout = 0;
 }
 
-void TestDocumentLayout::setupTest(const QString &initText)
+void TestDocumentLayout::setupTest(const QString &initText, KoTextLayoutRootAreaProvider *provider)
 {
     m_doc = new QTextDocument;
     Q_ASSERT(m_doc);
 
-    MockRootAreaProvider *provider = new MockRootAreaProvider();
+    if (!provider) {
+        provider = new MockRootAreaProvider();
+    }
     Q_ASSERT(provider);
     KoTextDocument(m_doc).setInlineTextObjectManager(new KoInlineTextObjectManager);
 
@@ -191,4 +196,103 @@ void TestDocumentLayout::testRootAreaZeroWidthAndHeight()
     QCOMPARE(provider->m_area->referenceRect(), QRectF(10.,10.,0.,0.));
 }
 
+void TestDocumentLayout::testIncrementalLayout()
+{
+    QStringList paragraphs;
+    for (int i = 0; i < 200; ++i) {
+        paragraphs << QString("Paragraph %1 with enough words to wrap into a second line").arg(i);
+    }
+    MockPagedRootAreaProvider *provider = new MockPagedRootAreaProvider(QRectF(0, 0, 200, 200));
+    setupTest(paragraphs.join("\n"), provider);
+
+    m_layout->layout();
+    const QList<KoTextLayoutRootArea *> rootAreas = m_layout->rootAreas();
+    QVERIFY(rootAreas.count() > 20);
+    QCOMPARE(provider->m_laidOutCount, rootAreas.count());
+
+    // typing in the middle only relayouts the root-areas around the edit
+    provider->m_laidOutCount = 0;
+    KoTextLayoutRootArea *middleArea = rootAreas[rootAreas.count() / 2];
+    QTextCursor cursor(m_doc);
+    cursor.setPosition(middleArea->nextStartOfArea()->it.currentBlock().position());
+    cursor.insertText("x");
+    m_layout->layout();
+    QVERIFY(provider->m_laidOutCount > 0);
+    QVERIFY(provider->m_laidOutCount <= 4);
+    QCOMPARE(m_layout->rootAreas(), rootAreas);
+    QVERIFY(m_layout->rootAreaForPosition(cursor.position()));
+
+    // nothing to do without changes
+    provider->m_laidOutCount = 0;
+    m_layout->layout();
+    QCOMPARE(provider->m_laidOutCount, 0);
+
+    // removing paragraphs moves the text of all following root-areas
+    cursor.setPosition(rootAreas[2]->nextStartOfArea()->it.currentBlock().position());
+    cursor.movePosition(QTextCursor::NextBlock, QTextCursor::KeepAnchor, 10);
+    cursor.removeSelectedText();
+    m_layout->layout();
+    QVERIFY(m_layout->rootAreas().count() < rootAreas.count());
+
+    // the result is the same as laying out everything again
+    QList<QRectF> boundingRects;
+    foreach (KoTextLayoutRootArea *rootArea, m_layout->rootAreas()) {
+        QVERIFY(!rootArea->isDirty());
+        boundingRects.append(rootArea->boundingRect());
+        rootArea->setDirty();
+    }
+    provider->m_laidOutCount = 0;
+    m_layout->layout();
+    QCOMPARE(provider->m_laidOutCount, boundingRects.count());
+    QCOMPARE(m_layout->rootAreas().count(), boundingRects.count());
+    for (int i = 0; i < boundingRects.count(); ++i) {
+        QCOMPARE(m_layout->rootAreas()[i]->boundingRect(), boundingRects[i]);
+    }
+}
+
+void TestDocumentLayout::testTimeSlicedLayout()
+{
+    QStringList paragraphs;
+    for (int i = 0; i < 2000; ++i) {
+        paragraphs << QString("Paragraph %1 with enough words to wrap into a second line").arg(i);
+    }
+    MockPagedRootAreaProvider *provider = new MockPagedRootAreaProvider(QRectF(0, 0, 200, 200));
+    setupTest(paragraphs.join("\n"), provider);
+    m_layout->setLayoutTimeSlice(1, 3);
+    QCOMPARE(m_layout->layoutTimeSlice(), 1);
+
+    // direct calls are never interrupted
+    QSignalSpy finishedSpy(m_layout, SIGNAL(finishedLayout()));
+    m_layout->layout();
+    QCOMPARE(finishedSpy.count(), 1);
+    QList<QRectF> boundingRects;
+    foreach (KoTextLayoutRootArea *rootArea, m_layout->rootAreas()) {
+        boundingRects.append(rootArea->boundingRect());
+        rootArea->setDirty();
+    }
+    QVERIFY(boundingRects.count() > 100);
+
+    // a scheduled layout is interrupted after its time slice...
+    finishedSpy.clear();
+    provider->m_laidOutCount = 0;
+    QSignalSpy interruptedSpy(m_layout, SIGNAL(layoutInterrupted()));
+    m_layout->scheduleLayout();
+    QVERIFY(interruptedSpy.wait());
+    QCOMPARE(interruptedSpy.count(), 1);
+    QCOMPARE(finishedSpy.count(), 0);
+    QVERIFY(m_layout->rootAreas().count() >= 3);
+    QVERIFY(m_layout->rootAreas().count() < boundingRects.count());
+    QCOMPARE(provider->m_laidOutCount, m_layout->rootAreas().count());
+
+    // ...and continues in further runs until it is finished
+    QVERIFY(finishedSpy.wait());
+    QCOMPARE(finishedSpy.count(), 1);
+    QVERIFY(interruptedSpy.count() > 1);
+    QCOMPARE(provider->m_laidOutCount, boundingRects.count());
+    QCOMPARE(m_layout->rootAreas().count(), boundingRects.count());
+    for (int i = 0; i < boundingRects.count(); ++i) {
+        QCOMPARE(m_layout->rootAreas()[i]->boundingRect(), boundingRects[i]);
+    }
+}
+
 QTEST_MAIN(TestDocumentLayout)
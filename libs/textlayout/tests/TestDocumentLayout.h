@@ -27,6 +27,7 @@
 class QTextDocument;
 class KoTextDocumentLayout;
 class KoStyleManager;
+class KoTextLayoutRootAreaProvider;
 
 class TestDocumentLayout : public QObject
 {
@@ -57,8 +58,14 @@ private Q_SLOTS:
      */
     void testRootAreaZeroWidthAndHeight();
 
+    /**
+     * Test that an edit only relayouts the root-areas around it.
+     */
+    void testIncrementalLayout();
+    void testTimeSlicedLayout();
+
 private:
-    void setupTest(const QString &initText = QString());
+    void setupTest(const QString &initText = QString(), KoTextLayoutRootAreaProvider *provider = 0);
 
 private:
     QTextDocument *m_doc;
@@ -18,13 +18,14 @@
  */
 
 #include "ComponentTransferEffect.h"
-#include "ColorChannelConversion.h"
+#include "FilterEffectKernels.h"
 #include <KoFilterEffectRenderContext.h>
 #include <KoXmlWriter.h>
 #include <KoXmlReader.h>
 #include <klocalizedstring.h>
 #include <QRect>
 #include <QImage>
+#include <QVector>
 #include <math.h>
 
 ComponentTransferEffect::ComponentTransferEffect()
@@ -110,81 +111,46 @@ QImage ComponentTransferEffect::processImage(const QImage &image, const KoFilter
     QRgb *dst = (QRgb*)result.bits();
     int w = result.width();
 
-    qreal sa, sr, sg, sb;
-    qreal da, dr, dg, db;
-    int pixel;
-
-    const QRect roi = context.filterRegion().toRect();
-    const int minRow = roi.top();
-    const int maxRow = roi.bottom();
-    const int minCol = roi.left();
-    const int maxCol = roi.right();
-
-    for (int row = minRow; row <= maxRow; ++row) {
-        for (int col = minCol; col <= maxCol; ++col) {
-            pixel = row * w + col;
-            const QRgb &s = src[pixel];
-
-            sa = fromIntColor[qAlpha(s)];
-            sr = fromIntColor[qRed(s)];
-            sg = fromIntColor[qGreen(s)];
-            sb = fromIntColor[qBlue(s)];
-            // the matrix is applied to non-premultiplied color values
-            // so we have to convert colors by dividing by alpha value
-            if (sa > 0.0 && sa < 1.0) {
-                sr /= sa;
-                sb /= sa;
-                sg /= sa;
-            }
-
-            dr = transferChannel(ChannelR, sr);
-            dg = transferChannel(ChannelG, sg);
-            db = transferChannel(ChannelB, sb);
-            da = transferChannel(ChannelA, sa);
-
-            da *= 255.0;
-
-            // set pre-multiplied color values on destination image
-            dst[pixel] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
-                               static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+    FilterEffectKernels::TransferParameters channels[4];
+    QVector<qreal> tableValues[4];
+    for (int channel = ChannelR; channel <= ChannelA; ++channel) {
+        const Data &d = m_data[channel];
+        FilterEffectKernels::TransferParameters &c = channels[channel];
+        switch (d.function) {
+        case Identity:
+            c.function = FilterEffectKernels::TransferIdentity;
+            break;
+        case Table:
+            c.function = FilterEffectKernels::TransferTable;
+            break;
+        case Discrete:
+            c.function = FilterEffectKernels::TransferDiscrete;
+            break;
+        case Linear:
+            c.function = FilterEffectKernels::TransferLinear;
+            break;
+        case Gamma:
+            c.function = FilterEffectKernels::TransferGamma;
+            break;
         }
+        tableValues[channel] = d.tableValues.toVector();
+        c.tableValues = tableValues[channel].constData();
+        c.tableSize = tableValues[channel].count();
+        c.slope = d.slope;
+        c.intercept = d.intercept;
+        c.amplitude = d.amplitude;
+        c.exponent = d.exponent;
+        c.offset = d.offset;
     }
 
-    return result;
-}
-
-qreal ComponentTransferEffect::transferChannel(Channel channel, qreal value) const
-{
-    const Data &d = m_data[channel];
-
-    switch (d.function) {
-    case Identity:
-        return value;
-    case Table: {
-        qreal valueCount = d.tableValues.count() - 1;
-        if (valueCount < 0.0)
-            return value;
-        qreal k1 = static_cast<int>(value * valueCount);
-        qreal k2 = qMin(k1 + 1, valueCount);
-        qreal vk1 = d.tableValues[k1];
-        qreal vk2 = d.tableValues[k2];
-        return vk1 + (value - static_cast<qreal>(k1) / valueCount)*valueCount *(vk2 - vk1);
-    }
-    case Discrete: {
-        qreal valueCount = d.tableValues.count() - 1;
-        if (valueCount < 0.0)
-            return value;
-        return d.tableValues[static_cast<int>(value*valueCount)];
-    }
-    case Linear:
-        return d.slope * value + d.intercept;
-    case Gamma:
-        return d.amplitude * pow(value, d.exponent) + d.offset;
+    const FilterEffectKernels *kernels = FilterEffectKernels::instance();
+    const QRect roi = context.filterRegion().toRect();
+    for (int row = roi.top(); row <= roi.bottom(); ++row) {
+        const int pixel = row * w + roi.left();
+        kernels->componentTransfer(src + pixel, dst + pixel, roi.width(), channels);
     }
 
-    return value;
+    return result;
 }
 
 bool ComponentTransferEffect::load(const KoXmlElement &element, const KoFilterEffectLoadingContext &)
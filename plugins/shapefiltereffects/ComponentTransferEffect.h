@@ -103,9 +103,6 @@ private:
     /// saves channel transfer function to given xml writer
     void saveChannel(Channel channel, KoXmlWriter &writer);
 
-    /// transfers color channel
-    qreal transferChannel(Channel channel, qreal value) const;
-
     struct Data {
         Data()
                 : function(Identity), slope(1.0), intercept(0.0)
@@ -18,7 +18,7 @@
  */
 
 #include "CompositeEffect.h"
-#include "ColorChannelConversion.h"
+#include "FilterEffectKernels.h"
 #include <KoFilterEffectRenderContext.h>
 #include <KoViewConverter.h>
 #include <KoXmlWriter.h>
@@ -78,42 +78,13 @@ QImage CompositeEffect::processImages(const QVector<QImage> &images, const KoFil
         QRgb *dst = (QRgb*)result.bits();
         int w = result.width();
 
-        qreal sa, sr, sg, sb;
-        qreal da, dr, dg, db;
-        int pixel = 0;
-
         // TODO: do we have to calculate with non-premuliplied colors here ???
 
+        const FilterEffectKernels *kernels = FilterEffectKernels::instance();
         QRect roi = context.filterRegion().toRect();
         for (int row = roi.top(); row < roi.bottom(); ++row) {
-            for (int col = roi.left(); col < roi.right(); ++col) {
-                pixel = row * w + col;
-                const QRgb &s = src[pixel];
-                QRgb &d = dst[pixel];
-
-                sa = fromIntColor[qAlpha(s)];
-                sr = fromIntColor[qRed(s)];
-                sg = fromIntColor[qGreen(s)];
-                sb = fromIntColor[qBlue(s)];
-
-                da = fromIntColor[qAlpha(d)];
-                dr = fromIntColor[qRed(d)];
-                dg = fromIntColor[qGreen(d)];
-                db = fromIntColor[qBlue(d)];
-
-                da = m_k[0] * sa * da + m_k[1] * da + m_k[2] * sa + m_k[3];
-                dr = m_k[0] * sr * dr + m_k[1] * dr + m_k[2] * sr + m_k[3];
-                dg = m_k[0] * sg * dg + m_k[1] * dg + m_k[2] * sg + m_k[3];
-                db = m_k[0] * sb * db + m_k[1] * db + m_k[2] * sb + m_k[3];
-
-                da *= 255.0;
-
-                // set pre-multiplied color values on destination image
-                d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
-                          static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
-                          static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
-                          static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
-            }
+            const int pixel = row * w + roi.left();
+            kernels->arithmeticComposite(src + pixel, dst + pixel, roi.right() - roi.left(), m_k);
         }
     } else {
         QPainter painter(&result);
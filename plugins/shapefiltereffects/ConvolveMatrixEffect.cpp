@@ -23,6 +23,7 @@
 #include "KoViewConverter.h"
 #include "KoXmlWriter.h"
 #include "KoXmlReader.h"
+#include "FilterEffectKernels.h"
 #include <klocalizedstring.h>
 #include <QRect>
 #include <QVector>
@@ -139,17 +140,6 @@ QImage ConvolveMatrixEffect::processImage(const QImage &image, const KoFilterEff
     const int w = result.width();
     const int h = result.height();
 
-    // setup mask
-    const int maskSize = rx*ry;
-    QVector<QPoint> offset(maskSize);
-    int index = 0;
-    for (int y = 0; y < ry; ++y) {
-        for (int x = 0; x < rx; ++x) {
-            offset[index] = QPoint(x-tx, y-ty);
-            index++;
-        }
-    }
-
     qreal divisor = m_divisor;
     // if no divisor given, it is the sum of all kernel values
     // if sum of kernel values is zero, divisor is set to 1
@@ -161,77 +151,31 @@ QImage ConvolveMatrixEffect::processImage(const QImage &image, const KoFilterEff
             divisor = 1.0;
     }
 
-    int dstPixel, srcPixel;
-    qreal sumA, sumR, sumG, sumB;
+    FilterEffectKernels::ConvolveParameters parameters;
+    parameters.orderX = rx;
+    parameters.orderY = ry;
+    parameters.targetX = tx;
+    parameters.targetY = ty;
+    parameters.kernel = m_kernel.constData();
+    parameters.divisor = divisor;
+    parameters.bias = m_bias;
+    parameters.preserveAlpha = m_preserveAlpha;
+    switch (m_edgeMode) {
+    case Duplicate:
+        parameters.edgeMode = FilterEffectKernels::EdgeDuplicate;
+        break;
+    case Wrap:
+        parameters.edgeMode = FilterEffectKernels::EdgeWrap;
+        break;
+    case None:
+        parameters.edgeMode = FilterEffectKernels::EdgeNone;
+        break;
+    }
+
     const QRgb * src = (const QRgb*)image.constBits();
     QRgb * dst = (QRgb*)result.bits();
 
-    const QRect roi = context.filterRegion().toRect();
-    const int minX = roi.left();
-    const int maxX = roi.right();
-    const int minY = roi.top();
-    const int maxY = roi.bottom();
-
-    int srcRow, srcCol;
-    for (int row = minY; row <= maxY; ++row) {
-        for (int col = minX; col <= maxX; ++col) {
-            dstPixel = row * w + col;
-            sumA = sumR = sumG = sumB = 0;
-            for (int i = 0; i < maskSize; ++i) {
-                srcRow = row + offset[i].y();
-                srcCol = col + offset[i].x();
-                // handle top and bottom edge
-                if (srcRow < 0 || srcRow >= h ) {
-                    switch(m_edgeMode) {
-                        case Duplicate:
-                            srcRow = srcRow >= h ? h-1 : 0;
-                            break;
-                        case Wrap:
-                            srcRow = (srcRow+h)%h;
-                            break;
-                        case None:
-                            // zero for all color channels
-                            continue;
-                            break;
-                    }
-                }
-                // handle left and right edge
-                if (srcCol < 0 || srcCol >= w) {
-                    switch(m_edgeMode) {
-                        case Duplicate:
-                            srcCol = srcCol >= w ? w-1 : 0;
-                            break;
-                        case Wrap:
-                            srcCol = (srcCol+w)%w;
-                            break;
-                        case None:
-                            // zero for all color channels
-                            continue;
-                            break;
-                    }
-                }
-                srcPixel = srcRow * w + srcCol;
-                const QRgb &s = src[srcPixel];
-                const qreal &k = m_kernel[i];
-                if (!m_preserveAlpha)
-                    sumA += qAlpha(s) * k;
-                sumR += qRed(s) * k;
-                sumG += qGreen(s) * k;
-                sumB += qBlue(s) * k;
-            }
-            if (m_preserveAlpha) {
-                dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
-                                       qAlpha(dst[dstPixel]));
-            } else {
-                dst[dstPixel] = qRgba( qBound(0, static_cast<int>(sumR / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumG / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumB / divisor + m_bias), 255),
-                                       qBound(0, static_cast<int>(sumA / divisor + m_bias), 255));
-            }
-        }
-    }
+    FilterEffectKernels::instance()->convolve(src, dst, w, h, context.filterRegion().toRect(), parameters);
 
     return result;
 }
@@ -0,0 +1,137 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef FILTEREFFECTKERNELS_H
+#define FILTEREFFECTKERNELS_H
+
+#include <QRgb>
+
+class QRect;
+
+/**
+ * The pixel kernels of the filter effects.
+ *
+ * The kernels work on premultiplied ARGB32 pixels. Each CPU architecture
+ * has its own implementation, the best one supported by the CPU is chosen
+ * at runtime, like for the optimized composite ops of pigment.
+ */
+class FilterEffectKernels
+{
+public:
+    enum BlendMode {
+        BlendNormal,
+        BlendMultiply,
+        BlendScreen,
+        BlendDarken,
+        BlendLighten
+    };
+
+    enum TransferFunction {
+        TransferIdentity,
+        TransferTable,
+        TransferDiscrete,
+        TransferLinear,
+        TransferGamma
+    };
+
+    enum EdgeMode {
+        EdgeDuplicate, ///< duplicates colors at the edges
+        EdgeWrap,      ///< takes the colors at the opposite edge
+        EdgeNone       ///< uses values of zero for each color channel
+    };
+
+    /// The transfer function of a single color channel
+    struct TransferParameters {
+        TransferParameters()
+            : function(TransferIdentity), tableValues(0), tableSize(0), slope(1.0), intercept(0.0)
+            , amplitude(1.0), exponent(1.0), offset(0.0) {
+        }
+
+        TransferFunction function;
+        const qreal *tableValues; ///< lookup table for table or discrete function
+        int tableSize;
+        qreal slope;     ///< slope for linear function
+        qreal intercept; ///< intercept for linear function
+        qreal amplitude; ///< amplitude for gamma function
+        qreal exponent;  ///< exponent for gamma function
+        qreal offset;    ///< offset for gamma function
+    };
+
+    /// The parameters of a convolution
+    struct ConvolveParameters {
+        int orderX;          ///< the number of kernel columns
+        int orderY;          ///< the number of kernel rows
+        int targetX;         ///< target column within the kernel
+        int targetY;         ///< target row within the kernel
+        const qreal *kernel; ///< the kernel, row by row
+        qreal divisor;
+        qreal bias;
+        EdgeMode edgeMode;
+        bool preserveAlpha;
+    };
+
+    virtual ~FilterEffectKernels() {}
+
+    /**
+     * Returns the kernels for the CPU the application runs on.
+     */
+    static const FilterEffectKernels *instance();
+
+    /**
+     * Blurs all @p pixels of an image with the stack blur algorithm.
+     */
+    virtual void blur(QRgb *pixels, int width, int height, int radius) const = 0;
+
+    /**
+     * Applies the 5x4 color @p matrix to @p count pixels of @p src.
+     */
+    virtual void colorMatrix(const QRgb *src, QRgb *dst, int count, const qreal *matrix) const = 0;
+
+    /**
+     * Applies the transfer functions of the red, green, blue and alpha
+     * @p channels to @p count pixels of @p src.
+     */
+    virtual void componentTransfer(const QRgb *src, QRgb *dst, int count, const TransferParameters *channels) const = 0;
+
+    /**
+     * Blends @p count pixels of @p src into @p dst.
+     */
+    virtual void blend(const QRgb *src, QRgb *dst, int count, BlendMode mode) const = 0;
+
+    /**
+     * Combines @p count pixels of @p src and @p dst with the arithmetic
+     * operator, using the four coefficients @p k.
+     */
+    virtual void arithmeticComposite(const QRgb *src, QRgb *dst, int count, const qreal *k) const = 0;
+
+    /**
+     * Erodes or dilates the pixels of @p rect, with a kernel of the radius
+     * @p rx and @p ry. The kernel has to stay within the image for all
+     * pixels of @p rect.
+     */
+    virtual void morphology(const QRgb *src, QRgb *dst, int width, const QRect &rect, int rx, int ry, bool erode) const = 0;
+
+    /**
+     * Convolves the pixels of @p rect with the kernel given by @p parameters.
+     */
+    virtual void convolve(const QRgb *src, QRgb *dst, int width, int height, const QRect &rect,
+                          const ConvolveParameters &parameters) const = 0;
+};
+
+#endif
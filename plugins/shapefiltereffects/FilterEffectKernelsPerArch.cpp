@@ -0,0 +1,678 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#if !defined _MSC_VER
+#pragma GCC diagnostic ignored "-Wundef"
+#endif
+
+#include "FilterEffectKernelsPerArch.h" // vc.h must come first
+#include "FilterEffectKernelsScalar.h"
+
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__clang__)
+#pragma GCC diagnostic ignored "-Wlocal-type-template-args"
+#endif
+
+namespace
+{
+typedef Vc::float_v float_v;
+typedef Vc::SimdArray<int, float_v::size()> int_v;
+typedef Vc::SimdArray<unsigned int, float_v::size()> uint_v;
+
+/**
+ * Gets the channels of float_v::size() pixels as values in [0, 255].
+ */
+inline void fetchPixels(const QRgb *data, float_v &a, float_v &r, float_v &g, float_v &b)
+{
+    uint_v pixels;
+    pixels.load(data, Vc::Unaligned);
+
+    const uint_v mask(0xff);
+    a = float_v(int_v(pixels >> 24));
+    r = float_v(int_v((pixels >> 16) & mask));
+    g = float_v(int_v((pixels >> 8) & mask));
+    b = float_v(int_v(pixels & mask));
+}
+
+/**
+ * Sets float_v::size() pixels to the given channels. Like in the scalar
+ * kernels the values are bound to [0, 255] and truncated.
+ */
+inline void storePixels(QRgb *data, float_v a, float_v r, float_v g, float_v b)
+{
+    const float_v zero(Vc::Zero);
+    const float_v max(255.0f);
+    a = Vc::min(Vc::max(a, zero), max);
+    r = Vc::min(Vc::max(r, zero), max);
+    g = Vc::min(Vc::max(g, zero), max);
+    b = Vc::min(Vc::max(b, zero), max);
+
+    const uint_v pixels = (uint_v(int_v(a)) << 24) | (uint_v(int_v(r)) << 16)
+                        | (uint_v(int_v(g)) << 8) | uint_v(int_v(b));
+    pixels.store(data, Vc::Unaligned);
+}
+
+/**
+ * Applies a transfer function to the values in [0, 1] of one channel.
+ */
+inline float_v transferChannel(const FilterEffectKernels::TransferParameters &d, const float *table, float_v value)
+{
+    switch (d.function) {
+    case FilterEffectKernels::TransferIdentity:
+        return value;
+    case FilterEffectKernels::TransferTable: {
+        if (d.tableSize < 1)
+            return value;
+        const float valueCount = d.tableSize - 1;
+        // keep the table indexes within the table for invalid colors
+        value = Vc::min(Vc::max(value, float_v(Vc::Zero)), float_v(Vc::One));
+        const int_v k1(value * valueCount);
+        const int_v k2 = Vc::min(k1 + 1, int_v(d.tableSize - 1));
+        const float_v vk1(table, k1);
+        const float_v vk2(table, k2);
+        return vk1 + (value - float_v(k1) / valueCount) * valueCount * (vk2 - vk1);
+    }
+    case FilterEffectKernels::TransferDiscrete: {
+        if (d.tableSize < 1)
+            return value;
+        value = Vc::min(Vc::max(value, float_v(Vc::Zero)), float_v(Vc::One));
+        return float_v(table, int_v(value * float(d.tableSize - 1)));
+    }
+    case FilterEffectKernels::TransferLinear:
+        return float(d.slope) * value + float(d.intercept);
+    case FilterEffectKernels::TransferGamma: {
+        const float_v power = Vc::exp(float(d.exponent) * Vc::log(value));
+        const float_v zeroPower(std::pow(0.0f, float(d.exponent)));
+        return float(d.amplitude) * Vc::iif(value > 0.0f, power, zeroPower) + float(d.offset);
+    }
+    }
+
+    return value;
+}
+
+/**
+ * The channels of float_v::size() pixels as integers.
+ */
+struct Channels
+{
+    Channels()
+        : r(Vc::Zero), g(Vc::Zero), b(Vc::Zero), a(Vc::Zero)
+    {
+    }
+
+    explicit Channels(const uint_v &pixels)
+    {
+        const uint_v mask(0xff);
+        r = int_v((pixels >> 16) & mask);
+        g = int_v((pixels >> 8) & mask);
+        b = int_v(pixels & mask);
+        a = int_v(pixels >> 24);
+    }
+
+    /// Loads the channels stored with store() from @p data
+    void load(const int *data)
+    {
+        r.load(data, Vc::Unaligned);
+        g.load(data + int_v::size(), Vc::Unaligned);
+        b.load(data + 2 * int_v::size(), Vc::Unaligned);
+        a.load(data + 3 * int_v::size(), Vc::Unaligned);
+    }
+
+    /// Stores the channels one after the other to @p data
+    void store(int *data) const
+    {
+        r.store(data, Vc::Unaligned);
+        g.store(data + int_v::size(), Vc::Unaligned);
+        b.store(data + 2 * int_v::size(), Vc::Unaligned);
+        a.store(data + 3 * int_v::size(), Vc::Unaligned);
+    }
+
+    Channels &operator+=(const Channels &other)
+    {
+        r += other.r;
+        g += other.g;
+        b += other.b;
+        a += other.a;
+        return *this;
+    }
+
+    Channels &operator-=(const Channels &other)
+    {
+        r -= other.r;
+        g -= other.g;
+        b -= other.b;
+        a -= other.a;
+        return *this;
+    }
+
+    Channels operator*(int factor) const
+    {
+        Channels result;
+        result.r = r * factor;
+        result.g = g * factor;
+        result.b = b * factor;
+        result.a = a * factor;
+        return result;
+    }
+
+    int_v r;
+    int_v g;
+    int_v b;
+    int_v a;
+};
+
+template<bool erode>
+inline void accumulateExtreme(Channels &extreme, const Channels &pixels)
+{
+    if (erode) {
+        extreme.r = Vc::min(extreme.r, pixels.r);
+        extreme.g = Vc::min(extreme.g, pixels.g);
+        extreme.b = Vc::min(extreme.b, pixels.b);
+        extreme.a = Vc::min(extreme.a, pixels.a);
+    } else {
+        extreme.r = Vc::max(extreme.r, pixels.r);
+        extreme.g = Vc::max(extreme.g, pixels.g);
+        extreme.b = Vc::max(extreme.b, pixels.b);
+        extreme.a = Vc::max(extreme.a, pixels.a);
+    }
+}
+
+inline Channels loadChannels(const QRgb *data)
+{
+    uint_v pixels;
+    pixels.load(data, Vc::Unaligned);
+    return Channels(pixels);
+}
+
+inline void storeChannels(QRgb *data, const Channels &channels)
+{
+    const uint_v pixels = (uint_v(channels.a) << 24) | (uint_v(channels.r) << 16)
+                        | (uint_v(channels.g) << 8) | uint_v(channels.b);
+    pixels.store(data, Vc::Unaligned);
+}
+
+template<bool erode>
+void morphologyRowVectors(const QRgb *src, int srcStride, QRgb *dst, int dstStride, int rows, int columns, int radius)
+{
+    const int vectorSize = float_v::size();
+    for (int row = 0; row < rows; ++row) {
+        const QRgb *s = src + row * srcStride;
+        QRgb *d = dst + row * dstStride;
+        for (int col = 0; col + vectorSize <= columns; col += vectorSize) {
+            Channels extreme = loadChannels(s + col - radius);
+            for (int i = -radius + 1; i <= radius; ++i) {
+                accumulateExtreme<erode>(extreme, loadChannels(s + col + i));
+            }
+            storeChannels(d + col, extreme);
+        }
+    }
+}
+
+template<bool erode>
+void morphologyColumnVectors(const QRgb *src, int srcStride, QRgb *dst, int dstStride, int rows, int columns, int radius)
+{
+    const int vectorSize = float_v::size();
+    for (int row = 0; row < rows; ++row) {
+        const QRgb *s = src + row * srcStride;
+        QRgb *d = dst + row * dstStride;
+        for (int col = 0; col + vectorSize <= columns; col += vectorSize) {
+            Channels extreme = loadChannels(s + col);
+            for (int i = 1; i <= 2 * radius; ++i) {
+                accumulateExtreme<erode>(extreme, loadChannels(s + i * srcStride + col));
+            }
+            storeChannels(d + col, extreme);
+        }
+    }
+}
+
+/**
+ * Processes float_v::size() pixels at once and the remaining pixels with the
+ * scalar implementation.
+ */
+template<Vc::Implementation _impl>
+class FilterEffectKernelsVector : public FilterEffectKernelsScalar
+{
+public:
+    virtual void blur(QRgb *pixels, int width, int height, int radius) const
+    {
+        if (radius < 1) {
+            return;
+        }
+
+        const int vectorSize = float_v::size();
+        BlurBuffers buffers(width, height, radius);
+
+        int row = 0;
+        for (; row + vectorSize <= height; row += vectorSize) {
+            blurRowVectors(pixels, buffers, row);
+        }
+        blurRows(pixels, buffers, row, height);
+
+        int column = 0;
+        for (; column + vectorSize <= width; column += vectorSize) {
+            blurColumnVectors(pixels, buffers, column);
+        }
+        blurColumns(pixels, buffers, column, width);
+    }
+
+    virtual void colorMatrix(const QRgb *src, QRgb *dst, int count, const qreal *matrix) const
+    {
+        const int vectorSize = float_v::size();
+        float m[20];
+        for (int i = 0; i < 20; ++i) {
+            m[i] = matrix[i];
+        }
+
+        const float scale = 1.0f / 255.0f;
+        float_v sa, sr, sg, sb;
+        float_v da, dr, dg, db;
+
+        int i = 0;
+        for (; i + vectorSize <= count; i += vectorSize) {
+            fetchPixels(src + i, sa, sr, sg, sb);
+            sa *= scale;
+            sr *= scale;
+            sg *= scale;
+            sb *= scale;
+            // the matrix is applied to non-premultiplied color values
+            // so we have to convert colors by dividing by alpha value
+            const float_v alpha = Vc::iif(sa > 0.0f && sa < 1.0f, sa, float_v(Vc::One));
+            sr /= alpha;
+            sg /= alpha;
+            sb /= alpha;
+
+            // apply matrix to color values
+            dr = m[ 0] * sr + m[ 1] * sg + m[ 2] * sb + m[ 3] * sa + m[ 4];
+            dg = m[ 5] * sr + m[ 6] * sg + m[ 7] * sb + m[ 8] * sa + m[ 9];
+            db = m[10] * sr + m[11] * sg + m[12] * sb + m[13] * sa + m[14];
+            da = m[15] * sr + m[16] * sg + m[17] * sb + m[18] * sa + m[19];
+
+            // the new alpha value
+            da *= 255.0f;
+
+            // set pre-multiplied color values on destination image
+            storePixels(dst + i, da, dr * da, dg * da, db * da);
+        }
+
+        FilterEffectKernelsScalar::colorMatrix(src + i, dst + i, count - i, matrix);
+    }
+
+    virtual void componentTransfer(const QRgb *src, QRgb *dst, int count, const TransferParameters *channels) const
+    {
+        const int vectorSize = float_v::size();
+        if (count < vectorSize) {
+            FilterEffectKernelsScalar::componentTransfer(src, dst, count, channels);
+            return;
+        }
+
+        // the lookup tables are gathered from floats
+        QVector<float> tables[4];
+        for (int c = 0; c < 4; ++c) {
+            tables[c].resize(channels[c].tableSize);
+            for (int i = 0; i < channels[c].tableSize; ++i) {
+                tables[c][i] = channels[c].tableValues[i];
+            }
+        }
+
+        const float scale = 1.0f / 255.0f;
+        float_v sa, sr, sg, sb;
+        float_v da, dr, dg, db;
+
+        int i = 0;
+        for (; i + vectorSize <= count; i += vectorSize) {
+            fetchPixels(src + i, sa, sr, sg, sb);
+            sa *= scale;
+            sr *= scale;
+            sg *= scale;
+            sb *= scale;
+            // the transfer functions are applied to non-premultiplied color values
+            const float_v alpha = Vc::iif(sa > 0.0f && sa < 1.0f, sa, float_v(Vc::One));
+            sr /= alpha;
+            sg /= alpha;
+            sb /= alpha;
+
+            dr = transferChannel(channels[0], tables[0].constData(), sr);
+            dg = transferChannel(channels[1], tables[1].constData(), sg);
+            db = transferChannel(channels[2], tables[2].constData(), sb);
+            da = transferChannel(channels[3], tables[3].constData(), sa);
+
+            da *= 255.0f;
+
+            storePixels(dst + i, da, dr * da, dg * da, db * da);
+        }
+
+        FilterEffectKernelsScalar::componentTransfer(src + i, dst + i, count - i, channels);
+    }
+
+    virtual void blend(const QRgb *src, QRgb *dst, int count, BlendMode mode) const
+    {
+        const int vectorSize = float_v::size();
+        const float scale = 1.0f / 255.0f;
+        const float_v one(Vc::One);
+        float_v sa, sr, sg, sb;
+        float_v da, dr, dg, db;
+
+        int i = 0;
+        for (; i + vectorSize <= count; i += vectorSize) {
+            fetchPixels(src + i, sa, sr, sg, sb);
+            fetchPixels(dst + i, da, dr, dg, db);
+            sa *= scale;
+            sr *= scale;
+            sg *= scale;
+            sb *= scale;
+            da *= scale;
+            dr *= scale;
+            dg *= scale;
+            db *= scale;
+
+            switch (mode) {
+            case BlendNormal:
+                dr = (one - da) * sr + dr;
+                dg = (one - da) * sg + dg;
+                db = (one - da) * sb + db;
+                break;
+            case BlendMultiply:
+                dr = (one - da) * sr + (one - sa) * dr + dr * sr;
+                dg = (one - da) * sg + (one - sa) * dg + dg * sg;
+                db = (one - da) * sb + (one - sa) * db + db * sb;
+                break;
+            case BlendScreen:
+                dr = sr + dr - dr * sr;
+                dg = sg + dg - dg * sg;
+                db = sb + db - db * sb;
+                break;
+            case BlendDarken:
+                dr = Vc::min((one - da) * sr + dr, (one - sa) * dr + sr);
+                dg = Vc::min((one - da) * sg + dg, (one - sa) * dg + sg);
+                db = Vc::min((one - da) * sb + db, (one - sa) * db + sb);
+                break;
+            case BlendLighten:
+                dr = Vc::max((one - da) * sr + dr, (one - sa) * dr + sr);
+                dg = Vc::max((one - da) * sg + dg, (one - sa) * dg + sg);
+                db = Vc::max((one - da) * sb + db, (one - sa) * db + sb);
+                break;
+            }
+            da = one - (one - da) * (one - sa);
+
+            storePixels(dst + i, da * 255.0f, dr * 255.0f, dg * 255.0f, db * 255.0f);
+        }
+
+        FilterEffectKernelsScalar::blend(src + i, dst + i, count - i, mode);
+    }
+
+    virtual void arithmeticComposite(const QRgb *src, QRgb *dst, int count, const qreal *k) const
+    {
+        const int vectorSize = float_v::size();
+        const float scale = 1.0f / 255.0f;
+        const float k0 = k[0];
+        const float k1 = k[1];
+        const float k2 = k[2];
+        const float k3 = k[3];
+        float_v sa, sr, sg, sb;
+        float_v da, dr, dg, db;
+
+        int i = 0;
+        for (; i + vectorSize <= count; i += vectorSize) {
+            fetchPixels(src + i, sa, sr, sg, sb);
+            fetchPixels(dst + i, da, dr, dg, db);
+            sa *= scale;
+            sr *= scale;
+            sg *= scale;
+            sb *= scale;
+            da *= scale;
+            dr *= scale;
+            dg *= scale;
+            db *= scale;
+
+            da = k0 * sa * da + k1 * da + k2 * sa + k3;
+            dr = k0 * sr * dr + k1 * dr + k2 * sr + k3;
+            dg = k0 * sg * dg + k1 * dg + k2 * sg + k3;
+            db = k0 * sb * db + k1 * db + k2 * sb + k3;
+
+            da *= 255.0f;
+
+            storePixels(dst + i, da, dr * da, dg * da, db * da);
+        }
+
+        FilterEffectKernelsScalar::arithmeticComposite(src + i, dst + i, count - i, k);
+    }
+
+    virtual void morphology(const QRgb *src, QRgb *dst, int width, const QRect &rect, int rx, int ry, bool erode) const
+    {
+        // the rectangular kernel is separable, the rows are processed
+        // into a buffer first, then the columns of the buffer
+        const int columns = rect.width();
+        const int vectorColumns = columns - columns % float_v::size();
+        const int bufferRows = rect.height() + 2 * ry;
+        QVector<QRgb> buffer(columns * bufferRows);
+
+        const QRgb *s = src + (rect.top() - ry) * width + rect.left();
+        QRgb *b = buffer.data();
+        if (erode) {
+            morphologyRowVectors<true>(s, width, b, columns, bufferRows, vectorColumns, rx);
+        } else {
+            morphologyRowVectors<false>(s, width, b, columns, bufferRows, vectorColumns, rx);
+        }
+        morphologyRows(s + vectorColumns, width, b + vectorColumns, columns,
+                       bufferRows, columns - vectorColumns, rx, erode);
+
+        QRgb *d = dst + rect.top() * width + rect.left();
+        if (erode) {
+            morphologyColumnVectors<true>(b, columns, d, width, rect.height(), vectorColumns, ry);
+        } else {
+            morphologyColumnVectors<false>(b, columns, d, width, rect.height(), vectorColumns, ry);
+        }
+        morphologyColumns(b + vectorColumns, columns, d + vectorColumns, width,
+                          rect.height(), columns - vectorColumns, ry, erode);
+    }
+
+    virtual void convolve(const QRgb *src, QRgb *dst, int w, int h, const QRect &rect,
+                          const ConvolveParameters &parameters) const
+    {
+        const int vectorSize = float_v::size();
+
+        // the kernel stays within the image for these pixels, so there are no edges to handle
+        const QRect inner = rect & QRect(QPoint(parameters.targetX, parameters.targetY),
+                                         QPoint(w - parameters.orderX + parameters.targetX,
+                                                h - parameters.orderY + parameters.targetY));
+        if (inner.width() < vectorSize) {
+            FilterEffectKernelsScalar::convolve(src, dst, w, h, rect, parameters);
+            return;
+        }
+
+        // the edges around the inner pixels
+        FilterEffectKernelsScalar::convolve(src, dst, w, h,
+            QRect(rect.left(), rect.top(), rect.width(), inner.top() - rect.top()), parameters);
+        FilterEffectKernelsScalar::convolve(src, dst, w, h,
+            QRect(rect.left(), inner.bottom() + 1, rect.width(), rect.bottom() - inner.bottom()), parameters);
+        FilterEffectKernelsScalar::convolve(src, dst, w, h,
+            QRect(rect.left(), inner.top(), inner.left() - rect.left(), inner.height()), parameters);
+        FilterEffectKernelsScalar::convolve(src, dst, w, h,
+            QRect(inner.right() + 1, inner.top(), rect.right() - inner.right(), inner.height()), parameters);
+
+        const int maskSize = parameters.orderX * parameters.orderY;
+        QVector<int> offset(maskSize);
+        QVector<float> kernel(maskSize);
+        for (int i = 0; i < maskSize; ++i) {
+            offset[i] = (i / parameters.orderX - parameters.targetY) * w + i % parameters.orderX - parameters.targetX;
+            kernel[i] = parameters.kernel[i];
+        }
+        const float_v divisor(float(parameters.divisor));
+        const float_v bias(float(parameters.bias));
+
+        float_v sumA, sumR, sumG, sumB;
+        float_v sa, sr, sg, sb;
+        for (int row = inner.top(); row <= inner.bottom(); ++row) {
+            int col = inner.left();
+            for (; col + vectorSize - 1 <= inner.right(); col += vectorSize) {
+                const int dstPixel = row * w + col;
+                sumA = sumR = sumG = sumB = float_v(Vc::Zero);
+                for (int i = 0; i < maskSize; ++i) {
+                    fetchPixels(src + dstPixel + offset[i], sa, sr, sg, sb);
+                    const float k = kernel[i];
+                    sumA += sa * k;
+                    sumR += sr * k;
+                    sumG += sg * k;
+                    sumB += sb * k;
+                }
+                if (parameters.preserveAlpha) {
+                    fetchPixels(dst + dstPixel, sumA, sa, sg, sb);
+                } else {
+                    sumA = sumA / divisor + bias;
+                }
+                storePixels(dst + dstPixel, sumA, sumR / divisor + bias, sumG / divisor + bias, sumB / divisor + bias);
+            }
+            FilterEffectKernelsScalar::convolve(src, dst, w, h,
+                QRect(col, row, inner.right() - col + 1, 1), parameters);
+        }
+    }
+
+private:
+    /// Blurs float_v::size() rows from @p firstRow on, each row in one element of the vectors
+    void blurRowVectors(const QRgb *pix, BlurBuffers &buffers, int firstRow) const
+    {
+        const int vectorSize = float_v::size();
+        const int w = buffers.width;
+        const int wm = w - 1;
+        const int radius = buffers.radius;
+        const int div = radius + radius + 1;
+        const int r1 = radius + 1;
+        const int *dv = buffers.division.constData();
+
+        const int_v rowStart = (int_v::IndexesFromZero() + firstRow) * w;
+        QVector<int> stack(4 * vectorSize * div);
+        Channels sum, outsum, insum;
+        int stackpointer;
+        int *sir;
+
+        for (int i = -radius; i <= radius; ++i) {
+            const Channels p(uint_v(pix, rowStart + qMin(wm, qMax(i, 0))));
+            p.store(&stack[4 * vectorSize * (i + radius)]);
+            sum += p * (r1 - abs(i));
+            if (i > 0) {
+                insum += p;
+            } else {
+                outsum += p;
+            }
+        }
+        stackpointer = radius;
+
+        Channels p;
+        for (int x = 0; x < w; ++x) {
+            const int_v yi = rowStart + x;
+            int_v(dv, sum.r).scatter(buffers.red.data(), yi);
+            int_v(dv, sum.g).scatter(buffers.green.data(), yi);
+            int_v(dv, sum.b).scatter(buffers.blue.data(), yi);
+            int_v(dv, sum.a).scatter(buffers.alpha.data(), yi);
+
+            sum -= outsum;
+
+            sir = &stack[4 * vectorSize * ((stackpointer - radius + div) % div)];
+            p.load(sir);
+            outsum -= p;
+
+            p = Channels(uint_v(pix, rowStart + qMin(x + radius + 1, wm)));
+            p.store(sir);
+            insum += p;
+            sum += insum;
+
+            stackpointer = (stackpointer + 1) % div;
+            p.load(&stack[4 * vectorSize * stackpointer]);
+            outsum += p;
+            insum -= p;
+        }
+    }
+
+    /// Blurs float_v::size() columns from @p firstColumn on, each column in one element of the vectors
+    void blurColumnVectors(QRgb *pix, const BlurBuffers &buffers, int firstColumn) const
+    {
+        const int vectorSize = float_v::size();
+        const int w = buffers.width;
+        const int hm = buffers.height - 1;
+        const int radius = buffers.radius;
+        const int div = radius + radius + 1;
+        const int r1 = radius + 1;
+        const int *dv = buffers.division.constData();
+
+        QVector<int> stack(4 * vectorSize * div);
+        Channels sum, outsum, insum;
+        int stackpointer;
+        int *sir;
+
+        Channels p;
+        for (int i = -radius; i <= radius; ++i) {
+            loadPlanes(buffers, qBound(0, i, hm) * w + firstColumn, p);
+            p.store(&stack[4 * vectorSize * (i + radius)]);
+            sum += p * (r1 - abs(i));
+            if (i > 0) {
+                insum += p;
+            } else {
+                outsum += p;
+            }
+        }
+        stackpointer = radius;
+
+        for (int y = 0; y <= hm; ++y) {
+            Channels blurred;
+            blurred.r = int_v(dv, sum.r);
+            blurred.g = int_v(dv, sum.g);
+            blurred.b = int_v(dv, sum.b);
+            blurred.a = int_v(dv, sum.a);
+            storeChannels(pix + y * w + firstColumn, blurred);
+
+            sum -= outsum;
+
+            sir = &stack[4 * vectorSize * ((stackpointer - radius + div) % div)];
+            p.load(sir);
+            outsum -= p;
+
+            loadPlanes(buffers, firstColumn + qMin(y + r1, hm) * w, p);
+            p.store(sir);
+            insum += p;
+            sum += insum;
+
+            stackpointer = (stackpointer + 1) % div;
+            p.load(&stack[4 * vectorSize * stackpointer]);
+            outsum += p;
+            insum -= p;
+        }
+    }
+
+    static void loadPlanes(const BlurBuffers &buffers, int index, Channels &channels)
+    {
+        channels.r.load(buffers.red.constData() + index, Vc::Unaligned);
+        channels.g.load(buffers.green.constData() + index, Vc::Unaligned);
+        channels.b.load(buffers.blue.constData() + index, Vc::Unaligned);
+        channels.a.load(buffers.alpha.constData() + index, Vc::Unaligned);
+    }
+};
+} // namespace
+
+template<>
+FilterEffectKernelsFactory::ReturnType
+FilterEffectKernelsFactory::create<Vc::CurrentImplementation::current()>(ParamType)
+{
+    return new FilterEffectKernelsVector<Vc::CurrentImplementation::current()>();
+}
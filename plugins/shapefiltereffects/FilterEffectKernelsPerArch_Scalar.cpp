@@ -0,0 +1,606 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "FilterEffectKernelsPerArch.h"
+#include "FilterEffectKernelsScalar.h"
+#include "ColorChannelConversion.h"
+
+#include <QPoint>
+#include <QRect>
+
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+inline QRgb extremePixel(QRgb p1, QRgb p2, bool erode)
+{
+    if (erode) {
+        return qRgba(qMin(qRed(p1), qRed(p2)), qMin(qGreen(p1), qGreen(p2)),
+                     qMin(qBlue(p1), qBlue(p2)), qMin(qAlpha(p1), qAlpha(p2)));
+    }
+    return qRgba(qMax(qRed(p1), qRed(p2)), qMax(qGreen(p1), qGreen(p2)),
+                 qMax(qBlue(p1), qBlue(p2)), qMax(qAlpha(p1), qAlpha(p2)));
+}
+
+qreal transferChannel(const FilterEffectKernels::TransferParameters &d, qreal value)
+{
+    switch (d.function) {
+    case FilterEffectKernels::TransferIdentity:
+        return value;
+    case FilterEffectKernels::TransferTable: {
+        qreal valueCount = d.tableSize - 1;
+        if (valueCount < 0.0)
+            return value;
+        qreal k1 = static_cast<int>(value * valueCount);
+        qreal k2 = qMin(k1 + 1, valueCount);
+        qreal vk1 = d.tableValues[static_cast<int>(k1)];
+        qreal vk2 = d.tableValues[static_cast<int>(k2)];
+        return vk1 + (value - static_cast<qreal>(k1) / valueCount)*valueCount *(vk2 - vk1);
+    }
+    case FilterEffectKernels::TransferDiscrete: {
+        qreal valueCount = d.tableSize - 1;
+        if (valueCount < 0.0)
+            return value;
+        return d.tableValues[static_cast<int>(value*valueCount)];
+    }
+    case FilterEffectKernels::TransferLinear:
+        return d.slope * value + d.intercept;
+    case FilterEffectKernels::TransferGamma:
+        return d.amplitude * pow(value, d.exponent) + d.offset;
+    }
+
+    return value;
+}
+} // namespace
+
+template<>
+FilterEffectKernelsFactory::ReturnType
+FilterEffectKernelsFactory::create<Vc::ScalarImpl>(ParamType)
+{
+    return new FilterEffectKernelsScalar();
+}
+
+// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
+// fixed to handle alpha channel correctly by Zack Rusin
+
+FilterEffectKernelsScalar::BlurBuffers::BlurBuffers(int width, int height, int radius)
+    : width(width)
+    , height(height)
+    , radius(radius)
+    , red(width * height)
+    , green(width * height)
+    , blue(width * height)
+    , alpha(width * height)
+{
+    const int div = radius + radius + 1;
+    int divsum = (div + 1) >> 1;
+    divsum *= divsum;
+    division.resize(256 * divsum);
+    for (int i = 0; i < 256 * divsum; ++i) {
+        division[i] = (i / divsum);
+    }
+}
+
+void FilterEffectKernelsScalar::blur(QRgb *pixels, int width, int height, int radius) const
+{
+    if (radius < 1) {
+        return;
+    }
+
+    BlurBuffers buffers(width, height, radius);
+    blurRows(pixels, buffers, 0, height);
+    blurColumns(pixels, buffers, 0, width);
+}
+
+void FilterEffectKernelsScalar::blurRows(const QRgb *pix, BlurBuffers &buffers, int firstRow, int endRow) const
+{
+    const int w = buffers.width;
+    const int wm = w - 1;
+    const int radius = buffers.radius;
+    const int div = radius + radius + 1;
+    const int r1 = radius + 1;
+    const int *dv = buffers.division.constData();
+    int *r = buffers.red.data();
+    int *g = buffers.green.data();
+    int *b = buffers.blue.data();
+    int *a = buffers.alpha.data();
+
+    QVector<int> stack(4 * div);
+    int rsum, gsum, bsum, asum;
+    int routsum, goutsum, boutsum, aoutsum;
+    int rinsum, ginsum, binsum, ainsum;
+    int stackpointer;
+    int *sir;
+    QRgb p;
+
+    for (int y = firstRow; y < endRow; ++y) {
+        const int yw = y * w;
+        int yi = yw;
+        rinsum = ginsum = binsum = ainsum = 0;
+        routsum = goutsum = boutsum = aoutsum = 0;
+        rsum = gsum = bsum = asum = 0;
+
+        for (int i = -radius; i <= radius; ++i) {
+            p = pix[yi + qMin(wm, qMax(i, 0))];
+            sir = &stack[4 * (i + radius)];
+            sir[0] = qRed(p);
+            sir[1] = qGreen(p);
+            sir[2] = qBlue(p);
+            sir[3] = qAlpha(p);
+            const int rbs = r1 - abs(i);
+            rsum += sir[0] * rbs;
+            gsum += sir[1] * rbs;
+            bsum += sir[2] * rbs;
+            asum += sir[3] * rbs;
+            if (i > 0) {
+                rinsum += sir[0];
+                ginsum += sir[1];
+                binsum += sir[2];
+                ainsum += sir[3];
+            } else {
+                routsum += sir[0];
+                goutsum += sir[1];
+                boutsum += sir[2];
+                aoutsum += sir[3];
+            }
+        }
+        stackpointer = radius;
+
+        for (int x = 0; x < w; ++x) {
+            r[yi] = dv[rsum];
+            g[yi] = dv[gsum];
+            b[yi] = dv[bsum];
+            a[yi] = dv[asum];
+
+            rsum -= routsum;
+            gsum -= goutsum;
+            bsum -= boutsum;
+            asum -= aoutsum;
+
+            sir = &stack[4 * ((stackpointer - radius + div) % div)];
+
+            routsum -= sir[0];
+            goutsum -= sir[1];
+            boutsum -= sir[2];
+            aoutsum -= sir[3];
+
+            p = pix[yw + qMin(x + radius + 1, wm)];
+
+            sir[0] = qRed(p);
+            sir[1] = qGreen(p);
+            sir[2] = qBlue(p);
+            sir[3] = qAlpha(p);
+
+            rinsum += sir[0];
+            ginsum += sir[1];
+            binsum += sir[2];
+            ainsum += sir[3];
+
+            rsum += rinsum;
+            gsum += ginsum;
+            bsum += binsum;
+            asum += ainsum;
+
+            stackpointer = (stackpointer + 1) % div;
+            sir = &stack[4 * stackpointer];
+
+            routsum += sir[0];
+            goutsum += sir[1];
+            boutsum += sir[2];
+            aoutsum += sir[3];
+
+            rinsum -= sir[0];
+            ginsum -= sir[1];
+            binsum -= sir[2];
+            ainsum -= sir[3];
+
+            ++yi;
+        }
+    }
+}
+
+void FilterEffectKernelsScalar::blurColumns(QRgb *pix, const BlurBuffers &buffers, int firstColumn, int endColumn) const
+{
+    const int w = buffers.width;
+    const int hm = buffers.height - 1;
+    const int radius = buffers.radius;
+    const int div = radius + radius + 1;
+    const int r1 = radius + 1;
+    const int *dv = buffers.division.constData();
+    const int *r = buffers.red.constData();
+    const int *g = buffers.green.constData();
+    const int *b = buffers.blue.constData();
+    const int *a = buffers.alpha.constData();
+
+    QVector<int> stack(4 * div);
+    int rsum, gsum, bsum, asum;
+    int routsum, goutsum, boutsum, aoutsum;
+    int rinsum, ginsum, binsum, ainsum;
+    int stackpointer;
+    int *sir;
+    int p;
+
+    for (int x = firstColumn; x < endColumn; ++x) {
+        rinsum = ginsum = binsum = ainsum = 0;
+        routsum = goutsum = boutsum = aoutsum = 0;
+        rsum = gsum = bsum = asum = 0;
+
+        for (int i = -radius; i <= radius; ++i) {
+            p = qBound(0, i, hm) * w + x;
+            sir = &stack[4 * (i + radius)];
+            sir[0] = r[p];
+            sir[1] = g[p];
+            sir[2] = b[p];
+            sir[3] = a[p];
+            const int rbs = r1 - abs(i);
+            rsum += sir[0] * rbs;
+            gsum += sir[1] * rbs;
+            bsum += sir[2] * rbs;
+            asum += sir[3] * rbs;
+            if (i > 0) {
+                rinsum += sir[0];
+                ginsum += sir[1];
+                binsum += sir[2];
+                ainsum += sir[3];
+            } else {
+                routsum += sir[0];
+                goutsum += sir[1];
+                boutsum += sir[2];
+                aoutsum += sir[3];
+            }
+        }
+        int yi = x;
+        stackpointer = radius;
+
+        for (int y = 0; y <= hm; ++y) {
+            pix[yi] = qRgba(dv[rsum], dv[gsum], dv[bsum], dv[asum]);
+
+            rsum -= routsum;
+            gsum -= goutsum;
+            bsum -= boutsum;
+            asum -= aoutsum;
+
+            sir = &stack[4 * ((stackpointer - radius + div) % div)];
+
+            routsum -= sir[0];
+            goutsum -= sir[1];
+            boutsum -= sir[2];
+            aoutsum -= sir[3];
+
+            p = x + qMin(y + r1, hm) * w;
+
+            sir[0] = r[p];
+            sir[1] = g[p];
+            sir[2] = b[p];
+            sir[3] = a[p];
+
+            rinsum += sir[0];
+            ginsum += sir[1];
+            binsum += sir[2];
+            ainsum += sir[3];
+
+            rsum += rinsum;
+            gsum += ginsum;
+            bsum += binsum;
+            asum += ainsum;
+
+            stackpointer = (stackpointer + 1) % div;
+            sir = &stack[4 * stackpointer];
+
+            routsum += sir[0];
+            goutsum += sir[1];
+            boutsum += sir[2];
+            aoutsum += sir[3];
+
+            rinsum -= sir[0];
+            ginsum -= sir[1];
+            binsum -= sir[2];
+            ainsum -= sir[3];
+
+            yi += w;
+        }
+    }
+}
+
+void FilterEffectKernelsScalar::colorMatrix(const QRgb *src, QRgb *dst, int count, const qreal *m) const
+{
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+
+    for (int i = 0; i < count; ++i) {
+        const QRgb &s = src[i];
+        sa = fromIntColor[qAlpha(s)];
+        sr = fromIntColor[qRed(s)];
+        sg = fromIntColor[qGreen(s)];
+        sb = fromIntColor[qBlue(s)];
+        // the matrix is applied to non-premultiplied color values
+        // so we have to convert colors by dividing by alpha value
+        if (sa > 0.0 && sa < 1.0) {
+            sr /= sa;
+            sb /= sa;
+            sg /= sa;
+        }
+
+        // apply matrix to color values
+        dr = m[ 0] * sr + m[ 1] * sg + m[ 2] * sb + m[ 3] * sa + m[ 4];
+        dg = m[ 5] * sr + m[ 6] * sg + m[ 7] * sb + m[ 8] * sa + m[ 9];
+        db = m[10] * sr + m[11] * sg + m[12] * sb + m[13] * sa + m[14];
+        da = m[15] * sr + m[16] * sg + m[17] * sb + m[18] * sa + m[19];
+
+        // the new alpha value
+        da *= 255.0;
+
+        // set pre-multiplied color values on destination image
+        dst[i] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+    }
+}
+
+void FilterEffectKernelsScalar::componentTransfer(const QRgb *src, QRgb *dst, int count, const TransferParameters *channels) const
+{
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+
+    for (int i = 0; i < count; ++i) {
+        const QRgb &s = src[i];
+
+        sa = fromIntColor[qAlpha(s)];
+        sr = fromIntColor[qRed(s)];
+        sg = fromIntColor[qGreen(s)];
+        sb = fromIntColor[qBlue(s)];
+        // the matrix is applied to non-premultiplied color values
+        // so we have to convert colors by dividing by alpha value
+        if (sa > 0.0 && sa < 1.0) {
+            sr /= sa;
+            sb /= sa;
+            sg /= sa;
+        }
+
+        dr = transferChannel(channels[0], sr);
+        dg = transferChannel(channels[1], sg);
+        db = transferChannel(channels[2], sb);
+        da = transferChannel(channels[3], sa);
+
+        da *= 255.0;
+
+        // set pre-multiplied color values on destination image
+        dst[i] = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                       static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+    }
+}
+
+void FilterEffectKernelsScalar::blend(const QRgb *src, QRgb *dst, int count, BlendMode mode) const
+{
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+
+    for (int i = 0; i < count; ++i) {
+        const QRgb &s = src[i];
+        QRgb &d = dst[i];
+
+        sa = fromIntColor[qAlpha(s)];
+        sr = fromIntColor[qRed(s)];
+        sg = fromIntColor[qGreen(s)];
+        sb = fromIntColor[qBlue(s)];
+
+        da = fromIntColor[qAlpha(d)];
+        dr = fromIntColor[qRed(d)];
+        dg = fromIntColor[qGreen(d)];
+        db = fromIntColor[qBlue(d)];
+
+        switch (mode) {
+        case BlendNormal:
+            dr = (qreal(1.0) - da) * sr + dr;
+            dg = (qreal(1.0) - da) * sg + dg;
+            db = (qreal(1.0) - da) * sb + db;
+            break;
+        case BlendMultiply:
+            dr = (qreal(1.0) - da) * sr + (qreal(1.0) - sa) * dr + dr * sr;
+            dg = (qreal(1.0) - da) * sg + (qreal(1.0) - sa) * dg + dg * sg;
+            db = (qreal(1.0) - da) * sb + (qreal(1.0) - sa) * db + db * sb;
+            break;
+        case BlendScreen:
+            dr = sr + dr - dr * sr;
+            dg = sg + dg - dg * sg;
+            db = sb + db - db * sb;
+            break;
+        case BlendDarken:
+            dr = qMin((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+            dg = qMin((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+            db = qMin((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+            break;
+        case BlendLighten:
+            dr = qMax((qreal(1.0) - da) * sr + dr, (qreal(1.0) - sa) * dr + sr);
+            dg = qMax((qreal(1.0) - da) * sg + dg, (qreal(1.0) - sa) * dg + sg);
+            db = qMax((qreal(1.0) - da) * sb + db, (qreal(1.0) - sa) * db + sb);
+            break;
+        }
+        da = qreal(1.0) - (qreal(1.0) - da) * (qreal(1.0) - sa);
+
+        d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * qreal(255.0), qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), dg * qreal(255.0), qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), db * qreal(255.0), qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), da * qreal(255.0), qreal(255.0))));
+    }
+}
+
+void FilterEffectKernelsScalar::arithmeticComposite(const QRgb *src, QRgb *dst, int count, const qreal *k) const
+{
+    qreal sa, sr, sg, sb;
+    qreal da, dr, dg, db;
+
+    for (int i = 0; i < count; ++i) {
+        const QRgb &s = src[i];
+        QRgb &d = dst[i];
+
+        sa = fromIntColor[qAlpha(s)];
+        sr = fromIntColor[qRed(s)];
+        sg = fromIntColor[qGreen(s)];
+        sb = fromIntColor[qBlue(s)];
+
+        da = fromIntColor[qAlpha(d)];
+        dr = fromIntColor[qRed(d)];
+        dg = fromIntColor[qGreen(d)];
+        db = fromIntColor[qBlue(d)];
+
+        da = k[0] * sa * da + k[1] * da + k[2] * sa + k[3];
+        dr = k[0] * sr * dr + k[1] * dr + k[2] * sr + k[3];
+        dg = k[0] * sg * dg + k[1] * dg + k[2] * sg + k[3];
+        db = k[0] * sb * db + k[1] * db + k[2] * sb + k[3];
+
+        da *= 255.0;
+
+        // set pre-multiplied color values on destination image
+        d = qRgba(static_cast<quint8>(qBound(qreal(0.0), dr * da, qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), dg * da, qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), db * da, qreal(255.0))),
+                  static_cast<quint8>(qBound(qreal(0.0), da, qreal(255.0))));
+    }
+}
+
+void FilterEffectKernelsScalar::morphology(const QRgb *src, QRgb *dst, int width, const QRect &rect, int rx, int ry, bool erode) const
+{
+    // the rectangular kernel is separable, the rows are processed
+    // into a buffer first, then the columns of the buffer
+    const int columns = rect.width();
+    QVector<QRgb> buffer(columns * (rect.height() + 2 * ry));
+    morphologyRows(src + (rect.top() - ry) * width + rect.left(), width, buffer.data(), columns,
+                   rect.height() + 2 * ry, columns, rx, erode);
+    morphologyColumns(buffer.constData(), columns, dst + rect.top() * width + rect.left(), width,
+                      rect.height(), columns, ry, erode);
+}
+
+void FilterEffectKernelsScalar::morphologyRows(const QRgb *src, int srcStride, QRgb *dst, int dstStride,
+                                               int rows, int columns, int radius, bool erode) const
+{
+    for (int row = 0; row < rows; ++row) {
+        const QRgb *s = src + row * srcStride;
+        QRgb *d = dst + row * dstStride;
+        for (int col = 0; col < columns; ++col) {
+            QRgb p = s[col - radius];
+            for (int i = -radius + 1; i <= radius; ++i) {
+                p = extremePixel(p, s[col + i], erode);
+            }
+            d[col] = p;
+        }
+    }
+}
+
+void FilterEffectKernelsScalar::morphologyColumns(const QRgb *src, int srcStride, QRgb *dst, int dstStride,
+                                                  int rows, int columns, int radius, bool erode) const
+{
+    for (int row = 0; row < rows; ++row) {
+        const QRgb *s = src + row * srcStride;
+        QRgb *d = dst + row * dstStride;
+        for (int col = 0; col < columns; ++col) {
+            QRgb p = s[col];
+            for (int i = 1; i <= 2 * radius; ++i) {
+                p = extremePixel(p, s[i * srcStride + col], erode);
+            }
+            d[col] = p;
+        }
+    }
+}
+
+void FilterEffectKernelsScalar::convolve(const QRgb *src, QRgb *dst, int w, int h, const QRect &rect,
+                                         const ConvolveParameters &parameters) const
+{
+    // setup mask
+    const int maskSize = parameters.orderX * parameters.orderY;
+    QVector<QPoint> offset(maskSize);
+    int index = 0;
+    for (int y = 0; y < parameters.orderY; ++y) {
+        for (int x = 0; x < parameters.orderX; ++x) {
+            offset[index] = QPoint(x - parameters.targetX, y - parameters.targetY);
+            index++;
+        }
+    }
+
+    const qreal divisor = parameters.divisor;
+    const qreal bias = parameters.bias;
+
+    int dstPixel, srcPixel;
+    qreal sumA, sumR, sumG, sumB;
+
+    int srcRow, srcCol;
+    for (int row = rect.top(); row <= rect.bottom(); ++row) {
+        for (int col = rect.left(); col <= rect.right(); ++col) {
+            dstPixel = row * w + col;
+            sumA = sumR = sumG = sumB = 0;
+            for (int i = 0; i < maskSize; ++i) {
+                srcRow = row + offset[i].y();
+                srcCol = col + offset[i].x();
+                // handle top and bottom edge
+                if (srcRow < 0 || srcRow >= h) {
+                    switch (parameters.edgeMode) {
+                    case EdgeDuplicate:
+                        srcRow = srcRow >= h ? h-1 : 0;
+                        break;
+                    case EdgeWrap:
+                        srcRow = (srcRow+h)%h;
+                        break;
+                    case EdgeNone:
+                        // zero for all color channels
+                        continue;
+                        break;
+                    }
+                }
+                // handle left and right edge
+                if (srcCol < 0 || srcCol >= w) {
+                    switch (parameters.edgeMode) {
+                    case EdgeDuplicate:
+                        srcCol = srcCol >= w ? w-1 : 0;
+                        break;
+                    case EdgeWrap:
+                        srcCol = (srcCol+w)%w;
+                        break;
+                    case EdgeNone:
+                        // zero for all color channels
+                        continue;
+                        break;
+                    }
+                }
+                srcPixel = srcRow * w + srcCol;
+                const QRgb &s = src[srcPixel];
+                const qreal &k = parameters.kernel[i];
+                if (!parameters.preserveAlpha)
+                    sumA += qAlpha(s) * k;
+                sumR += qRed(s) * k;
+                sumG += qGreen(s) * k;
+                sumB += qBlue(s) * k;
+            }
+            if (parameters.preserveAlpha) {
+                dst[dstPixel] = qRgba(qBound(0, static_cast<int>(sumR / divisor + bias), 255),
+                                      qBound(0, static_cast<int>(sumG / divisor + bias), 255),
+                                      qBound(0, static_cast<int>(sumB / divisor + bias), 255),
+                                      qAlpha(dst[dstPixel]));
+            } else {
+                dst[dstPixel] = qRgba(qBound(0, static_cast<int>(sumR / divisor + bias), 255),
+                                      qBound(0, static_cast<int>(sumG / divisor + bias), 255),
+                                      qBound(0, static_cast<int>(sumB / divisor + bias), 255),
+                                      qBound(0, static_cast<int>(sumA / divisor + bias), 255));
+            }
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef FILTEREFFECTKERNELSSCALAR_H
+#define FILTEREFFECTKERNELSSCALAR_H
+
+#include "FilterEffectKernels.h"
+
+#include <QVector>
+
+/**
+ * The plain C++ implementation of the kernels.
+ *
+ * The vectorized implementations derive from it, to process the pixels
+ * which do not fill a whole vector.
+ */
+class FilterEffectKernelsScalar : public FilterEffectKernels
+{
+public:
+    virtual void blur(QRgb *pixels, int width, int height, int radius) const;
+    virtual void colorMatrix(const QRgb *src, QRgb *dst, int count, const qreal *matrix) const;
+    virtual void componentTransfer(const QRgb *src, QRgb *dst, int count, const TransferParameters *channels) const;
+    virtual void blend(const QRgb *src, QRgb *dst, int count, BlendMode mode) const;
+    virtual void arithmeticComposite(const QRgb *src, QRgb *dst, int count, const qreal *k) const;
+    virtual void morphology(const QRgb *src, QRgb *dst, int width, const QRect &rect, int rx, int ry, bool erode) const;
+    virtual void convolve(const QRgb *src, QRgb *dst, int width, int height, const QRect &rect,
+                          const ConvolveParameters &parameters) const;
+
+protected:
+    /**
+     * The intermediate results of the stack blur.
+     *
+     * The rows are blurred into the separate channel planes first, the
+     * columns are then blurred from the planes back into the image.
+     */
+    struct BlurBuffers {
+        BlurBuffers(int width, int height, int radius);
+
+        int width;
+        int height;
+        int radius;
+        QVector<int> division; ///< the sums divided by the number of weights
+        QVector<int> red;
+        QVector<int> green;
+        QVector<int> blue;
+        QVector<int> alpha;
+    };
+
+    /// Blurs the rows from @p firstRow up to, but excluding, @p endRow into the planes
+    void blurRows(const QRgb *pixels, BlurBuffers &buffers, int firstRow, int endRow) const;
+    /// Blurs the columns from @p firstColumn up to, but excluding, @p endColumn from the planes
+    void blurColumns(QRgb *pixels, const BlurBuffers &buffers, int firstColumn, int endColumn) const;
+
+    /**
+     * Erodes or dilates along the rows: each of the @p rows times @p columns
+     * pixels of @p dst gets the extreme of the @p src pixels within @p radius
+     * to the left and to the right of the pixel at the same position.
+     */
+    void morphologyRows(const QRgb *src, int srcStride, QRgb *dst, int dstStride,
+                        int rows, int columns, int radius, bool erode) const;
+    /**
+     * Erodes or dilates along the columns: each of the @p rows times @p columns
+     * pixels of @p dst gets the extreme of the 2 * @p radius + 1 @p src pixels
+     * in the same column from the same row on.
+     */
+    void morphologyColumns(const QRgb *src, int srcStride, QRgb *dst, int dstStride,
+                           int rows, int columns, int radius, bool erode) const;
+};
+
+#endif
@@ -23,6 +23,7 @@
 #include "KoViewConverter.h"
 #include "KoXmlWriter.h"
 #include "KoXmlReader.h"
+#include "FilterEffectKernels.h"
 #include <klocalizedstring.h>
 #include <QRect>
 #include <QImage>
@@ -66,59 +67,18 @@ QImage MorphologyEffect::processImage(const QImage &image, const KoFilterEffectR
     const int w = result.width();
     const int h = result.height();
 
-    // setup mask
-    const int maskSize = (1+2*rx)*(1+2*ry);
-    int * mask = new int[maskSize];
-    int index = 0;
-    for (int y = -ry; y <= ry; ++y) {
-        for (int x = -rx; x <= rx; ++x) {
-            mask[index] = y*w+x;
-            index++;
-        }
-    }
-
-    int dstPixel, srcPixel;
-    uchar s0, s1, s2, s3;
-    const uchar * src = image.constBits();
-    uchar * dst = result.bits();
-
     const QRect roi = context.filterRegion().toRect();
     const int minX = qMax(rx, roi.left());
     const int maxX = qMin(w-rx, roi.right());
     const int minY = qMax(ry, roi.top());
     const int maxY = qMin(h-ry, roi.bottom());
-    const int defValue = m_operator == Erode ? 255 : 0;
-
-    uchar * d = 0;
-
-    for (int row = minY; row < maxY; ++row) {
-        for (int col = minX; col < maxX; ++col) {
-            dstPixel = row * w + col;
-            s0 = s1 = s2 = s3 = defValue;
-            for (int i = 0; i < maskSize; ++i) {
-                srcPixel = dstPixel+mask[i];
-                const uchar *s = &src[4*srcPixel];
-                if (m_operator == Erode ) {
-                    s0 = qMin(s0, s[0]);
-                    s1 = qMin(s1, s[1]);
-                    s2 = qMin(s2, s[2]);
-                    s3 = qMin(s3, s[3]);
-                } else {
-                    s0 = qMax(s0, s[0]);
-                    s1 = qMax(s1, s[1]);
-                    s2 = qMax(s2, s[2]);
-                    s3 = qMax(s3, s[3]);
-                }
-            }
-            d = &dst[4*dstPixel];
-            d[0] = s0;
-            d[1] = s1;
-            d[2] = s2;
-            d[3] = s3;
-        }
-    }
+    if (rx < 0 || ry < 0 || minX >= maxX || minY >= maxY)
+        return result;
 
-    delete [] mask;
+    const QRgb *src = (const QRgb*)image.constBits();
+    QRgb *dst = (QRgb*)result.bits();
+    FilterEffectKernels::instance()->morphology(src, dst, w, QRect(QPoint(minX, minY), QPoint(maxX - 1, maxY - 1)),
+                                                rx, ry, m_operator == Erode);
 
     return result;
 }
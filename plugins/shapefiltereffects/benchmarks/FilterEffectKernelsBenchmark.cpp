@@ -0,0 +1,309 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "FilterEffectKernelsPerArch.h" // vc.h must come first
+#include "FilterEffectKernelsBenchmark.h"
+
+#include "FilterEffectKernels.h"
+
+#include <QTest>
+
+#include <cstdlib>
+
+const int IMG_WIDTH = 1024;
+const int IMG_HEIGHT = 1024;
+
+namespace
+{
+const qreal SaturateMatrix[20] = {
+    0.6063, 0.3576, 0.0361, 0.0, 0.0,
+    0.1063, 0.8576, 0.0361, 0.0, 0.0,
+    0.1063, 0.3576, 0.5361, 0.0, 0.0,
+    0.0,    0.0,    0.0,    1.0, 0.0
+};
+
+const qreal TableValues[5] = { 0.0, 0.6, 0.3, 0.8, 1.0 };
+
+const qreal ArithmeticCoefficients[4] = { 0.5, 0.5, 0.25, 0.0 };
+
+const qreal SharpenKernel[9] = {
+     0.0, -1.0,  0.0,
+    -1.0,  5.0, -1.0,
+     0.0, -1.0,  0.0
+};
+
+/// A premultiplied image with reproducible random pixels
+QImage randomImage(int seed)
+{
+    QImage image(IMG_WIDTH, IMG_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    srand(seed);
+    QRgb *pixels = (QRgb*)image.bits();
+    for (int i = 0; i < IMG_WIDTH * IMG_HEIGHT; ++i) {
+        const int alpha = rand() % 256;
+        pixels[i] = qRgba(rand() % (alpha + 1), rand() % (alpha + 1), rand() % (alpha + 1), alpha);
+    }
+    return image;
+}
+
+void transferParameters(FilterEffectKernels::TransferParameters *channels)
+{
+    channels[0].function = FilterEffectKernels::TransferTable;
+    channels[0].tableValues = TableValues;
+    channels[0].tableSize = 5;
+    channels[1].function = FilterEffectKernels::TransferDiscrete;
+    channels[1].tableValues = TableValues;
+    channels[1].tableSize = 5;
+    channels[2].function = FilterEffectKernels::TransferGamma;
+    channels[2].amplitude = 1.0;
+    channels[2].exponent = 0.5;
+    channels[3].function = FilterEffectKernels::TransferLinear;
+    channels[3].slope = 0.8;
+    channels[3].intercept = 0.1;
+}
+
+FilterEffectKernels::ConvolveParameters convolveParameters()
+{
+    FilterEffectKernels::ConvolveParameters parameters;
+    parameters.orderX = 3;
+    parameters.orderY = 3;
+    parameters.targetX = 1;
+    parameters.targetY = 1;
+    parameters.kernel = SharpenKernel;
+    parameters.divisor = 1.0;
+    parameters.bias = 0.0;
+    parameters.edgeMode = FilterEffectKernels::EdgeDuplicate;
+    parameters.preserveAlpha = false;
+    return parameters;
+}
+
+const QRect ImageRect(0, 0, IMG_WIDTH, IMG_HEIGHT);
+// the morphology kernel has to stay within the image
+const QRect MorphologyRect = ImageRect.adjusted(3, 3, -3, -3);
+} // namespace
+
+void FilterEffectKernelsBenchmark::initTestCase()
+{
+    m_scalar = FilterEffectKernelsFactory::create<Vc::ScalarImpl>(0);
+    m_optimized = createOptimizedClass<FilterEffectKernelsFactory>(0);
+    m_source = randomImage(1);
+    m_destination = randomImage(2);
+}
+
+void FilterEffectKernelsBenchmark::cleanupTestCase()
+{
+    delete m_scalar;
+    delete m_optimized;
+}
+
+void FilterEffectKernelsBenchmark::addImplementations()
+{
+    QTest::addColumn<QString>("implementation");
+
+    QTest::newRow("scalar") << "scalar";
+    QTest::newRow("optimized") << "optimized";
+}
+
+const FilterEffectKernels *FilterEffectKernelsBenchmark::kernels(const QString &implementation) const
+{
+    return implementation == "scalar" ? m_scalar : m_optimized;
+}
+
+QList<QImage> FilterEffectKernelsBenchmark::runKernels(const FilterEffectKernels *kernels) const
+{
+    const QRgb *src = (const QRgb*)m_source.constBits();
+    const int count = IMG_WIDTH * IMG_HEIGHT;
+    QList<QImage> results;
+
+    QImage result = m_source.copy();
+    kernels->blur((QRgb*)result.bits(), IMG_WIDTH, IMG_HEIGHT, 5);
+    results << result;
+
+    result = m_source.copy();
+    kernels->colorMatrix(src, (QRgb*)result.bits(), count, SaturateMatrix);
+    results << result;
+
+    FilterEffectKernels::TransferParameters channels[4];
+    transferParameters(channels);
+    result = m_source.copy();
+    kernels->componentTransfer(src, (QRgb*)result.bits(), count, channels);
+    results << result;
+
+    for (int mode = FilterEffectKernels::BlendNormal; mode <= FilterEffectKernels::BlendLighten; ++mode) {
+        result = m_destination.copy();
+        kernels->blend(src, (QRgb*)result.bits(), count, static_cast<FilterEffectKernels::BlendMode>(mode));
+        results << result;
+    }
+
+    result = m_destination.copy();
+    kernels->arithmeticComposite(src, (QRgb*)result.bits(), count, ArithmeticCoefficients);
+    results << result;
+
+    result = m_source.copy();
+    kernels->morphology(src, (QRgb*)result.bits(), IMG_WIDTH, MorphologyRect, 3, 2, true);
+    results << result;
+    result = m_source.copy();
+    kernels->morphology(src, (QRgb*)result.bits(), IMG_WIDTH, MorphologyRect, 2, 3, false);
+    results << result;
+
+    result = m_source.copy();
+    kernels->convolve(src, (QRgb*)result.bits(), IMG_WIDTH, IMG_HEIGHT, ImageRect, convolveParameters());
+    results << result;
+
+    return results;
+}
+
+void FilterEffectKernelsBenchmark::testResults()
+{
+    const QList<QImage> expected = runKernels(m_scalar);
+    const QList<QImage> actual = runKernels(m_optimized);
+    QCOMPARE(actual.count(), expected.count());
+
+    // the optimized kernels calculate with floats instead of doubles,
+    // so the channels may be off by one
+    for (int i = 0; i < expected.count(); ++i) {
+        const QRgb *e = (const QRgb*)expected[i].constBits();
+        const QRgb *a = (const QRgb*)actual[i].constBits();
+        for (int p = 0; p < IMG_WIDTH * IMG_HEIGHT; ++p) {
+            if (qAbs(qRed(e[p]) - qRed(a[p])) > 1 || qAbs(qGreen(e[p]) - qGreen(a[p])) > 1
+                    || qAbs(qBlue(e[p]) - qBlue(a[p])) > 1 || qAbs(qAlpha(e[p]) - qAlpha(a[p])) > 1) {
+                QFAIL(qPrintable(QString("kernel %1 differs at pixel %2: expected %3, actual %4")
+                                 .arg(i).arg(p).arg(e[p], 8, 16, QChar('0')).arg(a[p], 8, 16, QChar('0'))));
+            }
+        }
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkBlur_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkBlur()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    QImage result = m_source.copy();
+    QBENCHMARK {
+        k->blur((QRgb*)result.bits(), IMG_WIDTH, IMG_HEIGHT, 5);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkColorMatrix_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkColorMatrix()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    QImage result = m_source.copy();
+    QBENCHMARK {
+        k->colorMatrix((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH * IMG_HEIGHT, SaturateMatrix);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkComponentTransfer_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkComponentTransfer()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    FilterEffectKernels::TransferParameters channels[4];
+    transferParameters(channels);
+    QImage result = m_source.copy();
+    QBENCHMARK {
+        k->componentTransfer((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH * IMG_HEIGHT, channels);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkBlend_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkBlend()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    QImage result = m_destination.copy();
+    QBENCHMARK {
+        k->blend((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH * IMG_HEIGHT,
+                 FilterEffectKernels::BlendMultiply);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkArithmeticComposite_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkArithmeticComposite()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    QImage result = m_destination.copy();
+    QBENCHMARK {
+        k->arithmeticComposite((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH * IMG_HEIGHT,
+                               ArithmeticCoefficients);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkMorphology_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkMorphology()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    QImage result = m_source.copy();
+    QBENCHMARK {
+        k->morphology((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH, MorphologyRect, 3, 3, true);
+    }
+}
+
+void FilterEffectKernelsBenchmark::benchmarkConvolve_data()
+{
+    addImplementations();
+}
+
+void FilterEffectKernelsBenchmark::benchmarkConvolve()
+{
+    QFETCH(QString, implementation);
+    const FilterEffectKernels *k = kernels(implementation);
+
+    const FilterEffectKernels::ConvolveParameters parameters = convolveParameters();
+    QImage result = m_source.copy();
+    QBENCHMARK {
+        k->convolve((const QRgb*)m_source.constBits(), (QRgb*)result.bits(), IMG_WIDTH, IMG_HEIGHT, ImageRect, parameters);
+    }
+}
+
+QTEST_MAIN(FilterEffectKernelsBenchmark)
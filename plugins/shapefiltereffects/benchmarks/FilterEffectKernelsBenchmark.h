@@ -0,0 +1,71 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef FILTEREFFECTKERNELS_BENCHMARK_H
+#define FILTEREFFECTKERNELS_BENCHMARK_H
+
+#include <QImage>
+#include <QObject>
+
+class FilterEffectKernels;
+
+/**
+ * Compares the optimized filter effect kernels with the scalar ones.
+ *
+ * Each benchmark runs once with the \c scalar and once with the
+ * \c optimized kernels, which are the best supported by the CPU.
+ */
+class FilterEffectKernelsBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testResults();
+
+    void benchmarkBlur_data();
+    void benchmarkBlur();
+    void benchmarkColorMatrix_data();
+    void benchmarkColorMatrix();
+    void benchmarkComponentTransfer_data();
+    void benchmarkComponentTransfer();
+    void benchmarkBlend_data();
+    void benchmarkBlend();
+    void benchmarkArithmeticComposite_data();
+    void benchmarkArithmeticComposite();
+    void benchmarkMorphology_data();
+    void benchmarkMorphology();
+    void benchmarkConvolve_data();
+    void benchmarkConvolve();
+
+private:
+    void addImplementations();
+    const FilterEffectKernels *kernels(const QString &implementation) const;
+
+    /// Runs all kernels with @p kernels on copies of the images
+    QList<QImage> runKernels(const FilterEffectKernels *kernels) const;
+
+    FilterEffectKernels *m_scalar;
+    FilterEffectKernels *m_optimized;
+    QImage m_source;
+    QImage m_destination;
+};
+
+#endif
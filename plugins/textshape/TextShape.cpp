@@ -59,10 +59,29 @@
 #include <QFont>
 #include <QPainter>
 #include <QPen>
+#include <QTextBlock>
+#include <QTextDocument>
 #include <QTextLayout>
 
 #include <QDebug>
 
+// Returns false if the selection is known to be outside of the vertical range from top to bottom
+static bool selectionMayIntersect(const QTextCursor &cursor, qreal top, qreal bottom)
+{
+    QTextDocument *document = cursor.document();
+    // only the blocks of the root frame are laid out one below the other
+    if (document->frameAt(cursor.selectionStart()) != document->rootFrame()
+            || document->frameAt(cursor.selectionEnd()) != document->rootFrame()) {
+        return true;
+    }
+    QTextLayout *first = document->findBlock(cursor.selectionStart()).layout();
+    QTextLayout *last = document->findBlock(cursor.selectionEnd()).layout();
+    if (!first || !last || first->lineCount() == 0 || last->lineCount() == 0) {
+        return true;
+    }
+    return first->boundingRect().top() <= bottom && last->boundingRect().bottom() >= top;
+}
+
 TextShape::TextShape(KoInlineTextObjectManager *inlineTextObjectManager, KoTextRangeManager *textRangeManager)
         : KoShapeContainer(new KoTextShapeContainerModel())
         , KoFrameShape(KoXmlNS::draw, "text-box")
@@ -156,7 +175,14 @@ void TextShape::paintComponent(QPainter &painter, const KoViewConverter &convert
     selection.format.setForeground(palette.brush(QPalette::HighlightedText));
     pc.textContext.selections.append(selection);
 
-    pc.textContext.selections += KoTextDocument(doc).selections();
+    // Only the selections within the root area are painted; there may be lots of
+    // selections, e.g. when all matches of a search are highlighted.
+    const QRectF rootAreaRect = m_textShapeData->rootArea()->boundingRect();
+    foreach (const QAbstractTextDocumentLayout::Selection &docSelection, KoTextDocument(doc).selections()) {
+        if (selectionMayIntersect(docSelection.cursor, rootAreaRect.top(), rootAreaRect.bottom())) {
+            pc.textContext.selections.append(docSelection);
+        }
+    }
     pc.viewConverter = &converter;
     pc.imageCollection = m_imageCollection;
     pc.showFormattingCharacters = paintContext.showFormattingCharacters;
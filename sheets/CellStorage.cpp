@@ -34,10 +34,12 @@
 
 // Sheets
 #include "BindingStorage.h"
+#include "ColumnarValueStorage.h"
 #include "ConditionsStorage.h"
 #include "Damages.h"
 #include "DependencyManager.h"
 #include "FormulaStorage.h"
+#include "LookupCache.h"
 #include "Map.h"
 #include "ModelSupport.h"
 #include "RecalcManager.h"
@@ -83,7 +85,10 @@ public:
             , valueStorage(new ValueStorage())
             , richTextStorage(new RichTextStorage())
             , rowRepeatStorage(new RowRepeatStorage())
+            , columnarValueStorage(0)
             , undoData(0)
+            , bulkInsertion(false)
+            , bulkFormulas(false)
 #ifdef CALLIGRA_SHEETS_MT
             , bigUglyLock(QReadWriteLock::Recursive)
 #endif
@@ -106,11 +111,19 @@ public:
             , valueStorage(new ValueStorage(*other.valueStorage))
             , richTextStorage(new RichTextStorage(*other.richTextStorage))
             , rowRepeatStorage(new RowRepeatStorage(*other.rowRepeatStorage))
+            , columnarValueStorage(0)
             , undoData(0)
+            , bulkInsertion(false)
+            , bulkFormulas(false)
 #ifdef CALLIGRA_SHEETS_MT
             , bigUglyLock(QReadWriteLock::Recursive)
 #endif
-    {}
+    {
+        if (other.columnarValueStorage) {
+            columnarValueStorage = new ColumnarValueStorage();
+            columnarValueStorage->rebuild(*valueStorage);
+        }
+    }
 
     ~Private() {
         delete bindingStorage;
@@ -128,10 +141,17 @@ public:
         delete valueStorage;
         delete richTextStorage;
         delete rowRepeatStorage;
+        delete columnarValueStorage;
     }
 
     void createCommand(KUndo2Command *parent) const;
 
+    // Structural changes move lots of values; the lookup indices of the
+    // sheet are dropped.
+    void valuesMoved() {
+        sheet->map()->dependencyManager()->lookupCache()->invalidate(sheet);
+    }
+
     Sheet*                  sheet;
     BindingStorage*         bindingStorage;
     CommentStorage*         commentStorage;
@@ -148,7 +168,11 @@ public:
     ValueStorage*           valueStorage;
     RichTextStorage*        richTextStorage;
     RowRepeatStorage*       rowRepeatStorage;
+    ColumnarValueStorage*   columnarValueStorage;
     CellStorageUndoData*    undoData;
+    bool                    bulkInsertion;
+    QRect                   bulkRect;
+    bool                    bulkFormulas;
 
 #ifdef CALLIGRA_SHEETS_MT
     QReadWriteLock bigUglyLock;
@@ -274,6 +298,10 @@ void CellStorage::take(int col, int row)
     oldLink = d->linkStorage->take(col, row);
     oldUserInput = d->userInputStorage->take(col, row);
     oldValue = d->valueStorage->take(col, row);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->take(col, row);
+    if (!oldValue.isEmpty())
+        d->sheet->map()->dependencyManager()->valuesChanged(d->sheet, QRect(col, row, 1, 1));
     oldRichText = d->richTextStorage->take(col, row);
 
     if (!d->sheet->map()->isLoading()) {
@@ -687,9 +715,14 @@ void CellStorage::setValue(int column, int row, const Value& value)
         old = d->valueStorage->take(column, row);
     else
         old = d->valueStorage->insert(column, row, value);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->insert(column, row, value);
 
     // value changed?
     if (value != old) {
+        // The lookup indices have to be dropped at once; the formulas
+        // depending on this cell may get evaluated before the damage arrives.
+        d->sheet->map()->dependencyManager()->valuesChanged(d->sheet, QRect(column, row, 1, 1));
         if (!d->sheet->map()->isLoading()) {
             // Always trigger a repainting and a binding update.
             CellDamage::Changes changes = CellDamage::Appearance | CellDamage::Binding;
@@ -965,6 +998,9 @@ void CellStorage::insertColumns(int position, int number)
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->insertColumns(position, number);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->insertColumns(position, number);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->insertColumns(position, number);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->insertColumns(position, number);
+    d->valuesMoved();
     // recording undo?
     if (d->undoData) {
         d->undoData->bindings   << bindings;
@@ -1024,6 +1060,9 @@ void CellStorage::removeColumns(int position, int number)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->removeColumns(position, number);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->removeColumns(position, number);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->removeColumns(position, number);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->removeColumns(position, number);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->removeColumns(position, number);
     // recording undo?
     if (d->undoData) {
@@ -1083,6 +1122,9 @@ void CellStorage::insertRows(int position, int number)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->insertRows(position, number);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->insertRows(position, number);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->insertRows(position, number);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->insertRows(position, number);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->insertRows(position, number);
     // recording undo?
     if (d->undoData) {
@@ -1145,6 +1187,9 @@ void CellStorage::removeRows(int position, int number)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->removeRows(position, number);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->removeRows(position, number);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->removeRows(position, number);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->removeRows(position, number);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->removeRows(position, number);
     // recording undo?
     if (d->undoData) {
@@ -1207,6 +1252,9 @@ void CellStorage::removeShiftLeft(const QRect& rect)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->removeShiftLeft(rect);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->removeShiftLeft(rect);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->removeShiftLeft(rect);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->removeShiftLeft(rect);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->removeShiftLeft(rect);
     // recording undo?
     if (d->undoData) {
@@ -1268,6 +1316,9 @@ void CellStorage::insertShiftRight(const QRect& rect)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->insertShiftRight(rect);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->insertShiftRight(rect);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->insertShiftRight(rect);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->insertShiftRight(rect);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->insertShiftRight(rect);
     // recording undo?
     if (d->undoData) {
@@ -1330,6 +1381,9 @@ void CellStorage::removeShiftUp(const QRect& rect)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->removeShiftUp(rect);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->removeShiftUp(rect);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->removeShiftUp(rect);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->removeShiftUp(rect);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->removeShiftUp(rect);
     // recording undo?
     if (d->undoData) {
@@ -1391,6 +1445,9 @@ void CellStorage::insertShiftDown(const QRect& rect)
     QVector< QPair<QPoint, QString> > userInputs = d->userInputStorage->insertShiftDown(rect);
     QList< QPair<QRectF, Validity> > validities = d->validityStorage->insertShiftDown(rect);
     QVector< QPair<QPoint, Value> > values = d->valueStorage->insertShiftDown(rect);
+    if (d->columnarValueStorage)
+        d->columnarValueStorage->insertShiftDown(rect);
+    d->valuesMoved();
     QVector< QPair<QPoint, QSharedPointer<QTextDocument> > > richTexts = d->richTextStorage->insertShiftDown(rect);
     // recording undo?
     if (d->undoData) {
@@ -1676,6 +1733,27 @@ const ValueStorage* CellStorage::valueStorage() const
     return d->valueStorage;
 }
 
+void CellStorage::setColumnarValueStorageEnabled(bool enable)
+{
+#ifdef CALLIGRA_SHEETS_MT
+    QWriteLocker(&d->bigUglyLock);
+#endif
+    if (enable == (d->columnarValueStorage != 0))
+        return;
+    if (enable) {
+        d->columnarValueStorage = new ColumnarValueStorage();
+        d->columnarValueStorage->rebuild(*d->valueStorage);
+    } else {
+        delete d->columnarValueStorage;
+        d->columnarValueStorage = 0;
+    }
+}
+
+const ColumnarValueStorage* CellStorage::columnarValueStorage() const
+{
+    return d->columnarValueStorage;
+}
+
 void CellStorage::startUndoRecording()
 {
 #ifdef CALLIGRA_SHEETS_MT
@@ -1704,6 +1782,89 @@ void CellStorage::stopUndoRecording(KUndo2Command *parent)
     d->undoData = 0;
 }
 
+void CellStorage::beginBulkInsertion()
+{
+    d->bulkInsertion = true;
+}
+
+void CellStorage::endBulkInsertion()
+{
+    if (!d->bulkInsertion)
+        return;
+    const QRect rect = d->bulkRect;
+    const bool formulas = d->bulkFormulas;
+    d->bulkInsertion = false;
+    d->bulkRect = QRect();
+    d->bulkFormulas = false;
+    if (rect.isEmpty())
+        return;
+
+    Map* const map = d->sheet->map();
+    map->dependencyManager()->valuesChanged(d->sheet, rect);
+    // The dependencies and values get updated, once the loading completes.
+    if (map->isLoading())
+        return;
+    for (int row = rect.top(); row <= rect.bottom(); ++row)
+        d->rowRepeatStorage->setRowRepeat(row, 1);
+    CellDamage::Changes changes = CellDamage::Appearance | CellDamage::Binding;
+    if (formulas)
+        changes |= CellDamage::Formula;
+    if (!map->recalcManager()->isActive())
+        changes |= CellDamage::Value;
+    map->addDamage(new CellDamage(d->sheet, Region(rect, d->sheet), changes));
+}
+
+void CellStorage::insertRow(int row, int column, const QStringList& userInputs, const QVector<Value>& values,
+                            const QVector<Formula>& formulas, const QVector<Style>& styles)
+{
+    const int count = qMax(qMax(userInputs.count(), values.count()), qMax(formulas.count(), styles.count()));
+    if (count == 0)
+        return;
+    const bool singleRow = !d->bulkInsertion;
+    if (singleRow)
+        beginBulkInsertion();
+    {
+#ifdef CALLIGRA_SHEETS_MT
+        QWriteLocker(&d->bigUglyLock);
+#endif
+        // The lookups avoid the costlier removals from empty cells.
+        for (int i = 0; i < count; ++i) {
+            const int col = column + i;
+            if (i < formulas.count() && !formulas[i].expression().isEmpty()) {
+                d->formulaStorage->insert(col, row, formulas[i]);
+                d->bulkFormulas = true;
+            } else if (!d->formulaStorage->lookup(col, row).expression().isEmpty()) {
+                d->formulaStorage->take(col, row);
+                d->bulkFormulas = true;
+            }
+            if (i < userInputs.count() && !userInputs[i].isEmpty())
+                d->userInputStorage->insert(col, row, userInputs[i]);
+            else if (!d->userInputStorage->lookup(col, row).isEmpty())
+                d->userInputStorage->take(col, row);
+            if (i < values.count() && !values[i].isEmpty()) {
+                d->valueStorage->insert(col, row, values[i]);
+                if (d->columnarValueStorage)
+                    d->columnarValueStorage->insert(col, row, values[i]);
+            } else if (!d->valueStorage->lookup(col, row).isEmpty()) {
+                d->valueStorage->take(col, row);
+                if (d->columnarValueStorage)
+                    d->columnarValueStorage->take(col, row);
+            }
+        }
+        for (int i = 0; i < styles.count();) {
+            int next = i + 1;
+            while (next < styles.count() && styles[next] == styles[i])
+                ++next;
+            if (!styles[i].isEmpty())
+                d->styleStorage->insert(Region(QRect(column + i, row, next - i, 1), d->sheet), styles[i]);
+            i = next;
+        }
+        d->bulkRect |= QRect(column, row, count, 1);
+    }
+    if (singleRow)
+        endBulkInsertion();
+}
+
 void CellStorage::loadConditions(const QList<QPair<QRegion, Conditions> >& conditions)
 {
 #ifdef CALLIGRA_SHEETS_MT
@@ -1725,6 +1886,11 @@ void CellStorage::invalidateStyleCache()
     d->styleStorage->invalidateCache();
 }
 
+void CellStorage::invalidateStyleCache(const Region& region)
+{
+    d->styleStorage->invalidateCache(region);
+}
+
 int CellStorage::rowRepeat(int row) const
 {
 #ifdef CALLIGRA_SHEETS_MT
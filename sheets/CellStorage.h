@@ -22,7 +22,9 @@
 
 #include <QPair>
 #include <QRect>
+#include <QStringList>
 #include <QTextDocument>
+#include <QVector>
 
 #include "Cell.h"
 #include "calligra_sheets_limits.h"
@@ -39,6 +41,7 @@ namespace Sheets
 class Binding;
 class BindingStorage;
 class Cell;
+class ColumnarValueStorage;
 class CommentStorage;
 class Conditions;
 class ConditionsStorage;
@@ -384,10 +387,29 @@ public:
     const ValidityStorage* validityStorage() const;
     const ValueStorage* valueStorage() const;
 
+    /**
+     * Enables or disables the columnar copy of the values.
+     * If enabled, each value change is mirrored into a ColumnarValueStorage,
+     * that provides typed, contiguous per-column arrays for range functions.
+     * It pays off for large, numeric-heavy sheets; it is off by default.
+     * The copy comes on top of the ValueStorage; see ColumnarValueStorage
+     * for its memory use.
+     * \see columnarValueStorage
+     * \see Sheet::setColumnarStorageEnabled
+     */
+    void setColumnarValueStorageEnabled(bool enable);
+
+    /**
+     * \return the columnar copy of the values or zero, if it is disabled
+     * \see setColumnarValueStorageEnabled
+     */
+    const ColumnarValueStorage* columnarValueStorage() const;
+
     void loadConditions(const QList<QPair<QRegion, Conditions> >& conditions);
     void loadStyles(const QList<QPair<QRegion, Style> >& styles);
 
     void invalidateStyleCache();
+    void invalidateStyleCache(const Region& region);
 
     /**
      * Starts the undo recording.
@@ -405,6 +427,40 @@ public:
      */
     void stopUndoRecording(KUndo2Command *parent);
 
+    /**
+     * Starts a bulk insertion.
+     * Until endBulkInsertion() is called, the rows passed to insertRow() are
+     * written without undo recording, damages or dependency updates.
+     * Meant for filling empty areas, e.g. by import filters.
+     * \see insertRow
+     * \see endBulkInsertion
+     */
+    void beginBulkInsertion();
+
+    /**
+     * Ends a bulk insertion.
+     * A single damage for the area covering all inserted rows is emitted,
+     * which updates the dependencies and values once. While the map is
+     * loading, this is left to the completion of the loading.
+     * \see beginBulkInsertion
+     */
+    void endBulkInsertion();
+
+    /**
+     * Inserts the cells of \p row starting at \p column in one pass.
+     * The n-th cell gets the n-th entries of \p userInputs, \p values,
+     * \p formulas and \p styles. The user input, value and formula of a
+     * cell are replaced; missing or empty entries clear them. The styles
+     * are added to the existing ones, and adjacent cells with equal styles
+     * share one style rectangle.
+     * The formulas have to be created for their target cells.
+     * Outside of a bulk insertion, the row is inserted as a bulk of its own.
+     * \see beginBulkInsertion
+     */
+    void insertRow(int row, int column, const QStringList& userInputs, const QVector<Value>& values,
+                   const QVector<Formula>& formulas = QVector<Formula>(),
+                   const QVector<Style>& styles = QVector<Style>());
+
 Q_SIGNALS:
     void insertNamedArea(const Region&, const QString&);
     void namedAreaRemoved(const QString&);
@@ -0,0 +1,564 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// Local
+#include "ColumnarValueStorage.h"
+
+// C++
+#include <cstring>
+
+// Qt
+#include <QHash>
+#include <QMap>
+
+// Sheets
+#include "calligra_sheets_limits.h"
+#include "Value.h"
+#include "ValueStorage.h"
+
+using namespace Calligra::Sheets;
+
+namespace
+{
+// The rows start at 1; block 0 holds the rows 1 to BlockSize.
+inline int blockIndex(int row)
+{
+    return (row - 1) / ColumnarValueStorage::BlockSize;
+}
+
+inline int blockOffset(int row)
+{
+    return (row - 1) % ColumnarValueStorage::BlockSize;
+}
+
+inline int firstRowOfBlock(int index)
+{
+    return index * ColumnarValueStorage::BlockSize + 1;
+}
+
+struct Block {
+    Block() : count(0) {
+        memset(numbers, 0, sizeof(numbers));
+        memset(kinds, 0, sizeof(kinds));
+        memset(formats, 0, sizeof(formats));
+    }
+
+    double numbers[ColumnarValueStorage::BlockSize];
+    quint8 kinds[ColumnarValueStorage::BlockSize];
+    quint8 formats[ColumnarValueStorage::BlockSize];
+    // The values of kind Other by row offset.
+    QHash<int, Value> exact;
+    int count;
+};
+
+// block index -> block
+typedef QMap<int, Block*> Column;
+
+// A cell taken out of its block, while its values are moved.
+struct Entry {
+    int column;
+    int row;
+    double number;
+    quint8 kind;
+    quint8 format;
+    Value exact;
+};
+
+// Interned items with reference counts. Released slots are reused, so the
+// table does not grow beyond the number of distinct items in use.
+template<typename T>
+class InternTable
+{
+public:
+    int intern(const QString& key, const T& item) {
+        QHash<QString, int>::ConstIterator it = m_indices.constFind(key);
+        if (it != m_indices.constEnd()) {
+            ++m_references[it.value()];
+            return it.value();
+        }
+        int index;
+        if (m_free.isEmpty()) {
+            index = m_items.count();
+            m_items.append(item);
+            m_keys.append(key);
+            m_references.append(1);
+        } else {
+            index = m_free.takeLast();
+            m_items[index] = item;
+            m_keys[index] = key;
+            m_references[index] = 1;
+        }
+        m_indices.insert(key, index);
+        return index;
+    }
+
+    void release(int index) {
+        Q_ASSERT(index >= 0 && index < m_references.count() && m_references[index] > 0);
+        if (--m_references[index] > 0)
+            return;
+        m_indices.remove(m_keys[index]);
+        m_items[index] = T();
+        m_keys[index] = QString();
+        m_free.append(index);
+    }
+
+    T item(int index) const {
+        return m_items.value(index);
+    }
+
+    int count() const {
+        return m_indices.count();
+    }
+
+    void clear() {
+        m_items.clear();
+        m_keys.clear();
+        m_references.clear();
+        m_indices.clear();
+        m_free.clear();
+    }
+
+private:
+    QVector<T> m_items;
+    QVector<QString> m_keys;
+    QVector<int> m_references;
+    QHash<QString, int> m_indices;
+    QVector<int> m_free;
+};
+} // namespace
+
+class Q_DECL_HIDDEN ColumnarValueStorage::Private
+{
+public:
+    Private() : count(0) {}
+
+    Block* block(int column, int row) const;
+    void release(quint8 kind, double number);
+    void releaseColumn(const Column& blocks);
+    void clearCell(Block* block, int offset);
+    void extract(const QRect& rect, QVector<Entry>& entries);
+    void place(const Entry& entry);
+    void erase(const QRect& rect);
+    void shift(const QRect& rect, int dx, int dy);
+
+    // column -> blocks
+    QMap<int, Column> columns;
+    InternTable<QString> strings;
+    InternTable<Value> errors;
+    int count;
+};
+
+Block* ColumnarValueStorage::Private::block(int column, int row) const
+{
+    const QMap<int, Column>::ConstIterator cit = columns.constFind(column);
+    if (cit == columns.constEnd())
+        return 0;
+    return cit.value().value(blockIndex(row));
+}
+
+void ColumnarValueStorage::Private::release(quint8 kind, double number)
+{
+    if (kind == String)
+        strings.release(int(number));
+    else if (kind == Error)
+        errors.release(int(number));
+}
+
+void ColumnarValueStorage::Private::releaseColumn(const Column& blocks)
+{
+    Column::ConstIterator end = blocks.constEnd();
+    for (Column::ConstIterator bit = blocks.constBegin(); bit != end; ++bit) {
+        const Block* block = bit.value();
+        for (int offset = 0; offset < BlockSize; ++offset)
+            release(block->kinds[offset], block->numbers[offset]);
+        count -= block->count;
+        delete block;
+    }
+}
+
+void ColumnarValueStorage::Private::clearCell(Block* block, int offset)
+{
+    block->numbers[offset] = 0.0;
+    block->kinds[offset] = Empty;
+    block->formats[offset] = Value::fmt_None;
+    block->exact.remove(offset);
+    --block->count;
+    --count;
+}
+
+// Takes the cells in rect out of the storage. The interned strings and
+// errors stay referenced by the entries.
+void ColumnarValueStorage::Private::extract(const QRect& rect, QVector<Entry>& entries)
+{
+    const int firstBlock = blockIndex(qMax(1, rect.top()));
+    const int lastBlock = blockIndex(rect.bottom());
+    QMap<int, Column>::Iterator cit = columns.lowerBound(rect.left());
+    while (cit != columns.end() && cit.key() <= rect.right()) {
+        Column& blocks = cit.value();
+        Column::Iterator bit = blocks.lowerBound(firstBlock);
+        while (bit != blocks.end() && bit.key() <= lastBlock) {
+            Block* block = bit.value();
+            const int blockStart = firstRowOfBlock(bit.key());
+            const int first = qMax(rect.top(), blockStart) - blockStart;
+            const int last = qMin(rect.bottom(), blockStart + BlockSize - 1) - blockStart;
+            for (int offset = first; offset <= last && block->count > 0; ++offset) {
+                if (block->kinds[offset] == Empty)
+                    continue;
+                Entry entry;
+                entry.column = cit.key();
+                entry.row = blockStart + offset;
+                entry.number = block->numbers[offset];
+                entry.kind = block->kinds[offset];
+                entry.format = block->formats[offset];
+                if (entry.kind == Other)
+                    entry.exact = block->exact.value(offset);
+                entries.append(entry);
+                clearCell(block, offset);
+            }
+            if (block->count == 0) {
+                delete block;
+                bit = blocks.erase(bit);
+            } else
+                ++bit;
+        }
+        if (blocks.isEmpty())
+            cit = columns.erase(cit);
+        else
+            ++cit;
+    }
+}
+
+// Puts an extracted cell back; drops it, if it is out of range.
+void ColumnarValueStorage::Private::place(const Entry& entry)
+{
+    if (entry.column < 1 || entry.column > KS_colMax || entry.row < 1 || entry.row > KS_rowMax) {
+        release(entry.kind, entry.number);
+        return;
+    }
+    Block*& block = columns[entry.column][blockIndex(entry.row)];
+    if (!block)
+        block = new Block();
+    const int offset = blockOffset(entry.row);
+    if (block->kinds[offset] == Empty) {
+        ++block->count;
+        ++count;
+    } else
+        release(block->kinds[offset], block->numbers[offset]);
+    block->numbers[offset] = entry.number;
+    block->kinds[offset] = entry.kind;
+    block->formats[offset] = entry.format;
+    if (entry.kind == Other)
+        block->exact.insert(offset, entry.exact);
+    else
+        block->exact.remove(offset);
+}
+
+void ColumnarValueStorage::Private::erase(const QRect& rect)
+{
+    QVector<Entry> entries;
+    extract(rect, entries);
+    for (int i = 0; i < entries.count(); ++i)
+        release(entries[i].kind, entries[i].number);
+}
+
+// Moves the cells in rect by dx columns and dy rows. Only the moved cells
+// are touched, not the whole sheet.
+void ColumnarValueStorage::Private::shift(const QRect& rect, int dx, int dy)
+{
+    QVector<Entry> entries;
+    extract(rect, entries);
+    for (int i = 0; i < entries.count(); ++i) {
+        entries[i].column += dx;
+        entries[i].row += dy;
+        place(entries[i]);
+    }
+}
+
+
+ColumnarValueStorage::ColumnarValueStorage()
+        : d(new Private)
+{
+}
+
+ColumnarValueStorage::~ColumnarValueStorage()
+{
+    clear();
+    delete d;
+}
+
+void ColumnarValueStorage::clear()
+{
+    QMap<int, Column>::ConstIterator end = d->columns.constEnd();
+    for (QMap<int, Column>::ConstIterator cit = d->columns.constBegin(); cit != end; ++cit)
+        qDeleteAll(cit.value());
+    d->columns.clear();
+    d->strings.clear();
+    d->errors.clear();
+    d->count = 0;
+}
+
+void ColumnarValueStorage::rebuild(const ValueStorage& storage)
+{
+    clear();
+    // The point storage is ordered row-wise. Filling the blocks does not
+    // depend on the order, so just walk it once.
+    for (int i = 0; i < storage.count(); ++i)
+        insert(storage.col(i), storage.row(i), storage.data(i));
+}
+
+void ColumnarValueStorage::insert(int column, int row, const Value& value)
+{
+    if (value.isEmpty()) {
+        take(column, row);
+        return;
+    }
+
+    Entry entry;
+    entry.column = column;
+    entry.row = row;
+    entry.number = 0.0;
+    entry.kind = Other;
+    entry.format = value.format();
+    switch (value.type()) {
+    case Value::Boolean:
+        entry.kind = Boolean;
+        entry.number = value.asBoolean() ? 1.0 : 0.0;
+        break;
+    case Value::Integer: {
+        const qint64 integer = value.asInteger();
+        const double number = double(integer);
+        // beyond 2^53 the double would be off
+        if (qint64(number) == integer) {
+            entry.kind = Integer;
+            entry.number = number;
+        }
+        break;
+    }
+    case Value::Float: {
+        const Number exact = value.asFloat();
+        const double number = double(numToDouble(exact));
+        // the range functions have to see the same number as the value
+        if (Number(number) == exact) {
+            entry.kind = Float;
+            entry.number = number;
+        }
+        break;
+    }
+    case Value::String:
+        entry.kind = String;
+        entry.number = d->strings.intern(value.asString(), value.asString());
+        break;
+    case Value::Error:
+        entry.kind = Error;
+        entry.number = d->errors.intern(value.errorMessage(), value);
+        break;
+    default:
+        break;
+    }
+    if (entry.kind == Other)
+        entry.exact = value;
+    d->place(entry);
+}
+
+void ColumnarValueStorage::take(int column, int row)
+{
+    QMap<int, Column>::Iterator cit = d->columns.find(column);
+    if (cit == d->columns.end())
+        return;
+    Column::Iterator bit = cit.value().find(blockIndex(row));
+    if (bit == cit.value().end())
+        return;
+    Block* block = bit.value();
+    const int offset = blockOffset(row);
+    if (block->kinds[offset] == Empty)
+        return;
+
+    d->release(block->kinds[offset], block->numbers[offset]);
+    d->clearCell(block, offset);
+    if (block->count == 0) {
+        delete block;
+        cit.value().erase(bit);
+        if (cit.value().isEmpty())
+            d->columns.erase(cit);
+    }
+}
+
+void ColumnarValueStorage::insertColumns(int position, int number)
+{
+    // whole columns are moved by their key
+    QMap<int, Column> columns;
+    QMap<int, Column>::ConstIterator end = d->columns.constEnd();
+    for (QMap<int, Column>::ConstIterator cit = d->columns.constBegin(); cit != end; ++cit) {
+        if (cit.key() < position)
+            columns.insert(cit.key(), cit.value());
+        else if (cit.key() + number <= KS_colMax)
+            columns.insert(cit.key() + number, cit.value());
+        else
+            d->releaseColumn(cit.value());
+    }
+    d->columns = columns;
+}
+
+void ColumnarValueStorage::removeColumns(int position, int number)
+{
+    QMap<int, Column> columns;
+    QMap<int, Column>::ConstIterator end = d->columns.constEnd();
+    for (QMap<int, Column>::ConstIterator cit = d->columns.constBegin(); cit != end; ++cit) {
+        if (cit.key() < position)
+            columns.insert(cit.key(), cit.value());
+        else if (cit.key() >= position + number)
+            columns.insert(cit.key() - number, cit.value());
+        else
+            d->releaseColumn(cit.value());
+    }
+    d->columns = columns;
+}
+
+void ColumnarValueStorage::insertRows(int position, int number)
+{
+    d->shift(QRect(QPoint(1, position), QPoint(KS_colMax, KS_rowMax)), 0, number);
+}
+
+void ColumnarValueStorage::removeRows(int position, int number)
+{
+    d->erase(QRect(1, position, KS_colMax, number));
+    d->shift(QRect(QPoint(1, position + number), QPoint(KS_colMax, KS_rowMax)), 0, -number);
+}
+
+void ColumnarValueStorage::removeShiftLeft(const QRect& rect)
+{
+    d->erase(rect);
+    d->shift(QRect(QPoint(rect.right() + 1, rect.top()), QPoint(KS_colMax, rect.bottom())), -rect.width(), 0);
+}
+
+void ColumnarValueStorage::insertShiftRight(const QRect& rect)
+{
+    d->shift(QRect(QPoint(rect.left(), rect.top()), QPoint(KS_colMax, rect.bottom())), rect.width(), 0);
+}
+
+void ColumnarValueStorage::removeShiftUp(const QRect& rect)
+{
+    d->erase(rect);
+    d->shift(QRect(QPoint(rect.left(), rect.bottom() + 1), QPoint(rect.right(), KS_rowMax)), 0, -rect.height());
+}
+
+void ColumnarValueStorage::insertShiftDown(const QRect& rect)
+{
+    d->shift(QRect(QPoint(rect.left(), rect.top()), QPoint(rect.right(), KS_rowMax)), 0, rect.height());
+}
+
+ColumnarValueStorage::Kind ColumnarValueStorage::kind(int column, int row) const
+{
+    const Block* block = d->block(column, row);
+    return block ? static_cast<Kind>(block->kinds[blockOffset(row)]) : Empty;
+}
+
+Value ColumnarValueStorage::value(int column, int row) const
+{
+    const Block* block = d->block(column, row);
+    if (!block)
+        return Value();
+    const int offset = blockOffset(row);
+    const double number = block->numbers[offset];
+    Value value;
+    switch (block->kinds[offset]) {
+    case Boolean:
+        value = Value(number != 0.0);
+        break;
+    case Integer:
+        value = Value(qint64(number));
+        break;
+    case Float:
+        value = Value(number);
+        break;
+    case String:
+        value = Value(d->strings.item(int(number)));
+        break;
+    case Error:
+        return d->errors.item(int(number));
+    case Other:
+        return block->exact.value(offset);
+    default:
+        return Value();
+    }
+    value.setFormat(static_cast<Value::Format>(block->formats[offset]));
+    return value;
+}
+
+QVector<ColumnarValueStorage::Segment> ColumnarValueStorage::segments(const QRect& rect) const
+{
+    QVector<Segment> result;
+    if (rect.isEmpty())
+        return result;
+
+    const int firstBlock = blockIndex(qMax(1, rect.top()));
+    const int lastBlock = blockIndex(rect.bottom());
+    QMap<int, Column>::ConstIterator cit = d->columns.lowerBound(rect.left());
+    const QMap<int, Column>::ConstIterator cend = d->columns.upperBound(rect.right());
+    for (; cit != cend; ++cit) {
+        const Column& blocks = cit.value();
+        Column::ConstIterator bit = blocks.lowerBound(firstBlock);
+        const Column::ConstIterator bend = blocks.upperBound(lastBlock);
+        for (; bit != bend; ++bit) {
+            const int blockStart = firstRowOfBlock(bit.key());
+            const int start = qMax(rect.top(), blockStart);
+            const int end = qMin(rect.bottom(), blockStart + BlockSize - 1);
+            const int offset = start - blockStart;
+            const Block* block = bit.value();
+            Segment segment;
+            segment.column = cit.key();
+            segment.row = start;
+            segment.count = end - start + 1;
+            segment.numbers = block->numbers + offset;
+            segment.kinds = block->kinds + offset;
+            segment.formats = block->formats + offset;
+            result.append(segment);
+        }
+    }
+    return result;
+}
+
+QString ColumnarValueStorage::string(int index) const
+{
+    return d->strings.item(index);
+}
+
+Value ColumnarValueStorage::error(int index) const
+{
+    return d->errors.item(index);
+}
+
+int ColumnarValueStorage::count() const
+{
+    return d->count;
+}
+
+int ColumnarValueStorage::internedCount() const
+{
+    return d->strings.count() + d->errors.count();
+}
+
+int ColumnarValueStorage::blockCount() const
+{
+    int blocks = 0;
+    QMap<int, Column>::ConstIterator end(d->columns.constEnd());
+    for (QMap<int, Column>::ConstIterator it(d->columns.constBegin()); it != end; ++it)
+        blocks += it.value().count();
+    return blocks;
+}
@@ -0,0 +1,225 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CALLIGRA_SHEETS_COLUMNAR_VALUE_STORAGE
+#define CALLIGRA_SHEETS_COLUMNAR_VALUE_STORAGE
+
+#include <QRect>
+#include <QString>
+#include <QVector>
+
+#include "sheets_odf_export.h"
+
+namespace Calligra
+{
+namespace Sheets
+{
+class Value;
+class ValueStorage;
+
+/**
+ * \ingroup Storage
+ * A column-oriented, typed copy of the cell values.
+ *
+ * The values of each column are kept in fixed-size blocks of contiguous
+ * rows. A block stores the numeric payload as plain doubles next to a
+ * byte array with the value kind and one with the value format, so range
+ * functions can walk a column without touching a single Value object.
+ *
+ * Strings and errors are interned; for them the numeric payload holds the
+ * index into the string or error table. The tables are reference counted,
+ * so entries are dropped with the last cell using them. Values, that do not
+ * fit into a double (complex numbers, arrays, integers beyond 2^53, floats
+ * needing the extended precision of Number), are of kind Other and have to
+ * be looked up by value().
+ *
+ * The storage does not replace the ValueStorage, it mirrors it. It is
+ * maintained by CellStorage, if enabled for the sheet.
+ *
+ * Its memory comes on top of the ValueStorage. Each column allocates
+ * whole blocks: a block takes about 2.6 KiB on 64-bit systems (2560 bytes
+ * of arrays, its hash of exact values and the map node), no matter how
+ * many of its 256 rows are filled. A densely filled column therefore adds
+ * about 10 bytes per cell, roughly a quarter of the about 45 bytes the
+ * ValueStorage needs for a number (the Value, its shared data and the
+ * row index). A single value in an otherwise empty block costs the whole
+ * block. Interned strings share their data with the cell values, so only
+ * the table entries are added for them.
+ * \see Sheet::setColumnarStorageEnabled
+ */
+class CALLIGRA_SHEETS_ODF_EXPORT ColumnarValueStorage
+{
+public:
+    /**
+     * The kind of a stored value.
+     */
+    enum Kind {
+        Empty = 0,
+        Boolean,
+        Integer,
+        Float,
+        String,
+        Error,
+        Other
+    };
+
+    /**
+     * The number of rows per block.
+     */
+    enum { BlockSize = 256 };
+
+    /**
+     * A run of rows in a single column.
+     * The arrays are valid until the storage is modified.
+     */
+    struct Segment {
+        int column;
+        int row;                ///< the first row of the run
+        int count;              ///< the number of rows in the run
+        const double* numbers;  ///< the numeric payload
+        const quint8* kinds;    ///< the Kind of each row
+        const quint8* formats;  ///< the Value::Format of each row
+    };
+
+    ColumnarValueStorage();
+    ~ColumnarValueStorage();
+
+    /**
+     * Removes all values.
+     */
+    void clear();
+
+    /**
+     * Replaces the content by the values of \p storage.
+     */
+    void rebuild(const ValueStorage& storage);
+
+    /**
+     * Stores \p value at \p column , \p row .
+     * An empty \p value removes the cell.
+     */
+    void insert(int column, int row, const Value& value);
+
+    /**
+     * Removes the value at \p column , \p row .
+     */
+    void take(int column, int row);
+
+    /**
+     * Inserts \p number columns at \p position .
+     * Values shifted over the end are dropped.
+     */
+    void insertColumns(int position, int number);
+
+    /**
+     * Removes \p number columns at \p position .
+     */
+    void removeColumns(int position, int number);
+
+    /**
+     * Inserts \p number rows at \p position .
+     * Values shifted over the end are dropped.
+     */
+    void insertRows(int position, int number);
+
+    /**
+     * Removes \p number rows at \p position .
+     */
+    void removeRows(int position, int number);
+
+    /**
+     * Removes the values in \p rect and shifts the values right of it to
+     * the left by the width of \p rect .
+     */
+    void removeShiftLeft(const QRect& rect);
+
+    /**
+     * Shifts the values in and right of \p rect to the right by the width
+     * of \p rect .
+     */
+    void insertShiftRight(const QRect& rect);
+
+    /**
+     * Removes the values in \p rect and shifts the values below it to the
+     * top by the height of \p rect .
+     */
+    void removeShiftUp(const QRect& rect);
+
+    /**
+     * Shifts the values in and below \p rect to the bottom by the height
+     * of \p rect .
+     */
+    void insertShiftDown(const QRect& rect);
+
+    /**
+     * \return the kind of the value at \p column , \p row
+     */
+    Kind kind(int column, int row) const;
+
+    /**
+     * \return the value at \p column , \p row
+     * \note This is the slow path. Use segments() for ranges.
+     */
+    Value value(int column, int row) const;
+
+    /**
+     * Splits \p rect into column-wise runs of rows, that are backed by
+     * allocated blocks. Rows without a block are empty and not covered by
+     * any segment. The segments are ordered by column, then by row.
+     */
+    QVector<Segment> segments(const QRect& rect) const;
+
+    /**
+     * \return the interned string \p index
+     */
+    QString string(int index) const;
+
+    /**
+     * \return the interned error \p index
+     */
+    Value error(int index) const;
+
+    /**
+     * \return the number of non-empty cells
+     */
+    int count() const;
+
+    /**
+     * \return the number of distinct strings and errors in use
+     */
+    int internedCount() const;
+
+    /**
+     * \return the number of allocated blocks
+     * Each block holds BlockSize rows of a column, filled or not, so this
+     * is the measure of the memory used by the storage.
+     */
+    int blockCount() const;
+
+private:
+    Q_DISABLE_COPY(ColumnarValueStorage)
+
+    class Private;
+    Private * const d;
+};
+
+} // namespace Sheets
+} // namespace Calligra
+
+#endif // CALLIGRA_SHEETS_COLUMNAR_VALUE_STORAGE
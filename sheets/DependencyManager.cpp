@@ -27,6 +27,7 @@
 #include "CellStorage.h"
 #include "Formula.h"
 #include "FormulaStorage.h"
+#include "LookupCache.h"
 #include "Map.h"
 #include "NamedAreaManager.h"
 #include "Region.h"
@@ -102,6 +103,7 @@ void DependencyManager::regionChanged(const Region& region)
     if (region.isEmpty())
         return;
     debugSheetsFormula << "DependencyManager::regionChanged" << region.name();
+    d->lookupCache.invalidate(region);
     Region::ConstIterator end(region.constEnd());
     for (Region::ConstIterator it(region.constBegin()); it != end; ++it) {
         const QRect range = (*it)->rect();
@@ -174,7 +176,7 @@ void DependencyManager::addSheet(Sheet *sheet)
 
 void DependencyManager::removeSheet(Sheet *sheet)
 {
-    Q_UNUSED(sheet);
+    d->lookupCache.invalidate(sheet);
     // TODO Stefan: Implement, if dependencies should not be tracked all the time.
 }
 
@@ -183,6 +185,7 @@ void DependencyManager::updateAllDependencies(const Map* map, KoUpdater *updater
     ElapsedTime et("Generating dependencies", ElapsedTime::PrintOnlyTime);
 
     // clear everything
+    d->lookupCache.clear();
     d->providers.clear();
     qDeleteAll(d->consumers);
     d->consumers.clear();
@@ -236,6 +239,53 @@ QMap<Cell, int> DependencyManager::depths() const
     return d->depths;
 }
 
+int DependencyManager::depth(const Cell& cell) const
+{
+    return d->depths.value(cell);
+}
+
+QMap<int, Cell> DependencyManager::dirtyCells(const Region& region) const
+{
+    QMap<int, Cell> cells;
+    QSet<Cell> dirtyCells;
+    QList<Cell> pending;
+
+    Region::ConstIterator end(region.constEnd());
+    for (Region::ConstIterator it(region.constBegin()); it != end; ++it) {
+        const QRect range = (*it)->rect();
+        Sheet* const sheet = (*it)->sheet();
+
+        // Formulas in the region itself need a recalculation.
+        // There are no formulas beyond the used area of the formula storage.
+        const FormulaStorage* formulas = sheet->formulaStorage();
+        const int bottom = qMin(range.bottom(), formulas->rows());
+        const int right = qMin(range.right(), formulas->columns());
+        for (int row = range.top(); row <= bottom; ++row) {
+            for (int col = range.left(); col <= right; ++col) {
+                const Cell cell(sheet, col, row);
+                if (cell.isFormula())
+                    pending.append(cell);
+            }
+        }
+
+        // Even empty cells may act as value providers. Ask for the consumers
+        // of the whole range at once instead of cell by cell.
+        d->appendConsumers(sheet, range, pending);
+    }
+
+    // propagate the dirty flag to the consumers
+    while (!pending.isEmpty()) {
+        const Cell cell = pending.takeLast();
+        if (dirtyCells.contains(cell))
+            continue;
+        dirtyCells.insert(cell);
+        if (cell.isFormula())
+            cells.insertMulti(d->depths.value(cell), cell);
+        d->appendConsumers(cell.sheet(), QRect(cell.cellPosition(), QSize(1, 1)), pending);
+    }
+    return cells;
+}
+
 Calligra::Sheets::Region DependencyManager::consumingRegion(const Cell& cell) const
 {
     return d->consumingRegion(cell);
@@ -279,6 +329,16 @@ void DependencyManager::regionMoved(const Region& movedRegion, const Cell& desti
     }
 }
 
+LookupCache* DependencyManager::lookupCache() const
+{
+    return &d->lookupCache;
+}
+
+void DependencyManager::valuesChanged(const Sheet* sheet, const QRect& rect)
+{
+    d->lookupCache.invalidate(sheet, rect);
+}
+
 void DependencyManager::updateFormula(const Cell& cell, const Region::Element* oldLocation, const Region::Point& offset)
 {
     // Not a formula -> no dependencies
@@ -326,6 +386,7 @@ void DependencyManager::Private::reset()
 {
     providers.clear();
     consumers.clear();
+    lookupCache.clear();
 }
 
 Calligra::Sheets::Region DependencyManager::Private::consumingRegion(const Cell& cell) const
@@ -344,6 +405,17 @@ Calligra::Sheets::Region DependencyManager::Private::consumingRegion(const Cell&
     return region;
 }
 
+void DependencyManager::Private::appendConsumers(Sheet* sheet, const QRect& rect, QList<Cell>& cells) const
+{
+    QHash<Sheet*, RTree<Cell>*>::ConstIterator cit = consumers.constFind(sheet);
+    if (cit == consumers.constEnd())
+        return;
+    if (rect.width() == 1 && rect.height() == 1)
+        cells.append(cit.value()->contains(rect.topLeft()));
+    else
+        cells.append(cit.value()->intersects(rect));
+}
+
 void DependencyManager::Private::namedAreaModified(const QString& name)
 {
     // since area names are something like aliases, modifying an area name
@@ -31,6 +31,7 @@ namespace Calligra
 {
 namespace Sheets
 {
+class LookupCache;
 class Region;
 
 /**
@@ -76,6 +77,24 @@ public:
      */
     QMap<Cell, int> depths() const;
 
+    /**
+     * Returns the reference depth of \p cell .
+     * Prefer this to depths(), if only a few cells are of interest. It does
+     * not copy the whole depth table.
+     * \return the reference depth of \p cell or zero, if it has none
+     */
+    int depth(const Cell& cell) const;
+
+    /**
+     * Marks the cells in \p region as dirty and propagates the flag to all
+     * cells consuming their values, directly or indirectly.
+     * Only the transitive consumers of \p region are visited; the costs do
+     * not depend on the size of the whole dependency table.
+     *
+     * \return the dirty cells with a formula, ordered by their reference depth
+     */
+    QMap<int, Cell> dirtyCells(const Region& region) const;
+
     /**
      * Returns the region, that consumes the value of \p cell.
      *
@@ -102,6 +121,19 @@ public:
      */
     void regionMoved(const Region& movedRegion, const Cell& destination);
 
+    /**
+     * Returns the cache of the lookup function indices.
+     * The indices of the ranges in a region, that has changed formulas
+     * (see regionChanged) or values (see valuesChanged), are dropped.
+     */
+    LookupCache* lookupCache() const;
+
+    /**
+     * Handles the fact, that values have changed in \p rect on \p sheet.
+     * Drops the cached lookup indices of the range.
+     */
+    void valuesChanged(const Sheet* sheet, const QRect& rect);
+
 public Q_SLOTS:
     void namedAreaModified(const QString&);
 
@@ -28,6 +28,7 @@
 #include <QList>
 
 #include "Cell.h"
+#include "LookupCache.h"
 #include "Region.h"
 #include "RTree.h"
 
@@ -96,6 +97,11 @@ public:
      */
     Region consumingRegion(const Cell& cell) const;
 
+    /**
+     * Appends the cells consuming a value in \p rect on \p sheet to \p cells .
+     */
+    void appendConsumers(Sheet* sheet, const QRect& rect, QList<Cell>& cells) const;
+
     void namedAreaModified(const QString& name);
 
     /**
@@ -161,6 +167,8 @@ public:
      */
     // use QMap rather then QHash cause it's faster for our use-case
     QMap<Cell, int> depths;
+    // indices of the ranges searched by the lookup functions
+    LookupCache lookupCache;
 };
 
 } // namespace Sheets
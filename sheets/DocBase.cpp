@@ -33,6 +33,7 @@
 #include "DocBase_p.h"
 
 #include <KoDocumentResourceManager.h>
+#include <KoOdfReadStore.h>
 #include <KoShapeRegistry.h>
 #include <KoPart.h>
 
@@ -139,6 +140,17 @@ bool DocBase::loadOdf(KoOdfReadStore & odfStore)
     return Odf::loadDocument(this, odfStore);
 }
 
+bool DocBase::loadOasisFromStore(KoStore *store)
+{
+    KoOdfReadStore odfStore(store);
+    QString errorMessage;
+    if (!odfStore.loadAndParseWithoutBody(errorMessage)) {
+        setErrorMessage(errorMessage);
+        return false;
+    }
+    return loadOdf(odfStore);
+}
+
 void DocBase::paintContent(QPainter &, const QRect &)
 {
 }
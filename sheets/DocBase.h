@@ -117,6 +117,14 @@ public:
      * @see Map::loadOdf
      */
     virtual bool loadOdf(KoOdfReadStore & odfStore);
+
+    /**
+     * \ingroup OpenDocument
+     * Reimplemented from KoDocument to read the sheets of content.xml one
+     * by one instead of parsing the whole file at once.
+     * @see Odf::loadDocument
+     */
+    virtual bool loadOasisFromStore(KoStore *store);
 protected:
     class Private;
     Private * const d;
@@ -99,6 +99,35 @@ public:
     Opcode(unsigned t, unsigned i): type(t), index(i) {}
 };
 
+// Register based code, generated from the opcodes once a formula is compiled.
+// The registers correspond to the slots of the evaluation stack, i.e. the
+// operands of an instruction are stored in the registers starting at its
+// destination register.
+// see Formula::Private::generateProgram()
+class Instruction
+{
+public:
+
+    enum { LoadConstant = 0, LoadCell, LoadRange, Call, Unary, Binary };
+
+    unsigned type;
+    unsigned op;    // the Opcode type of unary and binary operations
+    int reg;        // the destination register
+    int index;      // the constant, reference or function index
+    int count;      // the argument count of calls
+
+    Instruction(): type(LoadConstant), op(Opcode::Nop), reg(0), index(0), count(0) {}
+    Instruction(unsigned t, unsigned o, int r, int i, int c = 0)
+        : type(t), op(o), reg(r), index(i), count(c) {}
+};
+
+// A cell or range reference, resolved at compile time if possible.
+struct Reference {
+    QString text;
+    Region region;
+    bool resolved;
+};
+
 // used when evaluation formulas
 struct stackEntry {
     void reset() {
@@ -123,7 +152,29 @@ public:
     mutable QVector<Opcode> codes;
     mutable QVector<Value> constants;
 
+    // register code, used as long as no cell indirections are given
+    mutable bool hasProgram;
+    mutable int registerCount;
+    mutable QVector<Instruction> program;
+    mutable QVector<Value> programConstants;
+    mutable QVector<Reference> references;
+    mutable QVector<QSharedPointer<Function> > functions;
+
     Value valueOrElement(FuncExtra &fe, const stackEntry& entry) const;
+
+    /**
+     * Translates the opcodes into register code.
+     * Folds operations on constant numbers, resolves the references, that
+     * are not named areas, and looks up the functions.
+     * If an opcode is not supported, no register code is generated and the
+     * evaluation falls back to Formula::evalRecursive().
+     */
+    void generateProgram() const;
+
+    /**
+     * Evaluates the register code.
+     */
+    Value evalProgram() const;
 };
 
 class TokenStack : public QVector<Token>
@@ -623,6 +674,11 @@ void Formula::clear()
     d->valid = false;
     d->constants.clear();
     d->codes.clear();
+    d->hasProgram = false;
+    d->program.clear();
+    d->programConstants.clear();
+    d->references.clear();
+    d->functions.clear();
 }
 
 // Returns list of token for the expression.
@@ -1080,6 +1136,7 @@ void Formula::compile(const Tokens& tokens) const
     d->valid = false;
     d->codes.clear();
     d->constants.clear();
+    d->hasProgram = false;
 
     // sanity check
     if (tokens.count() == 0) return;
@@ -1465,7 +1522,10 @@ void Formula::compile(const Tokens& tokens) const
     if (!d->valid) {
         d->constants.clear();
         d->codes.clear();
+        return;
     }
+
+    d->generateProgram();
 }
 
 bool Formula::isNamedArea(const QString& expr) const
@@ -1479,6 +1539,8 @@ bool Formula::isNamedArea(const QString& expr) const
 // evaluate the cellIndirections
 Value Formula::eval(CellIndirection cellIndirections) const
 {
+    if (cellIndirections.isEmpty() && !d->dirty && d->hasProgram)
+        return d->evalProgram();
     QHash<Cell, Value> values;
     return evalRecursive(cellIndirections, values);
 }
@@ -1529,6 +1591,101 @@ Value numericOrError(const ValueConverter* converter, const Value &v)
     return Value::errorVALUE();
 }
 
+// Applies the unary operation \p op to \p value .
+// Shared by the stack and the register based evaluation.
+static Value unaryOperation(unsigned op, const Value& value, const ValueConverter* converter, ValueCalc* calc)
+{
+    Value result;
+    switch (op) {
+    case Opcode::Neg:
+        result = value;
+        if (!result.isError()) // do nothing if we got an error
+            result = calc->mul(result, -1);
+        break;
+    case Opcode::Not:
+        result = converter->asBoolean(value);
+        if (result.isError())
+            result = Value::errorVALUE();
+        else
+            result = Value(!result.asBoolean());
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+// Applies the binary operation \p op to the operands \p val1 and \p val2 .
+// Shared by the stack and the register based evaluation.
+static Value binaryOperation(unsigned op, const Value& val1, const Value& val2, const ValueConverter* converter, ValueCalc* calc)
+{
+    Value result;
+    switch (op) {
+    case Opcode::Add:
+        result = calc->add(numericOrError(converter, val1), numericOrError(converter, val2));
+        break;
+    case Opcode::Sub:
+        result = calc->sub(numericOrError(converter, val1), numericOrError(converter, val2));
+        break;
+    case Opcode::Mul:
+        result = calc->mul(numericOrError(converter, val1), numericOrError(converter, val2));
+        break;
+    case Opcode::Div:
+        result = calc->div(numericOrError(converter, val1), numericOrError(converter, val2));
+        break;
+    case Opcode::Pow:
+        result = calc->pow(numericOrError(converter, val1), numericOrError(converter, val2));
+        break;
+
+        // string concatenation
+    case Opcode::Concat: {
+        const Value string1 = converter->asString(val1);
+        const Value string2 = converter->asString(val2);
+        if (string1.isError() || string2.isError())
+            result = Value::errorVALUE();
+        else
+            result = Value(string1.asString() + string2.asString());
+    } break;
+
+        // comparison
+    case Opcode::Equal:
+    case Opcode::Less:
+    case Opcode::Greater:
+        if (val2.isError())
+            result = val2;
+        else if (val1.isError())
+            result = val1;
+        else {
+            const int comparison = val1.compare(val2, calc->settings()->caseSensitiveComparisons());
+            if (op == Opcode::Equal)
+                result = Value(comparison == 0);
+            else if (op == Opcode::Less)
+                result = Value(comparison < 0);
+            else
+                result = Value(comparison > 0);
+        }
+        break;
+    default:
+        break;
+    }
+    return result;
+}
+
+// Operations on constant numbers and booleans do not depend on the
+// calculation settings and can be evaluated on compilation.
+static bool isFoldable(unsigned op, const Value& value)
+{
+    switch (op) {
+    case Opcode::Neg: case Opcode::Not:
+    case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::Div: case Opcode::Pow:
+    case Opcode::Equal: case Opcode::Less: case Opcode::Greater:
+        break;
+    default:
+        return false;
+    }
+    return value.type() == Value::Integer || value.type() == Value::Float || value.type() == Value::Boolean;
+}
+
 Value Formula::evalRecursive(CellIndirection cellIndirections, QHash<Cell, Value>& values) const
 {
     QStack<stackEntry> stack;
@@ -1578,71 +1735,32 @@ Value Formula::evalRecursive(CellIndirection cellIndirections, QHash<Cell, Value
 
             // unary operation
         case Opcode::Neg:
+            val1 = d->valueOrElement(fe, stack.pop());
             entry.reset();
-            entry.val = d->valueOrElement(fe, stack.pop());
-            if (!entry.val.isError()) // do nothing if we got an error
-                entry.val = calc->mul(entry.val, -1);
+            entry.val = unaryOperation(opcode.type, val1, converter, calc);
             stack.push(entry);
             break;
 
             // binary operation: take two values from stack, do the operation,
             // push the result to stack
         case Opcode::Add:
-            entry.reset();
-            val2 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val1 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val2 = calc->add(val1, val2);
-            entry.reset();
-            entry.val = val2;
-            stack.push(entry);
-            break;
-
         case Opcode::Sub:
-            val2 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val1 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val2 = calc->sub(val1, val2);
-            entry.reset();
-            entry.val = val2;
-            stack.push(entry);
-            break;
-
         case Opcode::Mul:
-            val2 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val1 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val2 = calc->mul(val1, val2);
-            entry.reset();
-            entry.val = val2;
-            stack.push(entry);
-            break;
-
         case Opcode::Div:
-            val2 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val1 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val2 = calc->div(val1, val2);
-            entry.reset();
-            entry.val = val2;
-            stack.push(entry);
-            break;
-
         case Opcode::Pow:
-            val2 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val1 = numericOrError(converter, d->valueOrElement(fe, stack.pop()));
-            val2 = calc->pow(val1, val2);
+            val2 = d->valueOrElement(fe, stack.pop());
+            val1 = d->valueOrElement(fe, stack.pop());
             entry.reset();
-            entry.val = val2;
+            entry.val = binaryOperation(opcode.type, val1, val2, converter, calc);
             stack.push(entry);
             break;
 
             // string concatenation
         case Opcode::Concat:
-            val1 = converter->asString(stack.pop().val);
-            val2 = converter->asString(stack.pop().val);
-            if (val1.isError() || val2.isError())
-                val1 = Value::errorVALUE();
-            else
-                val1 = Value(val2.asString().append(val1.asString()));
+            val2 = stack.pop().val;
+            val1 = stack.pop().val;
             entry.reset();
-            entry.val = val1;
+            entry.val = binaryOperation(opcode.type, val1, val2, converter, calc);
             stack.push(entry);
             break;
 
@@ -1698,67 +1816,22 @@ Value Formula::evalRecursive(CellIndirection cellIndirections, QHash<Cell, Value
 
             // logical not
         case Opcode::Not:
-            val1 = converter->asBoolean(d->valueOrElement(fe, stack.pop()));
-            if (val1.isError())
-                val1 = Value::errorVALUE();
-            else
-                val1 = Value(!val1.asBoolean());
+            val1 = d->valueOrElement(fe, stack.pop());
             entry.reset();
-            entry.val = val1;
+            entry.val = unaryOperation(opcode.type, val1, converter, calc);
             stack.push(entry);
             break;
 
             // comparison
         case Opcode::Equal:
-            val1 = d->valueOrElement(fe, stack.pop());
-            val2 = d->valueOrElement(fe, stack.pop());
-            if (val1.isError())
-                ;
-            else if (val2.isError())
-                val1 = val2;
-            else if (val2.compare(val1, calc->settings()->caseSensitiveComparisons()) == 0)
-                val1 = Value(true);
-            else
-                val1 = Value(false);
-            entry.reset();
-            entry.val = val1;
-            stack.push(entry);
-            break;
-
-            // less than
         case Opcode::Less:
-            val1 = d->valueOrElement(fe, stack.pop());
+        case Opcode::Greater:
             val2 = d->valueOrElement(fe, stack.pop());
-            if (val1.isError())
-                ;
-            else if (val2.isError())
-                val1 = val2;
-            else if (val2.compare(val1, calc->settings()->caseSensitiveComparisons()) < 0)
-                val1 = Value(true);
-            else
-                val1 = Value(false);
-            entry.reset();
-            entry.val = val1;
-            stack.push(entry);
-            break;
-
-            // greater than
-        case Opcode::Greater: {
             val1 = d->valueOrElement(fe, stack.pop());
-            val2 = d->valueOrElement(fe, stack.pop());
-            if (val1.isError())
-                ;
-            else if (val2.isError())
-                val1 = val2;
-            else if (val2.compare(val1, calc->settings()->caseSensitiveComparisons()) > 0)
-                val1 = Value(true);
-            else
-                val1 = Value(false);
             entry.reset();
-            entry.val = val1;
+            entry.val = binaryOperation(opcode.type, val1, val2, converter, calc);
             stack.push(entry);
-        }
-        break;
+            break;
 
         // cell in a sheet
         case Opcode::Cell: {
@@ -1905,6 +1978,287 @@ Value Formula::evalRecursive(CellIndirection cellIndirections, QHash<Cell, Value
     return stack.pop().val;
 }
 
+// Loads the value(s) of a cell or range reference into entry.
+// Shared by the register based evaluation for resolved and unresolved references.
+static void loadReference(stackEntry& entry, unsigned type, const Region& region, bool isNamedArea)
+{
+    Value val1 = Value::empty();
+    entry.reset();
+    if (type == Instruction::LoadCell) {
+        if (!region.isValid()) {
+            val1 = Value::errorREF();
+        } else if (region.isSingular()) {
+            const QPoint position = region.firstRange().topLeft();
+            val1 = Cell(region.firstSheet(), position).value();
+            // store the reference, so we can use it within functions
+            entry.col1 = entry.col2 = position.x();
+            entry.row1 = entry.row2 = position.y();
+            entry.reg = region;
+            entry.regIsNamedOrLabeled = isNamedArea;
+        } else {
+            warnSheets << "Unhandled non singular region in Instruction::LoadCell with rects=" << region.rects();
+        }
+    } else if (region.isValid()) {
+        val1 = region.firstSheet()->cellStorage()->valueRegion(region);
+        // store the reference, so we can use it within functions
+        entry.col1 = region.firstRange().left();
+        entry.row1 = region.firstRange().top();
+        entry.col2 = region.firstRange().right();
+        entry.row2 = region.firstRange().bottom();
+        entry.reg = region;
+        entry.regIsNamedOrLabeled = isNamedArea;
+    }
+    entry.val = val1; // any array is valid here
+}
+
+void Formula::Private::generateProgram() const
+{
+    hasProgram = false;
+    registerCount = 0;
+    program.clear();
+    programConstants.clear();
+    references.clear();
+    functions.clear();
+
+    // Without a sheet there is no calculator to fold constants with and
+    // nothing to resolve references against.
+    if (!sheet)
+        return;
+
+    const Map* map = sheet->map();
+    const ValueConverter* converter = map->converter();
+    ValueCalc* calc = map->calc();
+
+    // the instruction loading the value of each register and whether it is
+    // a constant known at compile time
+    QVector<QPair<int, bool> > loads;
+
+    for (int pc = 0; pc < codes.count(); ++pc) {
+        const Opcode& opcode = codes[pc];
+        const int top = loads.count();
+        switch (opcode.type) {
+        case Opcode::Nop:
+            break;
+
+            // constants, function names and other identifiers
+        case Opcode::Load:
+        case Opcode::Ref:
+            programConstants.append(constants[opcode.index]);
+            loads.append(qMakePair(program.count(), opcode.type == Opcode::Load));
+            program.append(Instruction(Instruction::LoadConstant, Opcode::Nop, top, programConstants.count() - 1));
+            break;
+
+            // references
+        case Opcode::Cell:
+        case Opcode::Range: {
+            Reference reference;
+            reference.text = constants[opcode.index].asString();
+            reference.resolved = false;
+            // Named areas may get redefined. Resolve them on each evaluation.
+            if (!map->namedAreaManager()->contains(reference.text)) {
+                reference.region = Region(reference.text, map, sheet);
+                reference.resolved = reference.region.isValid();
+            }
+            references.append(reference);
+            const unsigned type = (opcode.type == Opcode::Cell) ? Instruction::LoadCell : Instruction::LoadRange;
+            loads.append(qMakePair(program.count(), false));
+            program.append(Instruction(type, Opcode::Nop, top, references.count() - 1));
+            break;
+        }
+
+            // unary operations
+        case Opcode::Neg:
+        case Opcode::Not: {
+            if (top < 1)
+                return;
+            const int reg = top - 1;
+            if (loads[reg].second && isFoldable(opcode.type, programConstants[program[loads[reg].first].index])) {
+                Value& constant = programConstants[program[loads[reg].first].index];
+                constant = unaryOperation(opcode.type, constant, converter, calc);
+                break;
+            }
+            loads[reg] = qMakePair(program.count(), false);
+            program.append(Instruction(Instruction::Unary, opcode.type, reg, 0));
+            break;
+        }
+
+            // binary operations
+        case Opcode::Add:
+        case Opcode::Sub:
+        case Opcode::Mul:
+        case Opcode::Div:
+        case Opcode::Pow:
+        case Opcode::Concat:
+        case Opcode::Equal:
+        case Opcode::Less:
+        case Opcode::Greater: {
+            if (top < 2)
+                return;
+            const int reg = top - 2;
+            // Both constants are loaded by the last two instructions, as
+            // constant sub-expressions have already been folded.
+            if (loads[reg].second && loads[reg + 1].second &&
+                    isFoldable(opcode.type, programConstants[program[loads[reg].first].index]) &&
+                    isFoldable(opcode.type, programConstants[program[loads[reg + 1].first].index])) {
+                Q_ASSERT(loads[reg + 1].first == program.count() - 1);
+                const Value val2 = programConstants[program.last().index];
+                program.removeLast();
+                loads.removeLast();
+                Value& constant = programConstants[program.last().index];
+                constant = binaryOperation(opcode.type, constant, val2, converter, calc);
+                break;
+            }
+            loads.removeLast();
+            loads[reg] = qMakePair(program.count(), false);
+            program.append(Instruction(Instruction::Binary, opcode.type, reg, 0));
+            break;
+        }
+
+            // function calls
+        case Opcode::Function: {
+            const int count = opcode.index;
+            if (top < count + 1)
+                return;
+            const int reg = top - count - 1;
+            // the function name was loaded as constant
+            int function = -1;
+            const Instruction& name = program[loads[reg].first];
+            if (name.type == Instruction::LoadConstant) {
+                const Value functionName = converter->asString(programConstants[name.index]);
+                if (!functionName.isError()) {
+                    const QSharedPointer<Function> ptr = FunctionRepository::self()->function(functionName.asString());
+                    if (ptr) {
+                        functions.append(ptr);
+                        function = functions.count() - 1;
+                    }
+                }
+            }
+            loads.resize(reg + 1);
+            loads[reg] = qMakePair(program.count(), false);
+            program.append(Instruction(Instruction::Call, Opcode::Nop, reg, function, count));
+            break;
+        }
+
+            // Intersections, unions and inline arrays are left to the stack
+            // based evaluation.
+        default:
+            program.clear();
+            return;
+        }
+        registerCount = qMax(registerCount, loads.count());
+    }
+
+    // more than one value in stack ? unsuccessful execution...
+    if (loads.count() != 1) {
+        program.clear();
+        return;
+    }
+    hasProgram = true;
+}
+
+Value Formula::Private::evalProgram() const
+{
+    const Map* map = sheet->map();
+    const ValueConverter* converter = map->converter();
+    ValueCalc* calc = map->calc();
+
+    FuncExtra fe;
+    fe.mycol = fe.myrow = 0;
+    if (!cell.isNull()) {
+        fe.mycol = cell.column();
+        fe.myrow = cell.row();
+    }
+
+    QVector<stackEntry> registers(registerCount);
+    QVector<Value> args;
+    for (int pc = 0; pc < program.count(); ++pc) {
+        const Instruction& instruction = program.at(pc);
+        stackEntry& entry = registers[instruction.reg];
+        switch (instruction.type) {
+        case Instruction::LoadConstant:
+            entry.reset();
+            entry.val = programConstants.at(instruction.index);
+            break;
+
+        case Instruction::LoadCell:
+        case Instruction::LoadRange: {
+            const Reference& reference = references.at(instruction.index);
+            // A sheet may have been removed since the compilation.
+            if (reference.resolved && map->sheetList().contains(reference.region.firstSheet())) {
+                loadReference(entry, instruction.type, reference.region, false);
+            } else {
+                const Region region(reference.text, map, sheet);
+                loadReference(entry, instruction.type, region, map->namedAreaManager()->contains(reference.text));
+            }
+            break;
+        }
+
+        case Instruction::Unary: {
+            const Value value = valueOrElement(fe, entry);
+            entry.reset();
+            entry.val = unaryOperation(instruction.op, value, converter, calc);
+            break;
+        }
+
+        case Instruction::Binary: {
+            const stackEntry& second = registers[instruction.reg + 1];
+            Value val1, val2;
+            if (instruction.op == Opcode::Concat) {
+                val1 = entry.val;
+                val2 = second.val;
+            } else {
+                val1 = valueOrElement(fe, entry);
+                val2 = valueOrElement(fe, second);
+            }
+            entry.reset();
+            entry.val = binaryOperation(instruction.op, val1, val2, converter, calc);
+            break;
+        }
+
+        case Instruction::Call: {
+            const int count = instruction.count;
+            args.clear();
+            fe.ranges.clear();
+            fe.ranges.resize(count);
+            fe.regions.clear();
+            fe.regions.resize(count);
+            fe.sheet = sheet;
+            for (int i = 0; i < count; ++i) {
+                const stackEntry& e = registers[instruction.reg + 1 + i];
+                args.append(e.val);
+                // fill the FunctionExtra object
+                fe.ranges[i].col1 = e.col1;
+                fe.ranges[i].row1 = e.row1;
+                fe.ranges[i].col2 = e.col2;
+                fe.ranges[i].row2 = e.row2;
+                fe.regions[i] = e.reg;
+            }
+
+            QSharedPointer<Function> function;
+            if (instruction.index >= 0) {
+                function = functions.at(instruction.index);
+            } else {
+                // function name as string value
+                const Value name = converter->asString(entry.val);
+                if (name.isError())
+                    return name;
+                function = FunctionRepository::self()->function(name.asString());
+                if (!function)
+                    return Value::errorNAME(); // no such function
+            }
+
+            const Value result = function->exec(args, calc, &fe);
+            entry.reset();
+            entry.val = result;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return registers[0].val;
+}
+
 Formula& Formula::operator=(const Formula & other)
 {
     d = other.d;
@@ -46,7 +46,8 @@ public:
     LoadingInfo()
             : m_fileFormat(Unknown)
             , m_initialActiveSheet(0)
-            , m_loadTemplate(false) {}
+            , m_loadTemplate(false)
+            , m_parallelLoading(false) {}
     ~LoadingInfo() {}
 
     FileFormat fileFormat() const {
@@ -100,12 +101,24 @@ public:
         return m_loadTemplate;
     }
 
+    /**
+     * Enables loading the cell contents of several sheets concurrently.
+     * Only used for OpenDocument.
+     */
+    void setParallelLoading(bool enable) {
+        m_parallelLoading = enable;
+    }
+    bool parallelLoading() const {
+        return m_parallelLoading;
+    }
+
 private:
     FileFormat m_fileFormat;
     Sheet* m_initialActiveSheet;
     QMap<Sheet*, QPoint> m_cursorPositions;
     QMap<Sheet*, QPointF> m_scrollingOffsets;
     bool m_loadTemplate;
+    bool m_parallelLoading;
 };
 
 } // namespace Sheets
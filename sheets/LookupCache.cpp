@@ -0,0 +1,346 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+// Local
+#include "LookupCache.h"
+
+// C++
+#include <algorithm>
+#include <float.h>
+
+// Qt
+#include <QAtomicInt>
+#include <QCache>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+// Sheets
+#include "Region.h"
+#include "Value.h"
+#include "ValueCalc.h"
+
+using namespace Calligra::Sheets;
+
+// Shorter columns or rows are scanned; building the index does not pay off.
+static const int g_minimumLength = 32;
+// The maximum number of indexed cells.
+static const int g_maximumCost = 4 * 1024 * 1024;
+
+namespace
+{
+struct LookupKey {
+    const Sheet* sheet;
+    QRect range;
+    Qt::Orientation orientation;
+    bool caseSensitive;
+
+    // the searched column or row
+    QRect rect() const {
+        return (orientation == Qt::Vertical)
+               ? QRect(range.left(), range.top(), 1, range.height())
+               : QRect(range.left(), range.top(), range.width(), 1);
+    }
+
+    bool operator==(const LookupKey& other) const {
+        return sheet == other.sheet && range == other.range &&
+               orientation == other.orientation && caseSensitive == other.caseSensitive;
+    }
+};
+
+uint qHash(const LookupKey& key)
+{
+    return ::qHash(quintptr(key.sheet)) ^ ::qHash(key.range.left()) ^ (::qHash(key.range.top()) << 8)
+           ^ (::qHash(key.range.width()) << 16) ^ (::qHash(key.range.height()) << 24)
+           ^ (uint(key.orientation) << 1) ^ uint(key.caseSensitive);
+}
+
+bool lessNumber(const QPair<Number, int>& entry, Number number)
+{
+    return entry.first < number;
+}
+
+bool lessString(const QPair<QString, int>& entry, const QString& string)
+{
+    return entry.first < string;
+}
+
+class LookupIndex
+{
+public:
+    LookupIndex() : indexable(false), count(0), length(0), firstTrue(-1), firstFalse(-1) {}
+
+    bool build(const Value& data, Qt::Orientation orientation, bool caseSensitive);
+    int find(const Value& data, Qt::Orientation orientation, const Value& key,
+             bool caseSensitive, bool approximate, ValueCalc* calc) const;
+
+    bool indexable;
+    int count;                  // the number of non-empty values in data; a fingerprint
+    int length;
+    QVector<QPair<Number, int> > numbers;       // ascending, then by position
+    QHash<QString, int> strings;                // the first position of each text
+    QVector<QPair<QString, int> > sortedStrings;    // the non-empty texts, ascending
+    int firstTrue;
+    int firstFalse;
+};
+
+inline Value element(const Value& data, Qt::Orientation orientation, int position)
+{
+    return (orientation == Qt::Vertical) ? data.element(0, position) : data.element(position, 0);
+}
+} // namespace
+
+bool LookupIndex::build(const Value& data, Qt::Orientation orientation, bool caseSensitive)
+{
+    count = data.count();
+    length = (orientation == Qt::Vertical) ? data.rows() : data.columns();
+    for (int i = 0; i < length; ++i) {
+        const Value value = element(data, orientation, i);
+        switch (value.type()) {
+        case Value::Empty:
+            break;
+        case Value::Boolean:
+            if (value.asBoolean() && firstTrue == -1)
+                firstTrue = i;
+            else if (!value.asBoolean() && firstFalse == -1)
+                firstFalse = i;
+            break;
+        case Value::Integer:
+        case Value::Float:
+            numbers.append(qMakePair(value.asFloat(), i));
+            break;
+        case Value::String: {
+            const QString string = caseSensitive ? value.asString() : value.asString().toLower();
+            if (!strings.contains(string))
+                strings.insert(string, i);
+            break;
+        }
+        default:
+            // Errors and complex numbers compare in odd ways; leave them
+            // to the linear scan.
+            numbers.clear();
+            strings.clear();
+            return indexable = false;
+        }
+    }
+    std::sort(numbers.begin(), numbers.end());
+    QHash<QString, int>::ConstIterator end = strings.constEnd();
+    for (QHash<QString, int>::ConstIterator it = strings.constBegin(); it != end; ++it) {
+        if (!it.key().isEmpty())
+            sortedStrings.append(qMakePair(it.key(), it.value()));
+    }
+    std::sort(sortedStrings.begin(), sortedStrings.end());
+    return indexable = true;
+}
+
+int LookupIndex::find(const Value& data, Qt::Orientation orientation, const Value& key,
+                      bool caseSensitive, bool approximate, ValueCalc* calc) const
+{
+    int result = LookupCache::NotFound;
+    switch (key.type()) {
+    case Value::Boolean:
+        result = key.asBoolean() ? firstTrue : firstFalse;
+        // The approximate match of a boolean depends on the order of the
+        // texts and booleans; leave that to the scan.
+        if (result == -1 && approximate)
+            return LookupCache::NotIndexed;
+        break;
+    case Value::Integer:
+    case Value::Float: {
+        // Numbers are equal within DBL_EPSILON. Collect the candidates
+        // generously and let the value comparison decide.
+        const Number number = key.asFloat();
+        QVector<QPair<Number, int> >::ConstIterator it;
+        it = std::lower_bound(numbers.constBegin(), numbers.constEnd(), number - 2 * DBL_EPSILON, lessNumber);
+        for (; it != numbers.constEnd() && it->first <= number + 2 * DBL_EPSILON; ++it) {
+            if (result != -1 && it->second > result)
+                continue;
+            if (calc->naturalEqual(key, element(data, orientation, it->second), caseSensitive))
+                result = it->second;
+        }
+        break;
+    }
+    case Value::String: {
+        const QString string = caseSensitive ? key.asString() : key.asString().toLower();
+        // an empty text also matches empty cells
+        if (string.isEmpty())
+            return LookupCache::NotIndexed;
+        result = strings.value(string, -1);
+        // Only texts can become the approximate match: the scan starts with
+        // an empty value and numbers, booleans and empty texts never
+        // compare greater.
+        if (result == -1 && approximate) {
+            QVector<QPair<QString, int> >::ConstIterator it;
+            it = std::lower_bound(sortedStrings.constBegin(), sortedStrings.constEnd(), string, lessString);
+            if (it != sortedStrings.constBegin())
+                result = (it - 1)->second;
+        }
+        break;
+    }
+    default:
+        return LookupCache::NotIndexed;
+    }
+    return (result == -1) ? int(LookupCache::NotFound) : result;
+}
+
+
+class Q_DECL_HIDDEN LookupCache::Private
+{
+public:
+    Private() : cache(g_maximumCost), keyCount(0) {}
+
+    void remove(const Sheet* sheet, const QRect& rect, bool all);
+
+    QMutex mutex;
+    QCache<LookupKey, QSharedPointer<const LookupIndex> > cache;
+    // The keys by sheet, so that a change does not walk the whole cache.
+    // Keys evicted by the cache stay until the next pruning.
+    QHash<const Sheet*, QSet<LookupKey> > sheetKeys;
+    int keyCount;
+    // Avoids locking on each value change, as long as nothing is cached.
+    QAtomicInt count;
+};
+
+void LookupCache::Private::remove(const Sheet* sheet, const QRect& rect, bool all)
+{
+    QHash<const Sheet*, QSet<LookupKey> >::Iterator keys = sheetKeys.find(sheet);
+    if (keys == sheetKeys.end())
+        return;
+    QSet<LookupKey>::Iterator it = keys->begin();
+    while (it != keys->end()) {
+        if (all || it->rect().intersects(rect)) {
+            cache.remove(*it);
+            it = keys->erase(it);
+            --keyCount;
+        } else
+            ++it;
+    }
+    if (keys->isEmpty())
+        sheetKeys.erase(keys);
+    count.store(cache.count());
+}
+
+LookupCache::LookupCache()
+        : d(new Private)
+{
+}
+
+LookupCache::~LookupCache()
+{
+    delete d;
+}
+
+int LookupCache::find(const Sheet* sheet, const QRect& range, Qt::Orientation orientation,
+                      const Value& data, const Value& key,
+                      bool caseSensitive, bool approximate, ValueCalc* calc)
+{
+    const int length = (orientation == Qt::Vertical) ? data.rows() : data.columns();
+    if (!sheet || length < g_minimumLength)
+        return NotIndexed;
+
+    LookupKey cacheKey;
+    cacheKey.sheet = sheet;
+    cacheKey.range = range;
+    cacheKey.orientation = orientation;
+    cacheKey.caseSensitive = caseSensitive;
+
+    QSharedPointer<const LookupIndex> index;
+    {
+        QMutexLocker locker(&d->mutex);
+        if (QSharedPointer<const LookupIndex>* cached = d->cache.object(cacheKey))
+            index = *cached;
+    }
+    // The fingerprint catches values, that changed without passing the
+    // cell storage, e.g. by cell indirections.
+    if (!index || index->length != length || index->count != int(data.count())) {
+        LookupIndex* newIndex = new LookupIndex();
+        newIndex->build(data, orientation, caseSensitive);
+        index = QSharedPointer<const LookupIndex>(newIndex);
+        // Unindexable ranges are remembered as well, so that they are not
+        // inspected again on the next call.
+        QMutexLocker locker(&d->mutex);
+        d->cache.insert(cacheKey, new QSharedPointer<const LookupIndex>(index),
+                        index->indexable ? length : 1);
+        QSet<LookupKey>& keys = d->sheetKeys[sheet];
+        if (!keys.contains(cacheKey)) {
+            keys.insert(cacheKey);
+            ++d->keyCount;
+        }
+        // Forget the evicted keys, once they outnumber the cached ones.
+        if (d->keyCount > 2 * d->cache.count() + g_minimumLength) {
+            QHash<const Sheet*, QSet<LookupKey> >::Iterator it = d->sheetKeys.begin();
+            while (it != d->sheetKeys.end()) {
+                QSet<LookupKey>::Iterator key = it->begin();
+                while (key != it->end()) {
+                    if (d->cache.contains(*key))
+                        ++key;
+                    else {
+                        key = it->erase(key);
+                        --d->keyCount;
+                    }
+                }
+                if (it->isEmpty())
+                    it = d->sheetKeys.erase(it);
+                else
+                    ++it;
+            }
+        }
+        d->count.store(d->cache.count());
+    }
+    if (!index->indexable)
+        return NotIndexed;
+    return index->find(data, orientation, key, caseSensitive, approximate, calc);
+}
+
+void LookupCache::invalidate(const Region& region)
+{
+    if (d->count.load() == 0)
+        return;
+    Region::ConstIterator end(region.constEnd());
+    for (Region::ConstIterator it(region.constBegin()); it != end; ++it)
+        invalidate((*it)->sheet(), (*it)->rect());
+}
+
+void LookupCache::invalidate(const Sheet* sheet, const QRect& rect)
+{
+    if (d->count.load() == 0)
+        return;
+    QMutexLocker locker(&d->mutex);
+    d->remove(sheet, rect, false);
+}
+
+void LookupCache::invalidate(const Sheet* sheet)
+{
+    if (d->count.load() == 0)
+        return;
+    QMutexLocker locker(&d->mutex);
+    d->remove(sheet, QRect(), true);
+}
+
+void LookupCache::clear()
+{
+    QMutexLocker locker(&d->mutex);
+    d->cache.clear();
+    d->sheetKeys.clear();
+    d->keyCount = 0;
+    d->count.store(0);
+}
@@ -0,0 +1,109 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CALLIGRA_SHEETS_LOOKUP_CACHE
+#define CALLIGRA_SHEETS_LOOKUP_CACHE
+
+#include <QRect>
+
+#include "sheets_odf_export.h"
+
+namespace Calligra
+{
+namespace Sheets
+{
+class Region;
+class Sheet;
+class Value;
+class ValueCalc;
+
+/**
+ * \ingroup Value
+ * Caches indices of the ranges searched by VLOOKUP, HLOOKUP and MATCH.
+ *
+ * For each searched column or row a sorted list of the numbers and a hash
+ * of the texts are built once, so that repeated lookups into an unchanged
+ * range do not scan it linearly. The results are the same as the ones of
+ * the linear scans in the reference functions, which also remain in use,
+ * whenever the index cannot answer.
+ *
+ * The cache is owned by the DependencyManager. The indices of a range are
+ * dropped as soon as a formula or a value in the range changes.
+ *
+ * The lookups are thread-safe.
+ */
+class CALLIGRA_SHEETS_ODF_EXPORT LookupCache
+{
+public:
+    enum {
+        NotFound = -1,  ///< the key is not in the range
+        NotIndexed = -2 ///< the cache cannot answer, scan the range
+    };
+
+    LookupCache();
+    ~LookupCache();
+
+    /**
+     * Searches \p key in \p data, which holds the values of \p range on
+     * \p sheet. The search runs along the first column of \p data, if
+     * \p orientation is Qt::Vertical, and along the first row otherwise.
+     *
+     * Keys are compared with ValueCalc::naturalEqual(). The first exact
+     * match wins. If there is none and \p approximate is set, the first
+     * occurrence of the largest text lower than \p key is taken, as the
+     * linear scan of VLOOKUP does.
+     *
+     * \return the position of the match in the column or row,
+     * \c NotFound or \c NotIndexed
+     */
+    int find(const Sheet* sheet, const QRect& range, Qt::Orientation orientation,
+             const Value& data, const Value& key,
+             bool caseSensitive, bool approximate, ValueCalc* calc);
+
+    /**
+     * Drops the indices of all ranges intersecting \p region.
+     */
+    void invalidate(const Region& region);
+
+    /**
+     * Drops the indices of all ranges on \p sheet intersecting \p rect.
+     */
+    void invalidate(const Sheet* sheet, const QRect& rect);
+
+    /**
+     * Drops the indices of all ranges on \p sheet.
+     */
+    void invalidate(const Sheet* sheet);
+
+    /**
+     * Drops all indices.
+     */
+    void clear();
+
+private:
+    Q_DISABLE_COPY(LookupCache)
+
+    class Private;
+    Private * const d;
+};
+
+} // namespace Sheets
+} // namespace Calligra
+
+#endif // CALLIGRA_SHEETS_LOOKUP_CACHE
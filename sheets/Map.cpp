@@ -670,8 +670,8 @@ void Map::handleDamages(const QList<Damage*>& damages)
 
             // TODO Stefan: Detach the style cache from the CellView cache.
             if ((changes.testFlag(CellDamage::Appearance))) {
-                // Rebuild the style storage cache.
-                damagedSheet->cellStorage()->invalidateStyleCache(); // FIXME more fine-grained
+                // Rebuild the style storage cache of the damaged region.
+                damagedSheet->cellStorage()->invalidateStyleCache(region);
             }
             if ((cellDamage->changes() & CellDamage::Binding) &&
                     !workbookChanges.testFlag(WorkbookDamage::Value)) {
@@ -0,0 +1,255 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "NumericKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CALLIGRA_SHEETS_SSE2_KERNELS
+#include <emmintrin.h>
+#endif
+
+using namespace Calligra::Sheets;
+
+// The numbers are summed in double with the rounding error of each addition
+// (Knuth's TwoSum) accumulated separately. The partial sums and errors are
+// combined as Number at the end, so cancellation in the doubles does not
+// lose what the walk in Number would keep.
+
+#ifdef CALLIGRA_SHEETS_SSE2_KERNELS
+
+// Each kernel handles four values per iteration in two registers and adds
+// the remainder sequentially.
+
+static inline void add(__m128d& sum, __m128d& error, __m128d value)
+{
+    const __m128d s = _mm_add_pd(sum, value);
+    const __m128d v = _mm_sub_pd(s, sum);
+    error = _mm_add_pd(error, _mm_add_pd(_mm_sub_pd(sum, _mm_sub_pd(s, v)), _mm_sub_pd(value, v)));
+    sum = s;
+}
+
+static inline Number combine(__m128d sum0, __m128d sum1, __m128d error0, __m128d error1)
+{
+    double lanes[8];
+    _mm_storeu_pd(lanes, error0);
+    _mm_storeu_pd(lanes + 2, error1);
+    _mm_storeu_pd(lanes + 4, sum0);
+    _mm_storeu_pd(lanes + 6, sum1);
+    Number result = 0.0;
+    for (int i = 0; i < 8; ++i)
+        result += lanes[i];
+    return result;
+}
+
+Number NumericKernels::sum(const double* values, int count)
+{
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    __m128d error0 = _mm_setzero_pd();
+    __m128d error1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        add(sum0, error0, _mm_loadu_pd(values + i));
+        add(sum1, error1, _mm_loadu_pd(values + i + 2));
+    }
+    Number result = combine(sum0, sum1, error0, error1);
+    for (; i < count; ++i)
+        result += values[i];
+    return result;
+}
+
+Number NumericKernels::sumOfSquares(const double* values, int count)
+{
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    __m128d error0 = _mm_setzero_pd();
+    __m128d error1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128d v0 = _mm_loadu_pd(values + i);
+        const __m128d v1 = _mm_loadu_pd(values + i + 2);
+        add(sum0, error0, _mm_mul_pd(v0, v0));
+        add(sum1, error1, _mm_mul_pd(v1, v1));
+    }
+    Number result = combine(sum0, sum1, error0, error1);
+    for (; i < count; ++i)
+        result += Number(values[i]) * Number(values[i]);
+    return result;
+}
+
+Number NumericKernels::sumOfSquaredDeviations(const double* values, int count, Number mean)
+{
+    // the mean is split into two doubles to keep its precision
+    const double meanHigh = double(numToDouble(mean));
+    const __m128d high = _mm_set1_pd(meanHigh);
+    const __m128d low = _mm_set1_pd(double(numToDouble(mean - Number(meanHigh))));
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    __m128d error0 = _mm_setzero_pd();
+    __m128d error1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128d d0 = _mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(values + i), high), low);
+        const __m128d d1 = _mm_sub_pd(_mm_sub_pd(_mm_loadu_pd(values + i + 2), high), low);
+        add(sum0, error0, _mm_mul_pd(d0, d0));
+        add(sum1, error1, _mm_mul_pd(d1, d1));
+    }
+    Number result = combine(sum0, sum1, error0, error1);
+    for (; i < count; ++i) {
+        const Number deviation = Number(values[i]) - mean;
+        result += deviation * deviation;
+    }
+    return result;
+}
+
+Number NumericKernels::sumOfProducts(const double* values1, const double* values2, int count)
+{
+    __m128d sum0 = _mm_setzero_pd();
+    __m128d sum1 = _mm_setzero_pd();
+    __m128d error0 = _mm_setzero_pd();
+    __m128d error1 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        add(sum0, error0, _mm_mul_pd(_mm_loadu_pd(values1 + i), _mm_loadu_pd(values2 + i)));
+        add(sum1, error1, _mm_mul_pd(_mm_loadu_pd(values1 + i + 2), _mm_loadu_pd(values2 + i + 2)));
+    }
+    Number result = combine(sum0, sum1, error0, error1);
+    for (; i < count; ++i)
+        result += Number(values1[i]) * Number(values2[i]);
+    return result;
+}
+
+#else // CALLIGRA_SHEETS_SSE2_KERNELS
+
+// Four independent partial sums; compilers vectorise these loops on
+// targets with other vector units.
+
+static inline void add(double& sum, double& error, double value)
+{
+    const double s = sum + value;
+    const double v = s - sum;
+    error += (sum - (s - v)) + (value - v);
+    sum = s;
+}
+
+static inline Number combine(const double* sums, const double* errors)
+{
+    Number result = 0.0;
+    for (int j = 0; j < 4; ++j)
+        result += errors[j];
+    for (int j = 0; j < 4; ++j)
+        result += sums[j];
+    return result;
+}
+
+Number NumericKernels::sum(const double* values, int count)
+{
+    double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int j = 0; j < 4; ++j)
+            add(sums[j], errors[j], values[i + j]);
+    }
+    Number result = combine(sums, errors);
+    for (; i < count; ++i)
+        result += values[i];
+    return result;
+}
+
+Number NumericKernels::sumOfSquares(const double* values, int count)
+{
+    double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int j = 0; j < 4; ++j)
+            add(sums[j], errors[j], values[i + j] * values[i + j]);
+    }
+    Number result = combine(sums, errors);
+    for (; i < count; ++i)
+        result += Number(values[i]) * Number(values[i]);
+    return result;
+}
+
+Number NumericKernels::sumOfSquaredDeviations(const double* values, int count, Number mean)
+{
+    // the mean is split into two doubles to keep its precision
+    const double high = double(numToDouble(mean));
+    const double low = double(numToDouble(mean - Number(high)));
+    double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int j = 0; j < 4; ++j) {
+            const double deviation = (values[i + j] - high) - low;
+            add(sums[j], errors[j], deviation * deviation);
+        }
+    }
+    Number result = combine(sums, errors);
+    for (; i < count; ++i) {
+        const Number deviation = Number(values[i]) - mean;
+        result += deviation * deviation;
+    }
+    return result;
+}
+
+Number NumericKernels::sumOfProducts(const double* values1, const double* values2, int count)
+{
+    double sums[4] = { 0.0, 0.0, 0.0, 0.0 };
+    double errors[4] = { 0.0, 0.0, 0.0, 0.0 };
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int j = 0; j < 4; ++j)
+            add(sums[j], errors[j], values1[i + j] * values2[i + j]);
+    }
+    Number result = combine(sums, errors);
+    for (; i < count; ++i)
+        result += Number(values1[i]) * Number(values2[i]);
+    return result;
+}
+
+#endif // CALLIGRA_SHEETS_SSE2_KERNELS
+
+Number NumericKernels::sum(const NumberList& numbers)
+{
+    const QVector<QPair<const double*, int> >& runs = numbers.runs();
+    Number result = sum(numbers.buffer().constData(), numbers.buffer().count());
+    for (int i = 0; i < runs.count(); ++i)
+        result += sum(runs[i].first, runs[i].second);
+    return result;
+}
+
+Number NumericKernels::sumOfSquares(const NumberList& numbers)
+{
+    const QVector<QPair<const double*, int> >& runs = numbers.runs();
+    Number result = sumOfSquares(numbers.buffer().constData(), numbers.buffer().count());
+    for (int i = 0; i < runs.count(); ++i)
+        result += sumOfSquares(runs[i].first, runs[i].second);
+    return result;
+}
+
+Number NumericKernels::sumOfSquaredDeviations(const NumberList& numbers, Number mean)
+{
+    const QVector<QPair<const double*, int> >& runs = numbers.runs();
+    Number result = sumOfSquaredDeviations(numbers.buffer().constData(), numbers.buffer().count(), mean);
+    for (int i = 0; i < runs.count(); ++i)
+        result += sumOfSquaredDeviations(runs[i].first, runs[i].second, mean);
+    return result;
+}
@@ -0,0 +1,151 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CALLIGRA_SHEETS_NUMERIC_KERNELS
+#define CALLIGRA_SHEETS_NUMERIC_KERNELS
+
+#include <QPair>
+#include <QVector>
+
+#include "Number.h"
+
+#include "sheets_odf_export.h"
+
+namespace Calligra
+{
+namespace Sheets
+{
+
+/**
+ * \ingroup Value
+ * The numbers of the arguments of a range function.
+ *
+ * Runs of numbers, that are already stored contiguously, e.g. in a
+ * ColumnarValueStorage, are referenced in place. All other numbers are
+ * copied into an own buffer. The referenced runs have to stay valid as
+ * long as the list is used.
+ * \see ValueCalc::collectNumbers
+ */
+class NumberList
+{
+public:
+    NumberList() : m_count(0) {}
+
+    /**
+     * Copies \p number into the list.
+     */
+    void append(double number) {
+        m_buffer.append(number);
+        ++m_count;
+    }
+
+    /**
+     * References the \p count numbers at \p numbers .
+     */
+    void appendRun(const double* numbers, int count) {
+        if (count > 0) {
+            m_runs.append(qMakePair(numbers, count));
+            m_count += count;
+        }
+    }
+
+    /**
+     * \return the number of numbers
+     */
+    int count() const {
+        return m_count;
+    }
+
+    bool isEmpty() const {
+        return m_count == 0;
+    }
+
+    /**
+     * \return the referenced runs
+     */
+    const QVector<QPair<const double*, int> >& runs() const {
+        return m_runs;
+    }
+
+    /**
+     * \return the copied numbers
+     */
+    const QVector<double>& buffer() const {
+        return m_buffer;
+    }
+
+private:
+    QVector<QPair<const double*, int> > m_runs;
+    QVector<double> m_buffer;
+    int m_count;
+};
+
+/**
+ * Reductions over contiguous arrays of doubles.
+ *
+ * These are the inner loops of the range functions (SUM, AVERAGE, STDEV,
+ * SUMPRODUCT, ...) once the numbers have been collected by
+ * ValueCalc::collectNumbers(). They use SSE2 where available and keep
+ * four partial sums. The rounding error of each addition is accumulated
+ * separately and the partial sums are combined as Number, so the results
+ * are as precise as the sequential walk over the values in Number.
+ */
+namespace NumericKernels
+{
+/**
+ * \return the sum of the \p count values in \p values
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sum(const double* values, int count);
+
+/**
+ * \return the sum of the squares of the \p count values in \p values
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sumOfSquares(const double* values, int count);
+
+/**
+ * \return the sum of the squared deviations of \p values from \p mean
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sumOfSquaredDeviations(const double* values, int count, Number mean);
+
+/**
+ * \return the sum of the products of \p values1 and \p values2
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sumOfProducts(const double* values1, const double* values2, int count);
+
+/**
+ * \return the sum of \p numbers
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sum(const NumberList& numbers);
+
+/**
+ * \return the sum of the squares of \p numbers
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sumOfSquares(const NumberList& numbers);
+
+/**
+ * \return the sum of the squared deviations of \p numbers from \p mean
+ */
+CALLIGRA_SHEETS_ODF_EXPORT Number sumOfSquaredDeviations(const NumberList& numbers, Number mean);
+
+} // namespace NumericKernels
+
+} // namespace Sheets
+} // namespace Calligra
+
+#endif // CALLIGRA_SHEETS_NUMERIC_KERNELS
@@ -38,9 +38,43 @@
 
 #include <QHash>
 #include <QMap>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
 
 using namespace Calligra::Sheets;
 
+// Levels with fewer cells than this are evaluated on the calling thread;
+// the overhead of dispatching them to the pool outweighs the gain.
+static const int g_minimumCellsPerJob = 64;
+
+namespace Calligra
+{
+namespace Sheets
+{
+/**
+ * \internal
+ * Evaluates the formulas of a slice of cells, which all have the same
+ * reference depth and thus are independent of each other.
+ * The results are only stored; they are written to the cells by the
+ * thread owning the RecalcManager, once all jobs of a level are done.
+ */
+class RecalcJob : public QRunnable
+{
+public:
+    RecalcJob(const Cell* cells, Value* results, bool* evaluated, int count)
+        : m_cells(cells), m_results(results), m_evaluated(evaluated), m_count(count) {}
+    virtual void run();
+private:
+    const Cell* m_cells;
+    Value* m_results;
+    bool* m_evaluated;
+    int m_count;
+};
+} // namespace Sheets
+} // namespace Calligra
+
 class Q_DECL_HIDDEN RecalcManager::Private
 {
 public:
@@ -62,9 +96,22 @@ public:
     void cellsToCalculate(Sheet* sheet = 0);
 
     /**
-     * Helper function for cellsToCalculate(const Region&) and cellsToCalculate(Sheet*).
+     * Evaluates the formula of \p cell .
+     * \return \c false , if the cell has to be skipped
+     */
+    static bool evaluate(const Cell& cell, Value& result);
+
+    /**
+     * Stores the evaluation \p result of the formula in \p cell .
+     * Takes care of array formulas spanning a range of locked cells.
+     */
+    static void setResult(const Cell& cell, const Value& result);
+
+    /**
+     * Evaluates the cells of one reference depth level on the thread pool
+     * and stores the results afterwards.
      */
-    void cellsToCalculate(const Region& region, QSet<Cell>& cells) const;
+    void recalcLevel(const QVector<Cell>& level);
 
     /*
      * Stores cells ordered by its reference depth.
@@ -84,30 +131,100 @@ public:
     QMap<int, Cell> cells;
     const Map* map;
     bool active;
+    int threadCount;
+    QThreadPool* threadPool;
 };
 
+void RecalcJob::run()
+{
+    for (int i = 0; i < m_count; ++i)
+        m_evaluated[i] = RecalcManager::Private::evaluate(m_cells[i], m_results[i]);
+}
+
+bool RecalcManager::Private::evaluate(const Cell& cell, Value& result)
+{
+    // only recalculate, if no circular dependency occurred
+    if (cell.value() == Value::errorCIRCLE())
+        return false;
+    // Check for valid formula; parses the expression, if not done already.
+    if (!cell.formula().isValid())
+        return false;
+    // evaluate the formula
+    result = cell.formula().eval();
+    return true;
+}
+
+void RecalcManager::Private::setResult(const Cell& cell, const Value& result)
+{
+    const Sheet* sheet = cell.sheet();
+    if (result.isArray() && (result.columns() > 1 || result.rows() > 1)) {
+        const QRect rect = cell.lockedCells();
+        // unlock
+        sheet->cellStorage()->unlockCells(rect.left(), rect.top());
+        for (int row = rect.top(); row <= rect.bottom(); ++row) {
+            for (int col = rect.left(); col <= rect.right(); ++col) {
+                Cell(sheet, col, row).setValue(result.element(col - rect.left(), row - rect.top()));
+            }
+        }
+        // relock
+        sheet->cellStorage()->lockCells(rect);
+    } else {
+        Cell(cell).setValue(result);
+    }
+}
+
+void RecalcManager::Private::recalcLevel(const QVector<Cell>& level)
+{
+    const int count = level.count();
+    QVector<Value> results(count);
+    QVector<bool> evaluated(count);
+
+    // The formulas get parsed lazily. Do it here, not concurrently in the jobs.
+    for (int i = 0; i < count; ++i)
+        level[i].formula().isValid();
+
+    if (count < 2 * g_minimumCellsPerJob) {
+        for (int i = 0; i < count; ++i)
+            evaluated[i] = evaluate(level[i], results[i]);
+    } else {
+        const int jobCount = qMin(threadPool->maxThreadCount(), count / g_minimumCellsPerJob);
+        const int chunk = (count + jobCount - 1) / jobCount;
+        Value* resultData = results.data();
+        bool* evaluatedData = evaluated.data();
+        for (int begin = 0; begin < count; begin += chunk) {
+            const int size = qMin(chunk, count - begin);
+            threadPool->start(new RecalcJob(level.constData() + begin, resultData + begin,
+                                            evaluatedData + begin, size));
+        }
+        // barrier: the next level depends on the values of this one
+        threadPool->waitForDone();
+    }
+
+    // Write the values back on this thread. The storages, the damages and
+    // the undo recording are not meant to be accessed concurrently.
+    for (int i = 0; i < count; ++i) {
+        if (evaluated[i])
+            setResult(level[i], results[i]);
+    }
+}
+
 void RecalcManager::Private::cellsToCalculate(const Region& region)
 {
     if (region.isEmpty())
         return;
 
-    // retrieve the cell depths
-    QMap<Cell, int> depths = map->dependencyManager()->depths();
-
-    // create the cell map ordered by depth
-    QSet<Cell> cells;
-    cellsToCalculate(region, cells);
-    const QSet<Cell>::ConstIterator end(cells.end());
-    for (QSet<Cell>::ConstIterator it(cells.begin()); it != end; ++it) {
-        if ((*it).sheet()->isAutoCalculationEnabled())
-            this->cells.insertMulti(depths[*it], *it);
+    // Only the transitive consumers of region get visited.
+    const QMap<int, Cell> dirtyCells = map->dependencyManager()->dirtyCells(region);
+    const QMap<int, Cell>::ConstIterator end(dirtyCells.constEnd());
+    for (QMap<int, Cell>::ConstIterator it(dirtyCells.constBegin()); it != end; ++it) {
+        if (it.value().sheet()->isAutoCalculationEnabled())
+            this->cells.insertMulti(it.key(), it.value());
     }
 }
 
 void RecalcManager::Private::cellsToCalculate(Sheet* sheet)
 {
-    // retrieve the cell depths
-    QMap<Cell, int> depths = map->dependencyManager()->depths();
+    const DependencyManager* manager = map->dependencyManager();
 
     // NOTE Stefan: It's necessary, that the cells are filled in row-wise;
     //              beginning with the top left; ending with the bottom right.
@@ -121,40 +238,13 @@ void RecalcManager::Private::cellsToCalculate(Sheet* sheet)
             sheet = map->sheet(s);
             for (int c = 0; c < sheet->formulaStorage()->count(); ++c) {
                 cell = Cell(sheet, sheet->formulaStorage()->col(c), sheet->formulaStorage()->row(c));
-                cells.insertMulti(depths[cell], cell);
+                cells.insertMulti(manager->depth(cell), cell);
             }
         }
     } else { // sheet recalculation
         for (int c = 0; c < sheet->formulaStorage()->count(); ++c) {
             cell = Cell(sheet, sheet->formulaStorage()->col(c), sheet->formulaStorage()->row(c));
-            cells.insertMulti(depths[cell], cell);
-        }
-    }
-}
-
-void RecalcManager::Private::cellsToCalculate(const Region& region, QSet<Cell>& cells) const
-{
-    Region::ConstIterator end(region.constEnd());
-    for (Region::ConstIterator it(region.constBegin()); it != end; ++it) {
-        const QRect range = (*it)->rect();
-        const Sheet* sheet = (*it)->sheet();
-        for (int col = range.left(); col <= range.right(); ++col) {
-            for (int row = range.top(); row <= range.bottom(); ++row) {
-                Cell cell(sheet, col, row);
-                // Even empty cells may act as value
-                // providers and need to be processed.
-
-                // check for already processed cells
-                if (cells.contains(cell))
-                    continue;
-
-                // add it to the list
-                if (cell.isFormula())
-                    cells.insert(cell);
-
-                // add its consumers to the list
-                cellsToCalculate(map->dependencyManager()->consumingRegion(cell), cells);
-            }
+            cells.insertMulti(manager->depth(cell), cell);
         }
     }
 }
@@ -165,13 +255,36 @@ RecalcManager::RecalcManager(Map *const map)
 {
     d->map  = map;
     d->active = false;
+    d->threadCount = 1;
+    d->threadPool = 0;
 }
 
 RecalcManager::~RecalcManager()
 {
+    delete d->threadPool;
     delete d;
 }
 
+void RecalcManager::setThreadCount(int count)
+{
+    if (count <= 0)
+        count = QThread::idealThreadCount();
+    d->threadCount = qMax(1, count);
+    if (d->threadCount == 1) {
+        delete d->threadPool;
+        d->threadPool = 0;
+        return;
+    }
+    if (!d->threadPool)
+        d->threadPool = new QThreadPool();
+    d->threadPool->setMaxThreadCount(d->threadCount);
+}
+
+int RecalcManager::threadCount() const
+{
+    return d->threadCount;
+}
+
 void RecalcManager::regionChanged(const Region& region)
 {
     if (d->active || region.isEmpty())
@@ -238,34 +351,32 @@ void RecalcManager::recalc(KoUpdater *updater)
 
     const QList<Cell> cells = d->cells.values();
     const int cellsCount = cells.count();
-    for (int c = 0; c < cellsCount; ++c) {
-        // only recalculate, if no circular dependency occurred
-        if (cells.value(c).value() == Value::errorCIRCLE())
-            continue;
-        // Check for valid formula; parses the expression, if not done already.
-        if (!cells.value(c).formula().isValid())
-            continue;
-
-        const Sheet* sheet = cells.value(c).sheet();
-
-        // evaluate the formula and set the result
-        Value result = cells.value(c).formula().eval();
-        if (result.isArray() && (result.columns() > 1 || result.rows() > 1)) {
-            const QRect rect = cells.value(c).lockedCells();
-            // unlock
-            sheet->cellStorage()->unlockCells(rect.left(), rect.top());
-            for (int row = rect.top(); row <= rect.bottom(); ++row) {
-                for (int col = rect.left(); col <= rect.right(); ++col) {
-                    Cell(sheet, col, row).setValue(result.element(col - rect.left(), row - rect.top()));
-                }
-            }
-            // relock
-            sheet->cellStorage()->lockCells(rect);
-        } else {
-            Cell(cells.value(c)).setValue(result);
+    if (d->threadCount > 1) {
+        // Cells of the same reference depth do not depend on each other.
+        // Evaluate them level by level.
+        QVector<Cell> level;
+        int processed = 0;
+        QMap<int, Cell>::ConstIterator end(d->cells.constEnd());
+        for (QMap<int, Cell>::ConstIterator it(d->cells.constBegin()); it != end; ++it) {
+            level.append(it.value());
+            QMap<int, Cell>::ConstIterator next = it + 1;
+            if (next != end && next.key() == it.key())
+                continue;
+            d->recalcLevel(level);
+            processed += level.count();
+            level.clear();
+            if (updater)
+                updater->setProgress(int(qreal(processed) / qreal(cellsCount) * 100.));
+        }
+    } else {
+        Value result;
+        for (int c = 0; c < cellsCount; ++c) {
+            // evaluate the formula and set the result
+            if (d->evaluate(cells.value(c), result))
+                d->setResult(cells.value(c), result);
+            if (updater)
+                updater->setProgress(int(qreal(c) / qreal(cellsCount) * 100.));
         }
-        if (updater)
-            updater->setProgress(int(qreal(c) / qreal(cellsCount) * 100.));
     }
 
     if (updater)
@@ -51,6 +51,12 @@ class Sheet;
  *
  * Cell value changes are blocked while doing this, i.e. they do not
  * trigger a new recalculation event.
+ *
+ * As the cells of one reference depth do not depend on each other, they
+ * can be evaluated concurrently. If more than one thread is allowed, each
+ * depth level is evaluated on a thread pool. The results are written to
+ * the cells after all cells of the level have been evaluated, before the
+ * next level starts.
  */
 class CALLIGRA_SHEETS_ODF_EXPORT RecalcManager : public QObject
 {
@@ -98,6 +104,20 @@ public:
      */
     bool isActive() const;
 
+    /**
+     * Sets the number of threads used to evaluate the cells of one
+     * reference depth level.
+     * A value of \c 1 , the default, recalculates all cells on the calling
+     * thread. A value of \c 0 or less uses QThread::idealThreadCount().
+     */
+    void setThreadCount(int count);
+
+    /**
+     * \return the number of threads used for recalculations
+     * \see setThreadCount()
+     */
+    int threadCount() const;
+
     /**
      * Prints out the cell depths in the current recalculation event.
      */
@@ -126,6 +146,7 @@ protected:
 private:
     Q_DISABLE_COPY(RecalcManager)
 
+    friend class RecalcJob;
     class Private;
     Private * const d;
 };
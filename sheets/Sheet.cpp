@@ -392,6 +392,16 @@ void Sheet::setShowColumnNumber(bool _showColumnNumber)
     d->showColumnNumber = _showColumnNumber;
 }
 
+bool Sheet::isColumnarStorageEnabled() const
+{
+    return d->cellStorage->columnarValueStorage() != 0;
+}
+
+void Sheet::setColumnarStorageEnabled(bool enable)
+{
+    d->cellStorage->setColumnarValueStorageEnabled(enable);
+}
+
 bool Sheet::getHideZero() const
 {
     return d->hideZero;
@@ -81,6 +81,7 @@ class CALLIGRA_SHEETS_ODF_EXPORT Sheet : public KoShapeUserData, public KoShapeB
     Q_OBJECT
     Q_PROPERTY(QString sheetName READ sheetName)
     Q_PROPERTY(bool autoCalc READ isAutoCalculationEnabled WRITE setAutoCalculationEnabled)
+    Q_PROPERTY(bool columnarStorage READ isColumnarStorageEnabled WRITE setColumnarStorageEnabled)
     Q_PROPERTY(bool showGrid READ getShowGrid WRITE setShowGrid)
 
 public:
@@ -226,6 +227,22 @@ public:
 
     void setAutoCalculationEnabled(bool enable);
 
+    /**
+     * \return \c true, if the cell values are also kept column-wise
+     * \see setColumnarStorageEnabled
+     */
+    bool isColumnarStorageEnabled() const;
+
+    /**
+     * Keeps a typed, column-wise copy of the cell values, if \p enable is
+     * \c true. The range functions read numbers from it without copying
+     * them. It pays off for large, numeric sheets, but does not save memory:
+     * the copy adds about 10 bytes per cell of densely filled columns, and
+     * up to 2.6 KiB per value in sparse ones, to the regular value storage.
+     * \see ColumnarValueStorage
+     */
+    void setColumnarStorageEnabled(bool enable);
+
     bool getShowColumnNumber() const;
 
     void setShowColumnNumber(bool _showColumnNumber);
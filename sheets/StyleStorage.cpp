@@ -21,14 +21,14 @@
 // Local
 #include "StyleStorage.h"
 
-#include <QCache>
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QRegion>
 #include <QTimer>
 #include <QRunnable>
-#ifdef CALLIGRA_SHEETS_MT
-#include <QMutex>
-#include <QMutexLocker>
-#endif
 
 #include "Global.h"
 #include "Map.h"
@@ -37,18 +37,55 @@
 #include "StyleManager.h"
 #include "RectStorage.h"
 
-static const int g_maximumCachedStyles = 10000;
+// The cached styles are grouped by tiles of 32x32 cells.
+static const int g_tileShift = 5;
+// The number of independently locked parts of the cache; a power of two.
+static const int g_cacheShards = 16;
+// The number of tiles cached per shard, i.e. 128 tiles or 131072 cells in
+// total; enough for several screens, even if some of their tiles share a shard.
+static const int g_maximumCachedTiles = 8;
 
 using namespace Calligra::Sheets;
 
+namespace
+{
+typedef QHash<QPoint, Style> StyleCacheTile;
+
+/**
+ * A part of the style cache. Each tile is cached in exactly one shard,
+ * so that lookups of different tiles do not contend for the same lock.
+ * If the shard is full, its least recently used tile is dropped.
+ */
+class StyleCacheShard
+{
+public:
+    QMutex mutex;
+    QHash<QPoint, StyleCacheTile> tiles;
+    QList<QPoint> recentTiles; // the least recently used first
+
+    void touch(const QPoint& tile) {
+        if (recentTiles.last() != tile) {
+            recentTiles.removeOne(tile);
+            recentTiles.append(tile);
+        }
+    }
+};
+
+inline QPoint tileOf(const QPoint& point)
+{
+    return QPoint((point.x() - 1) >> g_tileShift, (point.y() - 1) >> g_tileShift);
+}
+
+inline QRect tileRect(const QPoint& tile)
+{
+    const int size = 1 << g_tileShift;
+    return QRect(QPoint(tile.x() * size + 1, tile.y() * size + 1), QSize(size, size));
+}
+} // namespace
+
 class Q_DECL_HIDDEN StyleStorage::Private
 {
 public:
-    Private()
-#ifdef CALLIGRA_SHEETS_MT
-        : cacheMutex(QMutex::Recursive)
-#endif
-    {}
     Map* map;
     RTree<SharedSubStyle> tree;
     QMap<int, bool> usedColumns; // FIXME Stefan: Use QList and qUpperBound() for insertion.
@@ -56,14 +93,20 @@ public:
     QRegion usedArea;
     QHash<Style::Key, QList<SharedSubStyle> > subStyles;
     QMap<int, QPair<QRectF, SharedSubStyle> > possibleGarbage;
-    QCache<QPoint, Style> cache;
-    QRegion cachedArea;
+    StyleCacheShard cacheShards[g_cacheShards];
+    // Avoids locking the shards on invalidations, as long as nothing is cached.
+    QAtomicInt cachedStyles;
     StyleStorageLoaderJob* loader;
-#ifdef CALLIGRA_SHEETS_MT
-    QMutex cacheMutex;
-#endif
 
     void ensureLoaded();
+
+    StyleCacheShard& shard(const QPoint& tile) {
+        // neighbouring tiles end up in different shards
+        return cacheShards[(tile.x() * 7 + tile.y()) & (g_cacheShards - 1)];
+    }
+    void insertIntoCache(const QPoint& point, const Style& style);
+    void invalidateCache(const QRect& rect);
+    void clearCache();
 };
 
 class Calligra::Sheets::StyleStorageLoaderJob : public QRunnable
@@ -106,13 +149,7 @@ void StyleStorageLoaderJob::run()
     d->usedArea = QRegion();
     d->usedColumns.clear();
     d->usedRows.clear();
-    {
-#ifdef CALLIGRA_SHEETS_MT
-        QMutexLocker(&d->cacheMutex);
-#endif
-        d->cachedArea = QRegion();
-        d->cache.clear();
-    }
+    d->clearCache();
     typedef QPair<QRegion, Style> StyleRegion;
     foreach (const StyleRegion& styleArea, m_styles) {
         const QRegion& reg = styleArea.first;
@@ -175,12 +212,81 @@ void StyleStorage::Private::ensureLoaded()
     }
 }
 
+void StyleStorage::Private::insertIntoCache(const QPoint& point, const Style& style)
+{
+    const QPoint tile = tileOf(point);
+    StyleCacheShard& shard = this->shard(tile);
+    QMutexLocker locker(&shard.mutex);
+    QHash<QPoint, StyleCacheTile>::Iterator it = shard.tiles.find(tile);
+    if (it == shard.tiles.end()) {
+        // make room by dropping the least recently used tile
+        if (shard.tiles.count() >= g_maximumCachedTiles) {
+            const int dropped = shard.tiles.take(shard.recentTiles.takeFirst()).count();
+            cachedStyles.fetchAndAddOrdered(-dropped);
+        }
+        it = shard.tiles.insert(tile, StyleCacheTile());
+        shard.recentTiles.append(tile);
+    } else if (it->contains(point)) {
+        return;
+    } else {
+        shard.touch(tile);
+    }
+    it->insert(point, style);
+    cachedStyles.ref();
+}
+
+void StyleStorage::Private::invalidateCache(const QRect& rect)
+{
+    if (cachedStyles.load() == 0)
+        return;
+    const QRect tiles(tileOf(rect.topLeft()), tileOf(rect.bottomRight()));
+    for (int i = 0; i < g_cacheShards; ++i) {
+        StyleCacheShard& shard = cacheShards[i];
+        QMutexLocker locker(&shard.mutex);
+        if (shard.tiles.isEmpty())
+            continue;
+        int dropped = 0;
+        QHash<QPoint, StyleCacheTile>::Iterator it = shard.tiles.begin();
+        while (it != shard.tiles.end()) {
+            if (!tiles.contains(it.key())) {
+                ++it;
+            } else if (rect.contains(tileRect(it.key()))) {
+                dropped += it->count();
+                shard.recentTiles.removeOne(it.key());
+                it = shard.tiles.erase(it);
+            } else {
+                StyleCacheTile::Iterator cell = it->begin();
+                while (cell != it->end()) {
+                    if (rect.contains(cell.key())) {
+                        cell = it->erase(cell);
+                        ++dropped;
+                    } else {
+                        ++cell;
+                    }
+                }
+                ++it;
+            }
+        }
+        cachedStyles.fetchAndAddOrdered(-dropped);
+    }
+}
+
+void StyleStorage::Private::clearCache()
+{
+    for (int i = 0; i < g_cacheShards; ++i) {
+        StyleCacheShard& shard = cacheShards[i];
+        QMutexLocker locker(&shard.mutex);
+        shard.tiles.clear();
+        shard.recentTiles.clear();
+    }
+    cachedStyles.store(0);
+}
+
 StyleStorage::StyleStorage(Map* map)
         : QObject(map)
         , d(new Private)
 {
     d->map = map;
-    d->cache.setMaxCost(g_maximumCachedStyles);
     d->loader = 0;
 }
 
@@ -214,47 +320,26 @@ Style StyleStorage::contains(const QPoint& point) const
     if (!d->usedArea.contains(point) && !d->usedColumns.contains(point.x()) && !d->usedRows.contains(point.y()))
         return *styleManager()->defaultStyle();
 
+    // first, lookup point in the cache
+    const QPoint tile = tileOf(point);
+    StyleCacheShard& shard = d->shard(tile);
     {
-#ifdef CALLIGRA_SHEETS_MT
-        QMutexLocker ml(&d->cacheMutex);
-#endif
-        // first, lookup point in the cache
-        if (d->cache.contains(point)) {
-            Style st = *d->cache.object(point);
-            //if (point.x() == 1 && point.y() == 1) {debugSheetsStyle <<"StyleStorage: cached style:"<<point<<':'; st.dump();}
-            return st;
+        QMutexLocker locker(&shard.mutex);
+        QHash<QPoint, StyleCacheTile>::ConstIterator it = shard.tiles.constFind(tile);
+        if (it != shard.tiles.constEnd()) {
+            StyleCacheTile::ConstIterator cached = it->constFind(point);
+            if (cached != it->constEnd()) {
+                shard.touch(tile);
+                return *cached;
+            }
         }
     }
     // not found, lookup in the tree
     QList<SharedSubStyle> subStyles = d->tree.contains(point);
-    //if (point.x() == 1 && point.y() == 1) {debugSheetsStyle <<"StyleStorage: substyles:"<<point<<':'; for (const SharedSubStyle &s : subStyles) {debugSheetsStyle<<s.data()->debugData();}}
-    if (subStyles.isEmpty()) {
-        Style *style = styleManager()->defaultStyle();
-        // let's try caching empty styles too, the lookup is rather expensive still
-        {
-#ifdef CALLIGRA_SHEETS_MT
-            QMutexLocker ml(&d->cacheMutex);
-#endif
-            // insert style into the cache
-            d->cache.insert(point, style);
-            d->cachedArea += QRect(point, point);
-        }
-
-        return *style;
-    }
-    Style* style = new Style();
-    (*style) = composeStyle(subStyles);
-
-    {
-#ifdef CALLIGRA_SHEETS_MT
-        QMutexLocker ml(&d->cacheMutex);
-#endif
-        // insert style into the cache
-        d->cache.insert(point, style);
-        d->cachedArea += QRect(point, point);
-    }
-    //if (point.x() == 1 && point.y() == 1) {debugSheetsStyle <<"StyleStorage: style:"<<point<<':'; style->dump();}
-    return *style;
+    // let's try caching empty styles too, the lookup is rather expensive still
+    const Style style = subStyles.isEmpty() ? *styleManager()->defaultStyle() : composeStyle(subStyles);
+    d->insertIntoCache(point, style);
+    return style;
 }
 
 Style StyleStorage::contains(const QRect& rect) const
@@ -675,11 +760,18 @@ void StyleStorage::invalidateCache()
     if (d->loader && !d->loader->isFinished())
         return;
 
-#ifdef CALLIGRA_SHEETS_MT
-    QMutexLocker ml(&d->cacheMutex);
-#endif
-    d->cache.clear();
-    d->cachedArea = QRegion();
+    d->clearCache();
+}
+
+void StyleStorage::invalidateCache(const Region& region)
+{
+    // still busy loading? no cache to invalidate
+    if (d->loader && !d->loader->isFinished())
+        return;
+
+    Region::ConstIterator end(region.constEnd());
+    for (Region::ConstIterator it(region.constBegin()); it != end; ++it)
+        d->invalidateCache((*it)->rect());
 }
 
 void StyleStorage::garbageCollection()
@@ -823,6 +915,8 @@ void StyleStorage::regionChanged(const QRect& rect)
     // still busy loading? no garbage to collect
     if (d->loader && !d->loader->isFinished())
         return;
+    // invalidate cache
+    invalidateCache(rect);
     if (d->map->isLoading())
         return;
     // mark the possible garbage
@@ -830,8 +924,6 @@ void StyleStorage::regionChanged(const QRect& rect)
     // has to be inserted most recently, because it should be accessed first.
     d->possibleGarbage = d->tree.intersectingPairs(rect).unite(d->possibleGarbage);
     QTimer::singleShot(g_garbageCollectionTimeOut, this, SLOT(garbageCollection()));
-    // invalidate cache
-    invalidateCache(rect);
 }
 
 void StyleStorage::invalidateCache(const QRect& rect)
@@ -840,20 +932,8 @@ void StyleStorage::invalidateCache(const QRect& rect)
     if (d->loader && !d->loader->isFinished())
         return;
 
-#ifdef CALLIGRA_SHEETS_MT
-    QMutexLocker ml(&d->cacheMutex);
-#endif
 //     debugSheetsStyle <<"StyleStorage: Invalidating" << rect;
-    const QRegion region = d->cachedArea.intersected(rect);
-    d->cachedArea = d->cachedArea.subtracted(rect);
-    foreach(const QRect& rect, region.rects()) {
-        for (int col = rect.left(); col <= rect.right(); ++col) {
-            for (int row = rect.top(); row <= rect.bottom(); ++row) {
-//                 debugSheetsStyle <<"StyleStorage: Removing cached style for" << Cell::name( col, row );
-                d->cache.remove(QPoint(col, row));     // also deletes it
-            }
-        }
-    }
+    d->invalidateCache(rect);
 }
 
 Style StyleStorage::composeStyle(const QList<SharedSubStyle>& subStyles) const
@@ -46,6 +46,11 @@ class StyleStorageLoaderJob;
  * Acts mainly as a wrapper around the R-Tree data structure to allow a future
  * replacement of this backend. Decorated with some additional features like
  * garbage collection, caching, used area tracking, etc.
+ *
+ * The composed styles of single cells are cached per tile of cells. The
+ * tiles are spread over several independently locked shards, so that
+ * concurrent lookups, e.g. of the cell views painted by multiple threads,
+ * rarely block each other.
  */
 class CALLIGRA_SHEETS_ODF_EXPORT StyleStorage : public QObject
 {
@@ -196,6 +201,11 @@ public:
      */
     void invalidateCache();
 
+    /**
+     * Invalidates the cached styles lying in \p region .
+     */
+    void invalidateCache(const Region& region);
+
 protected Q_SLOTS:
     void garbageCollection();
 
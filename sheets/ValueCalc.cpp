@@ -21,7 +21,13 @@
 #include "ValueCalc.h"
 
 #include "Cell.h"
+#include "CellStorage.h"
+#include "ColumnarValueStorage.h"
+#include "Function.h"
 #include "Number.h"
+#include "NumericKernels.h"
+#include "Region.h"
+#include "Sheet.h"
 #include "ValueConverter.h"
 #include "CalculationSettings.h"
 #include "SheetsDebug.h"
@@ -1921,17 +1927,199 @@ void ValueCalc::registerAwFunc(const QString &name, arrayWalkFunc func)
     awFuncs[name] = func;
 }
 
+// The kernels work on doubles. Numbers, that need the extended precision
+// of Number, are left to the generic walk.
+static bool isDouble(Number number)
+{
+    return Number(double(numToDouble(number))) == number;
+}
+
+bool ValueCalc::collectNumbers(const Value &range, NumberList &numbers,
+                               bool full, bool booleans, bool plainNumbers)
+{
+    if (range.isArray()) {
+        // iterate over the non-empty entries
+        for (uint i = 0; i < range.count(); ++i) {
+            if (!collectNumbers(range.element(i), numbers, full, booleans, plainNumbers))
+                return false;
+        }
+        return true;
+    }
+
+    switch (range.type()) {
+    case Value::Empty:
+        return true;
+    case Value::Boolean:
+        if (full || booleans)
+            numbers.append(range.asBoolean() ? 1.0 : 0.0);
+        return true;
+    case Value::Integer: {
+        if (plainNumbers && range.format() != Value::fmt_Number)
+            return false;
+        const double number = double(range.asInteger());
+        if (qint64(number) != range.asInteger())
+            return false;
+        numbers.append(number);
+        return true;
+    }
+    case Value::Float:
+        if (plainNumbers && range.format() != Value::fmt_Number)
+            return false;
+        if (!isDouble(range.asFloat()))
+            return false;
+        numbers.append(double(numToDouble(range.asFloat())));
+        return true;
+    case Value::String:
+        // the A-versions convert text, leave that to the converter
+        return !full;
+    default:
+        // errors have to be propagated, complex numbers converted
+        return false;
+    }
+}
+
+// References the runs of numbers of rect in storage; the same rules as for
+// the values apply.
+static bool collectColumnarNumbers(const ColumnarValueStorage *storage, const QRect &rect,
+                                   NumberList &numbers, bool full, bool booleans, bool plainNumbers)
+{
+    const QVector<ColumnarValueStorage::Segment> segments = storage->segments(rect);
+    for (int s = 0; s < segments.count(); ++s) {
+        const ColumnarValueStorage::Segment &segment = segments[s];
+        int start = 0;
+        for (int i = 0; i < segment.count; ++i) {
+            bool isNumber = false;
+            switch (segment.kinds[i]) {
+            case ColumnarValueStorage::Empty:
+                break;
+            case ColumnarValueStorage::Boolean:
+                isNumber = full || booleans;
+                break;
+            case ColumnarValueStorage::Integer:
+            case ColumnarValueStorage::Float:
+                if (plainNumbers && segment.formats[i] != Value::fmt_Number)
+                    return false;
+                isNumber = true;
+                break;
+            case ColumnarValueStorage::String:
+                if (full)
+                    return false;
+                break;
+            default:
+                return false;
+            }
+            // anything skipped ends the current run
+            if (!isNumber) {
+                numbers.appendRun(segment.numbers + start, i - start);
+                start = i + 1;
+            }
+        }
+        numbers.appendRun(segment.numbers + start, segment.count - start);
+    }
+    return true;
+}
+
+bool ValueCalc::collectNumbers(const QVector<Value> &range, NumberList &numbers,
+                               bool full, bool booleans, bool plainNumbers,
+                               const FuncExtra *extra)
+{
+    for (int i = 0; i < range.count(); ++i) {
+        // a cell range argument of a sheet with a columnar storage?
+        const ColumnarValueStorage *storage = 0;
+        QRect rect;
+        if (extra && i < extra->regions.count() && range[i].isArray()) {
+            const Region &region = extra->regions[i];
+            if (region.isValid() && region.isContiguous() && !region.isSingular()) {
+                rect = region.firstRange();
+                storage = region.firstSheet()->cellStorage()->columnarValueStorage();
+            }
+        }
+        if (storage && int(range[i].columns()) == rect.width() && int(range[i].rows()) == rect.height()) {
+            if (!collectColumnarNumbers(storage, rect, numbers, full, booleans, plainNumbers))
+                return false;
+        } else if (!collectNumbers(range[i], numbers, full, booleans, plainNumbers))
+            return false;
+    }
+    return true;
+}
+
+static bool pairElement(const Value &value, double &number, bool &isNumber)
+{
+    switch (value.type()) {
+    case Value::Empty:
+        number = 0.0;
+        return true;
+    case Value::Boolean:
+        number = value.asBoolean() ? 1.0 : 0.0;
+        isNumber = true;
+        return true;
+    case Value::Integer:
+        if (value.format() != Value::fmt_Number)
+            return false;
+        number = double(value.asInteger());
+        if (qint64(number) != value.asInteger())
+            return false;
+        isNumber = true;
+        return true;
+    case Value::Float:
+        if (value.format() != Value::fmt_Number || !isDouble(value.asFloat()))
+            return false;
+        number = double(numToDouble(value.asFloat()));
+        isNumber = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ValueCalc::collectNumberPairs(const Value &a1, const Value &a2,
+                                   QVector<double> &numbers1, QVector<double> &numbers2)
+{
+    if (!a1.isArray() || !a2.isArray())
+        return false;
+    const unsigned rows = a1.rows();
+    const unsigned cols = a1.columns();
+    if ((rows != a2.rows()) || (cols != a2.columns()))
+        return false;
+
+    // The result format of the generic walk is fmt_Number, as soon as one
+    // pair is not empty. Without any, leave the format to the generic walk.
+    bool isNumber = false;
+    numbers1.resize(rows * cols);
+    numbers2.resize(rows * cols);
+    double *const data1 = numbers1.data();
+    double *const data2 = numbers2.data();
+    for (unsigned r = 0; r < rows; ++r) {
+        for (unsigned c = 0; c < cols; ++c) {
+            const unsigned index = r * cols + c;
+            if (!pairElement(a1.element(c, r), data1[index], isNumber))
+                return false;
+            if (!pairElement(a2.element(c, r), data2[index], isNumber))
+                return false;
+        }
+    }
+    return isNumber;
+}
+
 // ------------------------------------------------------
 
 Value ValueCalc::sum(const Value &range, bool full)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full) && !numbers.isEmpty())
+        return Value(NumericKernels::sum(numbers));
+
     Value res(0);
     arrayWalk(range, res, full ? awSumA : awSum, Value(0));
     return res;
 }
 
-Value ValueCalc::sum(QVector<Value> range, bool full)
+Value ValueCalc::sum(QVector<Value> range, bool full, const FuncExtra *extra)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full, false, false, extra) && !numbers.isEmpty())
+        return Value(NumericKernels::sum(numbers));
+
     Value res(0);
     arrayWalk(range, res, full ? awSumA : awSum, Value(0));
     return res;
@@ -1940,6 +2128,23 @@ Value ValueCalc::sum(QVector<Value> range, bool full)
 // sum of squares
 Value ValueCalc::sumsq(const Value &range, bool full)
 {
+    // booleans are squared in both versions
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full, true) && !numbers.isEmpty())
+        return Value(NumericKernels::sumOfSquares(numbers));
+
+    Value res(0);
+    arrayWalk(range, res, full ? awSumSqA : awSumSq, Value(0));
+    return res;
+}
+
+Value ValueCalc::sumsq(QVector<Value> range, bool full, const FuncExtra *extra)
+{
+    // booleans are squared in both versions
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full, true, false, extra) && !numbers.isEmpty())
+        return Value(NumericKernels::sumOfSquares(numbers));
+
     Value res(0);
     arrayWalk(range, res, full ? awSumSqA : awSumSq, Value(0));
     return res;
@@ -2192,13 +2397,21 @@ Value ValueCalc::averageIfs(const Cell &avgRangeStart, QList<Value> range, QList
 
 int ValueCalc::count(const Value &range, bool full)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full))
+        return numbers.count();
+
     Value res(0);
     arrayWalk(range, res, full ? awCountA : awCount, Value(0));
     return converter->asInteger(res).asInteger();
 }
 
-int ValueCalc::count(QVector<Value> range, bool full)
+int ValueCalc::count(QVector<Value> range, bool full, const FuncExtra *extra)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full, false, false, extra))
+        return numbers.count();
+
     Value res(0);
     arrayWalk(range, res, full ? awCountA : awCount, Value(0));
     return converter->asInteger(res).asInteger();
@@ -2275,14 +2488,28 @@ Value ValueCalc::countIfs(const Cell &cntRangeStart, QList<Value> range, QList<C
 
 Value ValueCalc::avg(const Value &range, bool full)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full)) {
+        if (numbers.isEmpty())
+            return Value(0.0);
+        return div(Value(NumericKernels::sum(numbers)), numbers.count());
+    }
+
     int cnt = count(range, full);
     if (cnt)
         return div(sum(range, full), cnt);
     return Value(0.0);
 }
 
-Value ValueCalc::avg(QVector<Value> range, bool full)
+Value ValueCalc::avg(QVector<Value> range, bool full, const FuncExtra *extra)
 {
+    NumberList numbers;
+    if (collectNumbers(range, numbers, full, false, false, extra)) {
+        if (numbers.isEmpty())
+            return Value(0.0);
+        return div(Value(NumericKernels::sum(numbers)), numbers.count());
+    }
+
     int cnt = count(range, full);
     if (cnt)
         return div(sum(range, full), cnt);
@@ -2343,6 +2570,32 @@ Value ValueCalc::product(QVector<Value> range,
     return res;
 }
 
+Value ValueCalc::devsq(const Value &range, Value avg, bool full, int *count)
+{
+    return devsq(QVector<Value>() << range, avg, full, count);
+}
+
+Value ValueCalc::devsq(QVector<Value> range, Value avg, bool full,
+                       int *count, const FuncExtra *extra)
+{
+    // The result takes the format of the values. Only plain numbers are
+    // reduced by the kernels, so that it is the same.
+    if (avg.isNumber() && !avg.isComplex() && avg.format() == Value::fmt_Number) {
+        NumberList numbers;
+        if (collectNumbers(range, numbers, full, false, true, extra) && !numbers.isEmpty()) {
+            if (count)
+                *count = numbers.count();
+            return Value(NumericKernels::sumOfSquaredDeviations(numbers, converter->toFloat(avg)));
+        }
+    }
+
+    Value res;
+    if (count)
+        *count = this->count(range, full);
+    arrayWalk(range, res, full ? awDevSqA : awDevSq, avg);
+    return res;
+}
+
 Value ValueCalc::stddev(const Value &range, bool full)
 {
     return stddev(range, avg(range, full), full);
@@ -2351,23 +2604,21 @@ Value ValueCalc::stddev(const Value &range, bool full)
 Value ValueCalc::stddev(const Value &range, Value avg,
                         bool full)
 {
-    Value res;
-    int cnt = count(range, full);
-    arrayWalk(range, res, full ? awDevSqA : awDevSq, avg);
+    int cnt;
+    Value res = devsq(range, avg, full, &cnt);
     return sqrt(div(res, cnt - 1));
 }
 
-Value ValueCalc::stddev(QVector<Value> range, bool full)
+Value ValueCalc::stddev(QVector<Value> range, bool full, const FuncExtra *extra)
 {
-    return stddev(range, avg(range, full), full);
+    return stddev(range, avg(range, full, extra), full, extra);
 }
 
 Value ValueCalc::stddev(QVector<Value> range,
-                        Value avg, bool full)
+                        Value avg, bool full, const FuncExtra *extra)
 {
-    Value res;
-    int cnt = count(range, full);
-    arrayWalk(range, res, full ? awDevSqA : awDevSq, avg);
+    int cnt;
+    Value res = devsq(range, avg, full, &cnt, extra);
     return sqrt(div(res, cnt - 1));
 }
 
@@ -2379,23 +2630,21 @@ Value ValueCalc::stddevP(const Value &range, bool full)
 Value ValueCalc::stddevP(const Value &range, Value avg,
                          bool full)
 {
-    Value res;
-    int cnt = count(range, full);
-    arrayWalk(range, res, full ? awDevSqA : awDevSq, avg);
+    int cnt;
+    Value res = devsq(range, avg, full, &cnt);
     return sqrt(div(res, cnt));
 }
 
-Value ValueCalc::stddevP(QVector<Value> range, bool full)
+Value ValueCalc::stddevP(QVector<Value> range, bool full, const FuncExtra *extra)
 {
-    return stddevP(range, avg(range, full), full);
+    return stddevP(range, avg(range, full, extra), full, extra);
 }
 
 Value ValueCalc::stddevP(QVector<Value> range,
-                         Value avg, bool full)
+                         Value avg, bool full, const FuncExtra *extra)
 {
-    Value res;
-    int cnt = count(range, full);
-    arrayWalk(range, res, full ? awDevSqA : awDevSq, avg);
+    int cnt;
+    Value res = devsq(range, avg, full, &cnt, extra);
     return sqrt(div(res, cnt));
 }
 
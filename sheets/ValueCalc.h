@@ -41,8 +41,10 @@ namespace Calligra
 namespace Sheets
 {
 class Cell;
+class NumberList;
 class ValueCalc;
 class ValueConverter;
+struct FuncExtra;
 
 // Condition structures
 enum Comp { isEqual, isLess, isGreater, lessEqual, greaterEqual, notEqual, stringMatch, regexMatch, wildcardMatch };
@@ -269,6 +271,37 @@ public:
     arrayWalkFunc awFunc(const QString &name);
     void registerAwFunc(const QString &name, arrayWalkFunc func);
 
+    /**
+     * Collects the numbers in \p range into \p numbers for the reductions
+     * in NumericKernels.h. Empty values are skipped. Booleans become 0 and
+     * 1 in \p full mode or if \p booleans is set, and are skipped
+     * otherwise. Text is skipped, if not in \p full mode.
+     * \return \c false, if \p range holds a value, that needs the generic
+     * walk: an error, a complex number, a number not representable as
+     * double, text in \p full mode or, if \p plainNumbers is set, a number
+     * not formatted as Value::fmt_Number
+     */
+    bool collectNumbers(const Value &range, NumberList &numbers,
+                        bool full, bool booleans = false, bool plainNumbers = false);
+    /**
+     * \overload
+     * The cell range arguments in \p range , that \p extra refers to, are
+     * read from the columnar value storage of their sheet, if it is enabled.
+     * Their numbers are referenced there instead of being copied.
+     */
+    bool collectNumbers(const QVector<Value> &range, NumberList &numbers,
+                        bool full, bool booleans = false, bool plainNumbers = false,
+                        const FuncExtra *extra = 0);
+    /**
+     * Collects the elements of the equally sized arrays \p a1 and \p a2
+     * pairwise into \p numbers1 and \p numbers2, empty elements as 0.
+     * \return \c false, if the generic walk is needed: the arrays differ in
+     * size, hold anything but empty values, booleans and plain numbers or
+     * hold no number at all
+     */
+    bool collectNumberPairs(const Value &a1, const Value &a2,
+                            QVector<double> &numbers1, QVector<double> &numbers2);
+
     /** basic range functions */
     // if full is true, A-version is used (means string/bool values included)
     Value sum(const Value &range, bool full = true);
@@ -297,21 +330,33 @@ public:
     Value stddevP(const Value &range, bool full = true);
     Value stddevP(const Value &range, Value avg,
                   bool full = true);
+    /**
+     * \return the sum of the squared deviations of \p range from \p avg
+     * \p count is set to the number of values taken into account.
+     */
+    Value devsq(const Value &range, Value avg, bool full = true,
+                int *count = 0);
 
     /** range functions using value lists */
-    Value sum(QVector<Value> range, bool full = true);
-    int count(QVector<Value> range, bool full = true);
-    Value avg(QVector<Value> range, bool full = true);
+    // if extra is given, cell ranges may be read from the columnar storage
+    Value sum(QVector<Value> range, bool full = true, const FuncExtra *extra = 0);
+    Value sumsq(QVector<Value> range, bool full = true, const FuncExtra *extra = 0);
+    int count(QVector<Value> range, bool full = true, const FuncExtra *extra = 0);
+    Value avg(QVector<Value> range, bool full = true, const FuncExtra *extra = 0);
     Value max(QVector<Value> range, bool full = true);
     Value min(QVector<Value> range, bool full = true);
     Value product(QVector<Value> range, Value init,
                   bool full = true);
-    Value stddev(QVector<Value> range, bool full = true);
+    Value stddev(QVector<Value> range, bool full = true,
+                 const FuncExtra *extra = 0);
     Value stddev(QVector<Value> range, Value avg,
-                 bool full = true);
-    Value stddevP(QVector<Value> range, bool full = true);
+                 bool full = true, const FuncExtra *extra = 0);
+    Value stddevP(QVector<Value> range, bool full = true,
+                  const FuncExtra *extra = 0);
     Value stddevP(QVector<Value> range, Value avg,
-                  bool full = true);
+                  bool full = true, const FuncExtra *extra = 0);
+    Value devsq(QVector<Value> range, Value avg, bool full = true,
+                int *count = 0, const FuncExtra *extra = 0);
 
     /**
       This method parses the condition in string text to the condition cond.
@@ -195,6 +195,7 @@ SheetPropertiesCommand::SheetPropertiesCommand(Sheet* s)
     map = s->map();
     oldDirection = newDirection = sheet->layoutDirection();
     oldAutoCalc = newAutoCalc = sheet->isAutoCalculationEnabled();
+    oldColumnarStorage = newColumnarStorage = sheet->isColumnarStorageEnabled();
     oldShowGrid = newShowGrid = sheet->getShowGrid();
     oldShowPageOutline = newShowPageOutline = sheet->isShowPageOutline();
     oldShowFormula = newShowFormula = sheet->getShowFormula();
@@ -217,6 +218,11 @@ void SheetPropertiesCommand::setAutoCalculationEnabled(bool b)
     newAutoCalc = b;
 }
 
+void SheetPropertiesCommand::setColumnarStorageEnabled(bool b)
+{
+    newColumnarStorage = b;
+}
+
 void SheetPropertiesCommand::setShowGrid(bool b)
 {
     newShowGrid = b;
@@ -266,6 +272,7 @@ void SheetPropertiesCommand::redo()
 {
     sheet->setLayoutDirection(newDirection);
     sheet->setAutoCalculationEnabled(newAutoCalc);
+    sheet->setColumnarStorageEnabled(newColumnarStorage);
     sheet->setShowGrid(newShowGrid);
     sheet->setShowPageOutline(newShowPageOutline);
     sheet->setShowFormula(newShowFormula);
@@ -282,6 +289,7 @@ void SheetPropertiesCommand::undo()
 {
     sheet->setLayoutDirection(oldDirection);
     sheet->setAutoCalculationEnabled(oldAutoCalc);
+    sheet->setColumnarStorageEnabled(oldColumnarStorage);
     sheet->setShowGrid(oldShowGrid);
     sheet->setShowPageOutline(oldShowPageOutline);
     sheet->setShowFormula(oldShowFormula);
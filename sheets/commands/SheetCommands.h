@@ -153,6 +153,7 @@ public:
     explicit SheetPropertiesCommand(Sheet *sheet);
     void setLayoutDirection(Qt::LayoutDirection direction);
     void setAutoCalculationEnabled(bool b);
+    void setColumnarStorageEnabled(bool b);
     void setShowGrid(bool b);
     void setShowPageOutline(bool b);
     void setShowFormula(bool b);
@@ -171,6 +172,7 @@ protected:
     Map* map;
     Qt::LayoutDirection oldDirection, newDirection;
     bool oldAutoCalc, newAutoCalc;
+    bool oldColumnarStorage, newColumnarStorage;
     bool oldShowGrid, newShowGrid;
     bool oldShowPageOutline, newShowPageOutline;
     bool oldShowFormula, newShowFormula;
@@ -58,9 +58,9 @@ QString DatabaseManager::createUniqueName() const
     return "database-" + QString::number(Private::s_id++);
 }
 
-bool DatabaseManager::loadOdf(const KoXmlElement& body)
+bool DatabaseManager::loadOdf(const KoXmlNode& parent)
 {
-    const KoXmlNode databaseRanges = KoXml::namedItemNS(body, KoXmlNS::table, "database-ranges");
+    const KoXmlNode databaseRanges = KoXml::namedItemNS(parent, KoXmlNS::table, "database-ranges");
     KoXmlElement element;
     forEachElement(element, databaseRanges) {
         if (element.namespaceURI() != KoXmlNS::table)
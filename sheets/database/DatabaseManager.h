@@ -55,10 +55,10 @@ public:
     QString createUniqueName() const;
 
     /**
-     * Loads databases.
+     * Loads the databases of the table:database-ranges child of \p parent.
      * \ingroup OpenDocument
      */
-    bool loadOdf(const KoXmlElement& element);
+    bool loadOdf(const KoXmlNode& parent);
 
     /**
      * Saves databases.
@@ -33,6 +33,7 @@
 #include "FunctionModuleRegistry.h"
 #include "Function.h"
 #include "FunctionRepository.h"
+#include "NumericKernels.h"
 #include "ValueCalc.h"
 #include "ValueConverter.h"
 
@@ -556,15 +557,15 @@ Value func_log10(valVector args, ValueCalc *calc, FuncExtra *)
 }
 
 // Function: sum
-Value func_sum(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_sum(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->sum(args, false);
+    return calc->sum(args, false, e);
 }
 
 // Function: suma
-Value func_suma(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_suma(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->sum(args, true);
+    return calc->sum(args, true, e);
 }
 
 // Function: SUMIF
@@ -653,8 +654,13 @@ Value func_div(valVector args, ValueCalc *calc, FuncExtra *)
 }
 
 // Function: SUMSQ
-Value func_sumsq(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_sumsq(valVector args, ValueCalc *calc, FuncExtra *e)
 {
+    // plain numbers only, the result takes the format of the first square
+    NumberList numbers;
+    if (calc->collectNumbers(args, numbers, false, true, true, e) && !numbers.isEmpty())
+        return Value(NumericKernels::sumOfSquares(numbers));
+
     Value res;
     calc->arrayWalk(args, res, calc->awFunc("sumsq"), Value(0));
     return res;
@@ -1012,15 +1018,15 @@ Value func_trunc(valVector args, ValueCalc *calc, FuncExtra *)
 }
 
 // Function: COUNT
-Value func_count(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_count(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return Value(calc->count(args, false));
+    return Value(calc->count(args, false, e));
 }
 
 // Function: COUNTA
-Value func_counta(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_counta(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return Value(calc->count(args));
+    return Value(calc->count(args, true, e));
 }
 
 // Function: COUNTBLANK
@@ -29,9 +29,11 @@
 #include "Map.h"
 #include "CalculationSettings.h"
 #include "CellStorage.h"
+#include "DependencyManager.h"
 #include "Formula.h"
 #include "Function.h"
 #include "FunctionModuleRegistry.h"
+#include "LookupCache.h"
 #include "ValueCalc.h"
 #include "ValueConverter.h"
 
@@ -44,7 +46,7 @@ Value func_cell(valVector args, ValueCalc *calc, FuncExtra *e);
 Value func_choose(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_column(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_columns(valVector args, ValueCalc *calc, FuncExtra *);
-Value func_hlookup(valVector args, ValueCalc *calc, FuncExtra *);
+Value func_hlookup(valVector args, ValueCalc *calc, FuncExtra *e);
 Value func_index(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_indirect(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_lookup(valVector args, ValueCalc *calc, FuncExtra *);
@@ -55,7 +57,7 @@ Value func_row(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_rows(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_sheet(valVector args, ValueCalc *calc, FuncExtra *);
 Value func_sheets(valVector args, ValueCalc *calc, FuncExtra *);
-Value func_vlookup(valVector args, ValueCalc *calc, FuncExtra *);
+Value func_vlookup(valVector args, ValueCalc *calc, FuncExtra *e);
 
 
 CALLIGRA_SHEETS_EXPORT_FUNCTION_MODULE("kspreadreferencemodule.json", ReferenceModule)
@@ -94,6 +96,7 @@ ReferenceModule::ReferenceModule(QObject* parent, const QVariantList&)
     f = new Function("HLOOKUP",  func_hlookup);
     f->setParamCount(3, 4);
     f->setAcceptArray();
+    f->setNeedsExtra(true);
     add(f);
     f = new Function("INDEX",   func_index);
     f->setParamCount(3);
@@ -140,6 +143,7 @@ ReferenceModule::ReferenceModule(QObject* parent, const QVariantList&)
     f = new Function("VLOOKUP",  func_vlookup);
     f->setParamCount(3, 4);
     f->setAcceptArray();
+    f->setNeedsExtra(true);
     add(f);
 }
 
@@ -149,6 +153,27 @@ QString ReferenceModule::descriptionFileName() const
 }
 
 
+//
+// helper: lookup_cached
+//
+// Asks the lookup cache of the map, if the searched data is a plain range.
+// Returns LookupCache::NotIndexed, if the range has to be scanned.
+static int lookup_cached(const Value& key, const Value& data, int index, Qt::Orientation orientation,
+                         bool caseSensitive, bool approximate, ValueCalc *calc, FuncExtra *e)
+{
+    if (!e || e->ranges.count() <= index || e->regions.count() <= index)
+        return LookupCache::NotIndexed;
+    if (e->ranges[index].col1 == -1 || !e->regions[index].isContiguous())
+        return LookupCache::NotIndexed;
+    const Calligra::Sheets::Region& region = e->regions[index];
+    Sheet* const sheet = region.firstSheet();
+    if (!sheet)
+        return LookupCache::NotIndexed;
+    LookupCache* const cache = sheet->map()->dependencyManager()->lookupCache();
+    return cache->find(sheet, region.firstRange(), orientation, data, key, caseSensitive, approximate, calc);
+}
+
+
 //
 // Function: ADDRESS
 //
@@ -353,7 +378,7 @@ Value func_columns(valVector, ValueCalc *, FuncExtra *e)
 //
 // Function: HLOOKUP
 //
-Value func_hlookup(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_hlookup(valVector args, ValueCalc *calc, FuncExtra *e)
 {
     const Value key = args[0];
     const Value data = args[1];
@@ -364,6 +389,12 @@ Value func_hlookup(valVector args, ValueCalc *calc, FuncExtra *)
         return Value::errorVALUE();
     const bool rangeLookup = (args.count() > 3) ? calc->conv()->asBoolean(args[3]).asBoolean() : true;
 
+    const int position = lookup_cached(key, data, 1, Qt::Horizontal, true, rangeLookup, calc, e);
+    if (position >= 0)
+        return data.element(position, row - 1);
+    if (position == LookupCache::NotFound)
+        return Value::errorNA();
+
     // now traverse the array and perform comparison
     Value r;
     Value v = Value::errorNA();
@@ -485,6 +516,13 @@ Value func_match(valVector args, ValueCalc *calc, FuncExtra* e)
     int n = qMax(searchArray.rows(), searchArray.columns());
 
     if (matchType == 0) {
+        const Qt::Orientation orientation = (dr == 1) ? Qt::Vertical : Qt::Horizontal;
+        const int position = lookup_cached(searchValue, searchArray, 1, orientation, false, false, calc, e);
+        if (position >= 0)
+            return Value(position + 1);
+        if (position == LookupCache::NotFound)
+            return Value::errorNA();
+
         // linear search
         for (int r = 0, c = 0; r < n && c < n; r += dr, c += dc) {
             if (calc->naturalEqual(searchValue, searchArray.element(c, r), false)) {
@@ -648,7 +686,7 @@ Value func_sheets(valVector /*args*/, ValueCalc *, FuncExtra *e)
 //
 // Function: VLOOKUP
 //
-Value func_vlookup(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_vlookup(valVector args, ValueCalc *calc, FuncExtra *e)
 {
     const Value key = args[0];
     const Value data = args[1];
@@ -659,6 +697,12 @@ Value func_vlookup(valVector args, ValueCalc *calc, FuncExtra *)
         return Value::errorVALUE();
     const bool rangeLookup = (args.count() > 3) ? calc->conv()->asBoolean(args[3]).asBoolean() : true;
 
+    const int position = lookup_cached(key, data, 1, Qt::Vertical, true, rangeLookup, calc, e);
+    if (position >= 0)
+        return data.element(col - 1, position);
+    if (position == LookupCache::NotFound)
+        return Value::errorNA();
+
     // now traverse the array and perform comparison
     Value r;
     Value v = Value::errorNA();
@@ -24,6 +24,7 @@
 
 #include "Function.h"
 #include "FunctionModuleRegistry.h"
+#include "NumericKernels.h"
 #include "ValueCalc.h"
 #include "ValueConverter.h"
 #include "SheetsDebug.h"
@@ -769,17 +770,17 @@ Value func_arrang(valVector args, ValueCalc *calc, FuncExtra *)
 //
 // Function: average
 //
-Value func_average(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_average(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->avg(args, false);
+    return calc->avg(args, false, e);
 }
 
 //
 // Function: averagea
 //
-Value func_averagea(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_averagea(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->avg(args);
+    return calc->avg(args, true, e);
 }
 
 //
@@ -1117,21 +1118,17 @@ Value func_covar(valVector args, ValueCalc *calc, FuncExtra *)
 //
 // function: devsq
 //
-Value func_devsq(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_devsq(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    Value res;
-    calc->arrayWalk(args, res, calc->awFunc("devsq"), calc->avg(args, false));
-    return res;
+    return calc->devsq(args, calc->avg(args, false, e), false, 0, e);
 }
 
 //
 // function: devsqa
 //
-Value func_devsqa(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_devsqa(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    Value res;
-    calc->arrayWalk(args, res, calc->awFunc("devsqa"), calc->avg(args));
-    return res;
+    return calc->devsq(args, calc->avg(args, true, e), true, 0, e);
 }
 
 //
@@ -2578,33 +2575,33 @@ Value func_standardize(valVector args, ValueCalc *calc, FuncExtra *)
 //
 // Function: stddev
 //
-Value func_stddev(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_stddev(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->stddev(args, false);
+    return calc->stddev(args, false, e);
 }
 
 //
 // Function: stddeva
 //
-Value func_stddeva(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_stddeva(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->stddev(args);
+    return calc->stddev(args, true, e);
 }
 
 //
 // Function: stddevp
 //
-Value func_stddevp(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_stddevp(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->stddevP(args, false);
+    return calc->stddevP(args, false, e);
 }
 
 //
 // Function: stddevpa
 //
-Value func_stddevpa(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_stddevpa(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    return calc->stddevP(args);
+    return calc->stddevP(args, true, e);
 }
 
 //
@@ -2642,6 +2639,11 @@ Value func_steyx(valVector args, ValueCalc* calc, FuncExtra*)
 //
 Value func_sumproduct(valVector args, ValueCalc *calc, FuncExtra *)
 {
+    QVector<double> numbers1;
+    QVector<double> numbers2;
+    if (calc->collectNumberPairs(args[0], args[1], numbers1, numbers2))
+        return Value(NumericKernels::sumOfProducts(numbers1.constData(), numbers2.constData(), numbers1.count()));
+
     Value result;
     calc->twoArrayWalk(args[0], args[1], result, tawSumproduct);
     return result;
@@ -2959,52 +2961,48 @@ Value func_ttest(valVector args, ValueCalc* calc, FuncExtra*)
 //
 // Function: variance
 //
-Value func_variance(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_variance(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    int count = calc->count(args, false);
+    int count;
+    Value result = calc->devsq(args, calc->avg(args, false, e), false, &count, e);
     if (count < 2)
         return Value::errorVALUE();
-
-    Value result = func_devsq(args, calc, 0);
     return calc->div(result, count - 1);
 }
 
 //
 // Function: vara
 //
-Value func_variancea(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_variancea(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    int count = calc->count(args);
+    int count;
+    Value result = calc->devsq(args, calc->avg(args, true, e), true, &count, e);
     if (count < 2)
         return Value::errorVALUE();
-
-    Value result = func_devsqa(args, calc, 0);
     return calc->div(result, count - 1);
 }
 
 //
 // Function: varp
 //
-Value func_variancep(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_variancep(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    int count = calc->count(args, false);
+    int count;
+    Value result = calc->devsq(args, calc->avg(args, false, e), false, &count, e);
     if (count == 0)
         return Value::errorVALUE();
-
-    Value result = func_devsq(args, calc, 0);
     return calc->div(result, count);
 }
 
 //
 // Function: varpa
 //
-Value func_variancepa(valVector args, ValueCalc *calc, FuncExtra *)
+Value func_variancepa(valVector args, ValueCalc *calc, FuncExtra *e)
 {
-    int count = calc->count(args);
+    int count;
+    Value result = calc->devsq(args, calc->avg(args, true, e), true, &count, e);
     if (count == 0)
         return Value::errorVALUE();
-
-    Value result = func_devsqa(args, calc, 0);
     return calc->div(result, count);
 }
 
@@ -28,6 +28,7 @@
 
 class KoShapeLoadingContext;
 class KoShape;
+class QMutex;
 
 namespace Calligra
 {
@@ -44,12 +45,18 @@ class OdfLoadingContext
 {
 public:
     explicit OdfLoadingContext(KoOdfLoadingContext &odfContext)
-            : odfContext(odfContext), shapeContext(0) {}
+            : odfContext(odfContext), shapeContext(0), sharedNodesMutex(0) {}
 
 public:
     KoOdfLoadingContext& odfContext;
     KoShapeLoadingContext* shapeContext;
     QHash<QString, KoXmlElement> validities;
+    /**
+     * Serializes the access to the XML nodes shared by all sheets, i.e. the
+     * styles and the validities, while sheets are loaded concurrently.
+     * Null, if the sheets are loaded one after the other.
+     */
+    QMutex* sharedNodesMutex;
 };
 
 struct ShapeLoadingData {
@@ -746,6 +746,11 @@ void Odf::loadCellText(Cell *cell, const KoXmlElement& parent, OdfLoadingContext
 
 void Odf::loadObjects(Cell *cell, const KoXmlElement &parent, OdfLoadingContext& tableContext, QList<ShapeLoadingData>& shapeData)
 {
+    // Most cells have no shapes. Do not touch the global attribute registry
+    // then, the cells may be loaded concurrently.
+    if (!findDrawElements(parent))
+        return;
+
     // Register additional attributes, that identify shapes anchored in cells.
     // Their dimensions need adjustment after all rows are loaded,
     // because the position of the end cell is not always known yet.
@@ -56,6 +56,7 @@
 
 #include <KCodecs>
 #include <QBuffer>
+#include <QScopedPointer>
 
 // This file contains functionality to load/save a DocBase
 
@@ -81,20 +82,42 @@ bool Odf::loadDocument(DocBase *doc, KoOdfReadStore &odfStore)
 
     KoXmlElement content = odfStore.contentDoc().documentElement();
     KoXmlElement realBody(KoXml::namedItemNS(content, KoXmlNS::office, "body"));
+    // If the store left the body out, it is read sheet by sheet.
+    QScopedPointer<KoXmlElementCursor> cursor(realBody.isNull() ? odfStore.bodyCursor() : 0);
+    if (cursor)
+        realBody = cursor->element();
     if (realBody.isNull()) {
         doc->setErrorMessage(i18n("Invalid OASIS OpenDocument file. No office:body tag found."));
         doc->map()->deleteLoadingInfo();
         return false;
     }
-    KoXmlElement body = KoXml::namedItemNS(realBody, KoXmlNS::office, "spreadsheet");
+    KoXmlElement body;
+    QString localName;
+    if (cursor) {
+        if (cursor->readNextStartElement()) {
+            if (cursor->isElement(KoXmlNS::office, "spreadsheet"))
+                body = cursor->readElementUntil(KoXmlNS::table, "table");
+            else
+                localName = cursor->localName();
+        }
+    } else {
+        body = KoXml::namedItemNS(realBody, KoXmlNS::office, "spreadsheet");
+        if (body.isNull()) {
+            KoXmlElement childElem;
+            forEachElement(childElem, realBody) {
+                localName = childElem.localName();
+            }
+        }
+    }
 
+    if (cursor && cursor->hasError()) {
+        doc->setErrorMessage(i18n("Parsing error in the main document at line %1, column %2\nError message: %3",
+                                  cursor->lineNumber(), cursor->columnNumber(), cursor->errorString()));
+        doc->map()->deleteLoadingInfo();
+        return false;
+    }
     if (body.isNull()) {
         errorSheetsODF << "No office:spreadsheet found!" << endl;
-        KoXmlElement childElem;
-        QString localName;
-        forEachElement(childElem, realBody) {
-            localName = childElem.localName();
-        }
         if (localName.isEmpty())
             doc->setErrorMessage(i18n("Invalid OASIS OpenDocument file. No tag found inside office:body."));
         else
@@ -111,10 +134,11 @@ bool Odf::loadDocument(DocBase *doc, KoOdfReadStore &odfStore)
     // TODO check versions and mimetypes etc.
 
     // all <sheet:sheet> goes to workbook
-    if (!loadMap(doc->map(), body, context)) {
+    if (!loadMap(doc->map(), body, context, cursor.data(), &odfStore)) {
         doc->map()->deleteLoadingInfo();
         return false;
     }
+    cursor.reset();
 
     if (!odfStore.settingsDoc().isNull()) {
         loadDocSettings(doc, odfStore.settingsDoc());
@@ -191,7 +215,8 @@ bool Odf::saveDocument(DocBase *doc, KoDocument::SavingContext &documentContext)
     // Done with writing out the contents to the tempfile, we can now write out the automatic styles
     mainStyles.saveOdfStyles(KoGenStyles::DocumentAutomaticStyles, contentWriter);
 
-    documentContext.odfStore.closeContentWriter();
+    if (!documentContext.odfStore.closeContentWriter())
+        return false;
 
     //add manifest line for content.xml
     manifestWriter->addManifestEntry("content.xml",  "text/xml");
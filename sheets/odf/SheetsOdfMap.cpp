@@ -48,16 +48,26 @@
 #include <KoCharacterStyle.h>
 #include <KoDocumentResourceManager.h>
 #include <KoGenStyles.h>
+#include <KoOdfReadStore.h>
+#include <KoProgressUpdater.h>
 #include <KoStyleManager.h>
 #include <KoStyleStack.h>
 #include <KoText.h>
 #include <KoTextSharedLoadingData.h>
 #include <KoUnit.h>
+#include <KoUpdater.h>
 #include <KoXmlNS.h>
+#include <KoXmlReader.h>
 #include <KoXmlWriter.h>
 
 #include <kcodecs.h>
 
+#include <QMutex>
+#include <QRunnable>
+#include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
+
 // This file contains functionality to load/save a Map
 
 namespace Calligra {
@@ -67,6 +77,121 @@ namespace Odf {
     void fixupStyle(KoCharacterStyle* style);
 }
 
+namespace {
+// Hands out the table:table elements of the body one by one, either from
+// its tree or read from a cursor. In the latter case only the sheets being
+// loaded are held in memory.
+class SheetElementReader
+{
+public:
+    explicit SheetElementReader(const KoXmlElement& body)
+            : m_node(body.firstChild()), m_cursor(0), m_sheetRead(false) {}
+    explicit SheetElementReader(KoXmlElementCursor* cursor)
+            : m_cursor(cursor), m_sheetRead(false) {}
+
+    // Returns the next sheet element, or a null element at the end. The
+    // element read from a cursor is valid until the next call, unless its
+    // ownerDocument() is kept.
+    KoXmlElement next() {
+        if (m_cursor) {
+            while (m_cursor->readNextStartElement()) {
+                if (m_cursor->isElement(KoXmlNS::table, "table")) {
+                    m_sheetRead = true;
+                    return m_cursor->readElement();
+                }
+                // The elements before the sheets are loaded already.
+                if (m_sheetRead)
+                    m_tail.append(m_cursor->readElement().ownerDocument());
+                else
+                    m_cursor->skipCurrentElement();
+            }
+            return KoXmlElement();
+        }
+        while (!m_node.isNull()) {
+            KoXmlElement sheetElement = m_node.toElement();
+            m_node = m_node.nextSibling();
+            if (sheetElement.isNull())
+                continue;
+            // make it slightly faster
+            KoXml::load(sheetElement);
+            if (sheetElement.nodeName() == "table:table")
+                return sheetElement;
+            // reduce memory usage
+            KoXml::unload(sheetElement);
+        }
+        return KoXmlElement();
+    }
+
+    // The documents of the elements following the sheets, if read from a cursor.
+    QList<KoXmlDocument> tail() const {
+        return m_tail;
+    }
+
+private:
+    KoXmlNode m_node;
+    KoXmlElementCursor* m_cursor;
+    bool m_sheetRead;
+    QList<KoXmlDocument> m_tail;
+};
+}
+
+namespace Odf {
+    void loadSheets(Map *map, SheetElementReader& reader, OdfLoadingContext& tableContext,
+                    const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles);
+    void loadSheetsConcurrently(Map *map, SheetElementReader& reader, OdfLoadingContext& tableContext,
+                                const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles);
+}
+
+namespace {
+// Loads the cell contents of a sheet in a worker thread.
+class SheetContentLoader : public QRunnable
+{
+public:
+    SheetContentLoader(Sheet *sheet, const KoXmlElement& sheetElement, Odf::OdfLoadingContext& tableContext,
+                       const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles)
+            : sheetElement(sheetElement)
+            , m_sheet(sheet)
+            , m_tableContext(tableContext)
+            , m_autoStyles(autoStyles)
+            , m_conditionalStyles(conditionalStyles) {
+        setAutoDelete(false);
+    }
+
+    virtual void run() {
+        Odf::loadSheetContent(m_sheet, sheetElement, m_tableContext, m_autoStyles, m_conditionalStyles,
+                              QPointer<KoUpdater>());
+    }
+
+    KoXmlElement sheetElement;
+    // keeps the element alive, if it was read from a cursor
+    KoXmlDocument document;
+    QPointer<KoUpdater> updater;
+
+private:
+    Sheet *m_sheet;
+    Odf::OdfLoadingContext& m_tableContext;
+    const Styles& m_autoStyles;
+    const QHash<QString, Conditions>& m_conditionalStyles;
+};
+
+// Runs the loaders of a batch and waits for them.
+void loadSheetContents(Map *map, QList<SheetContentLoader*>& batch, QThreadPool& threadPool)
+{
+    foreach (SheetContentLoader* loader, batch)
+        threadPool.start(loader);
+    threadPool.waitForDone();
+    foreach (SheetContentLoader* loader, batch) {
+        map->increaseLoadedRowsCounter(KoXml::childNodesCount(loader->sheetElement));
+        if (loader->updater)
+            loader->updater->setProgress(100);
+        // reduce memory usage
+        KoXml::unload(loader->sheetElement);
+    }
+    qDeleteAll(batch);
+    batch.clear();
+}
+}
+
 void Odf::fixupStyle(KoCharacterStyle* style)
 {
     style->removeHardCodedDefaults();
@@ -94,7 +219,8 @@ void Odf::fixupStyle(KoCharacterStyle* style)
     style->copyProperties(format);
 }
 
-bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfContext)
+bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfContext,
+                  KoXmlElementCursor *cursor, KoOdfReadStore *odfStore)
 {
     map->setLoading(true);
     map->loadingInfo()->setFileFormat(LoadingInfo::OpenDocument);
@@ -162,6 +288,40 @@ bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfCo
         loadProtection(map, body);
     }
 
+    int overallRowCount = 0;
+    if (cursor) {
+        // Only the names of the sheets are read for now; the contents
+        // follow, when all sheets exist.
+        if (!cursor->isElement(KoXmlNS::table, "table")) {
+            // We need at least one sheet !
+            map->doc()->setErrorMessage(i18n("This document has no sheets (tables)."));
+            map->setLoading(false);
+            return false;
+        }
+        do {
+            if (!cursor->isElement(KoXmlNS::table, "table")) {
+                cursor->skipCurrentElement();
+                continue;
+            }
+            const QString sheetName = cursor->attributeNS(KoXmlNS::table, "name");
+            if (sheetName.isEmpty()) {
+                cursor->skipCurrentElement();
+                continue;
+            }
+            Sheet* sheet = map->addNewSheet(sheetName);
+            sheet->setSheetName(sheetName, true);
+            while (cursor->readNextStartElement()) {
+                ++overallRowCount;
+                cursor->skipCurrentElement();
+            }
+        } while (cursor->readNextStartElement());
+        if (cursor->hasError()) {
+            map->doc()->setErrorMessage(i18n("Parsing error in the main document at line %1, column %2\nError message: %3",
+                                             cursor->lineNumber(), cursor->columnNumber(), cursor->errorString()));
+            map->setLoading(false);
+            return false;
+        }
+    } else {
     KoXmlNode sheetNode = KoXml::namedItemNS(body, KoXmlNS::table, "table");
 
     if (sheetNode.isNull()) {
@@ -171,7 +331,6 @@ bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfCo
         return false;
     }
 
-    int overallRowCount = 0;
     while (!sheetNode.isNull()) {
         KoXmlElement sheetElement = sheetNode.toElement();
         if (!sheetElement.isNull()) {
@@ -195,6 +354,7 @@ bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfCo
         KoXml::unload(sheetElement);
         sheetNode = sheetNode.nextSibling();
     }
+    }
     map->setOverallRowsCounter(overallRowCount);   // used for loading progress info
 
     //pre-load auto styles
@@ -203,28 +363,19 @@ bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfCo
                         conditionalStyles, map->parser());
 
     // load the sheet
-    sheetNode = body.firstChild();
-    while (!sheetNode.isNull()) {
-        KoXmlElement sheetElement = sheetNode.toElement();
-        if (!sheetElement.isNull()) {
-            // make it slightly faster
-            KoXml::load(sheetElement);
-
-            //debugSheets<<"tableElement.nodeName() bis :"<<sheetElement.nodeName();
-            if (sheetElement.nodeName() == "table:table") {
-                if (!sheetElement.attributeNS(KoXmlNS::table, "name", QString()).isEmpty()) {
-                    QString name = sheetElement.attributeNS(KoXmlNS::table, "name", QString());
-                    Sheet* sheet = map->findSheet(name);
-                    if (sheet)
-                        loadSheet(sheet, sheetElement, tableContext, autoStyles, conditionalStyles);
-                }
-            }
+    QScopedPointer<KoXmlElementCursor> sheetCursor;
+    if (cursor) {
+        sheetCursor.reset(odfStore->bodyCursor());
+        if (!sheetCursor || !sheetCursor->readNextStartElement()) {
+            map->setLoading(false);
+            return false;
         }
-
-        // reduce memory usage
-        KoXml::unload(sheetElement);
-        sheetNode = sheetNode.nextSibling();
     }
+    SheetElementReader reader = sheetCursor ? SheetElementReader(sheetCursor.data()) : SheetElementReader(body);
+    if (map->loadingInfo()->parallelLoading() && QThread::idealThreadCount() > 1)
+        loadSheetsConcurrently(map, reader, tableContext, autoStyles, conditionalStyles);
+    else
+        loadSheets(map, reader, tableContext, autoStyles, conditionalStyles);
 
     // make sure always at least one sheet exists
     if (map->count() == 0) {
@@ -238,11 +389,84 @@ bool Odf::loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfCo
 ///TODO new style odf
     map->databaseManager()->loadOdf(body); // table:database-ranges
     loadNamedAreas(map->namedAreaManager(), body); // table:named-expressions
+    // the same, if they follow the sheets read from the cursor
+    foreach (const KoXmlDocument& document, reader.tail()) {
+        map->databaseManager()->loadOdf(document);
+        loadNamedAreas(map->namedAreaManager(), document);
+    }
 
     map->setLoading(false);
     return true;
 }
 
+void Odf::loadSheets(Map *map, SheetElementReader& reader, OdfLoadingContext& tableContext,
+                     const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles)
+{
+    KoXmlElement sheetElement = reader.next();
+    while (!sheetElement.isNull()) {
+        //debugSheets<<"tableElement.nodeName() bis :"<<sheetElement.nodeName();
+        if (!sheetElement.attributeNS(KoXmlNS::table, "name", QString()).isEmpty()) {
+            QString name = sheetElement.attributeNS(KoXmlNS::table, "name", QString());
+            Sheet* sheet = map->findSheet(name);
+            if (sheet)
+                loadSheet(sheet, sheetElement, tableContext, autoStyles, conditionalStyles);
+        }
+
+        // reduce memory usage
+        KoXml::unload(sheetElement);
+        sheetElement = reader.next();
+    }
+}
+
+void Odf::loadSheetsConcurrently(Map *map, SheetElementReader& reader, OdfLoadingContext& tableContext,
+                                 const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles)
+{
+    // The sheets are loaded in batches of one sheet per thread. The XML tree
+    // of a batch is kept in memory completely, because loading nodes lazily
+    // is not thread-safe.
+    QMutex sharedNodesMutex;
+    tableContext.sharedNodesMutex = &sharedNodesMutex;
+
+    QThreadPool threadPool;
+    QList<SheetContentLoader*> batch;
+
+    for (KoXmlElement sheetElement = reader.next(); !sheetElement.isNull(); sheetElement = reader.next()) {
+        Sheet* sheet = 0;
+        const QString name = sheetElement.attributeNS(KoXmlNS::table, "name", QString());
+        if (!name.isEmpty())
+            sheet = map->findSheet(name);
+        if (!sheet) {
+            KoXml::unload(sheetElement);
+            continue;
+        }
+
+        if (preloadSheetContent(sheetElement)) {
+            SheetContentLoader* loader = new SheetContentLoader(sheet, sheetElement, tableContext,
+                                                                autoStyles, conditionalStyles);
+            loader->document = sheetElement.ownerDocument();
+            if (map->doc() && map->doc()->progressUpdater()) {
+                loader->updater = map->doc()->progressUpdater()->startSubtask(1,
+                                                            "Calligra::Sheets::Odf::loadSheet");
+                loader->updater->setProgress(0);
+            }
+            loadSheetProperties(sheet, sheetElement, tableContext);
+            batch.append(loader);
+            if (batch.count() == threadPool.maxThreadCount())
+                loadSheetContents(map, batch, threadPool);
+            continue;
+        }
+
+        // Shapes and rich text are loaded in the main thread.
+        loadSheetContents(map, batch, threadPool);
+        loadSheet(sheet, sheetElement, tableContext, autoStyles, conditionalStyles);
+        // reduce memory usage
+        KoXml::unload(sheetElement);
+    }
+    loadSheetContents(map, batch, threadPool);
+
+    tableContext.sharedNodesMutex = 0;
+}
+
 void Odf::loadMapSettings(Map *map, const KoOasisSettings &settings)
 {
     KoOasisSettings::Items viewSettings = settings.itemSet("view-settings");
@@ -356,9 +580,9 @@ void Odf::saveTableShape(Sheet *sheet, KoShapeSavingContext &context)
     tableContext.valStyle.writeStyle(context.xmlWriter());
 }
 
-void Odf::loadNamedAreas(NamedAreaManager *manager, const KoXmlElement& body)
+void Odf::loadNamedAreas(NamedAreaManager *manager, const KoXmlNode& parent)
 {
-    KoXmlNode namedAreas = KoXml::namedItemNS(body, KoXmlNS::table, "named-expressions");
+    KoXmlNode namedAreas = KoXml::namedItemNS(parent, KoXmlNS::table, "named-expressions");
     if (namedAreas.isNull()) return;
 
     debugSheetsODF << "Loading named areas...";
@@ -41,9 +41,15 @@
 #include <KoShapeLoadingContext.h>
 #include <KoShapeSavingContext.h>
 
+#include <QPointer>
+
 #include "OdfLoadingContext.h"
 #include "OdfSavingContext.h"
 
+class KoOdfReadStore;
+class KoUpdater;
+class KoXmlElementCursor;
+
 namespace Calligra {
 namespace Sheets {
 
@@ -59,14 +65,45 @@ namespace Odf {
     bool saveCalculationSettings(const CalculationSettings *settings, KoXmlWriter &settingsWriter);
 
     // SheetsOdfMap
-    bool loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfContext);
+    /**
+     * Loads the map from the office:spreadsheet element \p body.
+     *
+     * If \p cursor is given, \p body holds only the children before the
+     * first table:table, at which the cursor is positioned. The sheets
+     * are then read one by one from the body cursor of \p odfStore.
+     */
+    bool loadMap(Map *map, const KoXmlElement& body, KoOdfLoadingContext& odfContext,
+                 KoXmlElementCursor *cursor = 0, KoOdfReadStore *odfStore = 0);
     void loadMapSettings(Map *map, const KoOasisSettings &settingsDoc);
     bool saveMap(Map *map, KoXmlWriter & xmlWriter, KoShapeSavingContext & savingContext);
-    void loadNamedAreas(NamedAreaManager *manager, const KoXmlElement& body);
+    void loadNamedAreas(NamedAreaManager *manager, const KoXmlNode& parent);
     void saveNamedAreas(const NamedAreaManager *manager, KoXmlWriter& xmlWriter);
 
     // SheetsOdfSheet
     bool loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingContext& tableContext, const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles);
+    /**
+     * Loads the table style of the sheet: the visibility, the page layout
+     * and the background image. Has to run in the main thread.
+     */
+    void loadSheetProperties(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingContext& tableContext);
+    /**
+     * Loads the columns, rows and cells of the sheet.
+     * If \p sheetElement passed preloadSheetContent() and
+     * OdfLoadingContext::sharedNodesMutex is set, this may run in any
+     * thread and concurrently for several sheets. Then \p updater has to be
+     * null.
+     */
+    bool loadSheetContent(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingContext& tableContext,
+                          const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles,
+                          const QPointer<KoUpdater>& updater);
+    /**
+     * Loads the XML tree of \p sheetElement into memory. Stops at the first
+     * shape or rich text.
+     * \return \c true, if the content consists of plain cells only, i.e. no
+     * shapes and no rich text, and can be loaded outside the main thread
+     * \see loadSheetContent
+     */
+    bool preloadSheetContent(const KoXmlElement& sheetElement);
     void loadSheetSettings(Sheet *sheet, const KoOasisSettings::NamedMap &settings);
     bool saveSheet(Sheet *sheet, OdfSavingContext& tableContext);
     void saveSheetSettings(Sheet *sheet, KoXmlWriter &settingsWriter);
@@ -48,6 +48,9 @@
 #include <KoXmlNS.h>
 #include <KoXmlWriter.h>
 
+#include <QMutex>
+#include <QMutexLocker>
+
 #include "CellStorage.h"
 #include "Condition.h"
 #include "DocBase.h"
@@ -122,11 +125,11 @@ namespace Odf {
     void loadColumnNodes(Sheet *sheet, const KoXmlElement& parent,
                             int& indexCol,
                             int& maxColumn,
-                            KoOdfLoadingContext& odfContext,
+                            OdfLoadingContext& tableContext,
                             QHash<QString, QRegion>& columnStyleRegions,
                             IntervalMap<QString>& columnStyles);
     bool loadColumnFormat(Sheet *sheet, const KoXmlElement& column,
-                             const KoOdfStylesReader& stylesReader, int & indexCol,
+                             OdfLoadingContext& tableContext, int & indexCol,
                              QHash<QString, QRegion>& columnStyleRegions, IntervalMap<QString>& columnStyles);
     int loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
                           OdfLoadingContext& tableContext,
@@ -161,6 +164,12 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
         updater->setProgress(0);
     }
 
+    loadSheetProperties(sheet, sheetElement, tableContext);
+    return loadSheetContent(sheet, sheetElement, tableContext, autoStyles, conditionalStyles, updater);
+}
+
+void Odf::loadSheetProperties(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingContext& tableContext)
+{
     KoOdfLoadingContext& odfContext = tableContext.odfContext;
     if (sheetElement.hasAttributeNS(KoXmlNS::table, "style-name")) {
         QString stylename = sheetElement.attributeNS(KoXmlNS::table, "style-name", QString());
@@ -296,7 +305,12 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
             }
         }
     }
+}
 
+bool Odf::loadSheetContent(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingContext& tableContext,
+                           const Styles& autoStyles, const QHash<QString, Conditions>& conditionalStyles,
+                           const QPointer<KoUpdater>& updater)
+{
     // Cell style regions
     QHash<QString, QRegion> cellStyleRegions;
     // Cell style regions (row defaults)
@@ -316,6 +330,9 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
     // Calligra Sheets so limit the number of repeated rows.
     // FIXME POSSIBLE DATA LOSS!
 
+    // The dependencies and values are updated, once the loading completes.
+    sheet->cellStorage()->beginBulkInsertion();
+
     // First load all style information for rows, columns and cells
     while (!rowNode.isNull() && rowIndex <= KS_rowMax) {
         //debugSheetsODF << " rowIndex :" << rowIndex << " indexCol :" << indexCol;
@@ -329,12 +346,12 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
                 if (rowElement.localName() == "table-header-columns") {
                     // NOTE Handle header cols as ordinary ones
                     //      as long as they're not supported.
-                    loadColumnNodes(sheet, rowElement, indexCol, maxColumn, odfContext, columnStyleRegions, columnStyles);
+                    loadColumnNodes(sheet, rowElement, indexCol, maxColumn, tableContext, columnStyleRegions, columnStyles);
                 } else if (rowElement.localName() == "table-column-group") {
-                    loadColumnNodes(sheet, rowElement, indexCol, maxColumn, odfContext, columnStyleRegions, columnStyles);
+                    loadColumnNodes(sheet, rowElement, indexCol, maxColumn, tableContext, columnStyleRegions, columnStyles);
                 } else if (rowElement.localName() == "table-column" && indexCol <= KS_colMax) {
                     //debugSheetsODF << " table-column found : index column before" << indexCol;
-                    loadColumnFormat(sheet, rowElement, odfContext.stylesReader(), indexCol, columnStyleRegions, columnStyles);
+                    loadColumnFormat(sheet, rowElement, tableContext, indexCol, columnStyleRegions, columnStyles);
                     //debugSheetsODF << " table-column found : index column after" << indexCol;
                     maxColumn = qMax(maxColumn, indexCol - 1);
                 } else if (rowElement.localName() == "table-header-rows") {
@@ -370,9 +387,13 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
 
         rowNode = rowNode.nextSibling();
 
-        int count = sheet->map()->increaseLoadedRowsCounter();
-        if (updater && count >= 0) updater->setProgress(count);
+        // The counter is not thread-safe; sheets loaded concurrently have no updater.
+        if (updater) {
+            int count = sheet->map()->increaseLoadedRowsCounter();
+            if (count >= 0) updater->setProgress(count);
+        }
     }
+    sheet->cellStorage()->endBulkInsertion();
 
     // now recalculate the size for embedded shapes that had sizes specified relative to a bottom-right corner cell
     foreach (const ShapeLoadingData& sd, shapeData) {
@@ -418,6 +439,31 @@ bool Odf::loadSheet(Sheet *sheet, const KoXmlElement& sheetElement, OdfLoadingCo
     return true;
 }
 
+// Loads the children of all nodes below parent, so that reading the tree does
+// not touch the packed document anymore. Returns false at the first shape or
+// at the first element within a paragraph, which might be rich text.
+static bool preloadNodes(const KoXmlNode& parent, bool inParagraph)
+{
+    for (KoXmlNode node = parent.firstChild(); !node.isNull(); node = node.nextSibling()) {
+        bool paragraph = inParagraph;
+        if (node.isElement()) {
+            if (inParagraph || node.namespaceURI() == KoXmlNS::draw)
+                return false;
+            if (node.namespaceURI() == KoXmlNS::table && node.localName() == "shapes")
+                return false;
+            paragraph = node.namespaceURI() == KoXmlNS::text && node.localName() == "p";
+        }
+        if (!preloadNodes(node, paragraph))
+            return false;
+    }
+    return true;
+}
+
+bool Odf::preloadSheetContent(const KoXmlElement& sheetElement)
+{
+    return preloadNodes(sheetElement, false);
+}
+
 void Odf::loadSheetObject(Sheet *sheet, const KoXmlElement& element, KoShapeLoadingContext& shapeContext)
 {
     KoShape* shape = KoShapeRegistry::instance()->createShapeFromOdf(element, shapeContext);
@@ -459,7 +505,7 @@ void Odf::loadRowNodes(Sheet *sheet, const KoXmlElement& parent,
 void Odf::loadColumnNodes(Sheet *sheet, const KoXmlElement& parent,
                             int& indexCol,
                             int& maxColumn,
-                            KoOdfLoadingContext& odfContext,
+                            OdfLoadingContext& tableContext,
                             QHash<QString, QRegion>& columnStyleRegions,
                             IntervalMap<QString>& columnStyles
                             )
@@ -469,10 +515,10 @@ void Odf::loadColumnNodes(Sheet *sheet, const KoXmlElement& parent,
         KoXmlElement elem = node.toElement();
         if (!elem.isNull() && elem.namespaceURI() == KoXmlNS::table) {
             if (elem.localName() == "table-column") {
-                loadColumnFormat(sheet, elem, odfContext.stylesReader(), indexCol, columnStyleRegions, columnStyles);
+                loadColumnFormat(sheet, elem, tableContext, indexCol, columnStyleRegions, columnStyles);
                 maxColumn = qMax(maxColumn, indexCol - 1);
             } else if (elem.localName() == "table-column-group") {
-                loadColumnNodes(sheet, elem, indexCol, maxColumn, odfContext, columnStyleRegions, columnStyles);
+                loadColumnNodes(sheet, elem, indexCol, maxColumn, tableContext, columnStyleRegions, columnStyles);
             }
         }
         node = node.nextSibling();
@@ -747,7 +793,7 @@ void Odf::loadMasterLayoutPage(Sheet *sheet, KoStyleStack &styleStack)
 }
 
 bool Odf::loadColumnFormat(Sheet *sheet, const KoXmlElement& column,
-                             const KoOdfStylesReader& stylesReader, int & indexCol,
+                             OdfLoadingContext& tableContext, int & indexCol,
                              QHash<QString, QRegion>& columnStyleRegions, IntervalMap<QString>& columnStyles)
 {
 //   debugSheetsODF<<"bool Odf::loadColumnFormat(const KoXmlElement& column, const KoOdfStylesReader& stylesReader, unsigned int & indexCol ) index Col :"<<indexCol;
@@ -784,35 +830,39 @@ bool Odf::loadColumnFormat(Sheet *sheet, const KoXmlElement& column,
         isNonDefaultColumn = true;
     }
 
-    KoStyleStack styleStack;
-    if (column.hasAttributeNS(KoXmlNS::table, "style-name")) {
-        QString str = column.attributeNS(KoXmlNS::table, "style-name", QString());
-        const KoXmlElement *style = stylesReader.findStyle(str, "table-column");
-        if (style) {
-            styleStack.push(*style);
-            isNonDefaultColumn = true;
+    double width = -1.0;
+    bool insertPageBreak = false;
+    {
+        // the style elements are shared by all sheets
+        QMutexLocker locker(tableContext.sharedNodesMutex);
+        KoStyleStack styleStack;
+        if (column.hasAttributeNS(KoXmlNS::table, "style-name")) {
+            QString str = column.attributeNS(KoXmlNS::table, "style-name", QString());
+            const KoXmlElement *style = tableContext.odfContext.stylesReader().findStyle(str, "table-column");
+            if (style) {
+                styleStack.push(*style);
+                isNonDefaultColumn = true;
+            }
         }
-    }
-    styleStack.setTypeProperties("table-column"); //style for column
+        styleStack.setTypeProperties("table-column"); //style for column
 
-    double width = -1.0;
-    if (styleStack.hasProperty(KoXmlNS::style, "column-width")) {
-        width = KoUnit::parseValue(styleStack.property(KoXmlNS::style, "column-width") , -1.0);
-        //debugSheetsODF << " style:column-width : width :" << width;
-        isNonDefaultColumn = true;
-    }
+        if (styleStack.hasProperty(KoXmlNS::style, "column-width")) {
+            width = KoUnit::parseValue(styleStack.property(KoXmlNS::style, "column-width") , -1.0);
+            //debugSheetsODF << " style:column-width : width :" << width;
+            isNonDefaultColumn = true;
+        }
 
-    bool insertPageBreak = false;
-    if (styleStack.hasProperty(KoXmlNS::fo, "break-before")) {
-        QString str = styleStack.property(KoXmlNS::fo, "break-before");
-        if (str == "page") {
-            insertPageBreak = true;
-        } else {
-            // debugSheetsODF << " str :" << str;
+        if (styleStack.hasProperty(KoXmlNS::fo, "break-before")) {
+            QString str = styleStack.property(KoXmlNS::fo, "break-before");
+            if (str == "page") {
+                insertPageBreak = true;
+            } else {
+                // debugSheetsODF << " str :" << str;
+            }
+            isNonDefaultColumn = true;
+        } else if (styleStack.hasProperty(KoXmlNS::fo, "break-after")) {
+            // TODO
         }
-        isNonDefaultColumn = true;
-    } else if (styleStack.hasProperty(KoXmlNS::fo, "break-after")) {
-        // TODO
     }
 
     // If it's a default column, we can return here.
@@ -871,16 +921,40 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
     KoOdfLoadingContext& odfContext = tableContext.odfContext;
     bool isNonDefaultRow = false;
 
-    KoStyleStack styleStack;
-    if (row.hasAttributeNS(KoXmlNS::table, sStyleName)) {
-        QString str = row.attributeNS(KoXmlNS::table, sStyleName, QString());
-        const KoXmlElement *style = odfContext.stylesReader().findStyle(str, "table-row");
-        if (style) {
-            styleStack.push(*style);
+    double height = -1.0;
+    bool insertPageBreak = false;
+    {
+        // the style elements are shared by all sheets
+        QMutexLocker locker(tableContext.sharedNodesMutex);
+        KoStyleStack styleStack;
+        if (row.hasAttributeNS(KoXmlNS::table, sStyleName)) {
+            QString str = row.attributeNS(KoXmlNS::table, sStyleName, QString());
+            const KoXmlElement *style = odfContext.stylesReader().findStyle(str, "table-row");
+            if (style) {
+                styleStack.push(*style);
+                isNonDefaultRow = true;
+            }
+        }
+        styleStack.setTypeProperties("table-row");
+
+        if (styleStack.hasProperty(KoXmlNS::style, "row-height")) {
+            height = KoUnit::parseValue(styleStack.property(KoXmlNS::style, "row-height") , -1.0);
+            //    debugSheetsODF<<" properties style:row-height : height :"<<height;
+            isNonDefaultRow = true;
+        }
+
+        if (styleStack.hasProperty(KoXmlNS::fo, "break-before")) {
+            QString str = styleStack.property(KoXmlNS::fo, "break-before");
+            if (str == sPage) {
+                insertPageBreak = true;
+            }
+            //  else
+            //      debugSheetsODF<<" str :"<<str;
             isNonDefaultRow = true;
+        } else if (styleStack.hasProperty(KoXmlNS::fo, "break-after")) {
+            // TODO
         }
     }
-    styleStack.setTypeProperties("table-row");
 
     int number = 1;
     if (row.hasAttributeNS(KoXmlNS::table, sNumberRowsRepeated)) {
@@ -901,13 +975,6 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
         }
     }
 
-    double height = -1.0;
-    if (styleStack.hasProperty(KoXmlNS::style, "row-height")) {
-        height = KoUnit::parseValue(styleStack.property(KoXmlNS::style, "row-height") , -1.0);
-        //    debugSheetsODF<<" properties style:row-height : height :"<<height;
-        isNonDefaultRow = true;
-    }
-
     enum { Visible, Collapsed, Filtered } visibility = Visible;
     if (row.hasAttributeNS(KoXmlNS::table, sVisibility)) {
         const QString string = row.attributeNS(KoXmlNS::table, sVisibility, sVisible);
@@ -918,19 +985,6 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
         isNonDefaultRow = true;
     }
 
-    bool insertPageBreak = false;
-    if (styleStack.hasProperty(KoXmlNS::fo, "break-before")) {
-        QString str = styleStack.property(KoXmlNS::fo, "break-before");
-        if (str == sPage) {
-            insertPageBreak = true;
-        }
-        //  else
-        //      debugSheetsODF<<" str :"<<str;
-        isNonDefaultRow = true;
-    } else if (styleStack.hasProperty(KoXmlNS::fo, "break-after")) {
-        // TODO
-    }
-
 //     debugSheetsODF<<" create non defaultrow format :"<<rowIndex<<" repeate :"<<number<<" height :"<<height;
     if (isNonDefaultRow) {
         if (height != -1.0)
@@ -946,6 +1000,14 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
     int columnMaximal = 0;
     const int endRow = qMin(rowIndex + number - 1, KS_rowMax);
 
+    // The contents of the row from its first non-empty cell on, inserted
+    // into all repetitions of the row at once.
+    CellStorage *const storage = sheet->cellStorage();
+    int firstColumn = 0;
+    QStringList userInputs;
+    QVector<Value> values;
+    QList<QPair<int, QString> > expressions;
+
     KoXmlElement cellElement;
     forEachElement(cellElement, row) {
         if (cellElement.namespaceURI() != KoXmlNS::table)
@@ -984,17 +1046,32 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
             sheet->cellStorage()->setValidity(Region(columnIndex, rowIndex, numberColumns, number, sheet), cell.validity());
 
         if (!cell.hasDefaultContent()) {
-            // Row-wise filling of PointStorages is faster than column-wise filling.
+            const QString userInput = storage->userInput(columnIndex, rowIndex);
+            const Value value = storage->value(columnIndex, rowIndex);
+            const QString expression = storage->formula(columnIndex, rowIndex).expression();
+            if (firstColumn == 0)
+                firstColumn = columnIndex;
+            const int offset = columnIndex - firstColumn;
+            while (userInputs.count() < offset)
+                userInputs.append(QString());
+            values.resize(offset + numberColumns);
+            for (int c = offset; c < offset + numberColumns; ++c) {
+                userInputs.append(userInput);
+                values[c] = value;
+                if (!expression.isEmpty())
+                    expressions.append(qMakePair(c, expression));
+            }
+
+            // Rich texts and merged cells are set cell by cell.
             QSharedPointer<QTextDocument> richText = cell.richText();
-            for (int r = rowIndex; r <= endRow; ++r) {
-                for (int c = 0; c < numberColumns; ++c) {
-                    Cell target(sheet, columnIndex + c, r);
-                    target.setFormula(cell.formula());
-                    target.setUserInput(cell.userInput());
-                    target.setRichText(richText);
-                    target.setValue(cell.value());
-                    if (cell.doesMergeCells()) {
-                        target.mergeCells(columnIndex + c, r, cell.mergedXCells(), cell.mergedYCells());
+            if (richText || cell.doesMergeCells()) {
+                for (int r = rowIndex; r <= endRow; ++r) {
+                    for (int c = 0; c < numberColumns; ++c) {
+                        Cell target(sheet, columnIndex + c, r);
+                        if (richText)
+                            target.setRichText(richText);
+                        if (cell.doesMergeCells())
+                            target.mergeCells(columnIndex + c, r, cell.mergedXCells(), cell.mergedYCells());
                     }
                 }
             }
@@ -1002,6 +1079,23 @@ int Odf::loadRowFormat(Sheet *sheet, const KoXmlElement& row, int &rowIndex,
         columnIndex += numberColumns;
     }
 
+    if (firstColumn > 0) {
+        // Row-wise filling of PointStorages is faster than column-wise filling.
+        for (int r = rowIndex; r <= endRow; ++r) {
+            // each cell gets a formula of its own
+            QVector<Formula> formulas;
+            if (!expressions.isEmpty()) {
+                formulas.resize(values.count());
+                for (int i = 0; i < expressions.count(); ++i) {
+                    const int c = expressions[i].first;
+                    formulas[c] = Formula(sheet, Cell(sheet, firstColumn + c, r));
+                    formulas[c].setExpression(expressions[i].second);
+                }
+            }
+            storage->insertRow(r, firstColumn, userInputs, values, formulas);
+        }
+    }
+
     sheet->cellStorage()->setRowsRepeated(rowIndex, number);
 
     rowIndex += number;
@@ -1750,6 +1844,7 @@ void Odf::loadSheetSettings(Sheet *sheet, const KoOasisSettings::NamedMap &setti
     sheet->setShowPageOutline(items.parseConfigItemBool("ShowPageOutline"));
     sheet->setLcMode(items.parseConfigItemBool("lcmode"));
     sheet->setAutoCalculationEnabled(items.parseConfigItemBool("autoCalc"));
+    sheet->setColumnarStorageEnabled(items.parseConfigItemBool("columnarStorage"));
     sheet->setShowColumnNumber(items.parseConfigItemBool("ShowColumnNumber"));
 }
 
@@ -1765,6 +1860,7 @@ void Odf::saveSheetSettings(Sheet *sheet, KoXmlWriter &settingsWriter)
     settingsWriter.addConfigItem("ShowPageOutline", sheet->isShowPageOutline());
     settingsWriter.addConfigItem("lcmode", sheet->getLcMode());
     settingsWriter.addConfigItem("autoCalc", sheet->isAutoCalculationEnabled());
+    settingsWriter.addConfigItem("columnarStorage", sheet->isColumnarStorageEnabled());
     settingsWriter.addConfigItem("ShowColumnNumber", sheet->getShowColumnNumber());
 }
 
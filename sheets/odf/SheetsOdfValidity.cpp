@@ -30,6 +30,8 @@
 #include <KoXmlReader.h>
 #include <KoXmlNS.h>
 
+#include <QMutexLocker>
+
 #include "OdfLoadingContext.h"
 
 namespace Calligra {
@@ -43,6 +45,8 @@ namespace Odf {
 void Odf::loadValidation(Validity *validity, Cell* const cell, const QString& validationName,
                                  OdfLoadingContext& tableContext)
 {
+    // the validity elements are shared by all sheets
+    QMutexLocker locker(tableContext.sharedNodesMutex);
     KoXmlElement element = tableContext.validities.value(validationName);
     if (element.hasAttributeNS(KoXmlNS::table, "condition")) {
         QString valExpression = element.attributeNS(KoXmlNS::table, "condition", QString());
@@ -565,6 +565,15 @@ void Doc::sheetAdded(Sheet* sheet)
 #endif
 }
 
+bool Doc::loadOdf(KoOdfReadStore & odfStore)
+{
+    KSharedConfigPtr config = Factory::global().config();
+    const bool parallel = config->group("Parameters").readEntry("Parallel Loading", false);
+    map()->loadingInfo()->setParallelLoading(parallel);
+
+    return DocBase::loadOdf(odfStore);
+}
+
 bool Doc::saveOdf(SavingContext &documentContext)
 {
     /* don't pull focus away from the editor if this is just a background
@@ -120,6 +120,12 @@ public:
 
     virtual bool saveOdf(SavingContext &documentContext);
 
+    /**
+     * \ingroup OpenDocument
+     * Reimplemented to apply the loading options of the configuration.
+     */
+    virtual bool loadOdf(KoOdfReadStore & odfStore);
+
     /**
      * Requests an update of all attached user interfaces (views).
      */
@@ -1330,6 +1330,7 @@ void View::sheetProperties()
     QPointer<SheetPropertiesDialog> dlg = new SheetPropertiesDialog(this);
     dlg->setLayoutDirection(d->activeSheet->layoutDirection());
     dlg->setAutoCalculationEnabled(d->activeSheet->isAutoCalculationEnabled());
+    dlg->setColumnarStorageEnabled(d->activeSheet->isColumnarStorageEnabled());
     dlg->setShowGrid(d->activeSheet->getShowGrid());
     dlg->setShowPageOutline(d->activeSheet->isShowPageOutline());
     dlg->setShowFormula(d->activeSheet->getShowFormula());
@@ -1351,6 +1352,7 @@ void View::sheetProperties()
 
         command->setLayoutDirection(dlg->layoutDirection());
         command->setAutoCalculationEnabled(dlg->autoCalc());
+        command->setColumnarStorageEnabled(dlg->columnarStorage());
         command->setShowGrid(dlg->showGrid());
         command->setShowPageOutline(dlg->showPageOutline());
         command->setShowFormula(dlg->showFormula());
@@ -55,6 +55,7 @@ void SheetPropertiesDialog::slotDefault()
 {
     setLayoutDirection(Qt::LeftToRight);
     setAutoCalculationEnabled(true);
+    setColumnarStorageEnabled(false);
     setShowGrid(true);
     setShowFormula(false);
     setHideZero(false);
@@ -101,6 +102,16 @@ void SheetPropertiesDialog::setAutoCalculationEnabled(bool b)
     m_widget->autoCalcCheckBox->setChecked(b);
 }
 
+bool SheetPropertiesDialog::columnarStorage() const
+{
+    return m_widget->columnarStorageCheckBox->isChecked();
+}
+
+void SheetPropertiesDialog::setColumnarStorageEnabled(bool b)
+{
+    m_widget->columnarStorageCheckBox->setChecked(b);
+}
+
 bool SheetPropertiesDialog::showGrid() const
 {
     return m_widget->showGridCheckBox->isChecked();
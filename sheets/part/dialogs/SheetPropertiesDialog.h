@@ -60,6 +60,10 @@ public:
 
     void setAutoCalculationEnabled(bool b);
 
+    bool columnarStorage() const;
+
+    void setColumnarStorageEnabled(bool b);
+
     bool showGrid() const;
 
     void setShowGrid(bool b);
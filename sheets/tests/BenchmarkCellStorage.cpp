@@ -0,0 +1,95 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkCellStorage.h"
+
+#include "Cell.h"
+#include "CellStorage.h"
+#include "Formula.h"
+#include "Map.h"
+#include "Sheet.h"
+#include "Value.h"
+
+#include <QStringList>
+#include <QTest>
+#include <QVector>
+
+using namespace Calligra::Sheets;
+
+static const int g_columns = 20;
+
+void CellStorageBenchmark::testFill_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<bool>("bulk");
+    QTest::addColumn<bool>("loading");
+
+    QTest::newRow("cell by cell, 10000 rows") << 10000 << false << false;
+    QTest::newRow("bulk, 10000 rows") << 10000 << true << false;
+    QTest::newRow("cell by cell while loading, 10000 rows") << 10000 << false << true;
+    QTest::newRow("bulk while loading, 10000 rows") << 10000 << true << true;
+}
+
+// Fills a sheet with numbers and a formula per row, like a CSV import.
+void CellStorageBenchmark::testFill()
+{
+    QFETCH(int, rows);
+    QFETCH(bool, bulk);
+    QFETCH(bool, loading);
+
+    QBENCHMARK {
+        Map map(0 /* no Doc */);
+        Sheet* sheet = map.addNewSheet();
+        CellStorage* storage = sheet->cellStorage();
+        map.setLoading(loading);
+        if (bulk)
+            storage->beginBulkInsertion();
+        for (int row = 1; row <= rows; ++row) {
+            QStringList userInputs;
+            QVector<Value> values(g_columns);
+            QVector<Formula> formulas(g_columns);
+            for (int col = 1; col < g_columns; ++col) {
+                userInputs << QString::number(row * col);
+                values[col - 1] = Value(row * col);
+            }
+            userInputs << QString();
+            formulas[g_columns - 1] = Formula(sheet, Cell(sheet, g_columns, row));
+            formulas[g_columns - 1].setExpression(QString("=SUM(A%1:S%1)").arg(row));
+            if (bulk) {
+                storage->insertRow(row, 1, userInputs, values, formulas);
+                continue;
+            }
+            for (int col = 1; col <= g_columns; ++col) {
+                Cell cell(sheet, col, row);
+                if (col == g_columns) {
+                    cell.setFormula(formulas[col - 1]);
+                } else {
+                    cell.setUserInput(userInputs[col - 1]);
+                    cell.setValue(values[col - 1]);
+                }
+            }
+        }
+        if (bulk)
+            storage->endBulkInsertion();
+        map.setLoading(false);
+        map.flushDamages();
+    }
+}
+
+QTEST_MAIN(CellStorageBenchmark)
@@ -0,0 +1,137 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkRecalc.h"
+
+#include "Cell.h"
+#include "Map.h"
+#include "Sheet.h"
+#include "Value.h"
+
+#include <QTest>
+
+using namespace Calligra::Sheets;
+
+void RecalcBenchmark::initTestCase()
+{
+    m_map = new Map(0 /* no Doc */);
+}
+
+Sheet* RecalcBenchmark::createSheet(const QString& name)
+{
+    Sheet* sheet = m_map->addNewSheet();
+    sheet->setSheetName(name);
+    return sheet;
+}
+
+void RecalcBenchmark::testEditLatency_independentRows_data()
+{
+    QTest::addColumn<int>("rows");
+
+    QTest::newRow("1000 rows") << 1000;
+    QTest::newRow("10000 rows") << 10000;
+    QTest::newRow("50000 rows") << 50000;
+}
+
+// A large model, in which the edited cell has got only a single consumer.
+// The latency should not depend on the model size.
+void RecalcBenchmark::testEditLatency_independentRows()
+{
+    QFETCH(int, rows);
+
+    Sheet* sheet = createSheet(QString("Rows%1").arg(rows));
+    for (int row = 1; row <= rows; ++row) {
+        Cell(sheet, 1, row).setUserInput(QString::number(row));
+        Cell(sheet, 2, row).setUserInput(QString("=A%1*2").arg(row));
+        Cell(sheet, 3, row).setUserInput(QString("=B%1+A%1").arg(row));
+    }
+    m_map->flushDamages();
+
+    Cell cell(sheet, 1, rows / 2);
+    int i = 0;
+    QBENCHMARK {
+        cell.setUserInput(QString::number(++i));
+        m_map->flushDamages();
+    }
+    QCOMPARE(Cell(sheet, 3, rows / 2).value(), Value(3.0 * i));
+}
+
+void RecalcBenchmark::testEditLatency_fanOut_data()
+{
+    QTest::addColumn<int>("consumers");
+
+    QTest::newRow("100 consumers") << 100;
+    QTest::newRow("1000 consumers") << 1000;
+    QTest::newRow("10000 consumers") << 10000;
+}
+
+// The edited cell is referenced by all formulas.
+void RecalcBenchmark::testEditLatency_fanOut()
+{
+    QFETCH(int, consumers);
+
+    Sheet* sheet = createSheet(QString("FanOut%1").arg(consumers));
+    Cell(sheet, 1, 1).setUserInput("1");
+    for (int row = 1; row <= consumers; ++row)
+        Cell(sheet, 2, row).setUserInput(QString("=$A$1*%1").arg(row));
+    m_map->flushDamages();
+
+    Cell cell(sheet, 1, 1);
+    int i = 0;
+    QBENCHMARK {
+        cell.setUserInput(QString::number(++i));
+        m_map->flushDamages();
+    }
+    QCOMPARE(Cell(sheet, 2, consumers).value(), Value(double(i) * consumers));
+}
+
+void RecalcBenchmark::testEditLatency_chain_data()
+{
+    QTest::addColumn<int>("length");
+
+    QTest::newRow("100 cells") << 100;
+    QTest::newRow("1000 cells") << 1000;
+}
+
+// Each cell in the chain references its predecessor.
+void RecalcBenchmark::testEditLatency_chain()
+{
+    QFETCH(int, length);
+
+    Sheet* sheet = createSheet(QString("Chain%1").arg(length));
+    Cell(sheet, 1, 1).setUserInput("1");
+    for (int row = 2; row <= length; ++row)
+        Cell(sheet, 1, row).setUserInput(QString("=A%1+1").arg(row - 1));
+    m_map->flushDamages();
+
+    Cell cell(sheet, 1, 1);
+    int i = 0;
+    QBENCHMARK {
+        cell.setUserInput(QString::number(++i));
+        m_map->flushDamages();
+    }
+    QCOMPARE(Cell(sheet, 1, length).value(), Value(double(i + length - 1)));
+}
+
+void RecalcBenchmark::cleanupTestCase()
+{
+    delete m_map;
+}
+
+QTEST_MAIN(RecalcBenchmark)
@@ -0,0 +1,59 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CALLIGRA_SHEETS_RECALC_BENCHMARK
+#define CALLIGRA_SHEETS_RECALC_BENCHMARK
+
+#include <QObject>
+
+namespace Calligra
+{
+namespace Sheets
+{
+class Map;
+class Sheet;
+
+/**
+ * Measures the latency from editing a cell until all damages, i.e. the
+ * dependency update, the recalculation and the repainting requests, are
+ * processed.
+ */
+class RecalcBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testEditLatency_independentRows_data();
+    void testEditLatency_independentRows();
+    void testEditLatency_fanOut_data();
+    void testEditLatency_fanOut();
+    void testEditLatency_chain_data();
+    void testEditLatency_chain();
+    void cleanupTestCase();
+
+private:
+    Sheet* createSheet(const QString& name);
+
+    Map* m_map;
+};
+
+} // namespace Sheets
+} // namespace Calligra
+
+#endif // CALLIGRA_SHEETS_RECALC_BENCHMARK
@@ -0,0 +1,170 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkStyleStorage.h"
+
+#include "Map.h"
+#include "Style.h"
+#include "StyleStorage.h"
+
+#include <QRunnable>
+#include <QTest>
+#include <QThreadPool>
+
+using namespace Calligra::Sheets;
+
+static const int g_columns = 100;
+static const int g_rows = 1000;
+
+namespace
+{
+/**
+ * Looks up the styles of a band of rows.
+ */
+class LookupJob : public QRunnable
+{
+public:
+    LookupJob(StyleStorage* storage, int firstRow, int lastRow)
+        : counter(0), m_storage(storage), m_firstRow(firstRow), m_lastRow(lastRow) {}
+
+    virtual void run() {
+        for (int y = m_firstRow; y <= m_lastRow; ++y) {
+            for (int x = 1; x <= g_columns; ++x) {
+                if (m_storage->contains(QPoint(x, y)).hasAttribute(Style::BackgroundColor))
+                    counter++;
+            }
+        }
+    }
+
+    int counter;
+
+private:
+    StyleStorage* m_storage;
+    int m_firstRow;
+    int m_lastRow;
+};
+} // namespace
+
+void StyleStorageBenchmark::init()
+{
+    m_map = new Map();
+    m_storage = new StyleStorage(m_map);
+    // a checkerboard of backgrounds and some bold columns
+    for (int y = 1; y <= g_rows; y += 2) {
+        for (int x = 1; x <= g_columns; x += 2) {
+            SharedSubStyle subStyle(new SubStyleOne<Style::BackgroundColor, QColor>(QColor(x % 255, y % 255, 0)));
+            m_storage->insert(QRect(x, y, 1, 1), subStyle);
+        }
+    }
+    for (int x = 1; x <= g_columns; x += 10)
+        m_storage->insert(QRect(x, 1, 1, g_rows), SharedSubStyle(new SubStyleOne<Style::FontBold, bool>(true)));
+}
+
+void StyleStorageBenchmark::cleanup()
+{
+    delete m_storage;
+    delete m_map;
+}
+
+void StyleStorageBenchmark::testLookupPerformance()
+{
+    LookupJob job(m_storage, 1, g_rows);
+    QBENCHMARK {
+        m_storage->invalidateCache();
+        job.run();
+    }
+}
+
+void StyleStorageBenchmark::testCachedLookupPerformance()
+{
+    LookupJob job(m_storage, 1, g_rows);
+    job.run();
+    QBENCHMARK {
+        job.run();
+    }
+}
+
+void StyleStorageBenchmark::testViewportLookupPerformance()
+{
+    // a screen of 96 rows, i.e. 4x3 cache tiles, painted repeatedly
+    LookupJob job(m_storage, 1, 96);
+    job.run();
+    QBENCHMARK {
+        job.run();
+    }
+}
+
+void StyleStorageBenchmark::testConcurrentLookupPerformance_data()
+{
+    QTest::addColumn<int>("threads");
+    QTest::addColumn<bool>("cached");
+
+    QTest::newRow("1 thread") << 1 << false;
+    QTest::newRow("4 threads") << 4 << false;
+    QTest::newRow("8 threads") << 8 << false;
+    QTest::newRow("1 thread, cached") << 1 << true;
+    QTest::newRow("4 threads, cached") << 4 << true;
+    QTest::newRow("8 threads, cached") << 8 << true;
+}
+
+void StyleStorageBenchmark::testConcurrentLookupPerformance()
+{
+    QFETCH(int, threads);
+    QFETCH(bool, cached);
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threads);
+    // the cells are looked up in bands of rows, like painted tiles, once per thread
+    QList<LookupJob*> jobs;
+    const int band = 32;
+    for (int i = 0; i < threads; ++i) {
+        for (int y = 1; y <= g_rows; y += band) {
+            LookupJob* job = new LookupJob(m_storage, y, qMin(y + band - 1, g_rows));
+            job->setAutoDelete(false);
+            jobs.append(job);
+        }
+    }
+    // the lazy loading is not thread-safe
+    m_storage->contains(QPoint(1, 1));
+    if (cached)
+        LookupJob(m_storage, 1, g_rows).run();
+    QBENCHMARK {
+        if (!cached)
+            m_storage->invalidateCache();
+        foreach (LookupJob* job, jobs)
+            threadPool.start(job);
+        threadPool.waitForDone();
+    }
+    qDeleteAll(jobs);
+}
+
+void StyleStorageBenchmark::testInvalidationPerformance()
+{
+    LookupJob job(m_storage, 1, g_rows);
+    job.run();
+    int row = 0;
+    QBENCHMARK {
+        // a single cell edit
+        row = row % g_rows + 1;
+        m_storage->insert(QRect(3, row, 1, 1), SharedSubStyle(new SubStyleOne<Style::FontItalic, bool>(true)));
+        job.run();
+    }
+}
+
+QTEST_MAIN(StyleStorageBenchmark)
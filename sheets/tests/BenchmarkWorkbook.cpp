@@ -0,0 +1,197 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#include "BenchmarkWorkbook.h"
+
+#include "MockPart.h"
+
+#include <part/Doc.h> // FIXME detach from part
+#include "Cell.h"
+#include "Map.h"
+#include "RecalcManager.h"
+#include "Sheet.h"
+
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace Calligra::Sheets;
+
+void WorkbookBenchmark::initTestCase()
+{
+    m_directory = new QTemporaryDir();
+    QVERIFY(m_directory->isValid());
+}
+
+void WorkbookBenchmark::addWorkbooks()
+{
+    QTest::addColumn<QString>("kind");
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("chain 2000") << "chain" << 2000;
+    QTest::newRow("fanout 10000") << "fanout" << 10000;
+    QTest::newRow("lookup 10000") << "lookup" << 10000;
+    QTest::newRow("array 5000") << "array" << 5000;
+    QTest::newRow("volatile 5000") << "volatile" << 5000;
+}
+
+QPoint WorkbookBenchmark::generate(Map* map, const QString& kind, int size)
+{
+    Sheet* sheet = map->addNewSheet("Sheet1");
+    QPoint input(1, 1);
+
+    if (kind == "chain") {
+        // A1 <- A2 <- ... <- An
+        Cell(sheet, 1, 1).setUserInput("1");
+        for (int row = 2; row <= size; ++row)
+            Cell(sheet, 1, row).setUserInput(QString("=A%1+1").arg(row - 1));
+    } else if (kind == "fanout") {
+        // every formula references A1
+        Cell(sheet, 1, 1).setUserInput("1");
+        for (int row = 1; row <= size; ++row)
+            Cell(sheet, 2, row).setUserInput(QString("=$A$1*%1").arg(row));
+    } else if (kind == "lookup") {
+        // a table in A:B and one lookup per ten table rows in D:F
+        for (int row = 1; row <= size; ++row) {
+            Cell(sheet, 1, row).setUserInput(QString("key%1").arg(row));
+            Cell(sheet, 2, row).setUserInput(QString::number(row));
+        }
+        const QString table = QString("$A$1:$B$%1").arg(size);
+        const QString keys = QString("$A$1:$A$%1").arg(size);
+        for (int row = 1; row <= size / 10; ++row) {
+            Cell(sheet, 4, row).setUserInput(QString("key%1").arg((row * 7919) % size + 1));
+            Cell(sheet, 5, row).setUserInput(QString("=VLOOKUP(D%1;%2;2;0)").arg(row).arg(table));
+            Cell(sheet, 6, row).setUserInput(QString("=MATCH(D%1;%2;0)").arg(row).arg(keys));
+        }
+        // a table value; all lookups depend on it
+        input = QPoint(2, 1);
+    } else if (kind == "array") {
+        // sliding windows of ten rows and a total
+        for (int row = 1; row <= size; ++row) {
+            Cell(sheet, 1, row).setUserInput(QString::number(row));
+            Cell(sheet, 2, row).setUserInput(QString::number(row % 7));
+        }
+        for (int row = 10; row <= size; ++row) {
+            Cell(sheet, 3, row).setUserInput(QString("=SUMPRODUCT(A%1:A%2;B%1:B%2)").arg(row - 9).arg(row));
+            Cell(sheet, 4, row).setUserInput(QString("=SUM(A%1:A%2*B%1:B%2)").arg(row - 9).arg(row));
+        }
+        Cell(sheet, 5, 1).setUserInput(QString("=SUM(C10:D%1)").arg(size));
+        input = QPoint(1, size / 2);
+    } else if (kind == "volatile") {
+        // volatile functions scaled by a common input and a total
+        Cell(sheet, 4, 1).setUserInput("1");
+        for (int row = 1; row <= size; ++row) {
+            Cell(sheet, 1, row).setUserInput((row % 2) ? "=RAND()" : "=NOW()");
+            Cell(sheet, 2, row).setUserInput(QString("=A%1*$D$1").arg(row));
+        }
+        Cell(sheet, 3, 1).setUserInput(QString("=SUM(B1:B%1)").arg(size));
+        input = QPoint(4, 1);
+    }
+    map->flushDamages();
+    return input;
+}
+
+void WorkbookBenchmark::testFullRecalc_data()
+{
+    addWorkbooks();
+}
+
+void WorkbookBenchmark::testFullRecalc()
+{
+    QFETCH(QString, kind);
+    QFETCH(int, size);
+
+    Doc doc(new MockPart);
+    generate(doc.map(), kind, size);
+
+    QBENCHMARK {
+        doc.map()->recalcManager()->recalcMap();
+    }
+}
+
+void WorkbookBenchmark::testEditRecalc_data()
+{
+    addWorkbooks();
+}
+
+void WorkbookBenchmark::testEditRecalc()
+{
+    QFETCH(QString, kind);
+    QFETCH(int, size);
+
+    Doc doc(new MockPart);
+    const QPoint input = generate(doc.map(), kind, size);
+
+    Cell cell(doc.map()->sheet(0), input);
+    int i = 0;
+    QBENCHMARK {
+        cell.setUserInput(QString::number(++i));
+        doc.map()->flushDamages();
+    }
+}
+
+void WorkbookBenchmark::testLoad_data()
+{
+    addWorkbooks();
+}
+
+void WorkbookBenchmark::testLoad()
+{
+    QFETCH(QString, kind);
+    QFETCH(int, size);
+
+    const QString fileName = m_directory->path() + QString("/load-%1-%2.ods").arg(kind).arg(size);
+    {
+        Doc doc(new MockPart);
+        generate(doc.map(), kind, size);
+        doc.setOutputMimeType(SHEETS_MIME_TYPE);
+        QVERIFY(doc.saveNativeFormat(fileName));
+    }
+
+    QBENCHMARK {
+        Doc doc(new MockPart);
+        QVERIFY(doc.loadNativeFormat(fileName));
+    }
+}
+
+void WorkbookBenchmark::testSave_data()
+{
+    addWorkbooks();
+}
+
+void WorkbookBenchmark::testSave()
+{
+    QFETCH(QString, kind);
+    QFETCH(int, size);
+
+    Doc doc(new MockPart);
+    generate(doc.map(), kind, size);
+    doc.setOutputMimeType(SHEETS_MIME_TYPE);
+
+    const QString fileName = m_directory->path() + QString("/save-%1-%2.ods").arg(kind).arg(size);
+    QBENCHMARK {
+        QVERIFY(doc.saveNativeFormat(fileName));
+    }
+}
+
+void WorkbookBenchmark::cleanupTestCase()
+{
+    delete m_directory;
+}
+
+QTEST_MAIN(WorkbookBenchmark)
@@ -0,0 +1,78 @@
+/* This file is part of the KDE project
+   Copyright 2018 The Calligra Team <calligra-devel@kde.org>
+
+   This library is free software; you can redistribute it and/or
+   modify it under the terms of the GNU Library General Public
+   License as published by the Free Software Foundation; either
+   version 2 of the License, or (at your option) any later version.
+
+   This library is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   Library General Public License for more details.
+
+   You should have received a copy of the GNU Library General Public License
+   along with this library; see the file COPYING.LIB.  If not, write to
+   the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+   Boston, MA 02110-1301, USA.
+*/
+
+#ifndef CALLIGRA_SHEETS_WORKBOOK_BENCHMARK
+#define CALLIGRA_SHEETS_WORKBOOK_BENCHMARK
+
+#include <QObject>
+#include <QPoint>
+
+class QTemporaryDir;
+
+namespace Calligra
+{
+namespace Sheets
+{
+class Map;
+
+/**
+ * Measures the recalculation, the loading and the saving of synthetic
+ * workbooks. Each workbook stresses another part of the engine:
+ *
+ * \li \c chain: a deep dependency chain
+ * \li \c fanout: a single input referenced by many formulas
+ * \li \c lookup: VLOOKUP and MATCH into a large table
+ * \li \c array: array expressions and SUMPRODUCT over sliding windows
+ * \li \c volatile: RAND and NOW with dependent formulas
+ *
+ * The workbooks are generated deterministically, so the numbers of two
+ * builds are comparable. Use the QTest options for machine-readable
+ * results, e.g. \c "-o results.xml,xml" or \c "-csv".
+ */
+class WorkbookBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void testFullRecalc_data();
+    void testFullRecalc();
+    void testEditRecalc_data();
+    void testEditRecalc();
+    void testLoad_data();
+    void testLoad();
+    void testSave_data();
+    void testSave();
+    void cleanupTestCase();
+
+private:
+    void addWorkbooks();
+
+    /**
+     * Fills \p map with the workbook \p kind of \p size.
+     * \return the input cell on the first sheet, that affects the most formulas
+     */
+    QPoint generate(Map* map, const QString& kind, int size);
+
+    QTemporaryDir* m_directory;
+};
+
+} // namespace Sheets
+} // namespace Calligra
+
+#endif // CALLIGRA_SHEETS_WORKBOOK_BENCHMARK
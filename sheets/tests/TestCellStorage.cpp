@@ -20,9 +20,12 @@
 #include "TestCellStorage.h"
 
 #include <sheets/CellStorage.h>
+#include <sheets/ColumnarValueStorage.h>
+#include <sheets/Formula.h>
 #include <sheets/Map.h>
 #include <sheets/Sheet.h>
 #include <sheets/Value.h>
+#include <sheets/ValueStorage.h>
 
 #include <QTest>
 
@@ -72,4 +75,199 @@ void CellStorageTest::testMergedCellsInsertRowBug()
     QCOMPARE(storage->mergedYCells(1, 3), 2);
 }
 
+void CellStorageTest::testColumnarValueStorage()
+{
+    Map map;
+    Sheet* sheet = map.addNewSheet();
+    CellStorage* storage = sheet->cellStorage();
+    QVERIFY(!storage->columnarValueStorage());
+
+    storage->setValue(1, 1, Value(1));
+    storage->setValue(1, 2, Value(2.5));
+    storage->setValue(1, 3, Value("text"));
+    storage->setValue(1, 300, Value(true));
+    storage->setValue(2, 2, Value::errorDIV0());
+
+    // enabling picks up the existing values
+    storage->setColumnarValueStorageEnabled(true);
+    const ColumnarValueStorage* columnar = storage->columnarValueStorage();
+    QVERIFY(columnar);
+    QCOMPARE(columnar->count(), 5);
+    QCOMPARE(columnar->kind(1, 1), ColumnarValueStorage::Integer);
+    QCOMPARE(columnar->kind(1, 2), ColumnarValueStorage::Float);
+    QCOMPARE(columnar->kind(1, 3), ColumnarValueStorage::String);
+    QCOMPARE(columnar->kind(1, 4), ColumnarValueStorage::Empty);
+    QCOMPARE(columnar->kind(1, 300), ColumnarValueStorage::Boolean);
+    QCOMPARE(columnar->kind(2, 2), ColumnarValueStorage::Error);
+    QCOMPARE(columnar->value(1, 3), Value("text"));
+    QCOMPARE(columnar->value(2, 2), Value::errorDIV0());
+
+    // column 1 spans two blocks, column 2 one
+    QVector<ColumnarValueStorage::Segment> segments = columnar->segments(QRect(1, 1, 2, 400));
+    QCOMPARE(segments.count(), 3);
+    QCOMPARE(segments[0].column, 1);
+    QCOMPARE(segments[0].row, 1);
+    QCOMPARE(segments[0].count, int(ColumnarValueStorage::BlockSize));
+    QCOMPARE(segments[0].numbers[1], 2.5);
+    QCOMPARE(columnar->string(int(segments[0].numbers[2])), QString("text"));
+    QCOMPARE(segments[1].column, 1);
+    QCOMPARE(segments[1].row, ColumnarValueStorage::BlockSize + 1);
+    QCOMPARE(segments[1].count, 400 - ColumnarValueStorage::BlockSize);
+    QCOMPARE(segments[2].column, 2);
+    QCOMPARE(columnar->blockCount(), 3);
+
+    // edits are mirrored
+    storage->setValue(1, 1, Value(7));
+    storage->setValue(1, 3, Value());
+    QCOMPARE(columnar->value(1, 1), Value(7));
+    QCOMPARE(columnar->kind(1, 3), ColumnarValueStorage::Empty);
+    QCOMPARE(columnar->count(), 4);
+
+    // emptied blocks are released
+    storage->setValue(1, 300, Value());
+    QCOMPARE(columnar->blockCount(), 2);
+    storage->setValue(1, 300, Value(true));
+    QCOMPARE(columnar->blockCount(), 3);
+
+    // structural changes too
+    storage->insertRows(1, 1);
+    QCOMPARE(columnar->value(1, 2), Value(7));
+    QCOMPARE(columnar->value(1, 3), Value(2.5));
+    QCOMPARE(columnar->kind(1, 301), ColumnarValueStorage::Boolean);
+
+    storage->setColumnarValueStorageEnabled(false);
+    QVERIFY(!storage->columnarValueStorage());
+}
+
+// Checks, that the columnar copy holds exactly the values of the storage.
+static bool columnarMatches(const CellStorage* storage)
+{
+    const ValueStorage* values = storage->valueStorage();
+    const ColumnarValueStorage* columnar = storage->columnarValueStorage();
+    if (columnar->count() != values->count()) {
+        qDebug() << "count" << columnar->count() << "expected" << values->count();
+        return false;
+    }
+    for (int i = 0; i < values->count(); ++i) {
+        const int col = values->col(i);
+        const int row = values->row(i);
+        if (columnar->value(col, row) != values->data(i)) {
+            qDebug() << "mismatch at" << col << row << columnar->value(col, row) << values->data(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+void CellStorageTest::testColumnarValueStorageShifts()
+{
+    Map map;
+    Sheet* sheet = map.addNewSheet();
+    CellStorage* storage = sheet->cellStorage();
+    sheet->setColumnarStorageEnabled(true);
+    QVERIFY(sheet->isColumnarStorageEnabled());
+    QVERIFY(storage->columnarValueStorage());
+
+    for (int col = 1; col <= 6; ++col) {
+        for (int row = 1; row <= 600; row += 7)
+            storage->setValue(col, row, (row % 3) ? Value(col * 1000 + row) : Value(QString::number(row)));
+    }
+    QVERIFY(columnarMatches(storage));
+
+    storage->insertRows(5, 300);
+    QVERIFY(columnarMatches(storage));
+    storage->removeRows(2, 17);
+    QVERIFY(columnarMatches(storage));
+    storage->insertColumns(2, 3);
+    QVERIFY(columnarMatches(storage));
+    storage->removeColumns(1, 2);
+    QVERIFY(columnarMatches(storage));
+    storage->removeShiftLeft(QRect(2, 10, 2, 400));
+    QVERIFY(columnarMatches(storage));
+    storage->insertShiftRight(QRect(1, 200, 3, 50));
+    QVERIFY(columnarMatches(storage));
+    storage->removeShiftUp(QRect(3, 1, 2, 260));
+    QVERIFY(columnarMatches(storage));
+    storage->insertShiftDown(QRect(1, 100, 4, 513));
+    QVERIFY(columnarMatches(storage));
+
+    // values shifted over the end are dropped
+    storage->setValue(1, KS_rowMax, Value(1));
+    storage->insertRows(1, 1);
+    QVERIFY(columnarMatches(storage));
+
+    sheet->setColumnarStorageEnabled(false);
+    QVERIFY(!sheet->isColumnarStorageEnabled());
+}
+
+void CellStorageTest::testColumnarValueStorageInterning()
+{
+    Map map;
+    Sheet* sheet = map.addNewSheet();
+    CellStorage* storage = sheet->cellStorage();
+    sheet->setColumnarStorageEnabled(true);
+    const ColumnarValueStorage* columnar = storage->columnarValueStorage();
+
+    storage->setValue(1, 1, Value("a"));
+    storage->setValue(1, 2, Value("a"));
+    storage->setValue(1, 3, Value::errorNA());
+    QCOMPARE(columnar->internedCount(), 2);
+
+    // editing a cell over and over does not grow the tables
+    for (int i = 0; i < 100; ++i)
+        storage->setValue(2, 1, Value(QString::number(i)));
+    QCOMPARE(columnar->internedCount(), 3);
+
+    storage->setValue(1, 1, Value(1));
+    QCOMPARE(columnar->internedCount(), 3);
+    storage->setValue(1, 2, Value());
+    storage->setValue(1, 3, Value(2));
+    QCOMPARE(columnar->internedCount(), 1);
+    QCOMPARE(columnar->value(2, 1), Value("99"));
+
+    // removed cells release their strings
+    storage->removeColumns(2, 1);
+    QCOMPARE(columnar->internedCount(), 0);
+    storage->setValue(1, 5, Value("b"));
+    storage->removeRows(5, 1);
+    QCOMPARE(columnar->internedCount(), 0);
+    QVERIFY(columnarMatches(storage));
+}
+
+void CellStorageTest::testBulkInsertion()
+{
+    Map map;
+    Sheet* sheet = map.addNewSheet();
+    CellStorage* storage = sheet->cellStorage();
+
+    storage->beginBulkInsertion();
+    for (int row = 1; row <= 3; ++row) {
+        QStringList userInputs;
+        userInputs << QString::number(row) << QString() << "text";
+        QVector<Value> values;
+        values << Value(row) << Value() << Value("text");
+        QVector<Formula> formulas(2);
+        formulas[1] = Formula(sheet, Cell(sheet, 2, row));
+        formulas[1].setExpression("=A1*2");
+        storage->insertRow(row, 1, userInputs, values, formulas);
+    }
+    storage->endBulkInsertion();
+
+    QCOMPARE(storage->value(1, 2), Value(2));
+    QCOMPARE(storage->userInput(1, 2), QString("2"));
+    QCOMPARE(storage->value(3, 3), Value("text"));
+    QCOMPARE(storage->formula(2, 3).expression(), QString("=A1*2"));
+    QVERIFY(storage->userInput(2, 1).isEmpty());
+    QCOMPARE(storage->value(4, 1), Value());
+
+    // the contents of existing cells are replaced
+    storage->insertRow(3, 1, QStringList() << QString() << "4", QVector<Value>() << Value() << Value(4));
+    QCOMPARE(storage->value(1, 3), Value());
+    QVERIFY(storage->userInput(1, 3).isEmpty());
+    QVERIFY(storage->formula(2, 3).expression().isEmpty());
+    QCOMPARE(storage->value(2, 3), Value(4));
+    QCOMPARE(storage->userInput(2, 3), QString("4"));
+    QCOMPARE(storage->value(3, 3), Value("text"));
+}
+
 QTEST_MAIN(CellStorageTest)
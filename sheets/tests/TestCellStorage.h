@@ -32,6 +32,10 @@ class CellStorageTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testMergedCellsInsertRowBug();
+    void testColumnarValueStorage();
+    void testColumnarValueStorageShifts();
+    void testColumnarValueStorageInterning();
+    void testBulkInsertion();
 };
 
 } // namespace Sheets
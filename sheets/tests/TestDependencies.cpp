@@ -21,14 +21,18 @@
 
 #include <QTest>
 
+#include "Cell.h"
 #include "CellStorage.h"
 #include "DependencyManager.h"
 #include "DependencyManager_p.h"
 #include "Formula.h"
+#include "LookupCache.h"
 #include "Map.h"
+#include "RecalcManager.h"
 #include "Region.h"
 #include "Sheet.h"
 #include "Value.h"
+#include "ValueCalc.h"
 
 using namespace Calligra::Sheets;
 
@@ -108,6 +112,98 @@ void TestDependencies::testDepths()
     QCOMPARE(depths[a4], 2);
 }
 
+void TestDependencies::testParallelRecalc()
+{
+    Sheet* sheet = m_map->addNewSheet();
+    sheet->setSheetName("Parallel");
+    // three levels, large enough to get split into several jobs
+    for (int row = 1; row <= 500; ++row) {
+        Cell(sheet, 1, row).setUserInput(QString::number(row));
+        Cell(sheet, 2, row).setUserInput(QString("=A%1*2").arg(row));
+        Cell(sheet, 3, row).setUserInput(QString("=B%1+A%1").arg(row));
+    }
+    QApplication::processEvents(); // handle Damages
+
+    RecalcManager* manager = m_map->recalcManager();
+    manager->setThreadCount(4);
+    QCOMPARE(manager->threadCount(), 4);
+    Cell(sheet, 1, 1).setUserInput("1000");
+    QApplication::processEvents(); // handle Damages
+    manager->recalcSheet(sheet);
+
+    QCOMPARE(Cell(sheet, 2, 1).value(), Value(2000.0));
+    QCOMPARE(Cell(sheet, 3, 1).value(), Value(3000.0));
+    for (int row = 2; row <= 500; ++row) {
+        QCOMPARE(Cell(sheet, 2, row).value(), Value(2.0 * row));
+        QCOMPARE(Cell(sheet, 3, row).value(), Value(3.0 * row));
+    }
+
+    manager->setThreadCount(1);
+    QCOMPARE(manager->threadCount(), 1);
+}
+
+void TestDependencies::testLookupCache()
+{
+    Sheet* sheet = m_map->addNewSheet();
+    sheet->setSheetName("Lookup");
+    const QRect range(1, 1, 2, 40);
+    Value data(Value::Array);
+    for (int row = 1; row <= 40; ++row) {
+        const Value value = (row % 2) ? Value(row) : Value(QString("key%1").arg(row));
+        sheet->cellStorage()->setValue(1, row, value);
+        data.setElement(0, row - 1, value);
+        data.setElement(1, row - 1, Value(row * 10));
+    }
+
+    LookupCache* cache = m_map->dependencyManager()->lookupCache();
+    ValueCalc* calc = m_map->calc();
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value(7), true, false, calc), 6);
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value(8), true, false, calc), int(LookupCache::NotFound));
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value("key12"), true, false, calc), 11);
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value("KEY12"), true, false, calc), int(LookupCache::NotFound));
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value("KEY12"), false, false, calc), 11);
+    // the largest text below the key
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value("key13"), true, true, calc), 11);
+
+    // a value change drops the index of the range
+    sheet->cellStorage()->setValue(1, 20, Value(8));
+    data.setElement(0, 19, Value(8));
+    QCOMPARE(cache->find(sheet, range, Qt::Vertical, data, Value(8), true, false, calc), 19);
+
+    // approximate matches on sorted numbers
+    for (int row = 1; row <= 40; ++row) {
+        sheet->cellStorage()->setValue(3, row, Value(row * 10));
+        sheet->cellStorage()->setValue(4, row, Value((41 - row) * 10));
+    }
+    const QString expressions[6] = {
+        "=MATCH(250;C1:C40;0)", "=MATCH(250;C1:C40;1)", "=MATCH(255;C1:C40;1)",
+        "=MATCH(5;C1:C40;1)", "=MATCH(255;D1:D40;-1)", "=MATCH(500;D1:D40;-1)"
+    };
+    const Value results[6] = {
+        Value(25), Value(25), Value(25), Value::errorNA(), Value(15), Value::errorNA()
+    };
+    for (int i = 0; i < 6; ++i) {
+        Formula formula(sheet);
+        formula.setExpression(expressions[i]);
+        QCOMPARE(formula.eval(), results[i]);
+    }
+    // Like the scan of VLOOKUP, the index never takes a number as the
+    // approximate match.
+    Value numbers(Value::Array);
+    for (int row = 1; row <= 40; ++row)
+        numbers.setElement(0, row - 1, Value(row * 10));
+    const QRect numberRange(3, 1, 1, 40);
+    QCOMPARE(cache->find(sheet, numberRange, Qt::Vertical, numbers, Value(250), true, true, calc), 24);
+    QCOMPARE(cache->find(sheet, numberRange, Qt::Vertical, numbers, Value(255), true, true, calc), int(LookupCache::NotFound));
+    Formula formula(sheet);
+    formula.setExpression("=VLOOKUP(255;C1:D40;2;1)");
+    QCOMPARE(formula.eval(), Value::errorNA());
+
+    // short ranges are not indexed
+    const Value column = Value(Value::Array);
+    QCOMPARE(cache->find(sheet, QRect(1, 1, 1, 1), Qt::Vertical, column, Value(1), true, false, calc), int(LookupCache::NotIndexed));
+}
+
 void TestDependencies::cleanupTestCase()
 {
     delete m_map;
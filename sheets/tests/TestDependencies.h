@@ -39,6 +39,8 @@ private Q_SLOTS:
     void testCircleRemoval();
     void testCircles();
     void testDepths();
+    void testParallelRecalc();
+    void testLookupCache();
     void cleanupTestCase();
 
 private:
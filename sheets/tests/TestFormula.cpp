@@ -20,6 +20,10 @@
 
 #include "TestKspreadCommon.h"
 
+#include "Cell.h"
+#include "Map.h"
+#include "Sheet.h"
+
 using namespace Calligra::Sheets;
 
 static char encodeTokenType(const Token& token)
@@ -369,4 +373,59 @@ void TestFormula::testInlineArrays()
 #endif
 }
 
+void TestFormula::testRegisterCode_data()
+{
+    QTest::addColumn<QString>("expression");
+
+    // constant folding
+    QTest::newRow("folded arithmetic") << "=1+2*3-4/2^2";
+    QTest::newRow("folded percent") << "=50%";
+    QTest::newRow("folded negation") << "=-(2+3)";
+    QTest::newRow("folded comparison") << "=1+1=2";
+    QTest::newRow("folded division by zero") << "=1/0";
+    QTest::newRow("string not folded") << "=\"1\"+2";
+    QTest::newRow("concatenation") << "=\"a\"&1&\"b\"";
+
+    // references
+    QTest::newRow("cell") << "=A1*2+B1";
+    QTest::newRow("cell on other sheet") << "=Sheet2!A1+1";
+    QTest::newRow("range") << "=SUM(A1:B2)";
+    QTest::newRow("mixed") << "=A1+2*3+SUM(A1:A2;4)";
+    QTest::newRow("text operand") << "=A1+A3";
+    QTest::newRow("comparison") << "=A1<B1";
+    QTest::newRow("not") << "=NOT(A1=B1)";
+
+    // functions
+    QTest::newRow("nested functions") << "=SUM(ABS(-1);ABS(A2))";
+    QTest::newRow("no arguments") << "=PI()*2";
+    QTest::newRow("unknown function") << "=FOOBAR(1)";
+}
+
+void TestFormula::testRegisterCode()
+{
+    QFETCH(QString, expression);
+
+    Map map(0 /* no Doc */);
+    Sheet* sheet = map.addNewSheet();
+    sheet->setSheetName("Sheet1");
+    Sheet* sheet2 = map.addNewSheet();
+    sheet2->setSheetName("Sheet2");
+    Cell(sheet, 1, 1).setValue(Value(3));
+    Cell(sheet, 2, 1).setValue(Value(4.5));
+    Cell(sheet, 1, 2).setValue(Value(-7));
+    Cell(sheet, 2, 2).setValue(Value(2));
+    Cell(sheet, 1, 3).setValue(Value("text"));
+    Cell(sheet2, 1, 1).setValue(Value(10));
+
+    Formula formula(sheet, Cell(sheet, 5, 5));
+    formula.setExpression(expression);
+    QVERIFY(formula.isValid());
+
+    // A non-empty cell indirection forces the stack based evaluation.
+    CellIndirection indirection;
+    indirection.insert(Cell(sheet, 100, 100), Cell(sheet, 100, 100));
+
+    QCOMPARE(formula.eval(), formula.eval(indirection));
+}
+
 QTEST_MAIN(TestFormula)
@@ -45,6 +45,8 @@ private Q_SLOTS:
     void testString();
     void testFunction();
     void testInlineArrays();
+    void testRegisterCode_data();
+    void testRegisterCode();
 
 private:
     Value evaluate(const QString&, Value&);
@@ -939,6 +939,7 @@ void TestMathFunctions::testSUMSQ()
     CHECK_EVAL("SUMSQ(1;2;3)",      Value(14));     // Simple sum.
     CHECK_EVAL("SUMSQ(TRUE();2;3)", Value(14));     // TRUE() is 1.
     CHECK_EVAL("SUMSQ(B4:B5)",      Value(13));     // 2*2+3*3 is 13.
+    CHECK_EVAL("SUMSQ(B3:B5)",      Value(13));     // Strings in ranges are ignored.
 }
 
 void TestMathFunctions::testTRUNC()
@@ -26,12 +26,21 @@
 #include <KoXmlWriter.h>
 #include <KoGenStyles.h>
 #include <KoEmbeddedDocumentSaver.h>
+#include <KoStore.h>
 
 #include <part/Doc.h> // FIXME detach from part
 #include <Map.h>
 #include <Sheet.h>
+#include <Cell.h>
 #include <CellStorage.h>
-
+#include <FormulaStorage.h>
+#include <LoadingInfo.h>
+#include <RowColumnFormat.h>
+#include <RowFormatStorage.h>
+#include <Value.h>
+#include <odf/SheetsOdf.h>
+
+#include <QBuffer>
 #include <QPainter>
 #include <QTest>
 
@@ -173,6 +182,107 @@ void SheetTest::testDocumentToCellCoordinates()
     QCOMPARE(m_sheet->documentToCellCoordinates(area), result);
 }
 
+static QByteArray odfNamespaces()
+{
+    return "xmlns:office=\"urn:oasis:names:tc:opendocument:xmlns:office:1.0\" "
+           "xmlns:style=\"urn:oasis:names:tc:opendocument:xmlns:style:1.0\" "
+           "xmlns:text=\"urn:oasis:names:tc:opendocument:xmlns:text:1.0\" "
+           "xmlns:table=\"urn:oasis:names:tc:opendocument:xmlns:table:1.0\" "
+           "xmlns:fo=\"urn:oasis:names:tc:opendocument:xmlns:xsl-fo-compatible:1.0\" "
+           "xmlns:of=\"urn:oasis:names:tc:opendocument:xmlns:of:1.2\" "
+           "office:version=\"1.2\"";
+}
+
+static QByteArray odfPackage(int sheetCount, int rowCount)
+{
+    QByteArray content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                         "<office:document-content " + odfNamespaces() + ">"
+                         "<office:automatic-styles>"
+                         "<style:style style:name=\"ro1\" style:family=\"table-row\">"
+                         "<style:table-row-properties style:row-height=\"0.5in\"/>"
+                         "</style:style>"
+                         "<style:style style:name=\"co1\" style:family=\"table-column\">"
+                         "<style:table-column-properties style:column-width=\"2in\"/>"
+                         "</style:style>"
+                         "</office:automatic-styles>"
+                         "<office:body><office:spreadsheet>";
+    for (int s = 1; s <= sheetCount; ++s) {
+        content += "<table:table table:name=\"Sheet" + QByteArray::number(s) + "\">"
+                   "<table:table-column table:style-name=\"co1\"/>"
+                   "<table:table-column table:number-columns-repeated=\"2\"/>";
+        for (int r = 1; r <= rowCount; ++r) {
+            content += (r % 3) ? "<table:table-row>" : "<table:table-row table:style-name=\"ro1\">";
+            content += "<table:table-cell office:value-type=\"float\" office:value=\"" + QByteArray::number(s * r) + "\">"
+                       "<text:p>" + QByteArray::number(s * r) + "</text:p></table:table-cell>";
+            content += "<table:table-cell office:value-type=\"string\"><text:p>Text " + QByteArray::number(r) + "</text:p></table:table-cell>";
+            content += "<table:table-cell table:formula=\"of:=[Sheet1.A" + QByteArray::number(r) + "]+[.A" + QByteArray::number(r) + "]\"/>";
+            content += "</table:table-row>";
+        }
+        // rich text has to be loaded in the main thread
+        if (s == 2) {
+            content += "<table:table-row><table:table-cell><text:p>Rich <text:span>text</text:span></text:p>"
+                       "</table:table-cell></table:table-row>";
+        }
+        content += "</table:table>";
+    }
+    content += "</office:spreadsheet></office:body></office:document-content>";
+
+    const QByteArray styles = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                              "<office:document-styles " + odfNamespaces() + ">"
+                              "<office:styles/></office:document-styles>";
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    KoStore* store = KoStore::createStore(&buffer, KoStore::Write, "application/vnd.oasis.opendocument.spreadsheet");
+    store->open("content.xml");
+    store->write(content);
+    store->close();
+    store->open("styles.xml");
+    store->write(styles);
+    store->close();
+    delete store;
+    return data;
+}
+
+void SheetTest::testLoadConcurrently()
+{
+    const int sheetCount = 6;
+    const int rowCount = 50;
+    QByteArray data = odfPackage(sheetCount, rowCount);
+
+    Doc sequentialDoc(new MockPart);
+    QBuffer sequentialBuffer(&data);
+    QVERIFY(Odf::paste(sequentialBuffer, sequentialDoc.map()));
+
+    Doc concurrentDoc(new MockPart);
+    concurrentDoc.map()->loadingInfo()->setParallelLoading(true);
+    QBuffer concurrentBuffer(&data);
+    QVERIFY(Odf::paste(concurrentBuffer, concurrentDoc.map()));
+
+    QCOMPARE(concurrentDoc.map()->count(), sheetCount);
+    QCOMPARE(sequentialDoc.map()->count(), sheetCount);
+    for (int s = 0; s < sheetCount; ++s) {
+        Sheet* expected = sequentialDoc.map()->sheet(s);
+        Sheet* sheet = concurrentDoc.map()->sheet(s);
+        QCOMPARE(sheet->sheetName(), expected->sheetName());
+        QCOMPARE(sheet->cellStorage()->userInputStorage()->count(), expected->cellStorage()->userInputStorage()->count());
+        QCOMPARE(sheet->cellStorage()->formulaStorage()->count(), expected->cellStorage()->formulaStorage()->count());
+        QCOMPARE(sheet->columnFormat(1)->width(), expected->columnFormat(1)->width());
+        for (int row = 1; row <= rowCount + 1; ++row) {
+            QCOMPARE(sheet->rowFormats()->rowHeight(row), expected->rowFormats()->rowHeight(row));
+            for (int col = 1; col <= 3; ++col) {
+                const Cell cell(sheet, col, row);
+                const Cell expectedCell(expected, col, row);
+                QCOMPARE(cell.userInput(), expectedCell.userInput());
+                QCOMPARE(cell.value(), expectedCell.value());
+            }
+        }
+    }
+    QCOMPARE(Cell(concurrentDoc.map()->sheet(2), 1, 4).value(), Value(12));
+    QCOMPARE(Cell(concurrentDoc.map()->sheet(2), 3, 4).userInput(), QString("=Sheet1!A4+A4"));
+    QCOMPARE(Cell(concurrentDoc.map()->sheet(1), 1, rowCount + 1).userInput(), QString("Rich text"));
+}
+
 #if 0
 // test if embedded objects are propare taken into account (tests for bug 287997)
 void SheetTest::testCompareRows()
@@ -44,6 +44,8 @@ private Q_SLOTS:
     void testDocumentToCellCoordinates_data();
     void testDocumentToCellCoordinates();
 
+    void testLoadConcurrently();
+
 //    void testCompareRows();
 
 private:
@@ -29,6 +29,7 @@
 #include <Formula.h>
 #include <Map.h>
 #include <Sheet.h>
+#include <ValueCalc.h>
 
 #include "TestKspreadCommon.h"
 
@@ -1099,6 +1100,7 @@ void TestStatisticalFunctions::testSUMPRODUCT()
 {
     CHECK_EVAL("SUMPRODUCT(C19:C23;A19:A23)", Value(106));
     CHECK_EVAL("SUMPRODUCT(C19:C23^2;2*A19:A23)", Value(820));
+    CHECK_EVAL("SUMPRODUCT(C19:C23;A19:A22)", Value::errorVALUE()); // Sizes differ.
 }
 
 void TestStatisticalFunctions::testTDIST()
@@ -1243,6 +1245,75 @@ void TestStatisticalFunctions::testZTEST()
     CHECK_EVAL("ZTEST(B4:C5; 5  ; 0.1 )", Value(1));               // mean at a border value, small standard deviation: improbable
 }
 
+static bool closeTo(const Value& value, const Value& expected)
+{
+    const long double difference = fabsl(value.asFloat() - expected.asFloat());
+    if (difference <= 1e-12 * fabsl(expected.asFloat()))
+        return true;
+    qDebug() << (double)value.asFloat() << "expected" << (double)expected.asFloat();
+    return false;
+}
+
+void TestStatisticalFunctions::testReductionPrecision()
+{
+    ValueCalc* calc = m_map->calc();
+
+    // Cancels out in double, but not in Number. The blocks of four hit
+    // every partial sum of the kernels.
+    Value cancelling(Value::Array);
+    const double pattern[3] = { 1e16, 1.0, -1e16 };
+    for (int row = 0; row < 3000; ++row)
+        cancelling.setElement(0, row, Value(pattern[(row / 4) % 3]));
+    QVector<Value> range(1, cancelling);
+    Value sum(0);
+    calc->arrayWalk(range, sum, calc->awFunc("sum"), Value(0));
+    QVERIFY(sum.asFloat() == 1000);
+    QVERIFY(calc->sum(range, false).asFloat() == 1000);
+    QVERIFY(calc->avg(range, false).asFloat() == calc->div(sum, 3000).asFloat());
+
+    // A large mean and a small deviation.
+    Value offset(Value::Array);
+    for (int row = 0; row < 4001; ++row)
+        offset.setElement(0, row, Value(1e9 + 0.1 * (row % 10)));
+    range = QVector<Value>(1, offset);
+    sum = Value(0);
+    calc->arrayWalk(range, sum, calc->awFunc("sum"), Value(0));
+    const Value avg = calc->div(sum, 4001);
+    Value devsq;
+    calc->arrayWalk(range, devsq, calc->awFunc("devsq"), avg);
+    QVERIFY(closeTo(calc->sum(range, false), sum));
+    QVERIFY(closeTo(calc->avg(range, false), avg));
+    QVERIFY(closeTo(calc->devsq(range, avg, false), devsq));
+    QVERIFY(closeTo(calc->stddev(range, false), calc->sqrt(calc->div(devsq, 4000))));
+    QVERIFY(closeTo(calc->stddevP(range, false), calc->sqrt(calc->div(devsq, 4001))));
+
+    // The same through formulas on the columnar storage, with empty cells
+    // and text between the numbers.
+    Map map;
+    Sheet* sheet = map.addNewSheet();
+    CellStorage* storage = sheet->cellStorage();
+    for (int row = 1; row <= 4001; ++row)
+        storage->setValue(1, row, offset.element(0, row - 1));
+    storage->setValue(1, 5000, Value("text"));
+    for (int row = 1; row <= 3000; ++row)
+        storage->setValue(2, 2 * row, cancelling.element(0, row - 1));
+
+    const QString formulas[5] = {
+        "=SUM(B1:B6000)", "=AVERAGE(A1:A5000)", "=DEVSQ(A1:A5000)", "=STDEV(A1:A5000)", "=VAR(A1:A5000)"
+    };
+    const Value expected[5] = {
+        Value(1000.0), avg, devsq, calc->sqrt(calc->div(devsq, 4000)), calc->div(devsq, 4000)
+    };
+    for (int enabled = 0; enabled < 2; ++enabled) {
+        sheet->setColumnarStorageEnabled(enabled);
+        for (int i = 0; i < 5; ++i) {
+            Formula formula(sheet);
+            formula.setExpression(formulas[i]);
+            QVERIFY2(closeTo(formula.eval(), expected[i]), qPrintable(formulas[i]));
+        }
+    }
+}
+
 void TestStatisticalFunctions::cleanupTestCase()
 {
     delete m_map;
@@ -136,6 +136,9 @@ private Q_SLOTS:
     void testWEIBULL();
     void testZTEST();
 
+    // the reductions over plain numbers against the generic walk
+    void testReductionPrecision();
+
     void cleanupTestCase();
 
 private:
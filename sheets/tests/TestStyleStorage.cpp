@@ -21,6 +21,7 @@
 
 #include <StyleStorage.h>
 #include <Map.h>
+#include "calligra_sheets_limits.h"
 
 #include <QTest>
 
@@ -63,4 +64,60 @@ void TestStyleStorage::testGarbageCollection()
     }
 }
 
+void TestStyleStorage::testCacheInvalidation()
+{
+    Map map;
+    StyleStorage storage(&map);
+
+    QColor c1(Qt::red);
+    QColor c2(Qt::blue);
+    SharedSubStyle style1(new SubStyleOne<Style::BackgroundColor, QColor>(c1));
+    SharedSubStyle style2(new SubStyleOne<Style::BackgroundColor, QColor>(c2));
+    // spans several cache tiles
+    storage.insert(QRect(1, 1, 100, 100), style1);
+    for (int col = 1; col <= 100; col += 3) {
+        for (int row = 1; row <= 100; row += 3)
+            QCOMPARE(storage.contains(QPoint(col, row)).backgroundColor(), c1);
+    }
+    // only the cached styles in the changed rect are dropped
+    storage.insert(QRect(30, 30, 10, 10), style2);
+    for (int col = 1; col <= 100; col += 3) {
+        for (int row = 1; row <= 100; row += 3) {
+            const bool changed = QRect(30, 30, 10, 10).contains(col, row);
+            QCOMPARE(storage.contains(QPoint(col, row)).backgroundColor(), changed ? c2 : c1);
+        }
+    }
+    // whole columns
+    storage.insert(QRect(50, 1, 1, KS_rowMax), style2);
+    QCOMPARE(storage.contains(QPoint(49, 49)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(50, 49)).backgroundColor(), c2);
+    QCOMPARE(storage.contains(QPoint(50, 1000)).backgroundColor(), c2);
+    // structural changes
+    storage.insertRows(20, 1);
+    QCOMPARE(storage.contains(QPoint(1, 101)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(30, 30)).backgroundColor(), c1);
+    QCOMPARE(storage.contains(QPoint(30, 31)).backgroundColor(), c2);
+}
+
+void TestStyleStorage::testCacheEviction()
+{
+    Map map;
+    StyleStorage storage(&map);
+
+    QColor c1(Qt::red);
+    QColor c2(Qt::blue);
+    storage.insert(QRect(1, 1, 32 * 20, 32 * 20), SharedSubStyle(new SubStyleOne<Style::BackgroundColor, QColor>(c1)));
+    // more tiles than cached
+    for (int col = 1; col <= 32 * 20; col += 16) {
+        for (int row = 1; row <= 32 * 20; row += 16)
+            QCOMPARE(storage.contains(QPoint(col, row)).backgroundColor(), c1);
+    }
+    // dropped and still cached tiles are invalidated alike
+    storage.insert(QRect(1, 1, 32 * 20, 32 * 20), SharedSubStyle(new SubStyleOne<Style::BackgroundColor, QColor>(c2)));
+    for (int col = 1; col <= 32 * 20; col += 16) {
+        for (int row = 1; row <= 32 * 20; row += 16)
+            QCOMPARE(storage.contains(QPoint(col, row)).backgroundColor(), c2);
+    }
+}
+
 QTEST_MAIN(TestStyleStorage)
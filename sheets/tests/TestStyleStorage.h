@@ -32,6 +32,8 @@ class TestStyleStorage : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testGarbageCollection();
+    void testCacheInvalidation();
+    void testCacheEviction();
 };
 
 } // namespace Sheets
@@ -384,7 +384,8 @@ bool KWOdfWriter::save(KoOdfWriteStore &odfStore, KoEmbeddedDocumentSaver &embed
     bodyWriter->endElement(); // office:text
     bodyWriter->endElement(); // office:body
 
-    odfStore.closeContentWriter();
+    if (!odfStore.closeContentWriter())
+        return false;
 
     // add manifest line for content.xml
     manifestWriter->addManifestEntry("content.xml", "text/xml");
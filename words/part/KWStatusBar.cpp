@@ -39,6 +39,7 @@
 #include <QLineEdit>
 #include <QIntValidator>
 #include <QToolButton>
+#include <QProgressBar>
 #include <QTimer>
 #include <QAction>
 
@@ -213,6 +214,14 @@ KWStatusBar::KWStatusBar(QStatusBar *statusBar, KWView *view)
     m_statusbar->addAction(action);
     connect(action, SIGNAL(toggled(bool)), this, SLOT(showMouse(bool)));
 
+    // shown while the pages of the document are still being created
+    m_layoutProgress = new QProgressBar(m_statusbar);
+    m_layoutProgress->setRange(0, 100);
+    m_layoutProgress->setMaximumWidth(QFontMetrics(m_layoutProgress->font()).width("999999999999"));
+    m_layoutProgress->setFormat(i18n("Layout %p%"));
+    m_statusbar->addWidget(m_layoutProgress);
+    m_layoutProgress->setVisible(false);
+
     m_statusLabel = new KSqueezedTextLabel(m_statusbar);
     m_statusLabel->setSizePolicy(QSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding));
     m_statusbar->addWidget(m_statusLabel, 1);
@@ -238,6 +247,7 @@ KWStatusBar::~KWStatusBar()
     delete m_modifiedLabel;
     delete m_pageLabel;
     delete m_mousePosLabel;
+    delete m_layoutProgress;
     delete m_statusLabel;
     foreach (QWidget *widget, m_zoomWidgets)
         widget->deleteLater();
@@ -351,6 +361,22 @@ void KWStatusBar::updateMousePosition(const QPoint &pos)
         m_mousePosLabel->setText(QString("%1:%2").arg(pos.x()).arg(pos.y()));
 }
 
+void KWStatusBar::updateLayoutProgress(int percent)
+{
+    m_layoutProgress->setValue(percent);
+}
+
+void KWStatusBar::layoutInterrupted()
+{
+    // only layout runs that give the event loop a break take long enough to show progress
+    m_layoutProgress->setVisible(true);
+}
+
+void KWStatusBar::layoutFinished()
+{
+    m_layoutProgress->setVisible(false);
+}
+
 void KWStatusBar::canvasResourceChanged(int key, const QVariant &value)
 {
     Q_UNUSED(value);
@@ -427,6 +453,12 @@ void KWStatusBar::setCurrentView(KWView *view)
             if (editor) {
                 disconnect(editor, SIGNAL(cursorPositionChanged()), this, SLOT(updateCursorPosition()));
             }
+            KoTextDocumentLayout *lay = qobject_cast<KoTextDocumentLayout*>(fs->document()->documentLayout());
+            if (lay) {
+                disconnect(lay, SIGNAL(layoutProgressChanged(int)), this, SLOT(updateLayoutProgress(int)));
+                disconnect(lay, SIGNAL(finishedLayout()), this, SLOT(layoutFinished()));
+                disconnect(lay, SIGNAL(layoutInterrupted()), this, SLOT(layoutInterrupted()));
+            }
         }
         disconnect(m_currentView, SIGNAL(shownPagesChanged()), this, SLOT(updatePageCount()));
     }
@@ -461,6 +493,12 @@ void KWStatusBar::setCurrentView(KWView *view)
         if (editor) {
             connect(editor, SIGNAL(cursorPositionChanged()), this, SLOT(updateCursorPosition()), Qt::QueuedConnection);
         }
+        KoTextDocumentLayout *lay = qobject_cast<KoTextDocumentLayout*>(fs->document()->documentLayout());
+        if (lay) {
+            connect(lay, SIGNAL(layoutProgressChanged(int)), this, SLOT(updateLayoutProgress(int)));
+            connect(lay, SIGNAL(finishedLayout()), this, SLOT(layoutFinished()));
+            connect(lay, SIGNAL(layoutInterrupted()), this, SLOT(layoutInterrupted()));
+        }
     }
     connect(m_currentView, SIGNAL(shownPagesChanged()), this, SLOT(updatePageCount()));
 }
@@ -28,6 +28,7 @@
 class QPoint;
 class QAction;
 class QLabel;
+class QProgressBar;
 class QStatusBar;
 
 class KSqueezedTextLabel;
@@ -67,6 +68,9 @@ private Q_SLOTS:
     void updateCursorPosition();
     void gotoLine();
     void updateMousePosition(const QPoint&);
+    void updateLayoutProgress(int percent);
+    void layoutFinished();
+    void layoutInterrupted();
     void canvasResourceChanged(int, const QVariant&);
     void updateCurrentTool(KoCanvasController*);
     void createZoomWidget();
@@ -105,6 +109,7 @@ private:
     QLabel *m_pageSizeLabel;
     KWStatusBarEditItem *m_lineLabel;
     QLabel *m_mousePosLabel;
+    QProgressBar *m_layoutProgress;
     KSqueezedTextLabel *m_statusLabel;
     QList<KWView*> m_views;
 };
@@ -45,6 +45,12 @@
 #include <QTextDocument>
 #include <QTextBlock>
 
+// The time in milliseconds a scheduled layout run of the main text may take
+// before it continues in the next run, and the number of root areas that are
+// laid out at once in any case to fill the first screen.
+static const int MainTextLayoutTimeSlice = 40;
+static const int MainTextSynchronousRootAreaCount = 4;
+
 KWTextFrameSet::KWTextFrameSet(KWDocument *wordsDocument, Words::TextFrameSetType type)
     : KWFrameSet(Words::TextFrameSet)
     , m_document(new QTextDocument())
@@ -180,6 +186,10 @@ void KWTextFrameSet::setupDocument()
     // the KoTextDocumentLayout needs to be setup after the actions above are done to prepare the document
     KoTextDocumentLayout *lay = new KoTextDocumentLayout(m_document, m_rootAreaProvider);
     lay->setWordprocessingMode();
+    if (m_textFrameSetType == Words::MainTextFrameSet) {
+        // keep the window responsive while the pages of a long document are created
+        lay->setLayoutTimeSlice(MainTextLayoutTimeSlice, MainTextSynchronousRootAreaCount);
+    }
 
     QObject::connect(lay, SIGNAL(foundAnnotation(KoShape*,QPointF)),
                      m_wordsDocument->annotationLayoutManager(), SLOT(registerAnnotationRefPosition(KoShape*,QPointF)));